@@ -0,0 +1,59 @@
+#include "alloccounter.h"
+
+#ifdef IYS_COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Plain thread_local counter - no atomics, no locks, each thread only bumps its own
+thread_local std::uint64_t allocationsOnThisThread = 0;
+} // namespace
+
+// The replaceable global allocation functions. The array and nothrow flavours
+// are specified to forward here, so these few cover everything we care about.
+void* operator new(std::size_t size)
+{
+    ++allocationsOnThisThread;
+    if (size == 0) {
+        size = 1; // operator new(0) must still hand back a unique pointer
+    }
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+bool AllocationCounter::enabled()
+{
+    return true;
+}
+
+std::uint64_t AllocationCounter::threadAllocations()
+{
+    return allocationsOnThisThread;
+}
+
+#else
+
+bool AllocationCounter::enabled()
+{
+    return false;
+}
+
+std::uint64_t AllocationCounter::threadAllocations()
+{
+    return 0;
+}
+
+#endif // IYS_COUNT_ALLOCATIONS
@@ -0,0 +1,21 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <cstdint>
+
+// 🧮 Heap Allocation Counter (debug builds only) 🧮
+// When IYS_COUNT_ALLOCATIONS is defined (CMake turns it on for Debug builds) we swap in
+// our own global operator new that bumps a per-thread counter before calling malloc.
+// That lets the traversal prove it doesn't allocate per scanned entry.
+// In release builds everything here compiles down to "nope, not counting".
+namespace AllocationCounter {
+
+// Are we actually counting in this build?
+bool enabled();
+
+// How many times the CALLING thread has hit operator new so far (0 when not counting)
+std::uint64_t threadAllocations();
+
+} // namespace AllocationCounter
+
+#endif // ALLOCCOUNTER_H
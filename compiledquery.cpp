@@ -0,0 +1,74 @@
+#include "compiledquery.h"
+
+namespace {
+PatternKind kindOf(const SearchConfig& config, const std::string& term)
+{
+    const MatchMode mode = config.matchMode;
+    if (!config.searchTerms.empty()) {
+        return PatternKind::MultiTerm;
+    }
+    if (mode == MatchMode::Fuzzy) {
+        return PatternKind::Fuzzy;
+    }
+    if (mode != MatchMode::Substring) {
+        return PatternKind::Automaton;
+    }
+    if (term.empty()) {
+        return PatternKind::Everything;
+    }
+    return term.size() == 1 ? PatternKind::Byte : PatternKind::Substring;
+}
+} // namespace
+
+CompiledQuery::CompiledQuery(const SearchConfig& config)
+    // (A glob or regex keeps its case - \d and \D aren't the same thing - the automaton folds instead)
+    : searchTermEffective(config.caseInsensitive && config.matchMode != MatchMode::Glob && config.matchMode != MatchMode::Regex
+                              ? SimdMatch::foldAscii(config.searchTerm) : config.searchTerm)
+    , extensionFilterEffective(config.caseInsensitive ? SimdMatch::foldAscii(config.extensionFilter) : config.extensionFilter)
+    , caseInsensitive(config.caseInsensitive)
+    , kind(kindOf(config, searchTermEffective))
+    , termMatcher(searchTermEffective, caseInsensitive)
+    , metadataFilter(config.metadata)
+{
+    // Search terms are prepped based on case sensitivity above - once per search, not per directory
+
+    // Add a dot to our extension if needed - just a little housekeeping
+    if (!extensionFilterEffective.empty() && extensionFilterEffective[0] != '.') {
+        extensionFilterEffective = "." + extensionFilterEffective;
+    }
+    if (kind == PatternKind::Byte) {
+        termByte = searchTermEffective[0];
+    }
+    if (kind == PatternKind::Fuzzy) {
+        fuzzy = FuzzyMatcher(searchTermEffective, caseInsensitive);
+    }
+    if (kind == PatternKind::MultiTerm) {
+        if (config.matchMode != MatchMode::Substring) {
+            patternProblem = "several terms at once only work as plain text (no glob, regex or fuzzy)";
+        } else {
+            multiTerm.compile(config.searchTerms, caseInsensitive, patternProblem);
+        }
+    }
+    if (kind == PatternKind::Automaton) {
+        const PatternSyntax syntax = config.matchMode == MatchMode::Glob ? PatternSyntax::Glob : PatternSyntax::Regex;
+        if (!automaton.compile(config.searchTerm, syntax, caseInsensitive, patternProblem) && patternProblem.empty()) {
+            patternProblem = "the pattern didn't compile";
+        }
+    }
+
+    // Pick the specialization matches() will call from now on
+    matchFunction = dispatch([](auto match) -> MatchFunction { return &decltype(match)::invoke; });
+}
+
+std::vector<std::string_view> CompiledQuery::requiredLiterals() const
+{
+    std::vector<std::string_view> literals;
+    if (kind == PatternKind::Automaton) {
+        literals.assign(automaton.requiredLiterals().begin(), automaton.requiredLiterals().end());
+    } else if (kind != PatternKind::Fuzzy && kind != PatternKind::MultiTerm) {
+        // (Fuzzy letters needn't sit together, and a name needs only ONE of several terms - nothing every match must have)
+        literals.push_back(searchTermEffective);
+    }
+    literals.push_back(extensionFilterEffective);
+    return literals;
+}
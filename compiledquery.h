@@ -0,0 +1,176 @@
+#ifndef COMPILEDQUERY_H
+#define COMPILEDQUERY_H
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "searchlogic.h" // SearchConfig
+#include "simdmatch.h"   // SubstringMatcher
+#include "dfamatch.h"    // DfaMatcher, for globs and regexes
+#include "fuzzymatch.h"  // FuzzyMatcher, for fuzzy mode
+#include "multimatch.h"  // MultiTermMatcher, for several terms in one walk
+#include "metadatafilter.h" // MetadataFilter, for size/time/owner predicates
+
+// 🔍 Decides whether a filename is what the user is looking for 🔍
+// Compiled ONCE per search (SearchWorker::doSearch) from the SearchConfig: the term and
+// extension get lowercased up front when case doesn't matter, and the query works out
+// which kind of test it needs (globs and regexes get their automaton built right here).
+// Read-only afterwards, so every worker thread shares one.
+//
+// The per-entry check is specialized at compile time for every combination of
+// (case mode, extension filter or not, pattern kind), so the hot path never asks
+// "are we case-insensitive?" or "is there an extension?" again. Two ways in:
+//   matches(name)  - one indirect call into the right specialization
+//   dispatch(f)    - calls f(match) with a matcher whose TYPE is the specialization,
+//                    so a loop written inside f gets compiled once per combination
+//                    with the check inlined (the walk and the index scan use this)
+
+// What the search term boils down to
+enum class PatternKind {
+    Everything, // No term at all - every name passes (the extension may still filter)
+    Byte,       // A single character - a plain byte scan beats any setup
+    Substring,  // The general case - the vectorized SubstringMatcher
+    Automaton,  // A glob or regex (MatchMode) - the compiled DfaMatcher
+    Fuzzy,      // Fuzzy mode - the bit-parallel subsequence test (ranking happens where matches are reported)
+    MultiTerm   // SearchConfig::searchTerms - one Aho-Corasick pass for all of them (tagging happens where matches are reported)
+};
+
+class CompiledQuery
+{
+public:
+    explicit CompiledQuery(const SearchConfig& config);
+
+    // Does this bare filename (no directory part) pass both tests?
+    bool matches(std::string_view filename) const { return matchFunction(*this, filename); }
+
+    // One specialization of the check; Fold = case-insensitive, HasExtension = filter present
+    template <bool Fold, bool HasExtension, PatternKind Kind>
+    struct Matcher {
+        const CompiledQuery& query;
+        bool operator()(std::string_view filename) const;
+        static bool invoke(const CompiledQuery& query, std::string_view filename) { return Matcher{query}(filename); }
+    };
+
+    // Picks the specialization once and hands it to f (see above). Returns whatever f returns.
+    template <typename F>
+    decltype(auto) dispatch(F&& f) const;
+
+    // What it's actually looking for (already lowercased when caseInsensitive), so an
+    // index can narrow things down before asking matches()
+    const std::string& term() const { return searchTermEffective; }
+    const std::string& extension() const { return extensionFilterEffective; }
+    bool isCaseInsensitive() const { return caseInsensitive; }
+    PatternKind patternKind() const { return kind; }
+
+    // A glob or regex that didn't compile (or a term list that can't be) matches nothing - check this before searching
+    bool isValid() const { return patternProblem.empty(); }
+    const std::string& problem() const { return patternProblem; }
+
+    // Literal pieces every match must contain (folded when caseInsensitive): the term and the
+    // extension, or for a glob/regex whatever literals it can't match without. For the index.
+    std::vector<std::string_view> requiredLiterals() const;
+
+    // Fuzzy mode: the matcher that also scores the matches, for a FuzzyRanking
+    const FuzzyMatcher& fuzzyMatcher() const { return fuzzy; }
+
+    // Multi-term mode: the automaton that also says WHICH terms a name has, for TermGroups
+    const MultiTermMatcher& multiTermMatcher() const { return multiTerm; }
+
+    // Size/time/owner predicates (SearchConfig::metadata). NOT part of matches() - they cost a
+    // stat, so whoever reports matches asks this one only once the name has passed.
+    const MetadataFilter& metadata() const { return metadataFilter; }
+
+private:
+    template <bool Fold, bool HasExtension, typename F>
+    decltype(auto) dispatchKind(F&& f) const;
+
+    std::string searchTermEffective;
+    std::string extensionFilterEffective; // Always starts with a dot (or is empty)
+    bool caseInsensitive;
+    PatternKind kind;
+    char termByte = 0; // PatternKind::Byte: the one character (folded when caseInsensitive)
+    SubstringMatcher termMatcher;
+    DfaMatcher automaton;       // PatternKind::Automaton
+    FuzzyMatcher fuzzy;         // PatternKind::Fuzzy
+    MultiTermMatcher multiTerm; // PatternKind::MultiTerm
+    MetadataFilter metadataFilter;
+    std::string patternProblem; // Why the glob/regex didn't compile (empty = fine)
+
+    using MatchFunction = bool (*)(const CompiledQuery&, std::string_view);
+    MatchFunction matchFunction;
+};
+
+// --- The specialized checks (templates, so they live here where callers can inline them) ---
+
+template <bool Fold, bool HasExtension, PatternKind Kind>
+inline bool CompiledQuery::Matcher<Fold, HasExtension, Kind>::operator()(std::string_view filename) const
+{
+    // 🔍 Test 1: the extension, when there is one - it's the cheaper test, so it goes first.
+    // Same idea as fs::path::extension(): everything from the last dot, unless the dot leads the name.
+    if constexpr (HasExtension) {
+        const std::string& wanted = query.extensionFilterEffective;
+        const std::size_t dot = filename.rfind('.');
+        if (dot == std::string_view::npos || dot == 0 || filename.size() - dot != wanted.size()) {
+            return false;
+        }
+        for (std::size_t k = 1; k < wanted.size(); ++k) { // k = 0 is the dot, already known to match
+            const char c = Fold ? SimdMatch::foldAscii(filename[dot + k]) : filename[dot + k];
+            if (c != wanted[k]) {
+                return false;
+            }
+        }
+    }
+
+    // 🔍 Test 2: the search term
+    if constexpr (Kind == PatternKind::Everything) {
+        return true;
+    } else if constexpr (Kind == PatternKind::Byte) {
+        if constexpr (!Fold) {
+            return std::memchr(filename.data(), query.termByte, filename.size()) != nullptr;
+        }
+        for (char c : filename) {
+            if (SimdMatch::foldAscii(c) == query.termByte) {
+                return true;
+            }
+        }
+        return false;
+    } else if constexpr (Kind == PatternKind::Automaton) {
+        return query.automaton.matches(filename); // Does its own case folding
+    } else if constexpr (Kind == PatternKind::Fuzzy) {
+        return query.fuzzy.matches(filename);     // This one too
+    } else if constexpr (Kind == PatternKind::MultiTerm) {
+        return query.multiTerm.matchesAny(filename); // Folded terms, folding table
+    } else {
+        return query.termMatcher.contains(filename);
+    }
+}
+
+template <typename F>
+decltype(auto) CompiledQuery::dispatch(F&& f) const
+{
+    if (caseInsensitive) {
+        return extensionFilterEffective.empty() ? dispatchKind<true, false>(std::forward<F>(f))
+                                                : dispatchKind<true, true>(std::forward<F>(f));
+    }
+    return extensionFilterEffective.empty() ? dispatchKind<false, false>(std::forward<F>(f))
+                                            : dispatchKind<false, true>(std::forward<F>(f));
+}
+
+template <bool Fold, bool HasExtension, typename F>
+decltype(auto) CompiledQuery::dispatchKind(F&& f) const
+{
+    switch (kind) {
+    case PatternKind::Everything: return f(Matcher<Fold, HasExtension, PatternKind::Everything>{*this});
+    case PatternKind::Byte: return f(Matcher<Fold, HasExtension, PatternKind::Byte>{*this});
+    case PatternKind::Automaton: return f(Matcher<Fold, HasExtension, PatternKind::Automaton>{*this});
+    case PatternKind::Fuzzy: return f(Matcher<Fold, HasExtension, PatternKind::Fuzzy>{*this});
+    case PatternKind::MultiTerm: return f(Matcher<Fold, HasExtension, PatternKind::MultiTerm>{*this});
+    case PatternKind::Substring: break;
+    }
+    return f(Matcher<Fold, HasExtension, PatternKind::Substring>{*this});
+}
+
+#endif // COMPILEDQUERY_H
@@ -0,0 +1,375 @@
+#include "contentsearch.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kSnippetLead = 60; // Context kept before the match when a long line gets cut
+
+// How many '\n' in [p, p + length) - memchr is vectorized in every libc we run on
+std::uint64_t countNewlines(const char* p, std::size_t length)
+{
+    std::uint64_t count = 0;
+    const char* end = p + length;
+    while (p < end) {
+        const void* hit = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+        if (!hit) {
+            break;
+        }
+        ++count;
+        p = static_cast<const char*>(hit) + 1;
+    }
+    return count;
+}
+
+bool isContinuationByte(char c)
+{
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// ✂️ The matching line as a snippet: whole if it's short, otherwise kSnippetMax bytes around
+// the match with "..." where we cut (never in the middle of a UTF-8 character)
+std::string snippetOf(std::string_view text, std::size_t lineStart, std::size_t lineEnd, std::size_t matchAt)
+{
+    if (lineEnd > lineStart && text[lineEnd - 1] == '\r') {
+        --lineEnd; // CRLF files
+    }
+    std::size_t start = lineStart;
+    std::size_t end = lineEnd;
+    if (end - start > ContentSearcher::kSnippetMax) {
+        start = std::max(lineStart, matchAt > kSnippetLead ? matchAt - kSnippetLead : 0);
+        end = std::min(lineEnd, start + ContentSearcher::kSnippetMax);
+        while (start > lineStart && start < end && isContinuationByte(text[start])) {
+            ++start;
+        }
+        while (end < lineEnd && end > start && isContinuationByte(text[end])) {
+            --end;
+        }
+    }
+    std::string snippet;
+    snippet.reserve(end - start + 6);
+    if (start > lineStart) snippet += "...";
+    snippet.append(text.data() + start, end - start);
+    if (end < lineEnd) snippet += "...";
+    return snippet;
+}
+
+} // namespace
+
+ContentSearcher::ContentSearcher(const SearchConfig& config, MatchSink onMatch, std::atomic<bool>& cancelled,
+                                 ErrorSink onError)
+    : matcher(config.contentTerm, config.caseInsensitive)
+    , maxMatchesPerFile(config.contentMaxMatchesPerFile)
+    , onMatch(std::move(onMatch))
+    , onError(std::move(onError))
+    , cancelled(cancelled)
+{
+    const unsigned int count = resolveReaderCount(config);
+    readers.reserve(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        readers.emplace_back(&ContentSearcher::run, this);
+    }
+}
+
+ContentSearcher::~ContentSearcher()
+{
+    finish();
+}
+
+unsigned int ContentSearcher::resolveReaderCount(const SearchConfig& config)
+{
+    if (config.contentReaders > 0) {
+        return config.contentReaders;
+    }
+    // Reading is mostly waiting on the disk - a few readers keep it busy, more just fight over it
+    const unsigned int cores = std::thread::hardware_concurrency();
+    return std::clamp(cores, 2u, 8u);
+}
+
+void ContentSearcher::submit(std::string_view path)
+{
+    candidates.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (queue.size() >= kMaxQueuedFiles) {
+        // 🐢 The readers can't keep up - hold the walk here rather than queue up the whole tree
+        producerWaits.fetch_add(1, std::memory_order_relaxed);
+        queueChanged.wait(lock, [this] { return queue.size() < kMaxQueuedFiles || finishing || cancelled.load(); });
+    }
+    if (cancelled.load()) {
+        return;
+    }
+    queue.emplace_back(path);
+    queueChanged.notify_all();
+}
+
+ContentSearchStats ContentSearcher::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        finishing = true;
+    }
+    queueChanged.notify_all();
+    for (std::thread& reader : readers) {
+        if (reader.joinable()) {
+            reader.join(); // They drain the queue before they leave
+        }
+    }
+    return stats();
+}
+
+ContentSearchStats ContentSearcher::stats() const
+{
+    ContentSearchStats s;
+    s.candidates = candidates.load(std::memory_order_relaxed);
+    s.filesSearched = filesSearched.load(std::memory_order_relaxed);
+    s.binarySkipped = binarySkipped.load(std::memory_order_relaxed);
+    s.unreadable = unreadable.load(std::memory_order_relaxed);
+    s.mappedFiles = mappedFiles.load(std::memory_order_relaxed);
+    s.bytesSearched = bytesSearched.load(std::memory_order_relaxed);
+    s.matchingFiles = matchingFiles.load(std::memory_order_relaxed);
+    s.matchingLines = matchingLines.load(std::memory_order_relaxed);
+    s.producerWaits = producerWaits.load(std::memory_order_relaxed);
+    s.readers = static_cast<unsigned int>(readers.size());
+    return s;
+}
+
+// 🧵 One reader: take a path, search the file, repeat - with one buffer for its whole life
+void ContentSearcher::run()
+{
+    std::string buffer;
+    for (;;) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueChanged.wait(lock, [this] { return !queue.empty() || finishing; });
+            if (queue.empty()) {
+                break; // finishing, and nothing left to read
+            }
+            path = std::move(queue.front());
+            queue.pop_front();
+        }
+        queueChanged.notify_all(); // Room for a waiting submit()
+        if (!cancelled.load()) {
+            searchFile(path, buffer);
+        }
+    }
+}
+
+void ContentSearcher::searchFile(const std::string& path, std::string& buffer)
+{
+    auto fail = [&](const char* what) {
+        unreadable.fetch_add(1, std::memory_order_relaxed);
+        if (onError) {
+            onError(std::string("can't ") + what + " " + path + " - " + std::strerror(errno));
+        }
+    };
+
+#ifdef _WIN32
+    // No pread or mmap here - a plain read into the reused buffer does the job
+    std::ifstream in(std::filesystem::u8path(path), std::ios::binary);
+    if (!in) {
+        fail("open");
+        return;
+    }
+    in.seekg(0, std::ios::end);
+    const std::streamoff size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    buffer.resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    scan(path, std::string_view(buffer.data(), static_cast<std::size_t>(in.gcount())));
+#else
+    // O_NONBLOCK: a FIFO that slipped through must not hang a reader (regular files don't care)
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        fail("open");
+        return;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        fail("stat");
+        ::close(fd);
+        return;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        ::close(fd); // Devices, sockets, FIFOs: not ours to read
+        return;
+    }
+    const std::uint64_t size = static_cast<std::uint64_t>(info.st_size);
+
+    // 🗺️ Big file: map it and let the kernel page it in (read-ahead knows we go front to back)
+    if (size >= kMapThreshold) {
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            ::close(fd); // The mapping keeps the file alive on its own
+            ::madvise(mapped, size, MADV_SEQUENTIAL);
+            mappedFiles.fetch_add(1, std::memory_order_relaxed);
+            scan(path, std::string_view(static_cast<const char*>(mapped), size));
+            ::munmap(mapped, size);
+            return;
+        }
+        // Couldn't map it (some network filesystems say no) - read it a piece at a time instead
+        if (!scanInPieces(fd, path, buffer)) {
+            fail("read");
+        }
+        ::close(fd);
+        return;
+    }
+
+    // 📥 Small file: pread into the reader's buffer (it keeps its capacity for the next one)
+    buffer.resize(size);
+    std::size_t filled = 0;
+    while (filled < size) {
+        const ssize_t got = ::pread(fd, buffer.data() + filled, size - filled, static_cast<off_t>(filled));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            fail("read");
+            ::close(fd);
+            return;
+        }
+        if (got == 0) {
+            break; // It shrank while we were at it - search what we got
+        }
+        filled += static_cast<std::size_t>(got);
+    }
+    ::close(fd);
+    scan(path, std::string_view(buffer.data(), filled));
+#endif
+}
+
+#ifndef _WIN32
+// 📚 A big file mmap() turned down, through the reader's buffer kMapThreshold at a time.
+// Every piece ends at a line end and the rest of that line starts the next one, so matches and
+// snippets come out the same as from the mapping. A line longer than the whole buffer gets
+// cut, keeping the last needle length - 1 bytes so a match across the cut is still found.
+bool ContentSearcher::scanInPieces(int fd, const std::string& path, std::string& buffer)
+{
+    const std::size_t overlap = matcher.needle().empty() ? 0 : matcher.needle().size() - 1;
+    buffer.resize(kMapThreshold);
+    ScanState state;
+    std::size_t held = 0;     // Bytes at the front of buffer, the first of them left over from the last piece
+    std::uint64_t offset = 0; // Where the next pread() starts
+    bool firstPiece = true;
+    bool atEnd = false;
+    while (!atEnd && !cancelled.load(std::memory_order_relaxed)) {
+        const std::size_t leftOver = held;
+        while (held < buffer.size()) {
+            const ssize_t got = ::pread(fd, buffer.data() + held, buffer.size() - held, static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got < 0) {
+                return false;
+            }
+            if (got == 0) {
+                atEnd = true; // The end (or it shrank while we were at it - search what we got)
+                break;
+            }
+            held += static_cast<std::size_t>(got);
+            offset += static_cast<std::uint64_t>(got);
+        }
+        if (firstPiece) {
+            firstPiece = false;
+            // 🚫 Binary? Same look at the start as scan() takes
+            if (std::memchr(buffer.data(), '\0', std::min(held, kBinaryProbe)) != nullptr) {
+                binarySkipped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            filesSearched.fetch_add(1, std::memory_order_relaxed);
+        }
+        bytesSearched.fetch_add(held - leftOver, std::memory_order_relaxed);
+
+        // Up to the last line end; what comes after it waits for the rest of its line
+        std::size_t pieceEnd = held;
+        std::size_t keep = 0;
+        if (!atEnd) {
+            const std::size_t lastNewline = std::string_view(buffer.data(), held).rfind('\n');
+            if (lastNewline != std::string_view::npos) {
+                pieceEnd = lastNewline + 1;
+                keep = held - pieceEnd;
+            } else {
+                keep = std::min(overlap, held / 2); // One enormous line: scanned now, its tail again next time
+            }
+        }
+        if (!scanPiece(path, std::string_view(buffer.data(), pieceEnd), state)) {
+            return true; // Match limit reached, or cancelled
+        }
+        std::memmove(buffer.data(), buffer.data() + held - keep, keep);
+        held = keep;
+    }
+    return true;
+}
+#endif
+
+void ContentSearcher::scan(const std::string& path, std::string_view text)
+{
+    // 🚫 Binary? A NUL byte near the start says so - text files don't have them
+    if (std::memchr(text.data(), '\0', std::min(text.size(), kBinaryProbe)) != nullptr) {
+        binarySkipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    filesSearched.fetch_add(1, std::memory_order_relaxed);
+    bytesSearched.fetch_add(text.size(), std::memory_order_relaxed);
+    ScanState state;
+    scanPiece(path, text, state);
+}
+
+bool ContentSearcher::scanPiece(const std::string& path, std::string_view text, ScanState& state)
+{
+    std::uint64_t line = state.line;
+    std::size_t counted = 0; // Newlines before here are in line already
+    std::size_t from = 0;    // Always the start of a line (or of the piece)
+    std::size_t& reported = state.reported;
+    if (state.lineReported) {
+        // Still inside a line the last piece already reported - one report per line
+        const void* newline = std::memchr(text.data(), '\n', text.size());
+        if (!newline) {
+            return true;
+        }
+        from = static_cast<std::size_t>(static_cast<const char*>(newline) - text.data()) + 1;
+        state.lineReported = false;
+    }
+    while (from < text.size() && !cancelled.load(std::memory_order_relaxed)) {
+        std::size_t at = matcher.find(text.substr(from));
+        if (at == SubstringMatcher::npos) {
+            break;
+        }
+        at += from;
+        line += countNewlines(text.data() + counted, at - counted);
+        counted = at;
+
+        std::size_t lineStart = at;
+        while (lineStart > from && text[lineStart - 1] != '\n') {
+            --lineStart;
+        }
+        const void* newline = std::memchr(text.data() + at, '\n', text.size() - at);
+        const std::size_t lineEnd = newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - text.data())
+                                            : text.size();
+
+        onMatch(path, line, snippetOf(text, lineStart, lineEnd, at));
+        matchingLines.fetch_add(1, std::memory_order_relaxed);
+        if (++reported == 1) {
+            matchingFiles.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (maxMatchesPerFile != 0 && reported >= maxMatchesPerFile) {
+            return false;
+        }
+        state.lineReported = lineEnd == text.size(); // The piece ends inside this line
+        from = lineEnd + 1; // One report per line - on to the next one
+    }
+    state.line = line + countNewlines(text.data() + counted, text.size() - counted);
+    return !cancelled.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,122 @@
+#ifndef CONTENTSEARCH_H
+#define CONTENTSEARCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "searchlogic.h" // SearchConfig
+#include "simdmatch.h"   // SubstringMatcher - the same vectorized kernel the names go through
+
+// 📖 Searching INSIDE Files 📖
+// We used to pipe our results into grep, which opened and read every candidate again, one at
+// a time, after the walk was done. Now the search does it itself, while the walk is still going:
+// every file whose name passes (SearchConfig::contentTerm set) is handed to a small pool of
+// reader threads through a bounded queue, so reading overlaps walking and a slow disk holds the
+// walk back instead of piling up memory.
+//
+// Per file, a reader:
+//   1. opens it and asks its size (anything that isn't a regular file is left alone)
+//   2. reads it - big files (kMapThreshold and up) are mmap'ed, so the kernel pages them in
+//      as we go and nothing is copied; small ones go into the reader's own buffer with
+//      pread(), and that buffer is reused for the next file, so there's no allocation per file.
+//      A big file that can't be mapped goes through that buffer kMapThreshold at a time, cut
+//      at line ends, so no file ever costs a reader more memory than that
+//   3. skips it if a NUL byte shows up in the first kBinaryProbe bytes - that's a binary
+//      file, not text (the same guess grep makes)
+//   4. runs SubstringMatcher::find() over the whole thing (AVX2/SSE4.2 when the CPU has them),
+//      and for every hit works out the line number and cuts out the line as a snippet
+//
+// Matches come out through onMatch(path, line, snippet), from the reader threads - so it
+// has to be thread-safe (a ResultBatcher is). Each matching line is reported once.
+
+struct ContentSearchStats {
+    std::uint64_t candidates = 0;    // Files the name stage handed over
+    std::uint64_t filesSearched = 0; // ...that got read all the way through (or to the match limit)
+    std::uint64_t binarySkipped = 0; // ...skipped: a NUL byte near the start
+    std::uint64_t unreadable = 0;    // ...that couldn't be opened or read
+    std::uint64_t mappedFiles = 0;   // Read through mmap (the big ones)
+    std::uint64_t bytesSearched = 0;
+    std::uint64_t matchingFiles = 0; // Files with at least one match
+    std::uint64_t matchingLines = 0; // Lines reported
+    std::uint64_t producerWaits = 0; // Times the walk had to wait for a full queue
+    unsigned int readers = 0;
+};
+
+class ContentSearcher
+{
+public:
+    using MatchSink = std::function<void(std::string_view path, std::uint64_t line, std::string_view snippet)>;
+    using ErrorSink = std::function<void(const std::string& message)>;
+
+    static constexpr std::size_t kMaxQueuedFiles = 4096;          // submit() waits beyond this
+    static constexpr std::uint64_t kMapThreshold = 1024 * 1024;   // mmap from here up, pread below
+    static constexpr std::size_t kBinaryProbe = 8192;             // How far we look for a NUL byte
+    static constexpr std::size_t kSnippetMax = 200;               // Longer lines get cut down around the match
+
+    // Starts the readers. Searches for config.contentTerm (folded when config.caseInsensitive).
+    // cancelled is checked between files and between matches. onError (optional) hears about
+    // files we couldn't read.
+    ContentSearcher(const SearchConfig& config, MatchSink onMatch, std::atomic<bool>& cancelled,
+                    ErrorSink onError = ErrorSink());
+    ~ContentSearcher(); // Finishes if nobody did
+
+    ContentSearcher(const ContentSearcher&) = delete;
+    ContentSearcher& operator=(const ContentSearcher&) = delete;
+
+    // Queues one candidate file. Thread-safe; only waits if the queue is full.
+    void submit(std::string_view path);
+
+    // Lets the readers finish everything queued, then stops them. Returns the final numbers.
+    ContentSearchStats finish();
+
+    ContentSearchStats stats() const; // The numbers so far (any thread, any time)
+
+    // Turns config.contentReaders (0 = auto) into the number of readers a search will use
+    static unsigned int resolveReaderCount(const SearchConfig& config);
+
+private:
+    void run();
+    void searchFile(const std::string& path, std::string& buffer);
+    // Where a file's scan has got to - one piece of it at a time when it's read in pieces
+    struct ScanState {
+        std::uint64_t line = 1;    // Line number at the start of the next piece
+        std::size_t reported = 0;  // Lines reported from this file so far
+        bool lineReported = false; // The last piece ended inside a line that's already been reported
+    };
+    void scan(const std::string& path, std::string_view text);
+    bool scanPiece(const std::string& path, std::string_view text, ScanState& state); // False = stop reading
+    bool scanInPieces(int fd, const std::string& path, std::string& buffer);          // False = a read failed
+
+    const SubstringMatcher matcher;
+    const std::size_t maxMatchesPerFile;
+    MatchSink onMatch;
+    ErrorSink onError;
+    std::atomic<bool>& cancelled;
+
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<std::string> queue;
+    bool finishing = false;
+    std::vector<std::thread> readers;
+
+    std::atomic<std::uint64_t> candidates{0};
+    std::atomic<std::uint64_t> filesSearched{0};
+    std::atomic<std::uint64_t> binarySkipped{0};
+    std::atomic<std::uint64_t> unreadable{0};
+    std::atomic<std::uint64_t> mappedFiles{0};
+    std::atomic<std::uint64_t> bytesSearched{0};
+    std::atomic<std::uint64_t> matchingFiles{0};
+    std::atomic<std::uint64_t> matchingLines{0};
+    std::atomic<std::uint64_t> producerWaits{0};
+};
+
+#endif // CONTENTSEARCH_H
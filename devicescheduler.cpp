@@ -0,0 +1,426 @@
+#include "devicescheduler.h"
+#include "rootplanner.h"
+#include "traversalengine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <sys/stat.h>
+#include <sys/sysmacros.h> // major, minor
+#endif
+
+namespace {
+
+// How often the calling thread reports the live scanned count (same beat as a single engine)
+constexpr auto kProgressInterval = std::chrono::milliseconds(250);
+
+// What one root lives on
+struct DeviceIdentity {
+    std::string key;  // Roots with the same key share a disk (or a server)
+    std::string name;
+    DeviceKind kind = DeviceKind::Unknown;
+};
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+
+// Filesystems whose data sits on another machine
+bool isNetworkFilesystem(const std::string& type)
+{
+    static const char* const network[] = {
+        "nfs", "nfs4", "cifs", "smb3", "smbfs", "ncpfs", "afs", "9p", "ceph", "glusterfs", "lustre",
+        "gpfs", "beegfs", "davfs", "fuse.sshfs", "fuse.s3fs", "fuse.rclone", "fuse.glusterfs", "fuse.davfs2",
+    };
+    for (const char* name : network) {
+        if (type == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// "server:/export" -> "server", "//server/share" -> "server", "user@host:/dir" -> "host"
+std::string serverOf(const std::string& source)
+{
+    std::string server = source;
+    if (server.rfind("//", 0) == 0) {
+        server = server.substr(2, server.find('/', 2) - 2);
+    } else if (server.find(':') != std::string::npos) {
+        server = server.substr(0, server.find(':'));
+    }
+    const std::size_t at = server.rfind('@');
+    if (at != std::string::npos) {
+        server = server.substr(at + 1);
+    }
+    return server.empty() ? source : server;
+}
+
+bool readSysfsFlag(const fs::path& file, bool& value)
+{
+    std::ifstream in(file);
+    int number = 0;
+    if (!(in >> number)) {
+        return false;
+    }
+    value = number != 0;
+    return true;
+}
+
+// The disk behind a block device: partitions go to their whole disk, and a device-mapper or md
+// device sitting on exactly one other device (LVM on one drive, dm-crypt) goes down to that one.
+// Returns the disk's sysfs folder, or an empty path when sysfs doesn't know the number.
+fs::path diskFolderOf(dev_t device)
+{
+    std::error_code ec;
+    fs::path folder = fs::canonical("/sys/dev/block/" + std::to_string(major(device)) + ":" + std::to_string(minor(device)), ec);
+    if (ec) {
+        return {};
+    }
+    for (int layers = 0; layers < 8; ++layers) { // (A loop can't happen, but a bound costs nothing)
+        if (fs::exists(folder / "partition", ec)) {
+            folder = folder.parent_path();
+        }
+        std::vector<fs::path> below;
+        for (fs::directory_iterator it(folder / "slaves", ec), end; !ec && it != end; it.increment(ec)) {
+            below.push_back(it->path());
+        }
+        if (below.size() != 1) {
+            break; // A real disk, or spread over several (RAID, striped LVM) - this is as far as it goes
+        }
+        const fs::path next = fs::canonical(below.front(), ec);
+        if (ec) {
+            break;
+        }
+        folder = next;
+    }
+    return folder;
+}
+
+DeviceIdentity identify(const fs::path& root, const RootPlan& plan)
+{
+    DeviceIdentity identity;
+    struct stat st;
+    if (::stat(root.c_str(), &st) != 0) {
+        identity.key = identity.name = root.string(); // Can't tell - it walks on its own
+        return identity;
+    }
+    const std::uint64_t device = static_cast<std::uint64_t>(st.st_dev);
+    identity.key = identity.name = deviceName(device);
+
+    // The plan already has the mount table's word on the filesystem type and source
+    const MountPlanEntry* mount = nullptr;
+    for (const MountPlanEntry& entry : plan.mounts) {
+        if (entry.device == device && (!mount || entry.decision == MountDecision::Root)) {
+            mount = &entry;
+        }
+    }
+    if (mount && isNetworkFilesystem(mount->fsType)) {
+        identity.kind = DeviceKind::Network;
+        identity.name = serverOf(mount->source);
+        identity.key = "net:" + identity.name; // Two exports of one server are one server
+        return identity;
+    }
+    if (mount && (mount->fsType == "tmpfs" || mount->fsType == "ramfs")) {
+        identity.kind = DeviceKind::Memory;
+        identity.name = mount->fsType + " " + identity.name;
+        return identity;
+    }
+
+    // btrfs and friends report a made-up st_dev - their source (/dev/nvme0n1p2) is the real one
+    fs::path disk = diskFolderOf(st.st_dev);
+    struct stat sourceStat;
+    if (disk.empty() && mount && mount->source.rfind("/dev/", 0) == 0 && ::stat(mount->source.c_str(), &sourceStat) == 0
+        && S_ISBLK(sourceStat.st_mode)) {
+        disk = diskFolderOf(sourceStat.st_rdev);
+    }
+    bool rotational = false;
+    if (disk.empty() || !readSysfsFlag(disk / "queue" / "rotational", rotational)) {
+        return identity; // Unknown - it walks on its own, with every worker it can get
+    }
+    identity.name = disk.filename().string();
+    identity.key = "disk:" + disk.string();
+    identity.kind = rotational ? DeviceKind::Rotational
+                    : identity.name.rfind("nvme", 0) == 0 ? DeviceKind::Nvme
+                                                         : DeviceKind::Ssd;
+    return identity;
+}
+
+#else // Windows drive letters, macOS volumes: no sysfs to ask, so each root is a disk of its own
+
+DeviceIdentity identify(const fs::path& root, const RootPlan&)
+{
+    DeviceIdentity identity;
+    identity.key = identity.name = root.string();
+    return identity;
+}
+
+#endif
+
+unsigned int workerLimit(DeviceKind kind, const SearchConfig& config, unsigned int budget)
+{
+    switch (kind) {
+    case DeviceKind::Rotational: return std::max(1u, std::min(config.rotationalThreads, budget));
+    case DeviceKind::Network: return std::max(1u, std::min(config.networkThreads, budget));
+    default: return budget; // Flash, memory, or no idea: as many as there are
+    }
+}
+
+bool wantsInodeOrder(DeviceKind kind, const SearchConfig& config)
+{
+    switch (config.entryOrder) {
+    case EntryOrder::Inode: return true;
+    case EntryOrder::Directory: return false;
+    case EntryOrder::Auto: break;
+    }
+    return kind == DeviceKind::Rotational; // The only kind where seeks cost more than the sort
+}
+
+// 🎟️ Hands out runs of neighbouring worker slots, so an engine can count worker i into slot first + i
+class SlotPool
+{
+public:
+    explicit SlotPool(unsigned int slots) : busy(slots, false) {}
+
+    // Waits for count free slots in a row. False if the search got cancelled while waiting.
+    bool acquire(unsigned int count, unsigned int& first, const std::atomic<bool>& cancelled)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            if (cancelled.load()) {
+                return false;
+            }
+            unsigned int run = 0;
+            for (unsigned int i = 0; i < busy.size(); ++i) {
+                run = busy[i] ? 0 : run + 1;
+                if (run == count) {
+                    first = i + 1 - count;
+                    std::fill(busy.begin() + first, busy.begin() + first + count, true);
+                    return true;
+                }
+            }
+            freed.wait_for(lock, kProgressInterval); // (Timed, so a cancel gets noticed too)
+        }
+    }
+
+    void release(unsigned int first, unsigned int count)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::fill(busy.begin() + first, busy.begin() + first + count, false);
+        }
+        freed.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable freed;
+    std::vector<bool> busy;
+};
+
+} // namespace
+
+std::vector<DeviceGroup> groupRootsByDevice(const RootPlan& plan, const SearchConfig& config)
+{
+    const unsigned int budget = resolveThreadCount(config);
+    std::vector<DeviceGroup> groups;
+    if (!config.deviceScheduling) {
+        DeviceGroup everything;
+        everything.name = "all";
+        everything.threads = budget;
+        everything.inodeOrder = wantsInodeOrder(DeviceKind::Unknown, config); // Nobody asked the disks
+        everything.roots = plan.roots;
+        groups.push_back(std::move(everything));
+        return groups;
+    }
+
+    // Same disk, same group - in the order the plan found them
+    std::vector<std::string> keys;
+    for (const fs::path& root : plan.roots) {
+        const DeviceIdentity identity = identify(root, plan);
+        const auto known = std::find(keys.begin(), keys.end(), identity.key);
+        if (known != keys.end()) {
+            groups[static_cast<std::size_t>(known - keys.begin())].roots.push_back(root);
+            continue;
+        }
+        keys.push_back(identity.key);
+        DeviceGroup group;
+        group.name = identity.name;
+        group.kind = identity.kind;
+        group.threads = 0;
+        group.inodeOrder = wantsInodeOrder(identity.kind, config);
+        group.roots.push_back(root);
+        groups.push_back(std::move(group));
+    }
+
+    // 🍰 Share the workers out one at a time, round robin, until every disk is at its limit or none are left.
+    // More disks than workers? The ones left with none get one each and wait their turn for a slot.
+    unsigned int left = budget;
+    bool handedOut = true;
+    while (left > 0 && handedOut) {
+        handedOut = false;
+        for (DeviceGroup& group : groups) {
+            if (left > 0 && group.threads < workerLimit(group.kind, config, budget)) {
+                ++group.threads;
+                --left;
+                handedOut = true;
+            }
+        }
+    }
+    for (DeviceGroup& group : groups) {
+        group.threads = std::max(1u, group.threads);
+    }
+    return groups;
+}
+
+const char* deviceKindName(DeviceKind kind)
+{
+    switch (kind) {
+    case DeviceKind::Nvme: return "nvme";
+    case DeviceKind::Ssd: return "ssd";
+    case DeviceKind::Rotational: return "rotational";
+    case DeviceKind::Network: return "network";
+    case DeviceKind::Memory: return "memory";
+    case DeviceKind::Unknown: return "unknown";
+    }
+    return "?";
+}
+
+std::string describeDeviceGroups(const std::vector<DeviceGroup>& groups)
+{
+    std::string text;
+    for (const DeviceGroup& group : groups) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "device %-16s %-10s %2u worker(s), %-9s order:", group.name.c_str(),
+                      deviceKindName(group.kind), group.threads, group.inodeOrder ? "inode" : "directory");
+        text += line;
+        for (const fs::path& root : group.roots) {
+            text += " " + root.string();
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+void searchDeviceGroups(
+    const std::vector<DeviceGroup>& groups,
+    const SearchConfig& config,
+    const CompiledQuery& query,
+    const SearchCallback& reportResult,
+    unsigned long long& foundCount,
+    std::atomic<bool>& cancellationFlag,
+    std::atomic<std::uint64_t>& filesScannedCount,
+    std::atomic<bool>& pauseFlag,
+    std::mutex& pauseMutexRef,
+    std::condition_variable& pauseConditionRef,
+    const ProgressCallback& onProgress,
+    FileObserver* fileObserver,
+    SearchTelemetry* telemetry,
+    SearchTrace* trace
+    )
+{
+    // Every engine keeps its own workers from calling at once - this keeps the ENGINES from doing it
+    std::mutex reportMutex;
+    const SearchCallback report = [&](const std::string& foundPath, const std::string& errorMessage) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        reportResult(foundPath, errorMessage);
+    };
+
+    // Per-disk progress rows, set up before anybody starts counting into them
+    std::vector<DeviceTally*> tallies(groups.size(), nullptr);
+    if (telemetry) {
+        for (std::size_t g = 0; g < groups.size(); ++g) {
+            tallies[g] = &telemetry->addDevice(groups[g].name, deviceKindName(groups[g].kind), groups[g].threads,
+                                               static_cast<unsigned int>(groups[g].roots.size()));
+        }
+    }
+
+    // Root spans go onto the search lane - which has one writer, this thread - once everyone is done
+    struct RootSpan {
+        std::uint64_t start;
+        std::uint64_t end;
+        std::uint64_t entries;
+        fs::path root;
+    };
+    std::vector<std::vector<RootSpan>> spans(groups.size());
+
+    SlotPool slots(resolveThreadCount(config));
+    std::atomic<unsigned long long> found{0};
+    std::atomic<std::size_t> running{groups.size()};
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+
+    auto walkGroup = [&](std::size_t g) {
+        const DeviceGroup& group = groups[g];
+        unsigned int first = 0;
+        if (slots.acquire(group.threads, first, cancellationFlag)) {
+            DeviceTally* tally = tallies[g];
+            if (tally) {
+                tally->startedAt.store(telemetryNow());
+            }
+            SearchConfig groupConfig = config;
+            groupConfig.threadCount = group.threads;
+            groupConfig.entryOrder = group.inodeOrder ? EntryOrder::Inode : EntryOrder::Directory;
+            for (const fs::path& root : group.roots) {
+                if (cancellationFlag.load()) {
+                    break;
+                }
+                TraversalEngine engine(groupConfig, query, report, cancellationFlag, filesScannedCount,
+                                       pauseFlag, pauseMutexRef, pauseConditionRef);
+                engine.setFileObserver(fileObserver);
+                engine.setTelemetry(telemetry);
+                engine.setTrace(trace);
+                engine.setWorkerSlots(first, true);
+                engine.setDeviceTally(tally);
+                const std::uint64_t start = telemetryNow();
+                found += engine.run(root);
+                spans[g].push_back({start, telemetryNow(), engine.entriesScanned(), root});
+                if (tally) {
+                    tally->rootsDone.fetch_add(1);
+                }
+            }
+            if (tally) {
+                tally->finishedAt.store(telemetryNow());
+            }
+            slots.release(first, group.threads);
+        }
+        if (running.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            doneCondition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> walkers;
+    walkers.reserve(groups.size());
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        walkers.emplace_back(walkGroup, g);
+    }
+
+    // 👀 Same job as a single engine's calling thread: wait, and keep whoever's watching posted
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        while (running.load() != 0) {
+            doneCondition.wait_for(lock, kProgressInterval);
+            if (onProgress && running.load() != 0) {
+                lock.unlock();
+                onProgress(filesScannedCount.load());
+                lock.lock();
+            }
+        }
+    }
+    for (std::thread& walker : walkers) {
+        walker.join();
+    }
+
+    if (trace) {
+        for (const std::vector<RootSpan>& groupSpans : spans) {
+            for (const RootSpan& span : groupSpans) {
+                trace->searchLane().record(TraceSpanKind::Root, span.start, span.end, span.entries, span.root.native());
+            }
+        }
+    }
+    foundCount += found.load();
+}
@@ -0,0 +1,88 @@
+#ifndef DEVICESCHEDULER_H
+#define DEVICESCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "searchlogic.h" // SearchConfig, SearchCallback & friends
+
+namespace fs = std::filesystem;
+
+struct RootPlan; // rootplanner.h
+
+// 💽 Walking Several Disks at Once 💽
+// A search of every drive used to walk its roots one after the other, so four separate disks
+// took as long as all four added up. Those disks don't get in each other's way, so now the roots
+// are sorted by the disk (or file server) they live on, and every disk gets its own walk, all of
+// them at the same time. Roots that share a disk (two partitions, two LVM volumes on one drive)
+// still take turns.
+//
+// Each disk also gets a worker limit that suits it. An NVMe or SATA SSD gets as many as it can
+// use. A spinning disk gets 1-2, because more workers just make its head seek back and forth
+// between their folders, and that's slower than one worker reading in order. A file server gets
+// a few, so one search doesn't flood it with requests. The kind comes from sysfs on Linux
+// (/sys/dev/block/MAJ:MIN/queue/rotational, after following partitions and device-mapper
+// layers down to the real disk), and from the filesystem type for network mounts.
+//
+// All the walks together never use more than config.threadCount workers. Those are shared out
+// round robin up to each disk's limit, and every disk gets its own run of worker slots, so the
+// telemetry, trace lanes and index shards never see two workers on one slot.
+// Progress is counted per disk too (SearchTelemetry::addDevice), to show which disk holds things up.
+//
+// 💿 The kind also picks the order a disk's folders are read in. config.entryOrder = Auto walks
+// spinning disks in inode order (every folder read in full, then its subfolders and stats sorted
+// by inode number, so the head sweeps the inode table instead of hopping around it) and the rest
+// the way the directory lists them, since flash doesn't care and sorting isn't free.
+
+enum class DeviceKind {
+    Nvme,       // Non-rotational, and an nvme* device
+    Ssd,        // Non-rotational (SATA/SAS SSD, eMMC, most virtual disks that admit it)
+    Rotational, // /sys says rotational = 1
+    Network,    // NFS, SMB, sshfs... (grouped by server)
+    Memory,     // tmpfs / ramfs
+    Unknown     // No block device to ask (overlay, zfs, FUSE, other systems)
+};
+
+struct DeviceGroup {
+    std::string name;                 // "nvme0n1", "sda", "fileserver" (network: the server), or the device number
+    DeviceKind kind = DeviceKind::Unknown;
+    unsigned int threads = 1;         // Workers each of its walks gets
+    bool inodeOrder = false;          // Its folders get read in inode order (config.entryOrder, settled for this kind)
+    std::vector<fs::path> roots;      // Walked one after the other, in plan order
+};
+
+// Sorts plan.roots by disk and shares out the workers. With config.deviceScheduling off, it's
+// one group holding every root with all the workers - the old one-root-after-another walk.
+std::vector<DeviceGroup> groupRootsByDevice(const RootPlan& plan, const SearchConfig& config);
+
+// "nvme", "ssd", "rotational", ... for listings
+const char* deviceKindName(DeviceKind kind);
+
+// The groups as text: one line per disk
+std::string describeDeviceGroups(const std::vector<DeviceGroup>& groups);
+
+// 🚀 Walks every group at the same time (each group's roots in turn) and blocks until all are done.
+// Same arguments as searchDirectoryParallel(), and the same promise: the callback is never
+// called from two threads at once. onProgress is called from the calling thread only.
+void searchDeviceGroups(
+    const std::vector<DeviceGroup>& groups,
+    const SearchConfig& config,
+    const CompiledQuery& query,
+    const SearchCallback& reportResult,
+    unsigned long long& foundCount,
+    std::atomic<bool>& cancellationFlag,
+    std::atomic<std::uint64_t>& filesScannedCount,
+    std::atomic<bool>& pauseFlag,
+    std::mutex& pauseMutexRef,
+    std::condition_variable& pauseConditionRef,
+    const ProgressCallback& onProgress = ProgressCallback(),
+    FileObserver* fileObserver = nullptr,
+    SearchTelemetry* telemetry = nullptr,
+    SearchTrace* trace = nullptr
+    );
+
+#endif // DEVICESCHEDULER_H
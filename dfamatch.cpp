@@ -0,0 +1,1210 @@
+#include "dfamatch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <utility>
+
+namespace {
+
+constexpr std::uint32_t kMaxCodePoint = 0x10FFFF;
+constexpr int kMaxRepeat = 1000;                   // x{1000} is fine, x{100000} is a typo
+constexpr int kMaxNesting = 200;
+constexpr std::size_t kMaxNfaStates = 100000;
+constexpr std::size_t kMaxDfaStates = 10000;
+constexpr std::size_t kMaxTableEntries = 1 << 21;  // 8 MB of transitions, tops
+
+// ---------------------------------------------------------------------------------------------
+// 🔤 Sets of characters (code points), kept as sorted inclusive ranges
+// ---------------------------------------------------------------------------------------------
+
+using CodeRange = std::pair<std::uint32_t, std::uint32_t>;
+
+struct CharSet {
+    std::vector<CodeRange> ranges;
+
+    void add(std::uint32_t lo, std::uint32_t hi) { ranges.emplace_back(lo, hi); }
+    void add(const CharSet& other) { ranges.insert(ranges.end(), other.ranges.begin(), other.ranges.end()); }
+
+    void normalize()
+    {
+        std::sort(ranges.begin(), ranges.end());
+        std::vector<CodeRange> merged;
+        for (const CodeRange& range : ranges) {
+            if (!merged.empty() && range.first <= merged.back().second + 1) {
+                merged.back().second = std::max(merged.back().second, range.second);
+            } else {
+                merged.push_back(range);
+            }
+        }
+        ranges = std::move(merged);
+    }
+
+    // Only ASCII letters fold - same rule as everywhere else in the search
+    void addCasePartners()
+    {
+        std::vector<CodeRange> partners;
+        for (const CodeRange& range : ranges) {
+            const std::uint32_t lowerFrom = std::max<std::uint32_t>(range.first, 'a');
+            const std::uint32_t lowerTo = std::min<std::uint32_t>(range.second, 'z');
+            if (lowerFrom <= lowerTo) {
+                partners.emplace_back(lowerFrom - 32, lowerTo - 32);
+            }
+            const std::uint32_t upperFrom = std::max<std::uint32_t>(range.first, 'A');
+            const std::uint32_t upperTo = std::min<std::uint32_t>(range.second, 'Z');
+            if (upperFrom <= upperTo) {
+                partners.emplace_back(upperFrom + 32, upperTo + 32);
+            }
+        }
+        ranges.insert(ranges.end(), partners.begin(), partners.end());
+        normalize();
+    }
+
+    void negate()
+    {
+        normalize();
+        std::vector<CodeRange> rest;
+        std::uint32_t next = 0;
+        for (const CodeRange& range : ranges) {
+            if (range.first > next) {
+                rest.emplace_back(next, range.first - 1);
+            }
+            next = range.second + 1;
+        }
+        if (next <= kMaxCodePoint) {
+            rest.emplace_back(next, kMaxCodePoint);
+        }
+        ranges = std::move(rest);
+    }
+
+    // Every character there is? (Surrogates don't count - they can't appear in UTF-8)
+    bool isAnyCharacter() const
+    {
+        std::uint32_t covered = 0; // Everything below this is in the set
+        for (const CodeRange& range : ranges) {
+            if (range.first > covered && !(covered == 0xD800 && range.first <= 0xE000)) {
+                return false;
+            }
+            covered = std::max(covered, range.second + 1);
+        }
+        return covered > kMaxCodePoint;
+    }
+
+    // The one character this set stands for, if it's just one ('x' - or 'x'/'X' when folding, given as 'x')
+    bool literal(bool fold, std::uint32_t& codePoint) const
+    {
+        if (ranges.size() == 1 && ranges[0].first == ranges[0].second) {
+            codePoint = ranges[0].first;
+            return true;
+        }
+        if (fold && ranges.size() == 2 && ranges[0].first == ranges[0].second && ranges[1].first == ranges[1].second
+            && ranges[0].first >= 'A' && ranges[0].first <= 'Z' && ranges[1].first == ranges[0].first + 32) {
+            codePoint = ranges[1].first;
+            return true;
+        }
+        return false;
+    }
+};
+
+CharSet anyCharacter()
+{
+    CharSet set;
+    set.add(0, 0xD7FF);
+    set.add(0xE000, kMaxCodePoint);
+    return set;
+}
+
+CharSet singleCharacter(std::uint32_t codePoint)
+{
+    CharSet set;
+    set.add(codePoint, codePoint);
+    return set;
+}
+
+void appendUtf8(std::string& out, std::uint32_t codePoint)
+{
+    if (codePoint < 0x80) {
+        out.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// 🌳 The syntax tree both pattern languages parse into
+// ---------------------------------------------------------------------------------------------
+
+struct Node {
+    enum Kind { Empty, Chars, AnyByte, Concat, Alternate, Repeat, Begin, End } kind = Empty;
+    CharSet chars;              // Chars
+    std::vector<Node> children; // Concat, Alternate, Repeat (one child)
+    int min = 0;                // Repeat
+    int max = -1;               // Repeat, -1 = no limit
+
+    explicit Node(Kind k = Empty) : kind(k) {}
+};
+
+Node charsNode(CharSet set)
+{
+    Node node(Node::Chars);
+    node.chars = std::move(set);
+    node.chars.normalize();
+    return node;
+}
+
+Node repeatNode(Node child, int min, int max)
+{
+    Node node(Node::Repeat);
+    node.children.push_back(std::move(child));
+    node.min = min;
+    node.max = max;
+    return node;
+}
+
+bool isAnyStar(const Node& node)
+{
+    return node.kind == Node::Repeat && node.min == 0 && node.max == -1 && node.children[0].kind == Node::AnyByte;
+}
+
+// ---------------------------------------------------------------------------------------------
+// 📖 The parsers
+// ---------------------------------------------------------------------------------------------
+
+class PatternParser
+{
+public:
+    PatternParser(std::string_view text, bool fold) : text(text), fold(fold) {}
+
+    std::string problem;
+
+    bool parseRegex(Node& out)
+    {
+        if (!parseAlternation(out)) {
+            return false;
+        }
+        if (pos < text.size()) { // The only thing that stops the top level early
+            return fail("unmatched )");
+        }
+        return true;
+    }
+
+    bool parseGlob(Node& out)
+    {
+        Node body;
+        if (!parseGlobSequence(body, false)) {
+            return false;
+        }
+        out = Node(Node::Concat); // A glob describes the WHOLE name
+        out.children.push_back(Node(Node::Begin));
+        out.children.push_back(std::move(body));
+        out.children.push_back(Node(Node::End));
+        return true;
+    }
+
+private:
+    std::string_view text;
+    bool fold;
+    std::size_t pos = 0;
+    int depth = 0;
+
+    bool fail(const std::string& message)
+    {
+        problem = message + " (at position " + std::to_string(pos + 1) + ")";
+        return false;
+    }
+
+    bool decodeCharacter(std::uint32_t& codePoint)
+    {
+        const unsigned char lead = static_cast<unsigned char>(text[pos]);
+        std::size_t length;
+        if (lead < 0x80) { codePoint = lead; length = 1; }
+        else if ((lead & 0xE0) == 0xC0) { codePoint = lead & 0x1F; length = 2; }
+        else if ((lead & 0xF0) == 0xE0) { codePoint = lead & 0x0F; length = 3; }
+        else if ((lead & 0xF8) == 0xF0) { codePoint = lead & 0x07; length = 4; }
+        else return fail("the pattern isn't valid UTF-8");
+        if (pos + length > text.size()) {
+            return fail("the pattern isn't valid UTF-8");
+        }
+        for (std::size_t k = 1; k < length; ++k) {
+            const unsigned char c = static_cast<unsigned char>(text[pos + k]);
+            if ((c & 0xC0) != 0x80) {
+                return fail("the pattern isn't valid UTF-8");
+            }
+            codePoint = (codePoint << 6) | (c & 0x3F);
+        }
+        const std::uint32_t smallest[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (codePoint < smallest[length] || codePoint > kMaxCodePoint || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return fail("the pattern isn't valid UTF-8");
+        }
+        pos += length;
+        return true;
+    }
+
+    bool literalNode(Node& out)
+    {
+        std::uint32_t codePoint = 0;
+        if (!decodeCharacter(codePoint)) {
+            return false;
+        }
+        out = charsNode(caseFolded(singleCharacter(codePoint)));
+        return true;
+    }
+
+    CharSet caseFolded(CharSet set) const
+    {
+        if (fold) {
+            set.addCasePartners();
+        }
+        return set;
+    }
+
+    // --- Regex ---
+
+    bool parseAlternation(Node& out)
+    {
+        Node branch;
+        if (!parseConcat(branch)) {
+            return false;
+        }
+        if (pos >= text.size() || text[pos] != '|') {
+            out = std::move(branch);
+            return true;
+        }
+        out = Node(Node::Alternate);
+        out.children.push_back(std::move(branch));
+        while (pos < text.size() && text[pos] == '|') {
+            ++pos;
+            Node next;
+            if (!parseConcat(next)) {
+                return false;
+            }
+            out.children.push_back(std::move(next));
+        }
+        return true;
+    }
+
+    bool parseConcat(Node& out)
+    {
+        out = Node(Node::Concat);
+        while (pos < text.size() && text[pos] != '|' && text[pos] != ')') {
+            Node piece;
+            if (!parseRepeat(piece)) {
+                return false;
+            }
+            out.children.push_back(std::move(piece));
+        }
+        return true;
+    }
+
+    bool parseRepeat(Node& out)
+    {
+        Node atom;
+        if (!parseAtom(atom)) {
+            return false;
+        }
+        bool repeated = false;
+        while (pos < text.size()) {
+            int min;
+            int max;
+            const char c = text[pos];
+            if (c == '*') { min = 0; max = -1; ++pos; }
+            else if (c == '+') { min = 1; max = -1; ++pos; }
+            else if (c == '?') { min = 0; max = 1; ++pos; }
+            else if (c == '{') {
+                const std::size_t brace = pos;
+                if (!parseCounts(min, max)) {
+                    if (!problem.empty()) {
+                        return false;
+                    }
+                    pos = brace; // Not a {m,n} after all - a plain '{', for the next atom
+                    break;
+                }
+            } else {
+                break;
+            }
+            if (repeated) {
+                return fail("two repeat operators in a row - put the first in ( ) if you mean it");
+            }
+            if (atom.kind == Node::Begin || atom.kind == Node::End) {
+                return fail("nothing to repeat");
+            }
+            if (pos < text.size() && text[pos] == '?') {
+                ++pos; // Lazy - for a yes/no match it's the same thing
+            }
+            atom = repeatNode(std::move(atom), min, max);
+            repeated = true;
+        }
+        out = std::move(atom);
+        return true;
+    }
+
+    // {m} {m,} {m,n} - false with an empty problem means "not a quantifier, just a brace"
+    bool parseCounts(int& min, int& max)
+    {
+        std::size_t at = pos + 1;
+        auto number = [&](int& value) {
+            const std::size_t from = at;
+            long long total = 0;
+            while (at < text.size() && text[at] >= '0' && text[at] <= '9') {
+                total = std::min<long long>(total * 10 + (text[at] - '0'), 1LL << 30);
+                ++at;
+            }
+            value = static_cast<int>(total);
+            return at > from;
+        };
+        if (!number(min)) {
+            return false;
+        }
+        max = min;
+        if (at < text.size() && text[at] == ',') {
+            ++at;
+            if (!number(max)) {
+                max = -1;
+            }
+        }
+        if (at >= text.size() || text[at] != '}') {
+            return false;
+        }
+        if (min > kMaxRepeat || max > kMaxRepeat) {
+            return fail("repeat count is over " + std::to_string(kMaxRepeat));
+        }
+        if (max != -1 && max < min) {
+            return fail("repeat range is backwards");
+        }
+        pos = at + 1;
+        return true;
+    }
+
+    bool parseAtom(Node& out)
+    {
+        const char c = text[pos];
+        switch (c) {
+        case '(': {
+            ++pos;
+            if (text.substr(pos, 2) == "?:") {
+                pos += 2;
+            } else if (pos < text.size() && text[pos] == '?') {
+                return fail("(?...) groups like lookaround aren't supported - only (?:...)");
+            }
+            if (++depth > kMaxNesting) {
+                return fail("groups are nested too deeply");
+            }
+            if (!parseAlternation(out)) {
+                return false;
+            }
+            if (pos >= text.size()) {
+                return fail("missing ) to close a group");
+            }
+            ++pos;
+            --depth;
+            return true;
+        }
+        case '*':
+        case '+':
+        case '?':
+            return fail("nothing to repeat");
+        case '[':
+            return parseClass(out, false);
+        case '.':
+            ++pos;
+            out = charsNode(anyCharacter());
+            return true;
+        case '^':
+            ++pos;
+            out = Node(Node::Begin);
+            return true;
+        case '$':
+            ++pos;
+            out = Node(Node::End);
+            return true;
+        case '\\': {
+            CharSet set;
+            Node::Kind anchor = Node::Empty;
+            if (!parseEscape(set, &anchor)) {
+                return false;
+            }
+            out = anchor != Node::Empty ? Node(anchor) : charsNode(caseFolded(std::move(set)));
+            return true;
+        }
+        default:
+            return literalNode(out);
+        }
+    }
+
+    // After a backslash. anchor is null inside [...], where \A and \z make no sense.
+    bool parseEscape(CharSet& set, Node::Kind* anchor)
+    {
+        ++pos;
+        if (pos >= text.size()) {
+            return fail("the pattern ends with a lone backslash");
+        }
+        const char e = text[pos];
+        switch (e) {
+        case 'd': case 'D':
+            set.add('0', '9');
+            break;
+        case 'w': case 'W':
+            set.add('0', '9');
+            set.add('A', 'Z');
+            set.add('_', '_');
+            set.add('a', 'z');
+            break;
+        case 's': case 'S':
+            set.add('\t', '\r'); // \t \n \v \f \r
+            set.add(' ', ' ');
+            break;
+        case 'n': set.add('\n', '\n'); break;
+        case 't': set.add('\t', '\t'); break;
+        case 'r': set.add('\r', '\r'); break;
+        case 'f': set.add('\f', '\f'); break;
+        case 'v': set.add('\v', '\v'); break;
+        case 'A': case 'z': case 'Z':
+            if (!anchor) {
+                return fail("\\A and \\z can't go inside [...]");
+            }
+            *anchor = e == 'A' ? Node::Begin : Node::End;
+            break;
+        case 'b': case 'B':
+            return fail("word boundaries (\\b, \\B) aren't supported");
+        case 'x': {
+            ++pos;
+            const bool braced = pos < text.size() && text[pos] == '{';
+            pos += braced ? 1 : 0;
+            std::uint32_t value = 0;
+            int digits = 0;
+            while (pos < text.size() && std::isxdigit(static_cast<unsigned char>(text[pos])) && (braced || digits < 2)) {
+                const char h = text[pos];
+                value = value * 16 + static_cast<std::uint32_t>(h <= '9' ? h - '0' : (h | 0x20) - 'a' + 10);
+                ++pos;
+                if (++digits > 6) {
+                    return fail("\\x value is too long");
+                }
+            }
+            if (digits == 0 || (braced && (pos >= text.size() || text[pos] != '}')) || (!braced && digits != 2)) {
+                return fail("\\x needs two hex digits, or \\x{...}");
+            }
+            pos += braced ? 1 : 0;
+            if (value > kMaxCodePoint || (value >= 0xD800 && value <= 0xDFFF)) {
+                return fail("\\x value isn't a character");
+            }
+            set.add(value, value);
+            return true;
+        }
+        default:
+            if (e >= '1' && e <= '9') {
+                return fail("backreferences aren't supported - no automaton can check them");
+            }
+            if (std::isalnum(static_cast<unsigned char>(e))) {
+                return fail(std::string("unknown escape \\") + e);
+            }
+            std::uint32_t codePoint = 0; // \. \* \\ \( and friends - the character itself
+            if (!decodeCharacter(codePoint)) {
+                return false;
+            }
+            set.add(codePoint, codePoint);
+            return true;
+        }
+        ++pos;
+        if (e == 'D' || e == 'W' || e == 'S') {
+            set.negate();
+        }
+        return true;
+    }
+
+    // [abc] [a-z] [^...] - and in a glob [!...], with a missing ] meaning a plain '['
+    bool parseClass(Node& out, bool glob)
+    {
+        const std::size_t start = pos;
+        ++pos;
+        bool negated = false;
+        if (pos < text.size() && (text[pos] == '^' || (glob && text[pos] == '!'))) {
+            negated = true;
+            ++pos;
+        }
+        CharSet set;
+        for (bool first = true;; first = false) {
+            if (pos >= text.size()) {
+                if (glob) {
+                    pos = start + 1;
+                    out = charsNode(singleCharacter('['));
+                    return true;
+                }
+                pos = start;
+                return fail("missing ] to close [");
+            }
+            if (text[pos] == ']' && !first) {
+                ++pos;
+                break;
+            }
+            CharSet item;
+            std::uint32_t from = 0;
+            if (!parseClassItem(item, from, glob)) {
+                return false;
+            }
+            const bool single = item.ranges.size() == 1 && item.ranges[0].first == item.ranges[0].second;
+            if (single && pos + 1 < text.size() && text[pos] == '-' && text[pos + 1] != ']') {
+                ++pos;
+                CharSet upper;
+                std::uint32_t to = 0;
+                if (!parseClassItem(upper, to, glob)) {
+                    return false;
+                }
+                if (upper.ranges.size() != 1 || upper.ranges[0].first != upper.ranges[0].second) {
+                    return fail("a range can't end in a class like \\d");
+                }
+                if (to < from) {
+                    return fail("range is backwards");
+                }
+                set.add(from, to);
+            } else {
+                set.add(item);
+            }
+        }
+        set = caseFolded(std::move(set));
+        if (negated) {
+            set.negate();
+        }
+        set.normalize();
+        out = charsNode(std::move(set));
+        return true;
+    }
+
+    bool parseClassItem(CharSet& item, std::uint32_t& codePoint, bool glob)
+    {
+        if (text[pos] == '\\' && !glob) {
+            if (!parseEscape(item, nullptr)) {
+                return false;
+            }
+            item.normalize();
+            codePoint = item.ranges.empty() ? 0 : item.ranges[0].first;
+            return true;
+        }
+        if (text[pos] == '\\' && pos + 1 < text.size()) {
+            ++pos; // Glob: the next character, whatever it is
+        }
+        if (!decodeCharacter(codePoint)) {
+            return false;
+        }
+        item.add(codePoint, codePoint);
+        return true;
+    }
+
+    // --- Glob ---
+
+    // Is there a '}' for the '{' at pos? (Skipping escapes; nested braces have to close first)
+    bool braceCloses() const
+    {
+        int open = 0;
+        for (std::size_t at = pos; at < text.size(); ++at) {
+            if (text[at] == '\\') {
+                ++at;
+            } else if (text[at] == '{') {
+                ++open;
+            } else if (text[at] == '}' && --open == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parseGlobSequence(Node& out, bool inBraces)
+    {
+        out = Node(Node::Concat);
+        while (pos < text.size()) {
+            const char c = text[pos];
+            if (inBraces && (c == ',' || c == '}')) {
+                break;
+            }
+            Node piece;
+            if (c == '*') {
+                while (pos < text.size() && text[pos] == '*') {
+                    ++pos;
+                }
+                piece = repeatNode(Node(Node::AnyByte), 0, -1);
+            } else if (c == '?') {
+                ++pos;
+                piece = charsNode(anyCharacter());
+            } else if (c == '[') {
+                if (!parseClass(piece, true)) {
+                    return false;
+                }
+            } else if (c == '{' && braceCloses()) {
+                const std::size_t brace = pos;
+                if (!parseBraces(piece)) {
+                    if (!problem.empty()) {
+                        return false;
+                    }
+                    pos = brace; // A ] swallowed the closing brace - take the '{' literally after all
+                    ++pos;
+                    piece = charsNode(singleCharacter('{'));
+                }
+            } else if (c == '\\' && pos + 1 < text.size()) {
+                ++pos;
+                if (!literalNode(piece)) {
+                    return false;
+                }
+            } else {
+                if (!literalNode(piece)) {
+                    return false;
+                }
+            }
+            out.children.push_back(std::move(piece));
+        }
+        return true;
+    }
+
+    // {jpg,png,gif} - any one of the alternatives
+    bool parseBraces(Node& out)
+    {
+        if (++depth > kMaxNesting) {
+            return fail("{...} alternatives are nested too deeply");
+        }
+        ++pos;
+        out = Node(Node::Alternate);
+        for (;;) {
+            Node option;
+            if (!parseGlobSequence(option, true)) {
+                return false;
+            }
+            out.children.push_back(std::move(option));
+            if (pos >= text.size()) {
+                --depth;
+                return false;
+            }
+            if (text[pos++] == '}') {
+                break;
+            }
+        }
+        --depth;
+        return true;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------
+// 🧹 Tidying the tree
+// ---------------------------------------------------------------------------------------------
+
+// Flattens nested concatenations and alternations, and turns .* into a plain any-byte loop
+// (for valid UTF-8, "any number of characters" and "any number of bytes" are the same thing)
+Node simplify(Node node)
+{
+    for (Node& child : node.children) {
+        child = simplify(std::move(child));
+    }
+    if (node.kind == Node::Concat || node.kind == Node::Alternate) {
+        std::vector<Node> flat;
+        for (Node& child : node.children) {
+            if (child.kind == node.kind) {
+                for (Node& grandchild : child.children) {
+                    flat.push_back(std::move(grandchild));
+                }
+            } else if (!(node.kind == Node::Concat && child.kind == Node::Empty)) {
+                flat.push_back(std::move(child));
+            }
+        }
+        node.children = std::move(flat);
+        if (node.children.size() == 1) {
+            Node only = std::move(node.children[0]);
+            return only;
+        }
+    } else if (node.kind == Node::Repeat) {
+        Node& child = node.children[0];
+        if (node.max == -1 && child.kind == Node::Chars && child.chars.isAnyCharacter()) {
+            child = Node(Node::AnyByte);
+        }
+        if (node.min == 1 && node.max == 1) {
+            Node only = std::move(child);
+            return only;
+        }
+    }
+    return node;
+}
+
+// We look for matches ANYWHERE in the name, so "anything" at either end - ^.* or .*$ (or a
+// glob's leading/trailing *) - changes nothing and just makes the automaton work harder
+void trimLooseEnds(Node& tree)
+{
+    if (tree.kind != Node::Concat) {
+        if (isAnyStar(tree)) {
+            tree = Node(Node::Concat);
+        }
+        return;
+    }
+    std::vector<Node>& parts = tree.children;
+    for (;;) {
+        if (parts.size() >= 2 && parts[0].kind == Node::Begin && isAnyStar(parts[1])) {
+            parts.erase(parts.begin(), parts.begin() + 2);
+        } else if (!parts.empty() && isAnyStar(parts[0])) {
+            parts.erase(parts.begin());
+        } else {
+            break;
+        }
+    }
+    for (;;) {
+        const std::size_t n = parts.size();
+        if (n >= 2 && parts[n - 1].kind == Node::End && isAnyStar(parts[n - 2])) {
+            parts.erase(parts.end() - 2, parts.end());
+        } else if (n >= 1 && isAnyStar(parts[n - 1])) {
+            parts.pop_back();
+        } else {
+            break;
+        }
+    }
+    if (parts.size() == 1 && (parts[0].kind == Node::Begin || parts[0].kind == Node::End)) {
+        parts.clear(); // A lone ^ or $ holds for every name
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// 🧩 Literals every match must contain, for the prefilter and the index
+// ---------------------------------------------------------------------------------------------
+
+// Does this node match exactly one string, and which?
+bool exactLiteral(const Node& node, bool fold, std::string& out)
+{
+    switch (node.kind) {
+    case Node::Empty:
+        return true;
+    case Node::Chars: {
+        std::uint32_t codePoint = 0;
+        if (!node.chars.literal(fold, codePoint)) {
+            return false;
+        }
+        appendUtf8(out, codePoint);
+        return true;
+    }
+    case Node::Concat:
+        for (const Node& child : node.children) {
+            if (!exactLiteral(child, fold, out)) {
+                return false;
+            }
+        }
+        return true;
+    case Node::Repeat: {
+        std::string once;
+        if (node.min != node.max || !exactLiteral(node.children[0], fold, once)) {
+            return false;
+        }
+        for (int i = 0; i < node.min; ++i) {
+            out += once;
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void collectRequired(const Node& node, bool fold, std::vector<std::string>& out)
+{
+    if (node.kind == Node::Concat) {
+        std::string run; // Neighbouring literal pieces make one longer literal
+        for (const Node& child : node.children) {
+            std::string piece;
+            if (exactLiteral(child, fold, piece)) {
+                run += piece;
+                continue;
+            }
+            if (!run.empty()) {
+                out.push_back(std::move(run));
+                run.clear();
+            }
+            collectRequired(child, fold, out);
+        }
+        if (!run.empty()) {
+            out.push_back(std::move(run));
+        }
+    } else if (node.kind == Node::Repeat && node.min >= 1) {
+        std::string once;
+        if (exactLiteral(node.children[0], fold, once)) {
+            if (!once.empty()) {
+                out.push_back(std::move(once));
+            }
+        } else {
+            collectRequired(node.children[0], fold, out);
+        }
+    } else {
+        std::string piece;
+        if (exactLiteral(node, fold, piece) && !piece.empty()) {
+            out.push_back(std::move(piece));
+        }
+    }
+    // Alternations and optional parts promise nothing
+}
+
+// ---------------------------------------------------------------------------------------------
+// ⚙️ Thompson NFA over bytes
+// ---------------------------------------------------------------------------------------------
+
+struct NfaState {
+    enum Kind : std::uint8_t { ByteRange, Split, AssertBegin, AssertEnd, Match } kind;
+    std::uint8_t lo = 0;
+    std::uint8_t hi = 0;
+    int out = -1;
+    int out1 = -1;
+};
+
+using ByteSequence = std::vector<std::pair<std::uint8_t, std::uint8_t>>;
+
+// Splits a code point range into UTF-8 byte-range sequences, e.g. U+0080..U+07FF becomes
+// [C2-DF][80-BF]. Same length, and every byte but the last covering its full range, or split again.
+void utf8Sequences(std::uint32_t lo, std::uint32_t hi, std::vector<ByteSequence>& out)
+{
+    if (lo > hi) {
+        return;
+    }
+    if (lo <= 0xDFFF && hi >= 0xD800) { // Surrogates aren't characters
+        if (lo < 0xD800) {
+            utf8Sequences(lo, 0xD7FF, out);
+        }
+        if (hi > 0xDFFF) {
+            utf8Sequences(0xE000, hi, out);
+        }
+        return;
+    }
+    const std::uint32_t lengthLimits[] = {0x7F, 0x7FF, 0xFFFF};
+    for (std::uint32_t limit : lengthLimits) {
+        if (lo <= limit && hi > limit) {
+            utf8Sequences(lo, limit, out);
+            utf8Sequences(limit + 1, hi, out);
+            return;
+        }
+    }
+    if (hi < 0x80) {
+        out.push_back({{static_cast<std::uint8_t>(lo), static_cast<std::uint8_t>(hi)}});
+        return;
+    }
+    for (int i = 1; i < 4; ++i) {
+        const std::uint32_t mask = (1u << (6 * i)) - 1;
+        if ((lo & ~mask) != (hi & ~mask)) {
+            if ((lo & mask) != 0) {
+                utf8Sequences(lo, lo | mask, out);
+                utf8Sequences((lo | mask) + 1, hi, out);
+                return;
+            }
+            if ((hi & mask) != mask) {
+                utf8Sequences(lo, (hi & ~mask) - 1, out);
+                utf8Sequences(hi & ~mask, hi, out);
+                return;
+            }
+        }
+    }
+    std::string loBytes;
+    std::string hiBytes;
+    appendUtf8(loBytes, lo);
+    appendUtf8(hiBytes, hi);
+    ByteSequence sequence;
+    for (std::size_t k = 0; k < loBytes.size(); ++k) {
+        sequence.emplace_back(static_cast<std::uint8_t>(loBytes[k]), static_cast<std::uint8_t>(hiBytes[k]));
+    }
+    out.push_back(std::move(sequence));
+}
+
+class NfaBuilder
+{
+public:
+    std::vector<NfaState> states;
+    bool tooBig = false;
+
+    int add(NfaState::Kind kind, int out = -1, int out1 = -1, std::uint8_t lo = 0, std::uint8_t hi = 0)
+    {
+        if (states.size() >= kMaxNfaStates) {
+            tooBig = true;
+            return -1;
+        }
+        NfaState state;
+        state.kind = kind;
+        state.lo = lo;
+        state.hi = hi;
+        state.out = out;
+        state.out1 = out1;
+        states.push_back(state);
+        return static_cast<int>(states.size() - 1);
+    }
+
+    // Built back to front: returns the entry state of a piece that continues into next
+    int build(const Node& node, int next)
+    {
+        if (tooBig) {
+            return -1;
+        }
+        switch (node.kind) {
+        case Node::Empty:
+            return next;
+        case Node::Begin:
+            return add(NfaState::AssertBegin, next);
+        case Node::End:
+            return add(NfaState::AssertEnd, next);
+        case Node::AnyByte:
+            return add(NfaState::ByteRange, next, -1, 0, 255);
+        case Node::Chars:
+            return buildChars(node.chars, next);
+        case Node::Concat:
+            for (auto child = node.children.rbegin(); child != node.children.rend(); ++child) {
+                next = build(*child, next);
+            }
+            return next;
+        case Node::Alternate: {
+            int entry = build(node.children.back(), next);
+            for (std::size_t i = node.children.size() - 1; i-- > 0;) {
+                entry = add(NfaState::Split, build(node.children[i], next), entry);
+            }
+            return entry;
+        }
+        case Node::Repeat: {
+            const Node& child = node.children[0];
+            int entry = next;
+            if (node.max == -1) {
+                const int loop = add(NfaState::Split); // Patched below, once the body exists
+                if (loop < 0) {
+                    return -1;
+                }
+                const int body = build(child, loop);
+                states[loop].out = body;
+                states[loop].out1 = next;
+                entry = loop;
+            } else {
+                for (int i = node.min; i < node.max && !tooBig; ++i) {
+                    entry = add(NfaState::Split, build(child, entry), next);
+                }
+            }
+            for (int i = 0; i < node.min && !tooBig; ++i) {
+                entry = build(child, entry);
+            }
+            return entry;
+        }
+        }
+        return next;
+    }
+
+private:
+    int buildChars(const CharSet& set, int next)
+    {
+        std::vector<ByteSequence> sequences;
+        for (const CodeRange& range : set.ranges) {
+            utf8Sequences(range.first, range.second, sequences);
+        }
+        if (sequences.empty()) {
+            return add(NfaState::Split); // Nothing can pass - a dead end
+        }
+        int entry = -1;
+        for (auto sequence = sequences.rbegin(); sequence != sequences.rend(); ++sequence) {
+            int state = next;
+            for (auto byte = sequence->rbegin(); byte != sequence->rend(); ++byte) {
+                state = add(NfaState::ByteRange, state, -1, byte->first, byte->second);
+            }
+            entry = entry < 0 ? state : add(NfaState::Split, state, entry);
+        }
+        return entry;
+    }
+};
+
+} // namespace
+
+// ---------------------------------------------------------------------------------------------
+// 🏗️ DfaMatcher
+// ---------------------------------------------------------------------------------------------
+
+DfaMatcher::DfaMatcher()
+    : table{0, 1} // Row 0 (dead) and row 1 (matched) with a single byte class: start is dead
+{
+}
+
+bool DfaMatcher::compile(std::string_view pattern, PatternSyntax syntax, bool caseInsensitive, std::string& problem)
+{
+    *this = DfaMatcher(); // Matches nothing, unless we get all the way through
+
+    PatternParser parser(pattern, caseInsensitive);
+    Node tree;
+    if (!(syntax == PatternSyntax::Glob ? parser.parseGlob(tree) : parser.parseRegex(tree))) {
+        problem = parser.problem;
+        return false;
+    }
+    tree = simplify(std::move(tree));
+    trimLooseEnds(tree);
+
+    // 🧩 The literals first - sometimes they're the whole story
+    std::string exact;
+    if (exactLiteral(tree, caseInsensitive, exact) && !exact.empty()) {
+        literals.push_back(exact);
+        prefilter.emplace(exact, caseInsensitive);
+        prefilterDecides = true;
+        return true;
+    }
+    std::vector<std::string> required;
+    collectRequired(tree, caseInsensitive, required);
+    for (std::string& literal : required) {
+        if (std::find(literals.begin(), literals.end(), literal) == literals.end()) {
+            literals.push_back(std::move(literal));
+        }
+    }
+    const auto longest = std::max_element(literals.begin(), literals.end(),
+                                          [](const std::string& a, const std::string& b) { return a.size() < b.size(); });
+    if (longest != literals.end() && longest->size() >= 2) { // One byte rules out too little to pay for the extra pass
+        prefilter.emplace(*longest, caseInsensitive);
+    }
+
+    // ⚙️ Pattern -> NFA
+    NfaBuilder nfa;
+    const int matchState = nfa.add(NfaState::Match);
+    const int nfaStart = nfa.build(tree, matchState);
+    if (nfa.tooBig || nfaStart < 0) {
+        *this = DfaMatcher();
+        problem = "the pattern is too big (try smaller repeat counts)";
+        return false;
+    }
+    const bool anchoredStart = tree.kind == Node::Begin
+                               || (tree.kind == Node::Concat && !tree.children.empty() && tree.children[0].kind == Node::Begin);
+
+    // 🧮 Byte classes: bytes no state tells apart share a column
+    std::array<bool, 257> boundary{};
+    for (const NfaState& state : nfa.states) {
+        if (state.kind == NfaState::ByteRange) {
+            boundary[state.lo] = true;
+            boundary[state.hi + 1] = true;
+        }
+    }
+    std::vector<std::uint8_t> representative{0};
+    for (int b = 1; b < 256; ++b) {
+        if (boundary[b]) {
+            representative.push_back(static_cast<std::uint8_t>(b));
+        }
+        byteClasses[b] = static_cast<std::uint8_t>(representative.size() - 1);
+    }
+    byteClasses[0] = 0;
+    const std::uint32_t classes = static_cast<std::uint32_t>(representative.size());
+
+    // 🔁 NFA -> DFA (subset construction). A DFA state is the sorted set of NFA states we
+    // could be in; only byte-consuming states, end assertions and Match are kept in it.
+    std::vector<std::uint32_t> marks(nfa.states.size(), 0);
+    std::uint32_t generation = 0;
+    std::vector<int> stack;
+    auto addClosure = [&](int from, bool atBeginning, std::vector<int>& into) {
+        stack.push_back(from);
+        while (!stack.empty()) {
+            const int s = stack.back();
+            stack.pop_back();
+            if (s < 0 || marks[s] == generation) {
+                continue;
+            }
+            marks[s] = generation;
+            const NfaState& state = nfa.states[s];
+            if (state.kind == NfaState::Split) {
+                stack.push_back(state.out1);
+                stack.push_back(state.out);
+            } else if (state.kind == NfaState::AssertBegin) {
+                if (atBeginning) {
+                    stack.push_back(state.out);
+                }
+            } else {
+                into.push_back(s);
+            }
+        }
+    };
+    // Would the name be a match if it ended now? (Through any $ we're sitting in front of)
+    auto acceptsAtEndOf = [&](const std::vector<int>& set) {
+        ++generation;
+        for (int s : set) {
+            if (nfa.states[s].kind == NfaState::AssertEnd) {
+                stack.push_back(nfa.states[s].out);
+            }
+        }
+        bool accepted = false;
+        while (!stack.empty()) {
+            const int s = stack.back();
+            stack.pop_back();
+            if (s < 0 || marks[s] == generation) {
+                continue;
+            }
+            marks[s] = generation;
+            const NfaState& state = nfa.states[s];
+            if (state.kind == NfaState::Match) {
+                accepted = true;
+            } else if (state.kind == NfaState::Split) {
+                stack.push_back(state.out1);
+                stack.push_back(state.out);
+            } else if (state.kind == NfaState::AssertEnd) {
+                stack.push_back(state.out);
+            }
+        }
+        return accepted;
+    };
+
+    std::map<std::vector<int>, std::uint32_t> known;
+    std::vector<std::vector<int>> sets{{}, {}}; // Dead and matched have no set of their own
+    bool tooComplex = false;
+    auto intern = [&](std::vector<int>& set) -> std::uint32_t {
+        std::sort(set.begin(), set.end());
+        if (set.empty()) {
+            return 0;
+        }
+        for (int s : set) {
+            if (nfa.states[s].kind == NfaState::Match) {
+                return 1; // Matched - and whatever comes next can't take that back
+            }
+        }
+        const auto found = known.find(set);
+        if (found != known.end()) {
+            return found->second;
+        }
+        if (sets.size() >= kMaxDfaStates || (sets.size() + 1) * classes > kMaxTableEntries) {
+            tooComplex = true;
+            return 0;
+        }
+        const std::uint32_t id = static_cast<std::uint32_t>(sets.size());
+        known.emplace(set, id);
+        sets.push_back(set);
+        return id;
+    };
+
+    std::vector<std::uint32_t> transitions(2 * classes, 0);
+    std::fill(transitions.begin() + classes, transitions.end(), classes); // Matched stays matched
+    std::vector<std::uint8_t> endAccepts{0, 1};
+
+    std::vector<int> next;
+    ++generation;
+    addClosure(nfaStart, true, next);
+    const std::uint32_t startId = intern(next);
+
+    for (std::size_t id = 2; id < sets.size() && !tooComplex; ++id) {
+        endAccepts.push_back(acceptsAtEndOf(sets[id]) ? 1 : 0);
+        for (std::uint32_t c = 0; c < classes && !tooComplex; ++c) {
+            const std::uint8_t byte = representative[c];
+            next.clear();
+            ++generation;
+            for (int s : sets[id]) {
+                const NfaState& state = nfa.states[s];
+                if (state.kind == NfaState::ByteRange && state.lo <= byte && byte <= state.hi) {
+                    addClosure(state.out, false, next);
+                }
+            }
+            if (!anchoredStart) {
+                addClosure(nfaStart, false, next); // A match may start at any byte
+            }
+            transitions.push_back(intern(next) * classes);
+        }
+    }
+    if (tooComplex) {
+        *this = DfaMatcher();
+        problem = "the pattern is too complex to turn into an automaton (try fewer alternatives or repeats)";
+        return false;
+    }
+
+    table = std::move(transitions);
+    acceptsAtEnd = std::move(endAccepts);
+    classCount = classes;
+    startState = startId * classes;
+    matchedState = classes;
+    firstLiveState = 2 * classes;
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef DFAMATCH_H
+#define DFAMATCH_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "simdmatch.h" // SubstringMatcher, for the literal prefilter
+
+// 🤖 Glob & Regex Matching, the Linear-Time Way 🤖
+// Patterns like report_20??_*.csv or ^core\.\d+$ get compiled ONCE per search into a
+// deterministic automaton: one table lookup per byte of the name, no backtracking, ever.
+// A pattern that would send a backtracking engine into exponential time, like (a*)*b,
+// costs the same here as any other - the work was all done up front, when the table was built.
+//
+// How it's built: pattern -> syntax tree -> Thompson NFA over bytes -> DFA (subset
+// construction). Code points are turned into UTF-8 byte sequences, so "." and "?" mean one
+// character, not one byte. Bytes that behave the same in every state share one column of the
+// table (byte classes), which usually squeezes 256 columns down to a dozen.
+//
+// Most names fail long before the automaton gets a look: every literal piece that ALL matches
+// must contain ("report_20" and ".csv" above) is pulled out of the pattern, and the longest one
+// is checked first with the vectorized SubstringMatcher. A pattern that is nothing BUT a
+// literal somewhere in the name (*needle*) never runs the automaton at all.
+//
+// Globs match the whole name: * (anything), ? (one character), [abc] [a-z] [!x] classes and
+// {jpg,png} alternatives. Regexes match anywhere in the name unless anchored with ^ / $, and
+// support the regular subset: . [...] [^...] \d \w \s (and \D \W \S) | ( ) (?: ) * + ? {m,n}.
+// Backreferences, lookaround and word boundaries can't be done by an automaton, so
+// they're rejected with a message instead of being silently misread.
+
+enum class PatternSyntax {
+    Glob,
+    Regex
+};
+
+class DfaMatcher
+{
+public:
+    DfaMatcher(); // Matches nothing until compile() succeeds
+
+    // Builds the automaton. On a bad (or too big) pattern: returns false, says why in
+    // problem, and keeps matching nothing. caseInsensitive folds ASCII letters, like the
+    // rest of the search does.
+    bool compile(std::string_view pattern, PatternSyntax syntax, bool caseInsensitive, std::string& problem);
+
+    // 🔥 The hot path - called once per scanned name
+    bool matches(std::string_view name) const
+    {
+        if (prefilter && !prefilter->contains(name)) {
+            return false; // Doesn't even contain the must-have literal
+        }
+        if (prefilterDecides) {
+            return true;
+        }
+        const std::uint32_t* next = table.data();
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(name.data());
+        std::uint32_t state = startState;
+        for (std::size_t i = 0; i < name.size() && state >= firstLiveState; ++i) {
+            state = next[state + byteClasses[bytes[i]]];
+        }
+        if (state < firstLiveState) {
+            return state == matchedState; // Dead, or already matched (the rest can't change that)
+        }
+        return acceptsAtEnd[state / classCount] != 0;
+    }
+
+    // Literal pieces every match contains (folded when case-insensitive) - an index can use them to narrow things down
+    const std::vector<std::string>& requiredLiterals() const { return literals; }
+
+    std::size_t stateCount() const { return table.size() / classCount; }
+    std::size_t byteClassCount() const { return classCount; }
+
+private:
+    // The table holds state * classCount ("premultiplied"), so a step is one add and one load.
+    // Row 0 is the dead state, row 1 the matched state (both loop on themselves).
+    std::array<std::uint8_t, 256> byteClasses{};
+    std::vector<std::uint32_t> table;
+    std::vector<std::uint8_t> acceptsAtEnd; // Per state: is the name a match if it ends here?
+    std::uint32_t classCount = 1;
+    std::uint32_t startState = 0;
+    std::uint32_t matchedState = 1;
+    std::uint32_t firstLiveState = 2;
+
+    std::vector<std::string> literals;
+    std::optional<SubstringMatcher> prefilter;
+    bool prefilterDecides = false; // The pattern IS "contains this literal"
+};
+
+#endif // DFAMATCH_H
@@ -0,0 +1,339 @@
+#include "direnumerator.h"
+#include "searchtelemetry.h"
+#include "uringbatch.h"
+
+#include <system_error>
+
+#ifdef IYS_HAVE_GETDENTS64
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <dirent.h> // Just for the DT_* constants
+#include <vector>
+#endif
+
+namespace {
+
+// 🐢➡️🐇 The portable fallback: plain std::filesystem, exactly what we always used.
+// Costs a path object and a string per entry, but it runs on every platform.
+class StdFilesystemEnumerator : public DirectoryEnumerator
+{
+public:
+    bool enumerate(const fs::path& dir, DirEntryVisitor& visitor, std::string& errorMessage) override
+    {
+        std::error_code ec;
+        std::uint64_t readStart = telemetry ? telemetryNow() : 0;
+        // Let's peek into this directory, but skip any "no entry" signs
+        fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+        if (telemetry) {
+            telemetry->add(TelemetryCounter::DirsOpened);
+            telemetry->addNanos(TelemetryTimer::DirectoryRead, telemetryNow() - readStart);
+        }
+        if (ec) {
+            errorMessage = ec.message();
+            return false;
+        }
+
+        const fs::directory_iterator end;
+        while (it != end) {
+            const fs::directory_entry& entry = *it;
+            std::string name = entry.path().filename().string();
+
+            std::error_code statEc;
+            EntryType type = EntryType::Other;
+            if (entry.is_symlink(statEc)) {
+                // Follow links to files, but never walk through links to folders (hello, loops!)
+                std::error_code linkEc;
+                const std::uint64_t statStart = telemetry ? telemetryNow() : 0;
+                if (fs::is_regular_file(fs::status(entry.path(), linkEc))) {
+                    type = EntryType::RegularFile;
+                }
+                if (telemetry) {
+                    telemetry->add(TelemetryCounter::StatCalls);
+                    telemetry->addNanos(TelemetryTimer::Stat, telemetryNow() - statStart);
+                }
+            } else if (!statEc && entry.is_directory(statEc)) {
+                type = EntryType::Directory;
+            } else if (!statEc && entry.is_regular_file(statEc)) {
+                type = EntryType::RegularFile;
+            }
+
+            if (statEc) {
+                visitor.entryError(name, statEc.message());
+            } else if (!visitor.visit(DirEntryView{name.data(), name.size(), type})) {
+                return true; // The visitor has seen enough
+            }
+
+            if (telemetry) {
+                readStart = telemetryNow();
+                it.increment(ec);
+                telemetry->add(TelemetryCounter::ReadCalls);
+                telemetry->addNanos(TelemetryTimer::DirectoryRead, telemetryNow() - readStart);
+            } else {
+                it.increment(ec);
+            }
+            if (ec) {
+                errorMessage = ec.message();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* name() const override { return "std::filesystem"; }
+};
+
+#ifdef IYS_HAVE_GETDENTS64
+
+// What the kernel hands back from getdents64 - d_name runs past the end of the struct
+struct LinuxDirent64 {
+    std::uint64_t d_ino;
+    std::int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+inline bool isDots(const char* name)
+{
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+// 🐧 The fast lane: raw getdents64 into one big reusable buffer.
+// d_type tells us what most entries are for free; we only stat when the filesystem
+// shrugs (DT_UNKNOWN) or when we need to see where a symlink points.
+class Getdents64Enumerator : public DirectoryEnumerator
+{
+public:
+    Getdents64Enumerator() : buffer(new char[kBufferSize]) {}
+
+    bool enumerate(const fs::path& dir, DirEntryVisitor& visitor, std::string& errorMessage) override
+    {
+        const std::uint64_t openStart = telemetry ? telemetryNow() : 0;
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        const int openErrno = errno;
+        if (telemetry) {
+            telemetry->add(TelemetryCounter::DirsOpened);
+            telemetry->addNanos(TelemetryTimer::DirectoryRead, telemetryNow() - openStart);
+        }
+        if (fd < 0) {
+            if (openErrno == EACCES || openErrno == EPERM) {
+                return true; // Same as skip_permission_denied - not our business
+            }
+            errorMessage = std::strerror(openErrno);
+            return false;
+        }
+
+        bool ok = enumerateFd(fd, visitor, errorMessage);
+        ::close(fd);
+        return ok;
+    }
+
+    bool supportsDirFd() const override { return true; }
+
+    bool enumerateFd(int dirFd, DirEntryVisitor& visitor, std::string& errorMessage) override
+    {
+        bool keepGoing = true;
+        while (keepGoing) {
+            const std::uint64_t readStart = telemetry ? telemetryNow() : 0;
+            long bytesRead = ::syscall(SYS_getdents64, dirFd, buffer.get(), kBufferSize);
+            const int readErrno = errno;
+            if (telemetry) {
+                telemetry->add(TelemetryCounter::ReadCalls);
+                telemetry->addNanos(TelemetryTimer::DirectoryRead, telemetryNow() - readStart);
+            }
+            if (bytesRead == 0) {
+                break; // End of directory
+            }
+            if (bytesRead < 0) {
+                if (readErrno == EINTR) {
+                    continue;
+                }
+                errorMessage = std::strerror(readErrno);
+                return false;
+            }
+
+#ifdef IYS_HAVE_IO_URING
+            if (batchIo && batchStats(dirFd, bytesRead)) {
+                keepGoing = visitBatched(dirFd, bytesRead, visitor);
+                continue;
+            }
+#endif
+            for (long pos = 0; pos < bytesRead && keepGoing;) {
+                const auto* d = reinterpret_cast<const LinuxDirent64*>(buffer.get() + pos);
+                pos += d->d_reclen;
+
+                const char* name = d->d_name;
+                if (isDots(name)) {
+                    continue; // "." and ".." - been there
+                }
+
+                EntryType type;
+                if (!classify(dirFd, name, d->d_type, type, visitor)) {
+                    continue;
+                }
+                keepGoing = visitor.visit(DirEntryView{name, std::strlen(name), type, d->d_ino});
+            }
+        }
+        return true;
+    }
+
+    const char* name() const override { return "getdents64"; }
+
+private:
+    static constexpr std::size_t kBufferSize = 256 * 1024; // Thousands of entries per syscall
+
+    // Turns d_type into an EntryType, stat-ing only when we really have to.
+    // Returns false if the entry should be skipped (it vanished, or stat failed).
+    bool classify(int dirFd, const char* name, unsigned char dType, EntryType& type, DirEntryVisitor& visitor)
+    {
+        switch (dType) {
+        case DT_DIR: type = EntryType::Directory; return true;
+        case DT_REG: type = EntryType::RegularFile; return true;
+        case DT_LNK: type = followLink(dirFd, name); return true;
+        case DT_UNKNOWN: break; // Some filesystems (older XFS, some network mounts) don't fill d_type
+        default: type = EntryType::Other; return true;
+        }
+
+        struct stat st;
+        if (!countedStat(dirFd, name, st, AT_SYMLINK_NOFOLLOW)) {
+            if (errno != ENOENT) { // Deleted under our feet isn't worth a warning
+                visitor.entryError(name, std::strerror(errno));
+            }
+            return false;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            type = EntryType::Directory;
+        } else if (S_ISREG(st.st_mode)) {
+            type = EntryType::RegularFile;
+        } else if (S_ISLNK(st.st_mode)) {
+            type = followLink(dirFd, name);
+        } else {
+            type = EntryType::Other;
+        }
+        return true;
+    }
+
+    // Links to files count as files; links to folders (or nowhere) are left alone
+    EntryType followLink(int dirFd, const char* name)
+    {
+        struct stat st;
+        if (countedStat(dirFd, name, st, 0) && S_ISREG(st.st_mode)) {
+            return EntryType::RegularFile;
+        }
+        return EntryType::Other;
+    }
+
+    // fstatat, counted and timed when somebody is keeping score
+    bool countedStat(int dirFd, const char* name, struct stat& st, int flags)
+    {
+        if (!telemetry) {
+            return ::fstatat(dirFd, name, &st, flags) == 0;
+        }
+        const std::uint64_t start = telemetryNow();
+        const bool ok = ::fstatat(dirFd, name, &st, flags) == 0;
+        const int savedErrno = errno;
+        telemetry->add(TelemetryCounter::StatCalls);
+        telemetry->addNanos(TelemetryTimer::Stat, telemetryNow() - start);
+        errno = savedErrno; // The caller still wants to know why it failed
+        return ok;
+    }
+
+#ifdef IYS_HAVE_IO_URING
+    // 💍 Queues a statx for every entry in the buffer that needs one and runs them as one batch.
+    // False when nobody needed a stat - then the plain loop is all there is to do.
+    bool batchStats(int dirFd, long bytesRead)
+    {
+        statIndex.clear();
+        for (long pos = 0; pos < bytesRead;) {
+            const auto* d = reinterpret_cast<const LinuxDirent64*>(buffer.get() + pos);
+            pos += d->d_reclen;
+            if ((d->d_type == DT_UNKNOWN || d->d_type == DT_LNK) && !isDots(d->d_name)) {
+                // Unknown: what IS it (the link itself, like before)? Link: what does it point at?
+                const int flags = AT_STATX_DONT_SYNC | (d->d_type == DT_UNKNOWN ? AT_SYMLINK_NOFOLLOW : 0);
+                statIndex.push_back(batchIo->addStatx(dirFd, d->d_name, flags, STATX_TYPE));
+            }
+        }
+        if (statIndex.empty()) {
+            return false;
+        }
+        const std::uint64_t start = telemetry ? telemetryNow() : 0;
+        batchIo->run(telemetry);
+        if (telemetry) {
+            telemetry->add(TelemetryCounter::StatCalls, statIndex.size());
+            telemetry->addNanos(TelemetryTimer::Stat, telemetryNow() - start);
+        }
+        return true;
+    }
+
+    // The same walk over the buffer as the plain loop, with the answers batchStats() collected
+    bool visitBatched(int dirFd, long bytesRead, DirEntryVisitor& visitor)
+    {
+        std::size_t nextStat = 0;
+        for (long pos = 0; pos < bytesRead;) {
+            const auto* d = reinterpret_cast<const LinuxDirent64*>(buffer.get() + pos);
+            pos += d->d_reclen;
+
+            const char* name = d->d_name;
+            if (isDots(name)) {
+                continue;
+            }
+            EntryType type;
+            if (d->d_type == DT_UNKNOWN || d->d_type == DT_LNK) {
+                const std::size_t request = statIndex[nextStat++];
+                const int rc = batchIo->result(request);
+                if (rc < 0) {
+                    if (d->d_type == DT_LNK) {
+                        type = EntryType::Other; // Dangling link - same as followLink()
+                    } else {
+                        if (rc != -ENOENT) {
+                            visitor.entryError(name, std::strerror(-rc));
+                        }
+                        continue;
+                    }
+                } else {
+                    const unsigned int mode = batchIo->statxResult(request).stx_mode;
+                    if (S_ISDIR(mode)) {
+                        type = d->d_type == DT_LNK ? EntryType::Other : EntryType::Directory;
+                    } else if (S_ISREG(mode)) {
+                        type = EntryType::RegularFile;
+                    } else if (S_ISLNK(mode)) {
+                        type = followLink(dirFd, name); // DT_UNKNOWN that turned out to be a link: rare, one more trip
+                    } else {
+                        type = EntryType::Other;
+                    }
+                }
+            } else if (!classify(dirFd, name, d->d_type, type, visitor)) {
+                continue;
+            }
+            if (!visitor.visit(DirEntryView{name, std::strlen(name), type, d->d_ino})) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::size_t> statIndex; // Request index of each entry batchStats() queued, in buffer order
+#endif
+
+    std::unique_ptr<char[]> buffer;
+};
+
+#endif // IYS_HAVE_GETDENTS64
+
+} // namespace
+
+std::unique_ptr<DirectoryEnumerator> makeDirectoryEnumerator(EnumerationBackend backend)
+{
+#ifdef IYS_HAVE_GETDENTS64
+    if (backend == EnumerationBackend::Auto || backend == EnumerationBackend::Getdents64) {
+        return std::make_unique<Getdents64Enumerator>();
+    }
+#else
+    (void)backend; // Only the portable one in this build
+#endif
+    return std::make_unique<StdFilesystemEnumerator>();
+}
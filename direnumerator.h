@@ -0,0 +1,99 @@
+#ifndef DIRENUMERATOR_H
+#define DIRENUMERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+class ThreadTelemetry; // searchtelemetry.h
+class UringBatch;      // uringbatch.h
+
+// Which machinery reads directories for us.
+// Auto picks the fastest one this build has; the others force a specific one (handy for comparing!)
+enum class EnumerationBackend {
+    Auto,
+    StdFilesystem, // Portable std::filesystem::directory_iterator - works everywhere
+    Getdents64     // Linux only: raw getdents64 with big buffers and d_type (needs IYS_HAVE_GETDENTS64)
+};
+
+// What kind of thing an entry is, as far as the search cares.
+// Symlinks are followed for files (a link to a file counts as a file),
+// but a link to a directory is reported as Other so we never loop through it.
+enum class EntryType {
+    Directory,
+    RegularFile,
+    Other
+};
+
+// 👀 A peek at one directory entry - just borrowed bytes, nothing allocated.
+// The name is only valid during the visit() call, so copy it if you need to keep it.
+struct DirEntryView {
+    const char* name;
+    std::size_t nameLength;
+    EntryType type;
+    std::uint64_t inode = 0; // d_ino from getdents64 (0 = this backend doesn't know)
+
+    std::string_view nameView() const { return std::string_view(name, nameLength); }
+};
+
+// Whoever walks a directory implements this to get told about each entry
+class DirEntryVisitor
+{
+public:
+    virtual ~DirEntryVisitor() = default;
+
+    // Return false to stop reading this directory early (cancelled, etc.)
+    virtual bool visit(const DirEntryView& entry) = 0;
+
+    // Something went wrong with one specific entry - the rest of the directory is still fine
+    virtual void entryError(std::string_view name, const std::string& what) = 0;
+};
+
+// 📂 Reads one directory at a time and hands every entry (minus "." and "..") to a visitor.
+// One instance per thread please - implementations keep reusable buffers inside.
+class DirectoryEnumerator
+{
+public:
+    virtual ~DirectoryEnumerator() = default;
+
+    // Returns false (and fills errorMessage) if the directory couldn't be opened or read.
+    // Directories we simply aren't allowed into are skipped quietly, like before.
+    virtual bool enumerate(const fs::path& dir, DirEntryVisitor& visitor, std::string& errorMessage) = 0;
+
+    // Friendly name for logs ("getdents64", "std::filesystem")
+    virtual const char* name() const = 0;
+
+    // 🔗 Optional fast path for dirfd-relative walking (POSIX only):
+    // read an already-open directory descriptor instead of resolving a path again.
+    // The caller keeps ownership of dirFd. Backends that can't do it say so here.
+    virtual bool supportsDirFd() const { return false; }
+    virtual bool enumerateFd(int dirFd, DirEntryVisitor& visitor, std::string& errorMessage)
+    {
+        (void)dirFd; (void)visitor;
+        errorMessage = "this backend can't read directory descriptors";
+        return false;
+    }
+
+    // 📈 Where to count folders opened, read calls and stats, and time them (nullptr = nowhere).
+    // Has to be the owning thread's block - see searchtelemetry.h.
+    void setTelemetry(ThreadTelemetry* counters) { telemetry = counters; }
+
+    // 💍 A ready io_uring of the owning thread to batch the stats through (nullptr = one fstatat at a time).
+    // Only the getdents64 backend uses it: a buffer's DT_UNKNOWN and symlink entries go out together.
+    void setBatchIo(UringBatch* ring) { batchIo = ring; }
+
+protected:
+    ThreadTelemetry* telemetry = nullptr;
+    UringBatch* batchIo = nullptr;
+};
+
+// Builds the enumerator for the requested backend.
+// Asking for one this build doesn't have quietly gives you the portable fallback.
+std::unique_ptr<DirectoryEnumerator> makeDirectoryEnumerator(EnumerationBackend backend);
+
+#endif // DIRENUMERATOR_H
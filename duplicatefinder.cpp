@@ -0,0 +1,571 @@
+#include "duplicatefinder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// --- XXH64, streaming (same numbers as the reference implementation) ---
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+inline std::uint64_t rotl(std::uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t read64(const char* p)
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v)); // Little-endian everywhere we build; a big-endian box would just get other (consistent) hashes
+    return v;
+}
+
+inline std::uint32_t read32(const char* p)
+{
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint64_t round64(std::uint64_t acc, std::uint64_t lane)
+{
+    acc += lane * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t value)
+{
+    acc ^= round64(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+class Hash64
+{
+public:
+    explicit Hash64(std::uint64_t seed = 0)
+        : lanes{seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1}
+        , seed(seed)
+    {
+    }
+
+    void update(const char* p, std::size_t length)
+    {
+        total += length;
+        if (held + length < 32) {
+            std::memcpy(pending + held, p, length);
+            held += length;
+            return;
+        }
+        const char* end = p + length;
+        if (held > 0) {
+            // Top up the leftovers from last time to a full stripe first
+            const std::size_t fill = 32 - held;
+            std::memcpy(pending + held, p, fill);
+            stripe(pending);
+            p += fill;
+            held = 0;
+        }
+        for (; p + 32 <= end; p += 32) {
+            stripe(p);
+        }
+        held = static_cast<std::size_t>(end - p);
+        std::memcpy(pending, p, held);
+    }
+
+    std::uint64_t digest() const
+    {
+        std::uint64_t h;
+        if (total >= 32) {
+            h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+            for (const std::uint64_t lane : lanes) {
+                h = mergeRound(h, lane);
+            }
+        } else {
+            h = seed + kPrime5;
+        }
+        h += total;
+
+        const char* p = pending;
+        const char* end = pending + held;
+        for (; p + 8 <= end; p += 8) {
+            h ^= round64(0, read64(p));
+            h = rotl(h, 27) * kPrime1 + kPrime4;
+        }
+        if (p + 4 <= end) {
+            h ^= static_cast<std::uint64_t>(read32(p)) * kPrime1;
+            h = rotl(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+        }
+        for (; p < end; ++p) {
+            h ^= static_cast<std::uint64_t>(static_cast<unsigned char>(*p)) * kPrime5;
+            h = rotl(h, 11) * kPrime1;
+        }
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    void stripe(const char* p)
+    {
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = round64(lanes[i], read64(p + 8 * i));
+        }
+    }
+
+    std::uint64_t lanes[4];
+    std::uint64_t seed;
+    std::uint64_t total = 0;
+    char pending[32];
+    std::size_t held = 0;
+};
+
+// --- Reading files ---
+
+// One open candidate. Reads are positional, so nothing depends on where the file offset is.
+class InputFile
+{
+public:
+    explicit InputFile(const std::string& path)
+    {
+#ifdef _WIN32
+        in.open(std::filesystem::u8path(path), std::ios::binary);
+#else
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY | O_NONBLOCK);
+#endif
+    }
+    ~InputFile()
+    {
+#ifndef _WIN32
+        if (fd >= 0) {
+            ::close(fd);
+        }
+#endif
+    }
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+#ifdef _WIN32
+    bool isOpen() const { return in.is_open(); }
+#else
+    bool isOpen() const { return fd >= 0; }
+#endif
+
+    void expectSequential()
+    {
+#if !defined(_WIN32) && defined(POSIX_FADV_SEQUENTIAL)
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL); // Bigger read-ahead for stage 3 (just a hint)
+#endif
+    }
+
+    // Exactly length bytes at offset, or false (error, or the file got shorter under us)
+    bool readAt(char* into, std::size_t length, std::uint64_t offset)
+    {
+#ifdef _WIN32
+        in.seekg(static_cast<std::streamoff>(offset));
+        in.read(into, static_cast<std::streamsize>(length));
+        return static_cast<std::size_t>(in.gcount()) == length;
+#else
+        std::size_t filled = 0;
+        while (filled < length) {
+            const ssize_t got = ::pread(fd, into + filled, length - filled, static_cast<off_t>(offset + filled));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                return false;
+            }
+            filled += static_cast<std::size_t>(got);
+        }
+        return true;
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    std::ifstream in;
+#else
+    int fd = -1;
+#endif
+};
+
+// What stage 1 found out about one candidate
+struct FileFacts {
+    bool known = false;  // stat() worked
+    bool usable = false; // ...and it's a regular file
+    std::uint64_t size = 0;
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0; // 0 = unknown (then we can't spot hard links, and don't try)
+};
+
+// Every candidate that got past stage 1, with the hashes the later stages fill in
+struct Candidate {
+    std::size_t path;        // Index into the finder's arena
+    std::uint64_t size;
+    std::uint64_t device;
+    std::uint64_t inode;
+    std::uint64_t edgeHash = 0;
+    std::uint64_t fullHash = 0;
+    bool failed = false;
+};
+
+// 🧵 Runs work(i, buffer) for i in [0, count) on `readers` threads, each with a buffer of its own.
+// The calling thread reports progress while it waits - it never touches a file itself.
+template <typename Work>
+void runOnReaders(unsigned int readers, std::size_t count, const char* stage, const std::atomic<bool>& cancelled,
+                  const DuplicateFinder::ProgressSink& onProgress, Work work)
+{
+    if (count == 0) {
+        return;
+    }
+    readers = static_cast<unsigned int>(std::min<std::size_t>(readers, count));
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::mutex exitMutex;
+    std::condition_variable exited;
+    unsigned int running = readers;
+
+    std::vector<std::thread> threads;
+    threads.reserve(readers);
+    for (unsigned int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            std::string buffer;
+            for (;;) {
+                const std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= count || cancelled.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                work(i, buffer);
+                done.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::lock_guard<std::mutex> lock(exitMutex);
+            --running;
+            exited.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(exitMutex);
+        while (!exited.wait_for(lock, std::chrono::milliseconds(250), [&] { return running == 0; })) {
+            if (onProgress) {
+                lock.unlock();
+                onProgress(stage, done.load(std::memory_order_relaxed), count);
+                lock.lock();
+            }
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (onProgress) {
+        onProgress(stage, done.load(), count);
+    }
+}
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Calls onRun(first, last) for every run of two or more neighbours that same() says belong together
+template <typename Same, typename OnRun>
+void forEachRun(std::size_t count, Same same, OnRun onRun)
+{
+    std::size_t first = 0;
+    while (first < count) {
+        std::size_t last = first + 1;
+        while (last < count && same(first, last)) {
+            ++last;
+        }
+        if (last - first >= 2) {
+            onRun(first, last);
+        }
+        first = last;
+    }
+}
+
+} // namespace
+
+DuplicateFinder::DuplicateFinder(const SearchConfig& config, std::atomic<bool>& cancelled, ErrorSink onError)
+    : minSize(config.duplicateMinSize)
+    , readerCount(resolveReaderCount(config))
+    , cancelled(cancelled)
+    , onError(std::move(onError))
+{
+}
+
+unsigned int DuplicateFinder::resolveReaderCount(const SearchConfig& config)
+{
+    if (config.duplicateReaders > 0) {
+        return config.duplicateReaders;
+    }
+    // Same reasoning as the content readers: a few keep the disk busy, more just make it seek
+    const unsigned int cores = std::thread::hardware_concurrency();
+    return std::clamp(cores, 2u, 8u);
+}
+
+std::uint64_t DuplicateFinder::hash(std::string_view bytes, std::uint64_t seed)
+{
+    Hash64 state(seed);
+    state.update(bytes.data(), bytes.size());
+    return state.digest();
+}
+
+void DuplicateFinder::add(std::string_view path)
+{
+    std::lock_guard<std::mutex> lock(addMutex);
+    arena.append(path.data(), path.size());
+    ends.push_back(arena.size());
+}
+
+std::string_view DuplicateFinder::pathAt(std::size_t i) const
+{
+    const std::uint64_t start = i == 0 ? 0 : ends[i - 1];
+    return std::string_view(arena.data() + start, ends[i] - start);
+}
+
+std::vector<DuplicateGroup> DuplicateFinder::find(const ProgressSink& onProgress)
+{
+    std::lock_guard<std::mutex> lock(addMutex); // Nobody adds while we look
+    tally = DuplicateStats();
+    tally.candidates = ends.size();
+    tally.readers = readerCount;
+    std::atomic<std::uint64_t> statFailures{0};
+    std::atomic<std::uint64_t> readFailures{0};
+    std::atomic<std::uint64_t> bytesRead{0};
+
+    auto report = [&](const char* what, std::string_view path) {
+        if (onError) {
+            onError(std::string("can't ") + what + " " + std::string(path) + " - " + std::strerror(errno));
+        }
+    };
+
+    // 📏 Stage 1: sizes (and device + inode, to spot the same file reached twice)
+    auto stageStart = Clock::now();
+    std::vector<FileFacts> facts(ends.size());
+    runOnReaders(readerCount, ends.size(), "size", cancelled, onProgress, [&](std::size_t i, std::string&) {
+        const std::string path(pathAt(i));
+        FileFacts& f = facts[i];
+#ifdef _WIN32
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        const fs::path filePath = fs::u8path(path);
+        const bool regular = fs::is_regular_file(filePath, ec);
+        if (!ec && regular) {
+            f.size = fs::file_size(filePath, ec);
+        }
+        if (ec) {
+            statFailures.fetch_add(1, std::memory_order_relaxed);
+            if (onError) {
+                onError("can't stat " + path + " - " + ec.message());
+            }
+            return;
+        }
+        f.known = true;
+        f.usable = regular;
+#else
+        struct stat info;
+        if (::stat(path.c_str(), &info) != 0) {
+            statFailures.fetch_add(1, std::memory_order_relaxed);
+            report("stat", path);
+            return;
+        }
+        f.known = true;
+        f.usable = S_ISREG(info.st_mode);
+        f.size = static_cast<std::uint64_t>(info.st_size);
+        f.device = static_cast<std::uint64_t>(info.st_dev);
+        f.inode = static_cast<std::uint64_t>(info.st_ino);
+#endif
+    });
+    tally.statFailures = statFailures.load();
+
+    std::vector<Candidate> sized;
+    sized.reserve(ends.size());
+    for (std::size_t i = 0; i < facts.size(); ++i) {
+        const FileFacts& f = facts[i];
+        if (f.usable && f.size >= minSize) {
+            sized.push_back(Candidate{i, f.size, f.device, f.inode});
+        } else if (f.known) {
+            tally.skipped++; // A device/FIFO/folder, or too small to bother with
+        }
+    }
+    std::vector<FileFacts>().swap(facts);
+    // Same size next to each other, and within a size the same file (device + inode) next to itself
+    std::sort(sized.begin(), sized.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.size != b.size) return a.size < b.size;
+        if (a.device != b.device) return a.device < b.device;
+        if (a.inode != b.inode) return a.inode < b.inode;
+        return a.path < b.path;
+    });
+    {
+        std::vector<Candidate> distinct;
+        distinct.reserve(sized.size());
+        for (const Candidate& c : sized) {
+            if (!distinct.empty() && c.inode != 0 && distinct.back().inode == c.inode && distinct.back().device == c.device
+                && distinct.back().size == c.size) {
+                tally.sameFile++; // A hard link (or a symlink) to a file already on the list - not a copy
+                continue;
+            }
+            tally.totalBytes += c.size;
+            distinct.push_back(c);
+        }
+        sized.swap(distinct);
+    }
+    // Only sizes that come up at least twice are worth reading at all
+    std::vector<Candidate> edges;
+    forEachRun(sized.size(), [&](std::size_t a, std::size_t b) { return sized[a].size == sized[b].size; },
+               [&](std::size_t first, std::size_t last) { edges.insert(edges.end(), sized.begin() + first, sized.begin() + last); });
+    std::vector<Candidate>().swap(sized);
+    tally.sizeMatched = edges.size();
+    tally.statSeconds = secondsSince(stageStart);
+
+    // ✂️ Stage 2: the first and last kEdgeBytes of each (small files: all of it)
+    stageStart = Clock::now();
+    runOnReaders(readerCount, edges.size(), "edges", cancelled, onProgress, [&](std::size_t i, std::string& buffer) {
+        Candidate& c = edges[i];
+        const std::string path(pathAt(c.path));
+        InputFile file(path);
+        if (!file.isOpen()) {
+            c.failed = true;
+            readFailures.fetch_add(1, std::memory_order_relaxed);
+            report("open", path);
+            return;
+        }
+        const bool whole = c.size <= 2 * kEdgeBytes;
+        const std::size_t length = whole ? static_cast<std::size_t>(c.size) : 2 * kEdgeBytes;
+        buffer.resize(std::max(buffer.size(), length));
+        const bool ok = whole ? file.readAt(buffer.data(), length, 0)
+                              : file.readAt(buffer.data(), kEdgeBytes, 0)
+                                    && file.readAt(buffer.data() + kEdgeBytes, kEdgeBytes, c.size - kEdgeBytes);
+        if (!ok) {
+            c.failed = true;
+            readFailures.fetch_add(1, std::memory_order_relaxed);
+            report("read", path);
+            return;
+        }
+        bytesRead.fetch_add(length, std::memory_order_relaxed);
+        c.edgeHash = hash(std::string_view(buffer.data(), length));
+        if (whole) {
+            c.fullHash = c.edgeHash; // We just hashed all of it
+        }
+    });
+    tally.edgeHashed = edges.size();
+    tally.edgeSeconds = secondsSince(stageStart);
+
+    auto bySizeThen = [](auto key) {
+        return [key](const Candidate& a, const Candidate& b) {
+            if (a.size != b.size) return a.size < b.size;
+            return key(a) < key(b);
+        };
+    };
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [](const Candidate& c) { return c.failed; }), edges.end());
+    std::sort(edges.begin(), edges.end(), bySizeThen([](const Candidate& c) { return c.edgeHash; }));
+
+    // Still colliding: small files are settled already, big ones go on to stage 3
+    std::vector<Candidate> settled;
+    std::vector<Candidate> full;
+    forEachRun(edges.size(),
+               [&](std::size_t a, std::size_t b) { return edges[a].size == edges[b].size && edges[a].edgeHash == edges[b].edgeHash; },
+               [&](std::size_t first, std::size_t last) {
+                   std::vector<Candidate>& into = edges[first].size <= 2 * kEdgeBytes ? settled : full;
+                   into.insert(into.end(), edges.begin() + first, edges.begin() + last);
+               });
+    std::vector<Candidate>().swap(edges);
+
+    // 📖 Stage 3: the rest of each file, for the few that are left. The edges are hashed already, so
+    // only the bytes between them get read, and their hash is chained onto the edges' one.
+    stageStart = Clock::now();
+    runOnReaders(readerCount, full.size(), "full", cancelled, onProgress, [&](std::size_t i, std::string& buffer) {
+        Candidate& c = full[i];
+        const std::string path(pathAt(c.path));
+        InputFile file(path);
+        if (!file.isOpen()) {
+            c.failed = true;
+            readFailures.fetch_add(1, std::memory_order_relaxed);
+            report("open", path);
+            return;
+        }
+        file.expectSequential();
+        buffer.resize(std::max<std::size_t>(buffer.size(), kReadChunk));
+        Hash64 state(c.edgeHash);
+        const std::uint64_t middleEnd = c.size - kEdgeBytes;
+        for (std::uint64_t offset = kEdgeBytes; offset < middleEnd; offset += kReadChunk) {
+            if (cancelled.load(std::memory_order_relaxed)) {
+                c.failed = true;
+                return;
+            }
+            const std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(kReadChunk, middleEnd - offset));
+            if (!file.readAt(buffer.data(), length, offset)) {
+                c.failed = true;
+                readFailures.fetch_add(1, std::memory_order_relaxed);
+                report("read", path);
+                return;
+            }
+            bytesRead.fetch_add(length, std::memory_order_relaxed);
+            state.update(buffer.data(), length);
+        }
+        c.fullHash = state.digest();
+    });
+    tally.fullHashed = full.size();
+    tally.fullSeconds = secondsSince(stageStart);
+
+    full.erase(std::remove_if(full.begin(), full.end(), [](const Candidate& c) { return c.failed; }), full.end());
+    std::sort(full.begin(), full.end(), bySizeThen([](const Candidate& c) { return c.fullHash; }));
+    settled.insert(settled.end(), full.begin(), full.end());
+    std::vector<Candidate>().swap(full);
+
+    // 👯 Same size + same full hash = one group
+    std::vector<DuplicateGroup> groups;
+    if (!cancelled.load()) {
+        forEachRun(settled.size(),
+                   [&](std::size_t a, std::size_t b) { return settled[a].size == settled[b].size && settled[a].fullHash == settled[b].fullHash; },
+                   [&](std::size_t first, std::size_t last) {
+                       DuplicateGroup group;
+                       group.size = settled[first].size;
+                       group.hash = settled[first].fullHash;
+                       for (std::size_t i = first; i < last; ++i) {
+                           group.paths.emplace_back(pathAt(settled[i].path));
+                       }
+                       std::sort(group.paths.begin(), group.paths.end());
+                       groups.push_back(std::move(group));
+                   });
+    }
+    std::sort(groups.begin(), groups.end(), [](const DuplicateGroup& a, const DuplicateGroup& b) {
+        if (a.wastedBytes() != b.wastedBytes()) return a.wastedBytes() > b.wastedBytes(); // Biggest win first
+        if (a.size != b.size) return a.size > b.size;
+        return a.paths.front() < b.paths.front();
+    });
+
+    tally.readFailures = readFailures.load();
+    tally.bytesRead = bytesRead.load();
+    tally.bytesAvoided = tally.totalBytes > tally.bytesRead ? tally.totalBytes - tally.bytesRead : 0;
+    tally.groups = groups.size();
+    for (const DuplicateGroup& group : groups) {
+        tally.duplicateFiles += group.paths.size();
+        tally.wastedBytes += group.wastedBytes();
+    }
+    return groups;
+}
@@ -0,0 +1,112 @@
+#ifndef DUPLICATEFINDER_H
+#define DUPLICATEFINDER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "searchlogic.h" // SearchConfig
+
+// 👯 Finding Duplicate Files 👯
+// Cleaning up shared storage used to mean walking the tree with us and then AGAIN with a
+// separate duplicate checker that read every byte of every file. Now the walk hands its
+// candidates (every file whose name passes - SearchConfig::findDuplicates) straight over, and
+// the finder reads as little as it can get away with:
+//
+//   1. size     stat() every candidate. Two files of different sizes can't be the same, so
+//               only sizes shared by two or more files go on (most files drop out right here).
+//               The same file seen twice (hard links, or a symlink to it) counts once.
+//   2. edges    hash just the first and last kEdgeBytes of what's left. Different headers or
+//               trailers split most of the rest apart. A file of up to 2 * kEdgeBytes is read
+//               whole here, so its hash already IS the full one.
+//   3. full     only files whose size AND edge hash still collide get the rest read - just the
+//               part between the edges, since those are hashed already.
+//
+// Stages 1-3 run on a small pool of reader threads (SearchConfig::duplicateReaders), which is
+// also the most files we ever have open at once - the disk sees a few steady readers instead
+// of a crowd. The hash is XXH64 (fast, not cryptographic): fine for telling files apart on
+// your own disk, not meant to stand up to someone crafting collisions on purpose.
+//
+// What comes out is a list of groups, each holding files with the same size and the same
+// content fingerprint - biggest waste first - plus how many bytes we got away with not reading.
+
+struct DuplicateGroup {
+    std::uint64_t size = 0;          // Of each file in the group
+    std::uint64_t hash = 0;          // Content fingerprint: XXH64 of the file (small ones), or of its middle seeded with its edges' hash
+    std::vector<std::string> paths;  // Two or more, sorted
+    std::uint64_t wastedBytes() const { return paths.empty() ? 0 : size * (paths.size() - 1); }
+};
+
+struct DuplicateStats {
+    std::uint64_t candidates = 0;     // Files the walk handed over
+    std::uint64_t statFailures = 0;   // ...that we couldn't stat (gone, no permission)
+    std::uint64_t skipped = 0;        // ...not regular files, or below SearchConfig::duplicateMinSize
+    std::uint64_t sameFile = 0;       // ...hard links / symlinks to a file we already had
+    std::uint64_t totalBytes = 0;     // Sum of the sizes of the distinct files left
+    std::uint64_t sizeMatched = 0;    // Files that share their size with another (went to stage 2)
+    std::uint64_t edgeHashed = 0;     // ...hashed by their edges (the small ones whole)
+    std::uint64_t fullHashed = 0;     // ...that went on to stage 3 (the part between the edges)
+    std::uint64_t readFailures = 0;   // Files that couldn't be read in stage 2 or 3
+    std::uint64_t bytesRead = 0;      // What stages 2 and 3 actually read
+    std::uint64_t bytesAvoided = 0;   // totalBytes - bytesRead: what a read-everything tool would have read on top
+    std::uint64_t groups = 0;
+    std::uint64_t duplicateFiles = 0; // Files in groups, counting every copy
+    std::uint64_t wastedBytes = 0;    // What deleting all but one per group would free
+    double statSeconds = 0;
+    double edgeSeconds = 0;
+    double fullSeconds = 0;
+    unsigned int readers = 0;
+};
+
+class DuplicateFinder
+{
+public:
+    using ErrorSink = std::function<void(const std::string& message)>;
+    // Which stage we're in and how far through it (called from the thread running find())
+    using ProgressSink = std::function<void(const char* stage, std::uint64_t done, std::uint64_t total)>;
+
+    static constexpr std::size_t kEdgeBytes = 4096;        // Hashed from each end in stage 2
+    static constexpr std::size_t kReadChunk = 1024 * 1024; // Stage 3 reads this much at a time
+
+    // cancelled is checked between files (and between chunks of big ones).
+    // onError (optional, any reader thread) hears about files we couldn't stat or read.
+    DuplicateFinder(const SearchConfig& config, std::atomic<bool>& cancelled, ErrorSink onError = ErrorSink());
+
+    DuplicateFinder(const DuplicateFinder&) = delete;
+    DuplicateFinder& operator=(const DuplicateFinder&) = delete;
+
+    // Adds one candidate. Thread-safe, and cheap - nothing is read until find().
+    void add(std::string_view path);
+
+    // Runs the three stages over everything added so far and returns the groups, biggest waste first
+    std::vector<DuplicateGroup> find(const ProgressSink& onProgress = ProgressSink());
+
+    DuplicateStats stats() const { return tally; } // The numbers from the last find()
+
+    // Turns config.duplicateReaders (0 = auto) into the number of readers find() will use
+    static unsigned int resolveReaderCount(const SearchConfig& config);
+
+    // 🧮 XXH64 of a whole buffer (the same hash the stages use) - exposed for the benchmark
+    static std::uint64_t hash(std::string_view bytes, std::uint64_t seed = 0);
+
+private:
+    std::string_view pathAt(std::size_t i) const;
+
+    const std::uint64_t minSize;
+    const unsigned int readerCount;
+    std::atomic<bool>& cancelled;
+    ErrorSink onError;
+
+    std::mutex addMutex;
+    std::string arena;                 // Every candidate path, back to back (like a ResultBatch)
+    std::vector<std::uint64_t> ends;
+
+    DuplicateStats tally;
+};
+
+#endif // DUPLICATEFINDER_H
@@ -0,0 +1,644 @@
+#include "fileindex.h"
+#include "trigramindex.h"
+#include "searchtelemetry.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'Y', 'S', 'I', 'N', 'D', 'E', 'X'};
+
+// 📐 The on-disk records. Fixed-size and 8-byte aligned so we can read them straight out of the mapping.
+struct IndexHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t rootCount;
+    std::uint64_t dirCount;
+    std::uint64_t fileCount;
+    std::uint64_t rootsOffset;
+    std::uint64_t dirsOffset;
+    std::uint64_t filesOffset;
+    std::uint64_t stringsOffset;
+    std::uint64_t stringsSize;
+    std::int64_t builtAt;
+    std::uint64_t exactGramCount;
+    std::uint64_t exactGramsOffset;
+    std::uint64_t foldedGramCount;
+    std::uint64_t foldedGramsOffset;
+    std::uint64_t postingsOffset;
+    std::uint64_t postingsSize;
+};
+
+struct RootRecord {
+    std::int64_t mtime;
+    std::uint64_t pathOffset;
+    std::uint32_t pathLength;
+    std::uint32_t reserved;
+};
+
+struct DirRecord {
+    std::uint64_t pathOffset;
+    std::uint32_t pathLength;
+    std::uint32_t rootIndex; // Which root this folder was found under
+};
+
+struct FileRecord {
+    std::uint64_t nameOffset;
+    std::uint32_t dirIndex;
+    std::uint32_t nameLength;
+};
+
+static_assert(sizeof(IndexHeader) % 8 == 0, "header must keep the sections aligned");
+static_assert(sizeof(RootRecord) == 24 && sizeof(DirRecord) == 16 && sizeof(FileRecord) == 16
+                  && sizeof(GramRecord) == 24,
+              "on-disk records must not change size without a format version bump");
+
+// How many entries we check between peeks at the cancel flag / bumps of the shared counter
+constexpr std::uint64_t kScanBatch = 4096;
+
+std::int64_t currentMtime(const fs::path& path, std::error_code& ec)
+{
+    return static_cast<std::int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+}
+
+constexpr std::uint64_t alignUp(std::uint64_t value)
+{
+    return (value + 7) & ~std::uint64_t(7);
+}
+
+// Is `path` the same as `root`, or somewhere below it? Pure string work, no disk access.
+bool isSameOrUnder(std::string_view path, std::string_view root)
+{
+    if (path.size() < root.size() || path.compare(0, root.size(), root) != 0) {
+        return false;
+    }
+    if (path.size() == root.size() || root.empty()) {
+        return true;
+    }
+    const char last = root.back();
+    const char next = path[root.size()];
+    return last == '/' || last == '\\' || next == '/' || next == '\\';
+}
+
+// Do count records of recordSize bytes fit between offset and end? Divided, not multiplied,
+// so a huge count from a damaged header can't wrap around and look small
+constexpr bool sectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t recordSize, std::uint64_t end)
+{
+    return offset <= end && count <= (end - offset) / recordSize;
+}
+
+// Does a string of the string table stay inside it?
+constexpr bool stringFits(std::uint64_t offset, std::uint32_t length, std::uint64_t stringsSize)
+{
+    return offset <= stringsSize && length <= stringsSize - offset;
+}
+
+} // namespace
+
+// --- Building ---
+
+struct FileIndexBuilder::Shard {
+    std::string strings;
+    std::vector<DirRecord> dirs;   // rootIndex is filled in at write time
+    std::vector<FileRecord> files;
+    std::string lastDir;           // Entries of one folder arrive together, so one comparison is enough
+};
+
+FileIndexBuilder::FileIndexBuilder(unsigned int workerCount)
+{
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+FileIndexBuilder::~FileIndexBuilder() = default;
+
+void FileIndexBuilder::addRoot(const fs::path& root)
+{
+    std::error_code ec;
+    IndexedRoot indexed;
+    indexed.path = root.string();
+    indexed.mtime = currentMtime(root, ec);
+    roots.push_back(std::move(indexed));
+}
+
+void FileIndexBuilder::onFile(unsigned int worker, std::string_view dirPath, std::string_view name)
+{
+    Shard& shard = *shards[worker];
+
+    // New folder? Give it a record (folders are never split across workers)
+    if (shard.dirs.empty() || shard.lastDir != dirPath) {
+        shard.lastDir.assign(dirPath.data(), dirPath.size());
+        shard.dirs.push_back(DirRecord{shard.strings.size(), static_cast<std::uint32_t>(dirPath.size()), 0});
+        shard.strings.append(dirPath.data(), dirPath.size());
+    }
+
+    shard.files.push_back(FileRecord{shard.strings.size(),
+                                     static_cast<std::uint32_t>(shard.dirs.size() - 1),
+                                     static_cast<std::uint32_t>(name.size())});
+    shard.strings.append(name.data(), name.size());
+}
+
+bool FileIndexBuilder::write(const std::string& indexFile, std::string& errorMessage, IndexBuildStats* stats)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto writeStarted = Clock::now();
+
+    // 📏 Work out where everything goes. Root paths live at the very start of the blob.
+    IndexHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFileIndexFormatVersion;
+    header.rootCount = static_cast<std::uint32_t>(roots.size());
+    header.builtAt = static_cast<std::int64_t>(std::time(nullptr));
+
+    std::uint64_t rootBytes = 0;
+    for (const auto& root : roots) {
+        rootBytes += root.path.size();
+    }
+    for (const auto& shard : shards) {
+        header.dirCount += shard->dirs.size();
+        header.fileCount += shard->files.size();
+        header.stringsSize += shard->strings.size();
+    }
+    header.stringsSize += rootBytes;
+
+    header.rootsOffset = sizeof(IndexHeader);
+    header.dirsOffset = alignUp(header.rootsOffset + roots.size() * sizeof(RootRecord));
+    header.filesOffset = alignUp(header.dirsOffset + header.dirCount * sizeof(DirRecord));
+    header.stringsOffset = alignUp(header.filesOffset + header.fileCount * sizeof(FileRecord));
+
+    // 🔤 Trigram lists over every name, using the same file IDs the file table ends up with
+    const auto gramsStarted = Clock::now();
+    std::vector<GramRecord> exactGrams;
+    std::vector<GramRecord> foldedGrams;
+    std::string postings;
+    {
+        TrigramIndexBuilder grams;
+        std::uint32_t fileId = 0;
+        for (const auto& shard : shards) {
+            for (const FileRecord& file : shard->files) {
+                grams.addName(fileId++, std::string_view(shard->strings.data() + file.nameOffset, file.nameLength));
+            }
+        }
+        grams.finish(exactGrams, foldedGrams, postings);
+    }
+    const double trigramSeconds = std::chrono::duration<double>(Clock::now() - gramsStarted).count();
+
+    header.exactGramCount = exactGrams.size();
+    header.foldedGramCount = foldedGrams.size();
+    header.postingsSize = postings.size();
+    header.exactGramsOffset = alignUp(header.stringsOffset + header.stringsSize);
+    header.foldedGramsOffset = header.exactGramsOffset + header.exactGramCount * sizeof(GramRecord);
+    header.postingsOffset = header.foldedGramsOffset + header.foldedGramCount * sizeof(GramRecord);
+
+    // Write to a temp file first, so a half-written index never replaces a good one
+    const std::string tempFile = indexFile + ".tmp";
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        errorMessage = "can't create " + tempFile;
+        return false;
+    }
+
+    auto padTo = [&out](std::uint64_t offset) {
+        static const char zeros[8] = {};
+        std::uint64_t position = static_cast<std::uint64_t>(out.tellp());
+        if (offset > position) {
+            out.write(zeros, static_cast<std::streamsize>(offset - position));
+        }
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::uint64_t stringCursor = 0;
+    for (const auto& root : roots) {
+        RootRecord record{root.mtime, stringCursor, static_cast<std::uint32_t>(root.path.size()), 0};
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        stringCursor += root.path.size();
+    }
+
+    // Folders: shift each shard's string offsets past everything before it, and find their root
+    padTo(header.dirsOffset);
+    std::uint64_t shardStringBase = rootBytes;
+    for (const auto& shard : shards) {
+        for (DirRecord dir : shard->dirs) {
+            std::string_view dirPath(shard->strings.data() + dir.pathOffset, dir.pathLength);
+            dir.rootIndex = 0;
+            std::size_t bestLength = 0;
+            for (std::size_t r = 0; r < roots.size(); ++r) {
+                if (roots[r].path.size() >= bestLength && isSameOrUnder(dirPath, roots[r].path)) {
+                    dir.rootIndex = static_cast<std::uint32_t>(r);
+                    bestLength = roots[r].path.size();
+                }
+            }
+            dir.pathOffset += shardStringBase;
+            out.write(reinterpret_cast<const char*>(&dir), sizeof(dir));
+        }
+        shardStringBase += shard->strings.size();
+    }
+
+    // Files: same shifting, plus each shard's folder numbers move up by the folders before it
+    padTo(header.filesOffset);
+    shardStringBase = rootBytes;
+    std::uint32_t shardDirBase = 0;
+    for (const auto& shard : shards) {
+        for (FileRecord file : shard->files) {
+            file.nameOffset += shardStringBase;
+            file.dirIndex += shardDirBase;
+            out.write(reinterpret_cast<const char*>(&file), sizeof(file));
+        }
+        shardStringBase += shard->strings.size();
+        shardDirBase += static_cast<std::uint32_t>(shard->dirs.size());
+    }
+
+    padTo(header.stringsOffset);
+    for (const auto& root : roots) {
+        out.write(root.path.data(), static_cast<std::streamsize>(root.path.size()));
+    }
+    for (const auto& shard : shards) {
+        out.write(shard->strings.data(), static_cast<std::streamsize>(shard->strings.size()));
+    }
+
+    padTo(header.exactGramsOffset);
+    out.write(reinterpret_cast<const char*>(exactGrams.data()),
+              static_cast<std::streamsize>(exactGrams.size() * sizeof(GramRecord)));
+    out.write(reinterpret_cast<const char*>(foldedGrams.data()),
+              static_cast<std::streamsize>(foldedGrams.size() * sizeof(GramRecord)));
+    out.write(postings.data(), static_cast<std::streamsize>(postings.size()));
+
+    out.close();
+    if (!out) {
+        errorMessage = "failed while writing " + tempFile;
+        std::error_code ignored;
+        fs::remove(tempFile, ignored);
+        return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tempFile, indexFile, ec);
+    if (ec) {
+        errorMessage = "can't replace " + indexFile + " - " + ec.message();
+        return false;
+    }
+
+    if (stats) {
+        stats->fileCount = header.fileCount;
+        stats->dirCount = header.dirCount;
+        stats->bytesWritten = header.postingsOffset + header.postingsSize;
+        stats->gramCount = header.exactGramCount + header.foldedGramCount;
+        stats->trigramBytes = header.postingsOffset + header.postingsSize - header.exactGramsOffset;
+        stats->trigramSeconds = trigramSeconds;
+        stats->buildSeconds = std::chrono::duration<double>(Clock::now() - writeStarted).count();
+    }
+    return true;
+}
+
+// --- Querying ---
+
+// 🗺️ A read-only view of the whole index file
+struct FileIndex::Mapping {
+    const char* data = nullptr;
+    std::uint64_t size = 0;
+    TrigramIndexView exactGrams;
+    TrigramIndexView foldedGrams;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE view = nullptr;
+#endif
+
+    bool map(const std::string& path, std::string& errorMessage)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            errorMessage = "can't open " + path;
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            errorMessage = path + " is empty";
+            return false;
+        }
+        size = static_cast<std::uint64_t>(fileSize.QuadPart);
+        view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!view) {
+            errorMessage = "can't map " + path;
+            return false;
+        }
+        data = static_cast<const char*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+        if (!data) {
+            errorMessage = "can't map " + path;
+            return false;
+        }
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            errorMessage = "can't open " + path + " - " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            errorMessage = path + " is empty";
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<std::uint64_t>(st.st_size);
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping keeps the file alive on its own
+        if (mapped == MAP_FAILED) {
+            errorMessage = "can't map " + path + " - " + std::strerror(errno);
+            return false;
+        }
+        ::madvise(mapped, size, MADV_WILLNEED); // We're about to read most of it anyway
+        data = static_cast<const char*>(mapped);
+        return true;
+#endif
+    }
+
+    ~Mapping()
+    {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (view) CloseHandle(view);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) ::munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    const IndexHeader& header() const { return *reinterpret_cast<const IndexHeader*>(data); }
+
+    template <typename Record>
+    const Record* records(std::uint64_t offset) const { return reinterpret_cast<const Record*>(data + offset); }
+
+    std::string_view string(std::uint64_t offset, std::uint32_t length) const
+    {
+        return std::string_view(data + header().stringsOffset + offset, length);
+    }
+};
+
+FileIndex::FileIndex() = default;
+FileIndex::~FileIndex() = default;
+
+bool FileIndex::open(const std::string& indexFile, std::string& errorMessage)
+{
+    mapping.reset();
+    indexedRoots.clear();
+
+    auto candidate = std::make_unique<Mapping>();
+    if (!candidate->map(indexFile, errorMessage)) {
+        return false;
+    }
+
+    // 🧐 Trust, but verify - a truncated or foreign file must not send us reading off the end
+    if (candidate->size < sizeof(IndexHeader)
+        || std::memcmp(candidate->header().magic, kMagic, sizeof(kMagic)) != 0) {
+        errorMessage = indexFile + " isn't an IYS index file";
+        return false;
+    }
+    const IndexHeader& header = candidate->header();
+    if (header.version != kFileIndexFormatVersion) {
+        errorMessage = indexFile + " uses index format v" + std::to_string(header.version)
+                       + " but this build reads v" + std::to_string(kFileIndexFormatVersion) + " - please rebuild it";
+        return false;
+    }
+    // Every section after the header, in file order, each record table 8-byte aligned
+    const bool sectionsFit =
+        header.rootsOffset >= sizeof(IndexHeader)
+        && header.rootsOffset % 8 == 0 && header.dirsOffset % 8 == 0 && header.filesOffset % 8 == 0
+        && header.exactGramsOffset % 8 == 0 && header.foldedGramsOffset % 8 == 0
+        && sectionFits(header.rootsOffset, header.rootCount, sizeof(RootRecord), header.dirsOffset)
+        && sectionFits(header.dirsOffset, header.dirCount, sizeof(DirRecord), header.filesOffset)
+        && sectionFits(header.filesOffset, header.fileCount, sizeof(FileRecord), header.stringsOffset)
+        && sectionFits(header.stringsOffset, header.stringsSize, 1, header.exactGramsOffset)
+        && sectionFits(header.exactGramsOffset, header.exactGramCount, sizeof(GramRecord), header.foldedGramsOffset)
+        && sectionFits(header.foldedGramsOffset, header.foldedGramCount, sizeof(GramRecord), header.postingsOffset)
+        && sectionFits(header.postingsOffset, header.postingsSize, 1, candidate->size);
+    if (!sectionsFit) {
+        errorMessage = indexFile + " is truncated or damaged - please rebuild it";
+        return false;
+    }
+
+    // 🔎 ...and every record in them: search() and forEachFile() follow these offsets and indexes
+    // without another look, so one bad length or folder number would read outside the mapping
+    const RootRecord* rootRecords = candidate->records<RootRecord>(header.rootsOffset);
+    const DirRecord* dirRecords = candidate->records<DirRecord>(header.dirsOffset);
+    const FileRecord* fileRecords = candidate->records<FileRecord>(header.filesOffset);
+    bool recordsFit = true;
+    for (std::uint32_t r = 0; r < header.rootCount && recordsFit; ++r) {
+        recordsFit = stringFits(rootRecords[r].pathOffset, rootRecords[r].pathLength, header.stringsSize);
+    }
+    for (std::uint64_t d = 0; d < header.dirCount && recordsFit; ++d) {
+        recordsFit = stringFits(dirRecords[d].pathOffset, dirRecords[d].pathLength, header.stringsSize);
+    }
+    for (std::uint64_t f = 0; f < header.fileCount && recordsFit; ++f) {
+        recordsFit = fileRecords[f].dirIndex < header.dirCount
+                     && stringFits(fileRecords[f].nameOffset, fileRecords[f].nameLength, header.stringsSize);
+    }
+    if (!recordsFit) {
+        errorMessage = indexFile + " is truncated or damaged - please rebuild it";
+        return false;
+    }
+
+    for (std::uint32_t r = 0; r < header.rootCount; ++r) {
+        IndexedRoot root;
+        root.path = std::string(candidate->string(rootRecords[r].pathOffset, rootRecords[r].pathLength));
+        root.mtime = rootRecords[r].mtime;
+        indexedRoots.push_back(std::move(root));
+    }
+
+    const auto* postings = reinterpret_cast<const unsigned char*>(candidate->data + header.postingsOffset);
+    candidate->exactGrams = TrigramIndexView(candidate->records<GramRecord>(header.exactGramsOffset),
+                                             header.exactGramCount, postings, header.postingsSize);
+    candidate->foldedGrams = TrigramIndexView(candidate->records<GramRecord>(header.foldedGramsOffset),
+                                              header.foldedGramCount, postings, header.postingsSize);
+
+    mapping = std::move(candidate);
+    return true;
+}
+
+bool FileIndex::isOpen() const
+{
+    return mapping != nullptr;
+}
+
+std::uint64_t FileIndex::fileCount() const
+{
+    return mapping ? mapping->header().fileCount : 0;
+}
+
+std::uint64_t FileIndex::dirCount() const
+{
+    return mapping ? mapping->header().dirCount : 0;
+}
+
+std::int64_t FileIndex::builtAt() const
+{
+    return mapping ? mapping->header().builtAt : 0;
+}
+
+bool FileIndex::isStale(std::string& reason) const
+{
+    for (const auto& root : indexedRoots) {
+        std::error_code ec;
+        std::int64_t mtime = currentMtime(root.path, ec);
+        if (ec) {
+            reason = root.path + " can't be checked anymore (" + ec.message() + ")";
+            return true;
+        }
+        if (mtime != root.mtime) {
+            reason = root.path + " changed since the index was built";
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FileIndex::covers(const fs::path& root) const
+{
+    const std::string rootString = root.string();
+    for (const auto& indexed : indexedRoots) {
+        if (isSameOrUnder(rootString, indexed.path)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned long long FileIndex::search(const fs::path& root,
+                                     const CompiledQuery& query,
+                                     const SearchCallback& reportResult,
+                                     std::atomic<bool>& cancellationFlag,
+                                     std::atomic<std::uint64_t>& filesScannedCount,
+                                     const std::function<bool(std::string_view, std::string_view)>& isHidden,
+                                     ThreadTelemetry* telemetry) const
+{
+    if (!mapping) {
+        return 0;
+    }
+    const IndexHeader& header = mapping->header();
+    const DirRecord* dirs = mapping->records<DirRecord>(header.dirsOffset);
+    const FileRecord* files = mapping->records<FileRecord>(header.filesOffset);
+
+    // 🎯 Which folders are in scope? Folders recorded under root itself are a quick number check;
+    // anything else (root is a subfolder, or roots nest) gets a path prefix comparison -
+    // once per folder, not per file
+    const std::string rootString = root.string();
+    std::uint32_t exactRoot = header.rootCount;
+    for (std::uint32_t r = 0; r < header.rootCount; ++r) {
+        if (indexedRoots[r].path == rootString) {
+            exactRoot = r;
+        }
+    }
+    std::vector<bool> inScope(header.dirCount);
+    for (std::uint64_t d = 0; d < header.dirCount; ++d) {
+        inScope[d] = dirs[d].rootIndex == exactRoot
+                     || isSameOrUnder(mapping->string(dirs[d].pathOffset, dirs[d].pathLength), rootString);
+    }
+
+    // 🔤 Let the trigram lists pick the candidates (folded grams when case doesn't matter -
+    // the query's literals are already lowercased then; a glob or regex offers the pieces it
+    // can't match without). No usable literal = check everything.
+    const TrigramIndexView& grams = query.isCaseInsensitive() ? mapping->foldedGrams : mapping->exactGrams;
+    std::vector<std::uint32_t> candidateIds;
+    const bool useGrams = grams.candidates(query.requiredLiterals(), candidateIds);
+    const std::uint64_t toCheck = useGrams ? candidateIds.size() : header.fileCount;
+
+    unsigned long long found = 0;
+    std::uint64_t scannedInBatch = 0;
+    std::string foundPath;
+    const MetadataFilter& metadata = query.metadata();
+    const bool checkMetadata = metadata.isActive();
+    std::uint64_t metadataStats = 0;
+    std::uint64_t metadataRejected = 0;
+    std::uint64_t statsSaved = 0;
+    std::uint64_t statNanos = 0;
+    // The scan loop gets compiled once per kind of query, with the name check inlined
+    query.dispatch([&](const auto& match) {
+        for (std::uint64_t i = 0; i < toCheck; ++i) {
+            const std::uint64_t f = useGrams ? candidateIds[i] : i;
+            if (f >= header.fileCount) {
+                break; // Only a damaged posting list could point past the table (IDs are sorted)
+            }
+            if (++scannedInBatch == kScanBatch) {
+                filesScannedCount += scannedInBatch;
+                scannedInBatch = 0;
+                if (cancellationFlag.load()) {
+                    break; // ⛔ Cancelled - stop scanning
+                }
+            }
+
+            const FileRecord& file = files[f];
+            if (!inScope[file.dirIndex]) {
+                continue;
+            }
+            std::string_view name = mapping->string(file.nameOffset, file.nameLength);
+            if (!match(name)) {
+                statsSaved += checkMetadata; // Same order as the walk: names first, stats only for the ones that pass
+                continue;
+            }
+            const DirRecord& dir = dirs[file.dirIndex];
+            std::string_view dirPath = mapping->string(dir.pathOffset, dir.pathLength);
+            if (isHidden && isHidden(dirPath, name)) {
+                continue;
+            }
+
+            // 🎉 A hit! Only now do we glue folder and name into a real path
+            foundPath.assign(dirPath.data(), dirPath.size());
+            if (!foundPath.empty() && foundPath.back() != '/' && foundPath.back() != '\\') {
+                foundPath.push_back(static_cast<char>(fs::path::preferred_separator));
+            }
+            foundPath.append(name.data(), name.size());
+            if (checkMetadata) {
+                // 🗃️ Sizes and times aren't in the index - ask the disk, for this one file
+                const std::uint64_t statStart = telemetryNow();
+                const bool passes = metadata.matchesPath(foundPath);
+                statNanos += telemetryNow() - statStart;
+                metadataStats++;
+                if (!passes) {
+                    metadataRejected++;
+                    continue;
+                }
+            }
+            found++;
+            reportResult(foundPath, "");
+        }
+    });
+    filesScannedCount += scannedInBatch;
+    if (telemetry && checkMetadata) {
+        telemetry->add(TelemetryCounter::MetadataStats, metadataStats);
+        telemetry->add(TelemetryCounter::MetadataRejected, metadataRejected);
+        telemetry->add(TelemetryCounter::MetadataStatsSaved, statsSaved);
+        telemetry->addNanos(TelemetryTimer::Stat, statNanos);
+    }
+    return found;
+}
+
+void FileIndex::forEachFile(const std::function<void(std::string_view, std::string_view)>& visit) const
+{
+    if (!mapping) {
+        return;
+    }
+    const IndexHeader& header = mapping->header();
+    const DirRecord* dirs = mapping->records<DirRecord>(header.dirsOffset);
+    const FileRecord* files = mapping->records<FileRecord>(header.filesOffset);
+    for (std::uint64_t f = 0; f < header.fileCount; ++f) {
+        const DirRecord& dir = dirs[files[f].dirIndex];
+        visit(mapping->string(dir.pathOffset, dir.pathLength), mapping->string(files[f].nameOffset, files[f].nameLength));
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef FILEINDEX_H
+#define FILEINDEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "searchlogic.h" // SearchConfig, SearchCallback, FileObserver
+#include "compiledquery.h"
+
+class ThreadTelemetry; // searchtelemetry.h
+
+// 🗂️ The Filename Index (locate-style) 🗂️
+// Walking the whole disk every time is slow, so we can remember what we saw instead.
+// The index is one compact file: a table of folders, a table of files (name + which folder),
+// and one big blob of name bytes. Queries memory-map it and scan the tables directly,
+// so answering "which files contain 'report'?" doesn't touch the disk tree at all.
+//
+// File layout (all integers in host byte order, every section 8-byte aligned):
+//   IndexHeader   magic "IYSINDEX", format version, section counts and offsets
+//   RootRecord[]  the roots it was built from + their mtimes (for the staleness check)
+//   DirRecord[]   one per folder: where its full path sits in the string blob
+//   FileRecord[]  one per regular file: name in the blob + index of its folder
+//   string blob   raw path/name bytes, no separators or terminators
+//   GramRecord[]  exact trigram table, then the case-folded one (see trigramindex.h)
+//   posting blob  delta-encoded file-ID lists both gram tables point into
+
+// Bump this whenever the on-disk layout changes - older files are refused, not misread
+constexpr std::uint32_t kFileIndexFormatVersion = 2;
+
+// One of the starting folders an index was built from
+struct IndexedRoot {
+    std::string path;
+    std::int64_t mtime = 0; // Folder mtime when we walked it (filesystem clock ticks)
+};
+
+// Numbers from an index build, for the status bar
+struct IndexBuildStats {
+    std::uint64_t fileCount = 0;
+    std::uint64_t dirCount = 0;
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t gramCount = 0;    // Exact + folded gram table rows
+    std::uint64_t trigramBytes = 0; // Gram tables + posting lists (already part of bytesWritten)
+    double trigramSeconds = 0.0;    // Time spent building the trigram lists
+    double buildSeconds = 0.0;      // Whole write(), trigrams included
+};
+
+// 🏗️ Collects every file a live walk meets and writes them out as an index.
+// Hook it into the walk as a FileObserver - each worker gets its own shard, so no locking.
+class FileIndexBuilder : public FileObserver
+{
+public:
+    explicit FileIndexBuilder(unsigned int workerCount);
+    ~FileIndexBuilder() override;
+
+    // Remember a root (and its current mtime) before walking it
+    void addRoot(const fs::path& root);
+
+    void onFile(unsigned int worker, std::string_view dirPath, std::string_view name) override;
+
+    // Writes the index to a temp file next to indexFile, then swaps it in.
+    // Returns false and fills errorMessage if the disk says no.
+    bool write(const std::string& indexFile, std::string& errorMessage, IndexBuildStats* stats = nullptr);
+
+private:
+    struct Shard; // Per-worker buckets of folders, files and name bytes
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<IndexedRoot> roots;
+};
+
+// 🔎 A read-only, memory-mapped index ready to answer queries
+class FileIndex
+{
+public:
+    FileIndex();
+    ~FileIndex();
+
+    FileIndex(const FileIndex&) = delete;
+    FileIndex& operator=(const FileIndex&) = delete;
+
+    // Maps the file and sanity-checks the header. Returns false + errorMessage if it's unusable.
+    bool open(const std::string& indexFile, std::string& errorMessage);
+    bool isOpen() const;
+
+    // Quick staleness check: has any root's mtime moved since the build?
+    // (Cheap by design - it only notices changes directly inside the roots.)
+    bool isStale(std::string& reason) const;
+
+    // Is this folder one of our roots, or somewhere underneath one?
+    bool covers(const fs::path& root) const;
+
+    const std::vector<IndexedRoot>& roots() const { return indexedRoots; }
+    std::uint64_t fileCount() const;
+    std::uint64_t dirCount() const;
+    std::int64_t builtAt() const; // Seconds since the epoch
+
+    // Reports every indexed file under root that the query accepts. The trigram lists pick
+    // the candidates when the term, extension or a glob/regex literal is 3+ bytes long; otherwise every file is checked.
+    // Counts checked entries just like a live walk counts scanned ones. Returns how many matched.
+    // isHidden (optional) gets the last word on each match - the live watcher uses it to drop
+    // files that have been deleted since the index was written.
+    // The index keeps names only, so metadata predicates (query.metadata()) stat each name match
+    // on the live disk; telemetry (optional) gets those stats counted like a walk would.
+    unsigned long long search(const fs::path& root,
+                              const CompiledQuery& query,
+                              const SearchCallback& reportResult,
+                              std::atomic<bool>& cancellationFlag,
+                              std::atomic<std::uint64_t>& filesScannedCount,
+                              const std::function<bool(std::string_view dirPath, std::string_view name)>& isHidden = {},
+                              ThreadTelemetry* telemetry = nullptr) const;
+
+    // Hands every indexed file to visit(), folder by folder (used to rewrite an index without a walk)
+    void forEachFile(const std::function<void(std::string_view dirPath, std::string_view name)>& visit) const;
+
+private:
+    struct Mapping; // Platform-specific mmap bits
+    std::unique_ptr<Mapping> mapping;
+    std::vector<IndexedRoot> indexedRoots;
+};
+
+#endif // FILEINDEX_H
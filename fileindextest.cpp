@@ -0,0 +1,177 @@
+// 🧪 FileIndex::open() against damaged index files
+// Builds a small index, then breaks one copy of it per case - a header count, a section offset,
+// one record's string or folder number - and checks that open() turns each one down with the
+// usual "please rebuild it" message instead of reading off the end of the mapping later.
+// The untouched copy has to open and answer a query, so the cases can't pass by accident.
+//
+//   iys-index-test            (or ctest, which runs the same thing)
+
+#include "compiledquery.h"
+#include "fileindex.h"
+#include "searchlogic.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Where things sit in the file (see IndexHeader and the record structs in fileindex.cpp)
+constexpr std::size_t kDirCountAt = 16;
+constexpr std::size_t kRootsOffsetAt = 32;
+constexpr std::size_t kDirsOffsetAt = 40;
+constexpr std::size_t kFilesOffsetAt = 48;
+constexpr std::size_t kRootPathLengthAt = 16; // Inside a RootRecord
+constexpr std::size_t kDirPathOffsetAt = 0;   // Inside a DirRecord
+constexpr std::size_t kFileDirIndexAt = 8;    // Inside a FileRecord
+constexpr std::size_t kFileNameLengthAt = 12;
+
+int failures = 0;
+
+template <typename T>
+T readAt(const std::string& bytes, std::size_t at)
+{
+    T value;
+    std::memcpy(&value, bytes.data() + at, sizeof(value));
+    return value;
+}
+
+template <typename T>
+void writeAt(std::string& bytes, std::size_t at, T value)
+{
+    std::memcpy(&bytes[at], &value, sizeof(value));
+}
+
+bool saveFile(const fs::path& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+// How many matches the index gives for term under root (or -1 when it won't open)
+long long queryCount(const fs::path& indexFile, const fs::path& root, const std::string& term)
+{
+    FileIndex index;
+    std::string problem;
+    if (!index.open(indexFile.string(), problem)) {
+        return -1;
+    }
+    SearchConfig config;
+    config.searchTerm = term;
+    const CompiledQuery query(config);
+    std::atomic<bool> cancelled{false};
+    std::atomic<std::uint64_t> scanned{0};
+    const SearchCallback ignore = [](const std::string&, const std::string&) {};
+    return static_cast<long long>(index.search(root, query, ignore, cancelled, scanned));
+}
+
+void expectRefused(const char* what, const fs::path& indexFile, const std::string& original,
+                   const std::function<void(std::string&)>& damage)
+{
+    std::string bytes = original;
+    damage(bytes);
+    if (!saveFile(indexFile, bytes)) {
+        std::fprintf(stderr, "FAIL %s: couldn't write %s\n", what, indexFile.string().c_str());
+        ++failures;
+        return;
+    }
+    FileIndex index;
+    std::string problem;
+    if (index.open(indexFile.string(), problem)) {
+        std::fprintf(stderr, "FAIL %s: the damaged index opened\n", what);
+        ++failures;
+    } else if (problem.find("damaged") == std::string::npos) {
+        std::fprintf(stderr, "FAIL %s: refused, but with \"%s\"\n", what, problem.c_str());
+        ++failures;
+    } else {
+        std::fprintf(stderr, "ok   %s\n", what);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    // 🌱 A root with two folders and a few files - the builder never looks at the disk for those
+    const fs::path dir = fs::temp_directory_path() / "iys-index-test";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "tree", ec);
+    if (ec) {
+        std::fprintf(stderr, "can't make %s: %s\n", dir.string().c_str(), ec.message().c_str());
+        return 1;
+    }
+    const fs::path root = dir / "tree";
+    const std::string rootString = root.string();
+    const fs::path indexFile = dir / "test.iys";
+
+    FileIndexBuilder builder(1);
+    builder.addRoot(root);
+    builder.onFile(0, rootString, "report.txt");
+    builder.onFile(0, rootString, "notes.md");
+    builder.onFile(0, (root / "sub").string(), "report-old.txt");
+    std::string problem;
+    if (!builder.write(indexFile.string(), problem)) {
+        std::fprintf(stderr, "can't write the index: %s\n", problem.c_str());
+        return 1;
+    }
+    std::ifstream in(indexFile, std::ios::binary);
+    const std::string original((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    const long long found = queryCount(indexFile, root, "report");
+    if (found != 2) {
+        std::fprintf(stderr, "FAIL the intact index: %lld match(es) for \"report\", expected 2\n", found);
+        ++failures;
+    } else {
+        std::fprintf(stderr, "ok   the intact index opens and finds both reports\n");
+    }
+
+    const auto dirsAt = readAt<std::uint64_t>(original, kDirsOffsetAt);
+    const auto filesAt = readAt<std::uint64_t>(original, kFilesOffsetAt);
+    const auto rootsAt = readAt<std::uint64_t>(original, kRootsOffsetAt);
+
+    // 📐 The header
+    expectRefused("dirCount big enough to wrap around", indexFile, original, [](std::string& bytes) {
+        writeAt<std::uint64_t>(bytes, kDirCountAt, std::uint64_t(1) << 60);
+    });
+    expectRefused("dirCount past the files section", indexFile, original, [](std::string& bytes) {
+        writeAt<std::uint64_t>(bytes, kDirCountAt, readAt<std::uint64_t>(bytes, kDirCountAt) + 1000);
+    });
+    expectRefused("roots section inside the header", indexFile, original, [](std::string& bytes) {
+        writeAt<std::uint64_t>(bytes, kRootsOffsetAt, 0);
+    });
+    expectRefused("misaligned files section", indexFile, original, [](std::string& bytes) {
+        writeAt<std::uint64_t>(bytes, kFilesOffsetAt, readAt<std::uint64_t>(bytes, kFilesOffsetAt) + 4);
+    });
+    expectRefused("truncated file", indexFile, original.substr(0, static_cast<std::size_t>(filesAt)), [](std::string&) {});
+
+    // 🧾 One record
+    expectRefused("root path running off the strings", indexFile, original, [&](std::string& bytes) {
+        writeAt<std::uint32_t>(bytes, static_cast<std::size_t>(rootsAt) + kRootPathLengthAt, 0xffffffffu);
+    });
+    expectRefused("folder path starting past the strings", indexFile, original, [&](std::string& bytes) {
+        writeAt<std::uint64_t>(bytes, static_cast<std::size_t>(dirsAt) + kDirPathOffsetAt, std::uint64_t(1) << 40);
+    });
+    expectRefused("file name running off the strings", indexFile, original, [&](std::string& bytes) {
+        writeAt<std::uint32_t>(bytes, static_cast<std::size_t>(filesAt) + kFileNameLengthAt, 0x7fffffffu);
+    });
+    expectRefused("file in a folder that isn't there", indexFile, original, [&](std::string& bytes) {
+        writeAt<std::uint32_t>(bytes, static_cast<std::size_t>(filesAt) + kFileDirIndexAt, 1000);
+    });
+
+    fs::remove_all(dir, ec);
+    if (failures != 0) {
+        std::fprintf(stderr, "%d case(s) failed\n", failures);
+        return 1;
+    }
+    std::fprintf(stderr, "All damaged indexes were turned down\n");
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include "fuzzymatch.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "simdmatch.h" // SimdMatch::foldAscii
+
+namespace {
+
+// 🎯 The points (same spirit as fzf's: a match is worth a lot more than a gap costs)
+constexpr int kScoreMatch = 16;
+constexpr int kPenaltyGapStart = -3;
+constexpr int kPenaltyGapExtension = -1;
+constexpr int kBonusNameStart = 10;   // The very first character of the name
+constexpr int kBonusBoundary = 8;     // A word start: after a space, _ - . and friends
+constexpr int kBonusNonWord = 8;      // Typing the punctuation itself is deliberate, too
+constexpr int kBonusCamel = 7;        // fooBar, file2
+constexpr int kBonusConsecutive = 4;  // Keeps a run going (at least)
+constexpr int kFirstCharMultiplier = 2;
+constexpr int kPenaltyPerFolder = 1;  // Path proximity: one point per level down
+
+enum class CharClass { NonWord, Delimiter, Lower, Upper, Number };
+
+CharClass classOf(char c)
+{
+    if (c >= 'a' && c <= 'z') return CharClass::Lower;
+    if (c >= 'A' && c <= 'Z') return CharClass::Upper;
+    if (c >= '0' && c <= '9') return CharClass::Number;
+    if (static_cast<unsigned char>(c) >= 0x80) return CharClass::Lower; // Letters from other scripts act like words
+    if (c == ' ' || c == '_' || c == '-' || c == '.' || c == ',' || c == ':' || c == ';' || c == '/' || c == '\\') {
+        return CharClass::Delimiter;
+    }
+    return CharClass::NonWord;
+}
+
+bool isWord(CharClass c)
+{
+    return c != CharClass::NonWord && c != CharClass::Delimiter;
+}
+
+// What matching a character of class current right after one of class previous is worth
+int bonusFor(CharClass previous, CharClass current)
+{
+    if (isWord(current)) {
+        if (!isWord(previous)) return kBonusBoundary;
+        if (previous == CharClass::Lower && current == CharClass::Upper) return kBonusCamel;
+        if (previous != CharClass::Number && current == CharClass::Number) return kBonusCamel;
+        return 0;
+    }
+    return kBonusNonWord;
+}
+
+bool isSeparator(char c)
+{
+#ifdef _WIN32
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+}
+
+} // namespace
+
+FuzzyMatcher::FuzzyMatcher(std::string_view pattern, bool caseInsensitive)
+    : patternBytes(caseInsensitive ? SimdMatch::foldAscii(pattern) : std::string(pattern))
+    , caseInsensitive(caseInsensitive)
+{
+    // One bit per pattern position, set in the masks of the bytes that can fill it
+    const std::size_t bits = std::min(patternBytes.size(), kBitParallelMax);
+    for (std::size_t i = 0; i < bits; ++i) {
+        const unsigned char c = static_cast<unsigned char>(patternBytes[i]);
+        masks[c] |= std::uint64_t(1) << i;
+        if (caseInsensitive && c >= 'a' && c <= 'z') {
+            masks[c - 32] |= std::uint64_t(1) << i;
+        }
+    }
+    lastBit = bits == 0 ? 0 : std::uint64_t(1) << (bits - 1);
+}
+
+std::size_t FuzzyMatcher::matchEnd(std::string_view name) const
+{
+    if (patternBytes.size() <= kBitParallelMax) {
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < name.size(); ++i) {
+            seen |= ((seen << 1) | 1) & masks[static_cast<unsigned char>(name[i])];
+            if (seen & lastBit) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+    std::size_t p = 0;
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        const char c = caseInsensitive ? SimdMatch::foldAscii(name[i]) : name[i];
+        if (c == patternBytes[p] && ++p == patternBytes.size()) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+int FuzzyMatcher::scoreName(std::string_view name) const
+{
+    if (patternBytes.empty()) {
+        return 0;
+    }
+    const std::size_t end = matchEnd(name);
+    if (end == 0) {
+        return INT_MIN;
+    }
+    auto at = [&](std::size_t i) { return caseInsensitive ? SimdMatch::foldAscii(name[i]) : name[i]; };
+
+    // ⬅️ Walk back from where the first match ends, to find the tightest window holding it
+    std::size_t start = 0;
+    std::size_t p = patternBytes.size();
+    for (std::size_t i = end; i-- > 0;) {
+        if (at(i) == patternBytes[p - 1] && --p == 0) {
+            start = i;
+            break;
+        }
+    }
+
+    // ➡️ Score that window, character by character
+    int total = 0;
+    int firstBonus = 0;   // Bonus of the character that started the current run
+    std::size_t run = 0;  // Length of the current run of consecutive matches
+    bool inGap = false;
+    CharClass previous = start == 0 ? CharClass::Delimiter : classOf(name[start - 1]);
+    p = 0;
+    for (std::size_t i = start; i < end; ++i) {
+        const CharClass current = classOf(name[i]);
+        if (p < patternBytes.size() && at(i) == patternBytes[p]) {
+            int bonus = i == 0 ? kBonusNameStart : bonusFor(previous, current);
+            if (run == 0) {
+                firstBonus = bonus;
+            } else {
+                if (bonus >= kBonusBoundary && bonus > firstBonus) {
+                    firstBonus = bonus; // A new word inside the run takes over
+                }
+                bonus = std::max({bonus, firstBonus, kBonusConsecutive});
+            }
+            total += kScoreMatch + (p == 0 ? bonus * kFirstCharMultiplier : bonus);
+            ++run;
+            ++p;
+            inGap = false;
+        } else {
+            total += inGap ? kPenaltyGapExtension : kPenaltyGapStart;
+            inGap = true;
+            run = 0;
+            firstBonus = 0;
+        }
+        previous = current;
+    }
+    return total;
+}
+
+int FuzzyMatcher::score(std::string_view path) const
+{
+    std::size_t nameStart = path.size();
+    while (nameStart > 0 && !isSeparator(path[nameStart - 1])) {
+        --nameStart;
+    }
+    const int nameScore = scoreName(path.substr(nameStart));
+    if (nameScore == INT_MIN) {
+        return INT_MIN;
+    }
+    // 📍 Path proximity: every folder level costs a point, so of two equally good names the nearer one wins
+    int folders = 0;
+    for (std::size_t i = 0; i < nameStart; ++i) {
+        folders += isSeparator(path[i]) ? 1 : 0;
+    }
+    return nameScore - kPenaltyPerFolder * folders;
+}
+
+// --- FuzzyRanking ---
+
+FuzzyRanking::FuzzyRanking(FuzzyMatcher matcher, std::size_t capacity)
+    : matcher(std::move(matcher))
+    , limit(std::max<std::size_t>(1, capacity))
+{
+    heap.reserve(limit);
+}
+
+// Higher score first; then the shorter path; then plain byte order, so the ranking never depends on timing
+bool FuzzyRanking::better(const FuzzyHit& a, const FuzzyHit& b)
+{
+    if (a.score != b.score) return a.score > b.score;
+    if (a.path.size() != b.path.size()) return a.path.size() < b.path.size();
+    return a.path < b.path;
+}
+
+bool FuzzyRanking::offer(std::string_view path)
+{
+    offers.fetch_add(1, std::memory_order_relaxed);
+    const int score = matcher.score(path);
+    if (score == INT_MIN || score < entryBar.load(std::memory_order_relaxed)) {
+        return false; // Can't beat the worst of the best - no need for the lock
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (heap.size() < limit) {
+        heap.push_back(FuzzyHit{std::string(path), score});
+        std::push_heap(heap.begin(), heap.end(), better);
+    } else {
+        FuzzyHit candidate{std::string(path), score};
+        if (!better(candidate, heap.front())) {
+            return false;
+        }
+        std::pop_heap(heap.begin(), heap.end(), better); // The worst goes to the back...
+        heap.back() = std::move(candidate);              // ...and makes room
+        std::push_heap(heap.begin(), heap.end(), better);
+    }
+    if (heap.size() == limit) {
+        entryBar.store(heap.front().score, std::memory_order_relaxed);
+    }
+    version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+std::vector<FuzzyHit> FuzzyRanking::ranked() const
+{
+    std::vector<FuzzyHit> copy;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        copy = heap;
+    }
+    std::sort(copy.begin(), copy.end(), better);
+    return copy;
+}
+
+std::size_t FuzzyRanking::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return heap.size();
+}
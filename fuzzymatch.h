@@ -0,0 +1,113 @@
+#ifndef FUZZYMATCH_H
+#define FUZZYMATCH_H
+
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 🧶 Fuzzy Filename Search 🧶
+// For when you only half remember the name: "mwcpp" finds mainwindow.cpp, "repq3" finds
+// report_Q3_final.xlsx. The letters have to show up in order, but anything can sit between
+// them - and then the names get RANKED, so the one you meant comes out on top.
+//
+// Two steps, like fzf:
+//   matches(name) - the hot path, run on every name: is the pattern a subsequence of it?
+//                   Bit-parallel (bitap style): bit i of one 64-bit word says "the first i+1
+//                   pattern characters have been seen", and each byte of the name updates
+//                   all of them at once with a shift, an AND and an OR.
+//   score(path)   - only for names that passed: how GOOD a match is it? Every matched
+//                   character earns points, more when it starts a word (after _ - . or a
+//                   space, or a lowercase-to-Uppercase step) or continues a run, and gaps
+//                   cost a little. Shallower paths win ties - the closer to where you
+//                   started looking, the likelier it's the one.
+//
+// FuzzyRanking then keeps only the best K, in a bounded heap: constant memory no matter how
+// many millions of names match a two-letter pattern, and a snapshot of the current leaders
+// can go to the results view at any time while the walk goes on.
+
+class FuzzyMatcher
+{
+public:
+    FuzzyMatcher() = default; // Empty pattern: everything matches, with score 0
+    FuzzyMatcher(std::string_view pattern, bool caseInsensitive);
+
+    // 🔥 The hot path - called once per scanned name
+    bool matches(std::string_view name) const
+    {
+        if (patternBytes.empty()) {
+            return true;
+        }
+        if (patternBytes.size() > kBitParallelMax) {
+            return matchEnd(name) != 0;
+        }
+        std::uint64_t seen = 0; // Bit i: pattern[0..i] is a subsequence of what we've read so far
+        for (const char c : name) {
+            seen |= ((seen << 1) | 1) & masks[static_cast<unsigned char>(c)];
+        }
+        return (seen & lastBit) != 0;
+    }
+
+    // How good a match is this file? Higher is better. For paths whose name passed matches().
+    int score(std::string_view path) const;
+
+    // The same, for just the name - no path proximity
+    int scoreName(std::string_view name) const;
+
+    const std::string& pattern() const { return patternBytes; }
+
+private:
+    static constexpr std::size_t kBitParallelMax = 64; // Longer patterns take the one-byte-at-a-time road
+
+    std::size_t matchEnd(std::string_view name) const; // Just past where the first complete match ends, 0 = none
+
+    std::string patternBytes; // Folded when caseInsensitive
+    bool caseInsensitive = false;
+    std::array<std::uint64_t, 256> masks{}; // Per byte: which pattern positions it can fill
+    std::uint64_t lastBit = 0;
+};
+
+// One ranked result
+struct FuzzyHit {
+    std::string path;
+    int score = 0;
+};
+
+// 🏆 The best K matches so far. Thread-safe: the walk offers, anyone can take a snapshot.
+class FuzzyRanking
+{
+public:
+    FuzzyRanking(FuzzyMatcher matcher, std::size_t capacity);
+
+    FuzzyRanking(const FuzzyRanking&) = delete;
+    FuzzyRanking& operator=(const FuzzyRanking&) = delete;
+
+    // Scores the path and keeps it if it's among the best K. True if it made the list.
+    bool offer(std::string_view path);
+
+    std::vector<FuzzyHit> ranked() const; // Best first
+
+    std::uint64_t offered() const { return offers.load(std::memory_order_relaxed); } // Every fuzzy match seen
+    std::uint64_t changes() const { return version.load(std::memory_order_acquire); } // Bumps whenever the list changes
+    std::size_t capacity() const { return limit; }
+    std::size_t size() const;
+
+private:
+    static bool better(const FuzzyHit& a, const FuzzyHit& b);
+
+    const FuzzyMatcher matcher;
+    const std::size_t limit;
+
+    mutable std::mutex mutex;
+    std::vector<FuzzyHit> heap;          // Worst of the best at the front
+    std::atomic<int> entryBar{INT_MIN};  // Below this score there's no way in (checked without the lock)
+    std::atomic<std::uint64_t> offers{0};
+    std::atomic<std::uint64_t> version{0};
+};
+
+#endif // FUZZYMATCH_H
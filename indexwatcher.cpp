@@ -0,0 +1,689 @@
+#include "indexwatcher.h"
+#include "fileindex.h"
+#include "searchtelemetry.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <system_error>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// ⏱️ Batching knobs: a batch is applied once events stop for kQuietPeriod,
+// or once it's kMaxBatchAge old / kMaxBatchSize big even if the storm keeps going
+constexpr auto kQuietPeriod = std::chrono::milliseconds(150);
+constexpr auto kMaxBatchAge = std::chrono::milliseconds(1000);
+constexpr std::size_t kMaxBatchSize = 65536;
+
+// Once this many changes pile up over the index file, they get merged into it
+constexpr std::uint64_t kMergeThreshold = 50000;
+
+constexpr std::size_t kEventBufferSize = 256 * 1024;
+
+#ifdef __linux__
+constexpr std::uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                     | IN_DELETE_SELF | IN_MOVE_SELF
+                                     | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+#endif
+
+// Glues folder + name the same way the index does when it reports a hit
+std::string joinPath(std::string_view dir, std::string_view name)
+{
+    std::string path(dir);
+    if (!path.empty() && path.back() != '/' && path.back() != '\\') {
+        path.push_back(static_cast<char>(fs::path::preferred_separator));
+    }
+    path.append(name.data(), name.size());
+    return path;
+}
+
+// "/a/b/c" -> "/a/b", "/a" -> "/", "a" -> ""
+std::string_view parentOf(std::string_view path)
+{
+    const std::size_t slash = path.find_last_of("/\\");
+    if (slash == std::string_view::npos) {
+        return std::string_view();
+    }
+    return path.substr(0, slash == 0 ? 1 : slash);
+}
+
+bool isSameOrUnder(std::string_view path, std::string_view root)
+{
+    if (path.size() < root.size() || path.compare(0, root.size(), root) != 0) {
+        return false;
+    }
+    if (path.size() == root.size() || root.empty()) {
+        return true;
+    }
+    const char last = root.back();
+    const char next = path[root.size()];
+    return last == '/' || last == '\\' || next == '/' || next == '\\';
+}
+
+// Sorts one folder's entries into subfolders and files
+class TreeCollector : public DirEntryVisitor
+{
+public:
+    std::vector<std::string> dirs;
+    std::vector<std::string> files;
+
+    bool visit(const DirEntryView& entry) override
+    {
+        if (entry.type == EntryType::Directory) {
+            dirs.emplace_back(entry.nameView());
+        } else if (entry.type == EntryType::RegularFile) {
+            files.emplace_back(entry.nameView());
+        }
+        return true;
+    }
+
+    void entryError(std::string_view, const std::string&) override {}
+};
+
+} // namespace
+
+IndexWatcher::IndexWatcher(const std::string& indexFile, const SearchConfig& walkConfig)
+    : indexPath(indexFile), config(walkConfig)
+{
+}
+
+IndexWatcher::~IndexWatcher()
+{
+    stop();
+}
+
+bool IndexWatcher::start(std::string& errorMessage)
+{
+#ifndef __linux__
+    errorMessage = "keeping the index live needs inotify, which only Linux has";
+    return false;
+#else
+    if (running.load()) {
+        return true;
+    }
+
+    auto opened = std::make_shared<FileIndex>();
+    if (!opened->open(indexPath, errorMessage)) {
+        return false;
+    }
+
+    inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        errorMessage = std::string("can't start inotify - ") + std::strerror(errno);
+        return false;
+    }
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        errorMessage = std::string("can't create the wake-up eventfd - ") + std::strerror(errno);
+        ::close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    // Anything that changed between the build and now is invisible to the watches,
+    // so an index that already looks stale gets a full resync right away
+    std::string staleReason;
+    const bool resyncFirst = opened->isStale(staleReason);
+
+    index = opened;
+    rootPaths.clear();
+    for (const auto& root : opened->roots()) {
+        rootPaths.push_back(root.path);
+    }
+    lastResync = std::chrono::system_clock::from_time_t(static_cast<std::time_t>(opened->builtAt()));
+    tally = IndexWatcherStats();
+    tally.running = true;
+    publish();
+
+    eventBuffer.resize(kEventBufferSize);
+    stopRequested.store(false);
+    mergeOnStop.store(true);
+    running.store(true);
+    thread = std::thread([this, resyncFirst] { run(resyncFirst); });
+    return true;
+#endif
+}
+
+void IndexWatcher::stop(bool mergeChanges)
+{
+    if (!thread.joinable()) {
+        return;
+    }
+    mergeOnStop.store(mergeChanges);
+    stopRequested.store(true);
+#ifdef __linux__
+    const std::uint64_t one = 1;
+    [[maybe_unused]] ssize_t poked = ::write(wakeFd, &one, sizeof(one));
+#endif
+    thread.join();
+#ifdef __linux__
+    ::close(inotifyFd);
+    ::close(wakeFd);
+#endif
+    inotifyFd = -1;
+    wakeFd = -1;
+}
+
+IndexWatcherStats IndexWatcher::stats() const
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    IndexWatcherStats snapshot = published;
+    snapshot.secondsSinceResync =
+        std::chrono::duration<double>(std::chrono::system_clock::now() - publishedResync).count();
+    return snapshot;
+}
+
+void IndexWatcher::publish()
+{
+    tally.watchedDirs = watchToDir.size();
+    tally.queueDepth = pending.size();
+    if (tally.queueDepth > tally.queueHighWater) {
+        tally.queueHighWater = tally.queueDepth;
+    }
+    tally.pendingChanges = overlaySize;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    published = tally;
+    publishedResync = lastResync;
+}
+
+// --- Answering queries ---
+
+bool IndexWatcher::covers(const fs::path& root) const
+{
+    std::shared_lock<std::shared_mutex> lock(overlayMutex);
+    return index && index->covers(root);
+}
+
+std::uint64_t IndexWatcher::fileCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(overlayMutex);
+    return index ? index->fileCount() : 0;
+}
+
+bool IndexWatcher::isHidden(std::string_view dirPath, std::string_view name) const
+{
+    const auto added = addedFiles.find(std::string(dirPath));
+    if (added != addedFiles.end() && added->second.count(std::string(name))) {
+        return true; // Reported from the change list instead, so it isn't listed twice
+    }
+    if (!removedFiles.empty() && removedFiles.count(joinPath(dirPath, name))) {
+        return true;
+    }
+    if (!removedDirs.empty()) {
+        for (std::string_view dir = dirPath; !dir.empty(); ) {
+            if (removedDirs.count(std::string(dir))) {
+                return true;
+            }
+            const std::string_view parent = parentOf(dir);
+            if (parent == dir) {
+                break;
+            }
+            dir = parent;
+        }
+    }
+    return false;
+}
+
+unsigned long long IndexWatcher::search(const fs::path& root,
+                                        const CompiledQuery& query,
+                                        const SearchCallback& reportResult,
+                                        std::atomic<bool>& cancellationFlag,
+                                        std::atomic<std::uint64_t>& filesScannedCount,
+                                        ThreadTelemetry* telemetry) const
+{
+    // Readers share the lock; the watcher thread only needs it exclusively to apply a batch
+    std::shared_lock<std::shared_mutex> lock(overlayMutex);
+    if (!index) {
+        return 0;
+    }
+
+    // 1️⃣ The index file, minus whatever was deleted or moved away since
+    unsigned long long found = index->search(root, query, reportResult, cancellationFlag, filesScannedCount,
+                                             [this](std::string_view dirPath, std::string_view name) {
+                                                 return isHidden(dirPath, name);
+                                             }, telemetry);
+
+    // 2️⃣ Plus the files that only the change list knows about
+    const std::string rootString = root.string();
+    for (const auto& folder : addedFiles) {
+        if (cancellationFlag.load()) {
+            break;
+        }
+        if (!isSameOrUnder(folder.first, rootString)) {
+            continue;
+        }
+        filesScannedCount += folder.second.size();
+        const MetadataFilter& metadata = query.metadata();
+        query.dispatch([&](const auto& match) {
+            for (const auto& name : folder.second) {
+                if (!match(name)) {
+                    continue;
+                }
+                std::string foundPath = joinPath(folder.first, name);
+                if (metadata.isActive()) {
+                    // A handful of fresh files at most - stat them just like the index part does
+                    if (telemetry) {
+                        telemetry->add(TelemetryCounter::MetadataStats);
+                    }
+                    if (!metadata.matchesPath(foundPath)) {
+                        if (telemetry) {
+                            telemetry->add(TelemetryCounter::MetadataRejected);
+                        }
+                        continue;
+                    }
+                }
+                found++;
+                reportResult(foundPath, "");
+            }
+        });
+    }
+    return found;
+}
+
+// --- The watcher thread ---
+
+void IndexWatcher::run(bool resyncFirst)
+{
+#ifdef __linux__
+    enumerator = makeDirectoryEnumerator(config.enumerationBackend);
+
+    if (resyncFirst) {
+        resync();
+    } else {
+        for (const auto& root : rootPaths) {
+            watchTree(root, nullptr);
+        }
+    }
+    publish();
+
+    while (!stopRequested.load()) {
+        // Sleep until something happens - or until the pending batch is due
+        int timeoutMs = -1;
+        if (!pending.empty()) {
+            const auto due = std::min(lastEvent + kQuietPeriod, batchStarted + kMaxBatchAge);
+            const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+            timeoutMs = wait.count() > 0 ? static_cast<int>(wait.count()) : 0;
+        }
+
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+        if (::poll(fds, 2, timeoutMs) < 0 && errno != EINTR) {
+            tally.lastError = std::string("poll failed - ") + std::strerror(errno);
+            break;
+        }
+        if (stopRequested.load()) {
+            break;
+        }
+
+        bool needResync = false;
+        if (fds[0].revents & POLLIN) {
+            readEvents(needResync);
+        }
+        if (needResync) {
+            resync();
+            publish();
+            continue;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!pending.empty()
+            && (now - lastEvent >= kQuietPeriod || now - batchStarted >= kMaxBatchAge || pending.size() >= kMaxBatchSize)) {
+            applyBatch();
+            if (overlaySize >= kMergeThreshold) {
+                std::string problem;
+                if (!mergeIntoIndex(problem)) {
+                    tally.lastError = problem;
+                }
+            }
+        }
+        publish();
+    }
+
+    // 🏁 On the way out: fold in what we already know so the file on disk is as fresh as it gets
+    if (mergeOnStop.load()) {
+        if (!pending.empty()) {
+            applyBatch();
+        }
+        std::string problem;
+        if (overlaySize > 0 && !mergeIntoIndex(problem)) {
+            tally.lastError = problem;
+        }
+    }
+    unwatchAll();
+    tally.running = false;
+    running.store(false);
+    publish();
+#else
+    (void)resyncFirst;
+#endif
+}
+
+void IndexWatcher::readEvents(bool& needResync)
+{
+#ifdef __linux__
+    const ssize_t length = ::read(inotifyFd, eventBuffer.data(), eventBuffer.size());
+    if (length <= 0) {
+        return; // EAGAIN - someone else's wake-up
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    for (const char* p = eventBuffer.data(); p < eventBuffer.data() + length; ) {
+        const auto* event = reinterpret_cast<const inotify_event*>(p);
+        p += sizeof(inotify_event) + event->len;
+        tally.eventsSeen++;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            tally.overflows++; // The kernel threw events away - only a full walk can tell what we missed
+            needResync = true;
+            continue;
+        }
+
+        const auto watched = watchToDir.find(event->wd);
+        if (event->mask & IN_IGNORED) {
+            if (watched != watchToDir.end()) {
+                dirToWatch.erase(watched->second);
+                watchToDir.erase(watched);
+            }
+            continue;
+        }
+        if (watched == watchToDir.end()) {
+            tally.droppedEvents++;
+            continue;
+        }
+
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+            // Subfolders are handled through their parent's events; a root has no watched parent
+            for (const auto& root : rootPaths) {
+                if (root == watched->second) {
+                    tally.lastError = root + " was moved or deleted";
+                    needResync = true;
+                }
+            }
+            continue;
+        }
+        if (event->len == 0) {
+            continue;
+        }
+
+        const bool isDir = event->mask & IN_ISDIR;
+        Change change;
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+            change = isDir ? Change::DirAdded : Change::FileAdded;
+        } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+            change = isDir ? Change::DirRemoved : Change::FileRemoved;
+        } else {
+            continue;
+        }
+
+        // 🌪️ Coalescing: the newest event for a path replaces whatever was queued for it
+        if (pending.empty()) {
+            batchStarted = now;
+        }
+        auto slot = pending.try_emplace(joinPath(watched->second, event->name), change);
+        if (!slot.second) {
+            slot.first->second = change;
+            tally.eventsCoalesced++;
+        }
+        lastEvent = now;
+    }
+    if (pending.size() > tally.queueHighWater) {
+        tally.queueHighWater = pending.size();
+    }
+#else
+    (void)needResync;
+#endif
+}
+
+void IndexWatcher::applyBatch()
+{
+    // 1️⃣ Look at the disk first, without holding up any queries. Events only say something
+    // happened; what's there NOW is what counts (a file created and renamed away in the same
+    // batch shows up as an add of a file that no longer exists).
+    struct Resolved {
+        std::string path;
+        Change change;
+        std::vector<std::string> files; // DirAdded: everything found under it
+    };
+    std::vector<Resolved> resolved;
+    resolved.reserve(pending.size());
+    for (auto& entry : pending) {
+        Resolved item{entry.first, entry.second, {}};
+        if (item.change == Change::FileAdded) {
+            std::error_code ec;
+            if (!fs::is_regular_file(item.path, ec)) {
+                continue; // Gone already, or not a file after all (fifo, link to a folder...)
+            }
+        } else if (item.change == Change::DirAdded) {
+            watchTree(item.path, &item.files); // Watch it first, then list it, so nothing slips between
+        } else if (item.change == Change::DirRemoved) {
+            unwatchTree(item.path);
+        }
+        resolved.push_back(std::move(item));
+    }
+    pending.clear();
+
+    // 2️⃣ Now fold it all into the change list - removals, then new folders, then new files
+    std::unique_lock<std::shared_mutex> lock(overlayMutex);
+    for (const auto& item : resolved) {
+        if (item.change == Change::FileRemoved) {
+            const std::string dir(parentOf(item.path));
+            auto folder = addedFiles.find(dir);
+            if (folder != addedFiles.end()) {
+                folder->second.erase(item.path.substr(item.path.find_last_of("/\\") + 1));
+            }
+            removedFiles.insert(item.path);
+        } else if (item.change == Change::DirRemoved) {
+            removedDirs.insert(item.path);
+            for (auto folder = addedFiles.begin(); folder != addedFiles.end(); ) {
+                folder = isSameOrUnder(folder->first, item.path) ? addedFiles.erase(folder) : std::next(folder);
+            }
+        }
+    }
+    for (const auto& item : resolved) {
+        if (item.change == Change::DirAdded) {
+            // Whatever we knew under this name is history (it may be a different folder
+            // by now - "mv a b && mkdir a" coalesces to one add); the listing is the truth
+            removedDirs.insert(item.path);
+            for (auto folder = addedFiles.begin(); folder != addedFiles.end(); ) {
+                folder = isSameOrUnder(folder->first, item.path) ? addedFiles.erase(folder) : std::next(folder);
+            }
+            for (const auto& file : item.files) {
+                const std::size_t slash = file.find_last_of("/\\");
+                addedFiles[std::string(parentOf(file))].insert(file.substr(slash + 1));
+            }
+        }
+    }
+    for (const auto& item : resolved) {
+        if (item.change == Change::FileAdded) {
+            removedFiles.erase(item.path);
+            const std::size_t slash = item.path.find_last_of("/\\");
+            addedFiles[std::string(parentOf(item.path))].insert(item.path.substr(slash + 1));
+        }
+    }
+
+    overlaySize = removedFiles.size() + removedDirs.size();
+    for (const auto& folder : addedFiles) {
+        overlaySize += folder.second.size();
+    }
+    tally.batchesApplied++;
+}
+
+void IndexWatcher::watchTree(const std::string& dir, std::vector<std::string>* filesFound)
+{
+#ifdef __linux__
+    std::vector<std::string> stack{dir};
+    std::string problem;
+    while (!stack.empty() && !stopRequested.load()) {
+        std::string current = std::move(stack.back());
+        stack.pop_back();
+
+        const int wd = ::inotify_add_watch(inotifyFd, current.c_str(), kWatchMask);
+        if (wd < 0) {
+            tally.watchFailures++;
+            if (errno == ENOSPC) {
+                tally.lastError = "out of inotify watches - raise fs.inotify.max_user_watches";
+            }
+        } else {
+            // The same folder under a new name (moved) keeps its watch number - forget the old name
+            auto previous = watchToDir.find(wd);
+            if (previous != watchToDir.end()) {
+                dirToWatch.erase(previous->second);
+            }
+            watchToDir[wd] = current;
+            dirToWatch[current] = wd;
+        }
+
+        TreeCollector entries;
+        if (!enumerator->enumerate(current, entries, problem)) {
+            continue;
+        }
+        if (filesFound) {
+            for (const auto& name : entries.files) {
+                filesFound->push_back(joinPath(current, name));
+            }
+        }
+        for (const auto& name : entries.dirs) {
+            stack.push_back(joinPath(current, name));
+        }
+    }
+#else
+    (void)dir; (void)filesFound;
+#endif
+}
+
+void IndexWatcher::unwatchTree(const std::string& dir)
+{
+#ifdef __linux__
+    for (auto it = dirToWatch.begin(); it != dirToWatch.end(); ) {
+        if (isSameOrUnder(it->first, dir)) {
+            ::inotify_rm_watch(inotifyFd, it->second);
+            watchToDir.erase(it->second);
+            it = dirToWatch.erase(it);
+        } else {
+            ++it;
+        }
+    }
+#else
+    (void)dir;
+#endif
+}
+
+void IndexWatcher::unwatchAll()
+{
+#ifdef __linux__
+    for (const auto& watch : watchToDir) {
+        ::inotify_rm_watch(inotifyFd, watch.first);
+    }
+#endif
+    watchToDir.clear();
+    dirToWatch.clear();
+}
+
+// 🔁 The expensive fallback: re-watch everything and rebuild the index with a real walk.
+// Watches go up BEFORE the walk, so changes made while it runs are caught as events
+// (applying those on top of the fresh index is harmless even when the walk saw them too).
+void IndexWatcher::resync()
+{
+#ifdef __linux__
+    tally.resyncing = true;
+    publish();
+
+    pending.clear();
+    unwatchAll();
+    while (::read(inotifyFd, eventBuffer.data(), eventBuffer.size()) > 0) {
+        // Throw away whatever the old watches queued up
+    }
+    for (const auto& root : rootPaths) {
+        watchTree(root, nullptr);
+    }
+
+    SearchConfig walkConfig = config;
+    walkConfig.searchTerm.clear();
+    walkConfig.searchTerms.clear();
+    walkConfig.matchMode = MatchMode::Substring;
+    walkConfig.extensionFilter.clear();
+    const CompiledQuery everything(walkConfig);
+    FileIndexBuilder builder(resolveThreadCount(walkConfig));
+    std::atomic<std::uint64_t> scanned{0};
+    std::atomic<bool> paused{false};
+    std::mutex pauseMutex;
+    std::condition_variable pauseCondition;
+    unsigned long long found = 0;
+    const SearchCallback ignoreResults = [](const std::string&, const std::string&) {};
+    for (const auto& root : rootPaths) {
+        std::error_code ec;
+        if (!fs::is_directory(root, ec)) {
+            continue;
+        }
+        builder.addRoot(root);
+        searchDirectoryParallel(root, walkConfig, everything, ignoreResults, found, stopRequested, scanned,
+                                paused, pauseMutex, pauseCondition, ProgressCallback(), &builder);
+    }
+
+    tally.resyncing = false;
+    if (stopRequested.load()) {
+        return; // Half a walk is worse than the index we already have
+    }
+
+    std::string problem;
+    auto fresh = std::make_shared<FileIndex>();
+    if (!builder.write(indexPath, problem) || !fresh->open(indexPath, problem)) {
+        tally.lastError = "resync failed: " + problem;
+        return;
+    }
+    {
+        std::unique_lock<std::shared_mutex> lock(overlayMutex);
+        index = fresh;
+        addedFiles.clear();
+        removedFiles.clear();
+        removedDirs.clear();
+        overlaySize = 0;
+    }
+    lastResync = std::chrono::system_clock::now();
+    tally.resyncs++;
+#endif
+}
+
+// 💾 Writes index + change list out as a brand-new index file - no walking involved
+bool IndexWatcher::mergeIntoIndex(std::string& errorMessage)
+{
+    FileIndexBuilder builder(1);
+    for (const auto& root : rootPaths) {
+        builder.addRoot(root); // Fresh mtimes: everything up to now is accounted for
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(overlayMutex);
+        index->forEachFile([&](std::string_view dirPath, std::string_view name) {
+            if (!isHidden(dirPath, name)) {
+                builder.onFile(0, dirPath, name);
+            }
+        });
+        for (const auto& folder : addedFiles) {
+            for (const auto& name : folder.second) {
+                builder.onFile(0, folder.first, name);
+            }
+        }
+    }
+
+    auto fresh = std::make_shared<FileIndex>();
+    if (!builder.write(indexPath, errorMessage) || !fresh->open(indexPath, errorMessage)) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(overlayMutex);
+    index = fresh; // The old mapping goes away with its last reference
+    addedFiles.clear();
+    removedFiles.clear();
+    removedDirs.clear();
+    overlaySize = 0;
+    tally.merges++;
+    return true;
+}
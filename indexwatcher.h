@@ -0,0 +1,142 @@
+#ifndef INDEXWATCHER_H
+#define INDEXWATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "searchlogic.h" // SearchConfig, SearchCallback
+#include "compiledquery.h"
+
+class FileIndex;
+class ThreadTelemetry; // searchtelemetry.h
+
+// 👁️ Live Index Maintenance 👁️
+// A saved index goes stale the moment anything changes, and rebuilding it means walking
+// the whole tree again. The watcher keeps it fresh instead: it puts an inotify watch on
+// every folder under the indexed roots, and a background thread folds the create / delete /
+// rename events into a small in-memory list of changes that queries layer on top of the
+// memory-mapped index.
+//
+// Event storms (a `git checkout`, an unpacked tarball) are coalesced: events collect in a
+// pending queue keyed by path - the last word on each path wins - and only get applied once
+// things go quiet for a moment (or the batch gets old or big). When the change list grows
+// large it's merged back into the index file, no disk walk needed.
+//
+// Only when the kernel tells us it dropped events (queue overflow) or a root itself goes
+// away do we fall back to a full resync: re-watch everything and walk the roots again.
+//
+// Linux only (inotify). Elsewhere start() just explains that it can't.
+
+// Numbers for the status bar
+struct IndexWatcherStats {
+    bool running = false;
+    bool resyncing = false;          // A full walk is in progress right now
+    std::uint64_t watchedDirs = 0;
+    std::uint64_t queueDepth = 0;    // Coalesced changes waiting for the current batch to settle
+    std::uint64_t queueHighWater = 0;
+    std::uint64_t eventsSeen = 0;
+    std::uint64_t eventsCoalesced = 0; // Events that only updated a change already in the queue
+    std::uint64_t batchesApplied = 0;
+    std::uint64_t pendingChanges = 0;  // Changes layered over the index file, not merged in yet
+    std::uint64_t merges = 0;          // Times those changes were written back into the index file
+    std::uint64_t overflows = 0;       // Kernel queue overflows (each one means events were lost)
+    std::uint64_t droppedEvents = 0;   // Events we couldn't place (folder no longer watched)
+    std::uint64_t watchFailures = 0;   // Folders we couldn't watch (usually the max_user_watches limit)
+    std::uint64_t resyncs = 0;
+    double secondsSinceResync = 0.0;   // Since the last full walk (the index build counts as one)
+    std::string lastError;
+};
+
+class IndexWatcher
+{
+public:
+    // walkConfig supplies the thread count / backends used if a full resync is needed
+    IndexWatcher(const std::string& indexFile, const SearchConfig& walkConfig);
+    ~IndexWatcher(); // Same as stop()
+
+    IndexWatcher(const IndexWatcher&) = delete;
+    IndexWatcher& operator=(const IndexWatcher&) = delete;
+
+    // Opens the index and starts the background thread (which then places the watches).
+    // Returns false + errorMessage if the index can't be opened or this platform can't watch.
+    bool start(std::string& errorMessage);
+
+    // Stops the thread. Outstanding changes get merged into the index file first, unless
+    // the caller is about to overwrite that file anyway.
+    void stop(bool mergeChanges = true);
+
+    bool isRunning() const { return running.load(); }
+    const std::string& indexFile() const { return indexPath; }
+    IndexWatcherStats stats() const;
+
+    // Same job as FileIndex::covers / search, but with the live changes layered on top
+    bool covers(const fs::path& root) const;
+    std::uint64_t fileCount() const;
+    unsigned long long search(const fs::path& root,
+                              const CompiledQuery& query,
+                              const SearchCallback& reportResult,
+                              std::atomic<bool>& cancellationFlag,
+                              std::atomic<std::uint64_t>& filesScannedCount,
+                              ThreadTelemetry* telemetry = nullptr) const; // Metadata stats get counted here (optional)
+
+private:
+    // One coalesced entry of the pending queue
+    enum class Change { FileAdded, FileRemoved, DirAdded, DirRemoved };
+
+    void run(bool resyncFirst);
+    void readEvents(bool& needResync);
+    void applyBatch();
+    void watchTree(const std::string& dir, std::vector<std::string>* filesFound);
+    void unwatchTree(const std::string& dir);
+    void unwatchAll();
+    void resync();
+    void publish(); // Copies the thread's tallies to where stats() can see them
+    bool mergeIntoIndex(std::string& errorMessage);
+    bool isHidden(std::string_view dirPath, std::string_view name) const; // overlayMutex held
+
+    std::string indexPath;
+    SearchConfig config;
+
+    std::shared_ptr<FileIndex> index; // Swapped (under overlayMutex) after a merge or resync
+    std::vector<std::string> rootPaths;
+
+    // 🩹 The change list queries layer over the index (guarded by overlayMutex)
+    mutable std::shared_mutex overlayMutex;
+    std::unordered_map<std::string, std::unordered_set<std::string>> addedFiles; // folder -> names
+    std::unordered_set<std::string> removedFiles; // Full paths
+    std::unordered_set<std::string> removedDirs;  // Full paths; hides everything the index has below them
+    std::uint64_t overlaySize = 0;
+
+    // Owned by the watcher thread
+    int inotifyFd = -1;
+    int wakeFd = -1; // Pokes the thread out of poll() when it's time to stop
+    std::unordered_map<int, std::string> watchToDir;
+    std::unordered_map<std::string, int> dirToWatch;
+    std::unordered_map<std::string, Change> pending;
+    std::chrono::steady_clock::time_point batchStarted;
+    std::chrono::steady_clock::time_point lastEvent;
+    std::vector<char> eventBuffer;
+    std::unique_ptr<DirectoryEnumerator> enumerator;
+    IndexWatcherStats tally;
+    std::chrono::system_clock::time_point lastResync;
+
+    mutable std::mutex statsMutex;
+    IndexWatcherStats published;
+    std::chrono::system_clock::time_point publishedResync;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> mergeOnStop{true};
+    std::thread thread;
+};
+
+#endif // INDEXWATCHER_H
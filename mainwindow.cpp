@@ -16,7 +16,6 @@
 #include <QStyleOptionButton> // Keep if customizeCheckbox uses it implicitly
 
 // <-- New Includes -->
-#include <QStandardItemModel>
 #include <QSortFilterProxyModel>
 #include <QTableView>        // Explicit include
 #include <QHeaderView>       // For table header customization
@@ -28,6 +27,15 @@
 #include <QApplication>      // For clipboard access
 #include <QTabWidget>        // Explicit include
 #include <QPlainTextEdit>    // Explicit include
+#include <QTableWidget>      // The Stats tab
+#include <QSaveFile>         // For saving the telemetry report
+#include <QStringList>       // Per-term counts
+#include <QDateTime>         // "Now", for ages like 7d in the Modified field
+#include <algorithm>
+#include <chrono>
+
+#include "indexwatcher.h"    // Keeps the saved index fresh between searches
+#include "compiledquery.h"   // To check a glob/regex before the search starts
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -42,7 +50,14 @@ MainWindow::MainWindow(QWidget *parent)
     , statusLabel(nullptr)
     , countLabel(nullptr)
     , scannedLabel(nullptr)    // Initialize new label pointer
+    , originLabel(nullptr)
+    , watcherLabel(nullptr)
     , progressBar(nullptr)
+    , watcherStatusTimer(nullptr)
+    , batchesReceived(0)
+    , batchIntakeSeconds(0)
+    , batchDelayMaxSeconds(0)
+    , batchDelayTotalSeconds(0)
     , resultsContextMenu(nullptr) // Initialize new menu pointer
     , openLocationAction(nullptr)
     , copyPathAction(nullptr)
@@ -57,10 +72,30 @@ MainWindow::MainWindow(QWidget *parent)
     // --- Initial State ---
     setGuiEnabled(true);     // Initially enable GUI (disables cancel/pause)
     ui->tabWidget->setCurrentIndex(0); // Start on Results tab
+    ui->statsTableWidget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    ui->mountsTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    ui->mountsTableWidget->horizontalHeader()->setStretchLastSection(true);
 
     // --- Styling & Icons ---
     customizeCheckbox(ui->caseInsensitiveCheckBox);
     customizeCheckbox(ui->verboseErrorsCheckBox);
+    customizeCheckbox(ui->duplicatesCheckBox);
+    customizeCheckbox(ui->watchIndexCheckBox);
+    customizeCheckbox(ui->batchIoCheckBox);
+    customizeCheckbox(ui->includeVirtualCheckBox);
+
+    // io_uring is up to the kernel - no point offering it where it would only fall back
+    {
+        std::string whyNot;
+        if (!UringBatch::available(&whyNot)) {
+            ui->batchIoCheckBox->setEnabled(false);
+            ui->batchIoCheckBox->setToolTip(tr("Not available here: %1").arg(QString::fromStdString(whyNot)));
+        }
+    }
+
+    // Once a second, show how the live index watcher is doing (only ticks while one runs)
+    watcherStatusTimer = new QTimer(this);
+    connect(watcherStatusTimer, &QTimer::timeout, this, &MainWindow::refreshWatcherStatus);
 
     // Set window icon (using programmatic fallback as before)
     QIcon appIcon;
@@ -127,6 +162,8 @@ void MainWindow::setupStatusBar() {
     statusLabel = new QLabel(tr("Ready"), this);
     countLabel = new QLabel(this); // Text set later
     scannedLabel = new QLabel(this); // <-- New label for scanned count
+    originLabel = new QLabel(this);  // "Index (built ...)" / "Live walk"
+    watcherLabel = new QLabel(this); // "👁️ Live: ..." while the index watcher runs
     progressBar = new QProgressBar(this);
 
     progressBar->setRange(0, 0); // Indeterminate
@@ -151,6 +188,8 @@ void MainWindow::setupStatusBar() {
     // ui->statusbar->setStyleSheet("QStatusBar { padding: 4px; }"); // Moved to QSS
 
     ui->statusbar->addWidget(statusLabel, 1); // Stretch status label
+    ui->statusbar->addPermanentWidget(watcherLabel);
+    ui->statusbar->addPermanentWidget(originLabel);
     ui->statusbar->addPermanentWidget(scannedLabel);
     ui->statusbar->addPermanentWidget(countLabel);
     ui->statusbar->addPermanentWidget(progressBar);
@@ -158,10 +197,9 @@ void MainWindow::setupStatusBar() {
 
 void MainWindow::setupResultsView() {
     // Create models
-    resultsModel = new QStandardItemModel(0, 2, this); // 0 rows, 2 columns (Name, Path), parented
-    resultsModel->setHorizontalHeaderLabels({tr("Name"), tr("Path")});
+    resultsModel = new ResultsModel(this); // Name, Path columns, parented
 
-    resultsProxyModel = new QSortFilterProxyModel(this); // Parented
+    resultsProxyModel = new ResultsProxyModel(this); // Parented
     resultsProxyModel->setSourceModel(resultsModel);
     resultsProxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive); // Default filter behavior
     resultsProxyModel->setFilterKeyColumn(-1); // Filter across all columns by default
@@ -177,6 +215,8 @@ void MainWindow::setupResultsView() {
     // Adjust column widths
     ui->resultsTableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive); // Allow resizing Name
     ui->resultsTableView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);     // Stretch Path
+    ui->resultsTableView->horizontalHeader()->setSectionResizeMode(ResultsModel::MatchColumn, QHeaderView::Interactive);
+    ui->resultsTableView->setColumnHidden(ResultsModel::MatchColumn, true); // Only content and duplicate searches fill it
     ui->resultsTableView->setAlternatingRowColors(true); // Nice visual separation (QSS can enhance)
 
     // Enable context menu
@@ -268,10 +308,56 @@ void MainWindow::on_browseOutputFileButton_clicked()
     }
 }
 
+void MainWindow::on_browseTraceFileButton_clicked()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save Trace As"),
+                                                    QDir::homePath() + "/search-trace.json",
+                                                    tr("Trace Files (*.json);;All Files (*)"));
+    if (!fileName.isEmpty()) {
+        ui->traceFileLineEdit->setText(QDir::toNativeSeparators(fileName));
+    }
+}
+
+void MainWindow::on_browseIndexFileButton_clicked()
+{
+    // Existing file or a brand new one - either is fine, so use the save dialog without the overwrite nag
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Choose Index File"),
+                                                    QDir::homePath() + "/iys_searcher.index",
+                                                    tr("IYS Index Files (*.index);;All Files (*)"),
+                                                    nullptr, QFileDialog::DontConfirmOverwrite);
+    if (!fileName.isEmpty()) {
+        ui->indexFileLineEdit->setText(QDir::toNativeSeparators(fileName));
+    }
+}
+
 void MainWindow::on_startButton_clicked()
 {
     QString searchTerm = ui->searchTermLineEdit->text().trimmed();
-    if (searchTerm.isEmpty()) {
+    const QString contentTerm = ui->contentLineEdit->text(); // Not trimmed - "  return" is a fine thing to look for
+    const bool findDuplicates = ui->duplicatesCheckBox->isChecked();
+
+    // 🗃️ Size / modified / owner - the same syntax as iys-search's --size, --mtime and --owner
+    MetadataPredicates metadata;
+    const QString sizeText = ui->sizeLineEdit->text().trimmed();
+    const QString modifiedText = ui->modifiedLineEdit->text().trimmed();
+    const QString ownerText = ui->ownerLineEdit->text().trimmed();
+    if (!sizeText.isEmpty() && !MetadataSyntax::parseSizeRange(sizeText.toStdString(), metadata.minSize, metadata.maxSize)) {
+        QMessageBox::warning(this, tr("Invalid Size"), tr("Please enter a size range like 1G.. or 10K..1M."));
+        return;
+    }
+    if (!modifiedText.isEmpty()
+        && !MetadataSyntax::parseTimeRange(modifiedText.toStdString(), QDateTime::currentSecsSinceEpoch(),
+                                           metadata.modifiedFrom, metadata.modifiedTo)) {
+        QMessageBox::warning(this, tr("Invalid Time"), tr("Please enter an age like 7d, or dates like 2024-01-01..2024-06-30."));
+        return;
+    }
+    if (!ownerText.isEmpty() && !MetadataSyntax::parseOwner(ownerText.toStdString(), metadata.ownerUid)) {
+        QMessageBox::warning(this, tr("Unknown Owner"), tr("There's no user called \"%1\".").arg(ownerText));
+        return;
+    }
+
+    // With content to look for, duplicates to find or metadata to check, an empty term makes every file a candidate
+    if (searchTerm.isEmpty() && contentTerm.isEmpty() && !findDuplicates && !metadata.isActive()) {
         QMessageBox::warning(this, tr("Input Required"), tr("Please enter a search term.")); // Use tr()
         return;
     }
@@ -279,12 +365,67 @@ void MainWindow::on_startButton_clicked()
     // --- Prepare Configuration --- (Same as before)
     SearchConfig config;
     config.searchTerm = searchTerm.toStdString();
+    switch (ui->matchModeComboBox->currentIndex()) { // Same order as the combo box items
+    case 1: config.matchMode = MatchMode::Glob; break;
+    case 2: config.matchMode = MatchMode::Regex; break;
+    case 3: config.matchMode = MatchMode::Fuzzy; break;
+    default: config.matchMode = MatchMode::Substring; break;
+    }
+    if (searchTerm.isEmpty()) {
+        config.matchMode = MatchMode::Substring; // No name to match: every file goes to the content readers / duplicate finder / metadata check
+    } else if (ui->matchModeComboBox->currentIndex() == 4) {
+        // Several terms, split on '|' - one walk answers them all (see multimatch.h)
+        for (const QString& term : searchTerm.split('|', Qt::SkipEmptyParts)) {
+            if (!term.trimmed().isEmpty()) {
+                config.searchTerms.push_back(term.trimmed().toStdString());
+            }
+        }
+        if (config.searchTerms.empty()) {
+            QMessageBox::warning(this, tr("Input Required"), tr("Please enter at least one term, like invoice|receipt."));
+            return;
+        }
+        config.searchTerm.clear();
+    }
     config.startPath = ui->startPathLineEdit->text().trimmed().toStdString();
     config.extensionFilter = ui->extensionLineEdit->text().trimmed().toStdString();
+    config.contentTerm = contentTerm.toStdString();
+    config.metadata = metadata;
+    if (!config.contentTerm.empty() && config.matchMode == MatchMode::Fuzzy) {
+        // Fuzzy keeps only the best K names, and only at the very end - nothing to feed the readers as we go
+        QMessageBox::warning(this, tr("Not Supported"), tr("Fuzzy matching can't be combined with searching inside files."));
+        return;
+    }
+    config.findDuplicates = findDuplicates;
+    if (findDuplicates && (config.matchMode == MatchMode::Fuzzy || !config.searchTerms.empty() || !config.contentTerm.empty())) {
+        // The finder wants a plain list of candidates - not a top K, not per-term groups, not matching lines
+        QMessageBox::warning(this, tr("Not Supported"),
+                             tr("Finding duplicates works with a plain, glob or regex term - not with fuzzy, several terms or \"Containing\"."));
+        return;
+    }
     config.outputFile = ui->outputFileLineEdit->text().trimmed().toStdString();
+    switch (ui->outputFormatComboBox->currentIndex()) { // Same order as the combo box items
+    case 1: config.outputFormat = OutputFormat::NulSeparated; break;
+    case 2: config.outputFormat = OutputFormat::JsonLines; break;
+    case 3: config.outputFormat = OutputFormat::Binary; break;
+    default: config.outputFormat = OutputFormat::Text; break;
+    }
     config.caseInsensitive = ui->caseInsensitiveCheckBox->isChecked();
     config.verboseErrors = ui->verboseErrorsCheckBox->isChecked();
     config.searchAllRoots = config.startPath.empty();
+    config.threadCount = static_cast<unsigned int>(ui->threadCountSpinBox->value()); // 0 = Auto
+    config.ioBackend = ui->batchIoCheckBox->isChecked() ? IoBackend::IoUring : IoBackend::Sync; // Can't be ticked where it's unavailable
+    config.filesystemScope = ui->filesystemScopeComboBox->currentIndex() == 1 ? FilesystemScope::OneFilesystem
+                                                                              : FilesystemScope::AllFilesystems;
+    config.includeVirtualFilesystems = ui->includeVirtualCheckBox->isChecked();
+    config.indexFile = ui->indexFileLineEdit->text().trimmed().toStdString();
+    switch (ui->indexModeComboBox->currentIndex()) { // Same order as the combo box items
+    case 1: config.indexMode = IndexMode::Build; break;
+    case 2: config.indexMode = IndexMode::Query; break;
+    default: config.indexMode = IndexMode::Off; break;
+    }
+    config.watchIndex = ui->watchIndexCheckBox->isChecked();
+    config.traceFile = ui->traceFileLineEdit->text().trimmed().toStdString();
+    config.traceMinMillis = ui->traceMinMsSpinBox->value();
 
     // --- Validate Start Path --- (Improved slightly)
     if (!config.searchAllRoots) {
@@ -302,12 +443,37 @@ void MainWindow::on_startButton_clicked()
         }
     }
 
+    // --- Validate the Pattern --- (compiling one takes microseconds; a typo is better caught now than after the walk)
+    if (config.matchMode == MatchMode::Glob || config.matchMode == MatchMode::Regex || !config.searchTerms.empty()) {
+        const CompiledQuery check(config);
+        if (!check.isValid()) {
+            QMessageBox::warning(this, tr("Invalid Pattern"),
+                                 tr("That pattern won't work: %1").arg(QString::fromStdString(check.problem())));
+            return;
+        }
+    }
+
+    // --- Validate Index Settings ---
+    if (config.indexMode != IndexMode::Off && config.indexFile.empty()) {
+        QMessageBox::warning(this, tr("Index File Needed"), tr("Please choose an index file, or set the index mode to Off."));
+        return;
+    }
+
     // --- Setup Thread and Worker ---
     if (searchThread && searchThread->isRunning()) {
         QMessageBox::information(this, tr("Busy"), tr("A search is already in progress.")); // Use tr()
         return;
     }
 
+    // A rebuild is about to replace the file the watcher works on - let it go (merging would be wasted)
+    if (indexWatcher && config.indexMode == IndexMode::Build && indexWatcher->indexFile() == config.indexFile) {
+        indexWatcher->stop(false);
+        indexWatcher.reset();
+        refreshWatcherStatus();
+    }
+    lastSearchConfig = config;
+    showRootPlan(config); // (The worker makes the same plan again - reading the mount table takes microseconds)
+
     // Clean up previous thread/worker if they exist but aren't running
     // onSearchThreadFinished now uses deleteLater, so manual deletion here isn't strictly needed
     // delete worker; worker = nullptr;
@@ -317,10 +483,13 @@ void MainWindow::on_startButton_clicked()
     worker = new SearchWorker();      // No parent, will be moved
 
     worker->moveToThread(searchThread);
+    worker->setIndexWatcher(indexWatcher); // Index queries go through it while it runs
 
     // --- Clear Previous Results & Reset State ---
-    resultsModel->removeRows(0, resultsModel->rowCount()); // Clear table model
+    resultsModel->clear();                               // Clear table model
+    ui->resultsTableView->setColumnHidden(ResultsModel::MatchColumn, config.contentTerm.empty() && !config.findDuplicates); // "line: text" / "Group N"
     ui->errorLogTextEdit->clear();                       // Clear error log
+    resetStatsTab();                                     // Fresh numbers for a fresh search
     ui->tabWidget->setCurrentIndex(0);                   // Switch to results tab
     currentFoundCount = 0;
     currentScannedCount = 0;
@@ -328,15 +497,20 @@ void MainWindow::on_startButton_clicked()
     statusLabel->setText(tr("Starting search..."));
     countLabel->setText(tr("Found: 0"));
     scannedLabel->setText(tr("Scanned: 0"));
+    originLabel->clear();
 
 
     // --- Connect Signals and Slots ---
     // Worker -> MainWindow
-    connect(worker, &SearchWorker::resultFound, this, &MainWindow::handleResultFound); // Use default connection (Auto/Queued)
+    connect(worker, &SearchWorker::resultsBatch, this, &MainWindow::handleResultsBatch, Qt::QueuedConnection); // Emitted from the traversal threads
+    connect(worker, &SearchWorker::rankingUpdate, this, &MainWindow::handleRankingUpdate);
     connect(worker, &SearchWorker::errorOccurred, this, &MainWindow::handleErrorOccurred);
     connect(worker, &SearchWorker::searchFinished, this, &MainWindow::handleSearchFinished);
     connect(worker, &SearchWorker::progressUpdate, this, &MainWindow::handleProgressUpdate);
     connect(worker, &SearchWorker::progressDetailUpdate, this, &MainWindow::handleProgressDetailUpdate); // <-- New connection
+    connect(worker, &SearchWorker::resultsOrigin, this, &MainWindow::handleResultsOrigin);
+    connect(worker, &SearchWorker::telemetryUpdate, this, &MainWindow::handleTelemetryUpdate);
+    connect(worker, &SearchWorker::telemetryFinished, this, &MainWindow::handleTelemetryFinished);
 
     // Thread control
     connect(searchThread, &QThread::started, worker, [this, config](){ worker->doSearch(config); }); // Pass config via lambda
@@ -392,6 +566,17 @@ void MainWindow::on_pauseButton_clicked() {
 }
 
 
+void MainWindow::on_matchModeComboBox_currentIndexChanged(int index)
+{
+    switch (index) { // Same order as the combo box items
+    case 1: ui->searchTermLineEdit->setPlaceholderText(tr("Pattern for the whole filename, like *.conf or IMG_????.{jpg,png}")); break;
+    case 2: ui->searchTermLineEdit->setPlaceholderText(tr("Regular expression, like ^core\\.\\d+$")); break;
+    case 3: ui->searchTermLineEdit->setPlaceholderText(tr("Letters in order, like mwcpp for mainwindow.cpp - best matches first")); break;
+    case 4: ui->searchTermLineEdit->setPlaceholderText(tr("Several terms separated by |, like invoice|receipt|contract - one walk for all")); break;
+    default: ui->searchTermLineEdit->setPlaceholderText(tr("Enter text contained in filename")); break;
+    }
+}
+
 void MainWindow::on_resultsFilterLineEdit_textChanged(const QString &text) {
     if (resultsProxyModel) {
         resultsProxyModel->setFilterFixedString(text);
@@ -413,27 +598,34 @@ void MainWindow::showResultsContextMenu(const QPoint &pos) {
 
 // --- Worker Signal Handlers ---
 
-void MainWindow::handleResultFound(const QString& path)
+void MainWindow::handleResultsBatch(ResultBatchPtr batch)
 {
-    // Add row to the model
-    QList<QStandardItem*> newRow;
-    QFileInfo fileInfo(path);
-    QStandardItem* nameItem = new QStandardItem(fileInfo.fileName());
-    QStandardItem* pathItem = new QStandardItem(path);
-
-    // Optional: Set tooltip to full path for name column
-    nameItem->setToolTip(path);
-
-    // Items are not editable
-    nameItem->setEditable(false);
-    pathItem->setEditable(false);
+    // One event, thousands of rows, one insert notification - the worker's arena is copied in one go
+    const auto received = std::chrono::steady_clock::now();
+    currentFoundCount += resultsModel->appendBatch(*batch);
+    if (lastSearchConfig.findDuplicates) {
+        countLabel->setText(tr("Found: %1 duplicate(s)").arg(currentFoundCount)); // They only arrive at the end
+    } else if (lastSearchConfig.contentTerm.empty()) {
+        countLabel->setText(tr("Found: %1").arg(currentFoundCount));
+    } else {
+        countLabel->setText(tr("Found: %1 line(s)").arg(currentFoundCount)); // One row per matching line
+    }
 
-    newRow.append(nameItem);
-    newRow.append(pathItem);
-    resultsModel->appendRow(newRow); // Add to base model
+    // 📈 For the Stats tab: how long the batch waited for us, and how long we took with it
+    const double waited = std::chrono::duration<double>(received - batch->sealedAt).count();
+    batchesReceived++;
+    batchDelayTotalSeconds += waited;
+    batchDelayMaxSeconds = std::max(batchDelayMaxSeconds, waited);
+    batchIntakeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - received).count();
+}
 
-    currentFoundCount++;
-    countLabel->setText(tr("Found: %1").arg(currentFoundCount));
+void MainWindow::handleRankingUpdate(ResultBatchPtr ranked, quint64 fuzzyMatches)
+{
+    // Only the top K is ever around, so swapping the whole table is cheap
+    resultsModel->clear();
+    resultsModel->appendBatch(*ranked);
+    currentFoundCount = fuzzyMatches;
+    countLabel->setText(tr("Found: %1 (best %2 shown)").arg(fuzzyMatches).arg(ranked->size()));
 }
 
 void MainWindow::handleErrorOccurred(const QString& message)
@@ -467,17 +659,277 @@ void MainWindow::handleProgressDetailUpdate(quint64 filesScanned, const QString&
     // }
 }
 
+void MainWindow::handleResultsOrigin(const QString& description) {
+    originLabel->setText(description);
+}
+
+// --- Stats Tab ---
+
+void MainWindow::resetStatsTab() {
+    batchesReceived = 0;
+    batchIntakeSeconds = 0;
+    batchDelayMaxSeconds = 0;
+    batchDelayTotalSeconds = 0;
+    lastTelemetryJson.clear();
+    ui->statsTableWidget->setRowCount(0);
+    ui->statsJsonTextEdit->clear();
+    ui->saveStatsButton->setEnabled(false);
+}
+
+void MainWindow::addConsumerStats(TelemetrySnapshot& snapshot) const {
+    snapshot.consumerBatches = batchesReceived;
+    snapshot.consumerSeconds = batchIntakeSeconds;
+    snapshot.consumerMaxDelaySeconds = batchDelayMaxSeconds;
+    snapshot.consumerTotalDelaySeconds = batchDelayTotalSeconds;
+}
+
+void MainWindow::handleTelemetryUpdate(TelemetrySnapshot snapshot) {
+    addConsumerStats(snapshot);
+    showTelemetry(snapshot);
+}
+
+void MainWindow::handleTelemetryFinished(TelemetrySnapshot snapshot) {
+    // Queued right behind the last batch, so every batch has been counted by now
+    addConsumerStats(snapshot);
+    showTelemetry(snapshot);
+    lastTelemetryJson = QString::fromStdString(SearchTelemetry::toJson(snapshot));
+    ui->statsJsonTextEdit->setPlainText(lastTelemetryJson);
+    ui->saveStatsButton->setEnabled(true);
+}
+
+// 📊 One row per number - rebuilt on every update (a few dozen rows, four times a second)
+void MainWindow::showTelemetry(const TelemetrySnapshot& snapshot) {
+    QList<QPair<QString, QString>> rows;
+    auto seconds = [](double value) { return tr("%1 s").arg(value, 0, 'f', 3); };
+    // Worker time as a share of everything the workers did (busy + idle)
+    const double workerTotal = snapshot.seconds(TelemetryTimer::Busy) + snapshot.seconds(TelemetryTimer::Idle);
+    auto share = [workerTotal](double value) {
+        return tr("%1 s (%2%)").arg(value, 0, 'f', 3).arg(workerTotal > 0 ? 100.0 * value / workerTotal : 0.0, 0, 'f', 1);
+    };
+
+    rows.append({tr("Phase"), QString::fromLatin1(SearchTelemetry::phaseName(snapshot.currentPhase))
+                                  + (snapshot.finished ? tr(" (finished)") : QString())});
+    rows.append({tr("Elapsed"), seconds(snapshot.elapsedSeconds)});
+    if (!snapshot.finished) {
+        rows.append({tr("Entries/s (now)"), QString::number(snapshot.entriesPerSecond, 'f', 0)});
+    }
+    rows.append({tr("Entries/s (average)"), QString::number(snapshot.averageEntriesPerSecond, 'f', 0)});
+
+    // 🧮 Counters
+    for (std::size_t c = 0; c < kTelemetryCounters; ++c) {
+        const auto counter = static_cast<TelemetryCounter>(c);
+        rows.append({QString::fromLatin1(SearchTelemetry::counterName(counter)), QString::number(snapshot.counter(counter))});
+    }
+
+    // ⏱️ Where the workers' time went
+    rows.append({tr("Workers: reading folders"), share(snapshot.seconds(TelemetryTimer::DirectoryRead))});
+    rows.append({tr("Workers: stat()"), share(snapshot.seconds(TelemetryTimer::Stat))});
+    rows.append({tr("Workers: matching + bookkeeping"), share(snapshot.matchingSeconds())});
+    rows.append({tr("Workers: reporting matches"), share(snapshot.seconds(TelemetryTimer::Reporting))});
+    rows.append({tr("Workers: idle"), share(snapshot.seconds(TelemetryTimer::Idle))});
+
+    for (std::size_t p = 0; p < kSearchPhases; ++p) {
+        const auto phase = static_cast<SearchPhase>(p);
+        if (snapshot.phase(phase) > 0) {
+            rows.append({tr("Phase: %1").arg(QString::fromLatin1(SearchTelemetry::phaseName(phase))), seconds(snapshot.phase(phase))});
+        }
+    }
+
+    // 📦 The result hand-off, both ends
+    rows.append({tr("Batches sent"), tr("%1 (%2 results, %3 in the sink)")
+                                         .arg(snapshot.batchesSent).arg(snapshot.resultsSent)
+                                         .arg(seconds(snapshot.deliverySeconds))});
+    rows.append({tr("Batches received"), tr("%1 (%2 taking them in)")
+                                             .arg(snapshot.consumerBatches).arg(seconds(snapshot.consumerSeconds))});
+    if (snapshot.consumerBatches > 0) {
+        rows.append({tr("Batch queue delay"), tr("average %1 ms, worst %2 ms")
+                                                  .arg(1000.0 * snapshot.consumerTotalDelaySeconds / snapshot.consumerBatches, 0, 'f', 1)
+                                                  .arg(1000.0 * snapshot.consumerMaxDelaySeconds, 0, 'f', 1)});
+    }
+    if (snapshot.hasOutputFile) {
+        rows.append({tr("Output file"), tr("%1 results, %2 MB at %3 MB/s, queue peaked at %4, %5 waits")
+                                            .arg(snapshot.outputFile.results)
+                                            .arg(snapshot.outputFile.bytesWritten / (1024.0 * 1024.0), 0, 'f', 1)
+                                            .arg(snapshot.outputFile.megabytesPerSecond, 0, 'f', 1)
+                                            .arg(snapshot.outputFile.queueHighWater)
+                                            .arg(snapshot.outputFile.producerWaits)});
+    }
+
+    // 💽 One row per disk when several are walked at once - the one still going is the bottleneck
+    for (const DeviceTelemetry& device : snapshot.devices) {
+        const QString state = device.finished ? tr("done") : device.started ? tr("walking") : tr("waiting for workers");
+        rows.append({tr("Disk %1").arg(QString::fromStdString(device.name)),
+                     tr("%1, %2 workers: %3 entries in %4 (%5/s), %6 of %7 roots, %8")
+                         .arg(QString::fromStdString(device.kind)).arg(device.threads).arg(device.entries)
+                         .arg(seconds(device.seconds)).arg(device.entriesPerSecond, 0, 'f', 0)
+                         .arg(device.rootsDone).arg(device.roots).arg(state)});
+    }
+
+    // 👷 One row per worker - lopsided numbers mean work stealing isn't keeping up
+    for (std::size_t i = 0; i < snapshot.workers.size(); ++i) {
+        const WorkerTelemetry& row = snapshot.workers[i];
+        rows.append({tr("Worker %1").arg(i), tr("%1 entries, %2 folders, %3 matches, %4 steals, busy %5, idle %6")
+                                                 .arg(row.entries).arg(row.dirs).arg(row.matches).arg(row.steals)
+                                                 .arg(seconds(row.busySeconds)).arg(seconds(row.idleSeconds))});
+    }
+
+    QTableWidget* table = ui->statsTableWidget;
+    table->setRowCount(static_cast<int>(rows.size()));
+    for (int r = 0; r < rows.size(); ++r) {
+        for (int column = 0; column < 2; ++column) {
+            const QString& text = column == 0 ? rows[r].first : rows[r].second;
+            QTableWidgetItem* item = table->item(r, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                table->setItem(r, column, item);
+            }
+            item->setText(text);
+        }
+    }
+}
+
+// --- Mounts Tab ---
+
+// 🗺️ Which mounts get searched and which don't, and why - mount points indented under their parents
+void MainWindow::showRootPlan(const SearchConfig& config) {
+    const RootPlan plan = planRoots(config);
+    QTableWidget* table = ui->mountsTableWidget;
+    table->setRowCount(static_cast<int>(plan.mounts.size()));
+    for (int r = 0; r < table->rowCount(); ++r) {
+        const MountPlanEntry& mount = plan.mounts[static_cast<std::size_t>(r)];
+        const QString cells[] = {
+            QString(static_cast<int>(mount.depth) * 3, QLatin1Char(' ')) + QString::fromStdString(mount.mountPoint),
+            QString::fromStdString(mount.fsType),
+            QString::fromStdString(mount.source),
+            QString::fromStdString(deviceName(mount.device)),
+            QString::fromLatin1(mountDecisionName(mount.decision)),
+            QString::fromStdString(mount.note),
+        };
+        for (int column = 0; column < 6; ++column) {
+            QTableWidgetItem* item = table->item(r, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                table->setItem(r, column, item);
+            }
+            item->setText(cells[column]);
+            if (column == 4) {
+                item->setForeground(mount.decision == MountDecision::Root ? QColor("#57cc99") : QColor("#9a9a9a"));
+            }
+        }
+    }
+}
 
-void MainWindow::handleSearchFinished(unsigned long long count, double duration)
+void MainWindow::on_saveStatsButton_clicked() {
+    if (lastTelemetryJson.isEmpty()) {
+        return;
+    }
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Save Search Stats"), "search-stats.json",
+                                                          tr("JSON Files (*.json);;All Files (*)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)
+        || file.write(lastTelemetryJson.toUtf8()) < 0 || !file.commit()) {
+        QMessageBox::warning(this, tr("Couldn't Save"), tr("Couldn't write %1: %2").arg(fileName, file.errorString()));
+    }
+}
+
+
+// 👁️ Starts, restarts or stops the live index watcher to match what the last search asked for
+void MainWindow::updateIndexWatcher(const SearchConfig& config) {
+    const bool wanted = config.watchIndex && config.indexMode != IndexMode::Off && !config.indexFile.empty();
+    if (indexWatcher && (!wanted || indexWatcher->indexFile() != config.indexFile || !indexWatcher->isRunning())) {
+        indexWatcher->stop(); // Merges what it knows into the file on the way out
+        indexWatcher.reset();
+    }
+    if (wanted && !indexWatcher) {
+        auto watcher = std::make_shared<IndexWatcher>(config.indexFile, config);
+        std::string problem;
+        if (watcher->start(problem)) {
+            indexWatcher = watcher;
+        } else {
+            handleErrorOccurred(tr("Couldn't keep the index live: %1").arg(QString::fromStdString(problem)));
+        }
+    }
+
+    if (indexWatcher) {
+        watcherStatusTimer->start(1000);
+    } else {
+        watcherStatusTimer->stop();
+    }
+    refreshWatcherStatus();
+}
+
+void MainWindow::refreshWatcherStatus() {
+    if (!indexWatcher) {
+        watcherLabel->clear();
+        watcherLabel->setToolTip(QString());
+        return;
+    }
+
+    const IndexWatcherStats stats = indexWatcher->stats();
+    const double age = stats.secondsSinceResync;
+    const QString sinceResync = age < 120 ? tr("%1 s").arg(static_cast<int>(age))
+                              : age < 7200 ? tr("%1 min").arg(static_cast<int>(age / 60))
+                                           : tr("%1 h").arg(static_cast<int>(age / 3600));
+
+    if (!stats.running) {
+        watcherLabel->setText(tr("👁️ Watcher stopped"));
+    } else if (stats.resyncing) {
+        watcherLabel->setText(tr("👁️ Resyncing index..."));
+    } else {
+        watcherLabel->setText(tr("👁️ Live: queue %1 (peak %2) | %3 overflows, %4 dropped | resync %5 ago")
+                                  .arg(stats.queueDepth).arg(stats.queueHighWater)
+                                  .arg(stats.overflows).arg(stats.droppedEvents)
+                                  .arg(sinceResync));
+    }
+    watcherLabel->setToolTip(tr("Watching %1 folders (%2 couldn't be watched)\n"
+                                "%3 events seen, %4 coalesced into earlier ones, %5 batches applied\n"
+                                "%6 changes not merged into the file yet, %7 merges, %8 full resyncs%9")
+                                 .arg(stats.watchedDirs).arg(stats.watchFailures)
+                                 .arg(stats.eventsSeen).arg(stats.eventsCoalesced).arg(stats.batchesApplied)
+                                 .arg(stats.pendingChanges).arg(stats.merges).arg(stats.resyncs)
+                                 .arg(stats.lastError.empty() ? QString()
+                                                              : tr("\nLast problem: %1").arg(QString::fromStdString(stats.lastError))));
+}
+
+void MainWindow::handleSearchFinished(unsigned long long count, double duration, const QList<quint64>& termCounts)
 {
     qDebug() << "MainWindow received searchFinished signal.";
 
     // Update GUI - ensure final state is correct
     setGuiEnabled(true); // Re-enable controls, disable cancel/pause, hide progress bar
     statusLabel->setText(tr("Search completed in %1 seconds").arg(duration, 0, 'f', 2));
-    countLabel->setText(tr("Found: %1").arg(count)); // Ensure final count is correct
+    if (lastSearchConfig.matchMode == MatchMode::Fuzzy) {
+        countLabel->setText(tr("Found: %1 (best %2 shown)").arg(count).arg(resultsModel->rowCount()));
+    } else if (lastSearchConfig.findDuplicates) {
+        // 👯 count is every file in a group; the last row carries the highest group number
+        const int rows = resultsModel->rowCount();
+        countLabel->setText(tr("Found: %1 duplicate file(s) in %2 group(s)").arg(count)
+                                .arg(rows > 0 ? resultsModel->groupId(rows - 1) : 0));
+    } else if (!lastSearchConfig.contentTerm.empty()) {
+        // 📖 count is files whose content matched; the table has a row per matching line
+        countLabel->setText(tr("Found: %1 file(s), %2 line(s)").arg(count).arg(resultsModel->rowCount()));
+    } else {
+        countLabel->setText(tr("Found: %1").arg(count)); // Ensure final count is correct
+    }
+    // 🗂️ Several terms: how many hits each one got (a file can count for more than one)
+    QStringList perTerm;
+    for (int id = 0; id < termCounts.size() && id < static_cast<int>(lastSearchConfig.searchTerms.size()); ++id) {
+        perTerm << tr("%1: %2").arg(QString::fromStdString(lastSearchConfig.searchTerms[id])).arg(termCounts[id]);
+    }
+    if (!perTerm.isEmpty()) {
+        countLabel->setText(tr("Found: %1 (%2)").arg(count).arg(perTerm.join(", ")));
+        countLabel->setToolTip(perTerm.join("\n"));
+    } else {
+        countLabel->setToolTip(QString());
+    }
     scannedLabel->setText(tr("Scanned: %1").arg(currentScannedCount)); // Ensure final scanned count
 
+    // The index (if any) is as fresh as it gets right now - a good moment to start watching it
+    updateIndexWatcher(lastSearchConfig);
+
     // Tell the thread to quit its event loop if not already finished
     if (searchThread && !searchThread->isFinished()) {
         searchThread->quit();
@@ -543,14 +995,8 @@ QString MainWindow::getSelectedPathFromView() const {
     // We need to map the proxy index back to the source model index
     QModelIndex proxyIndex = selectedRows.first();
     QModelIndex sourceIndex = resultsProxyModel->mapToSource(proxyIndex);
-    // Assuming path is in the second column (index 1) of the source model
-    QModelIndex pathIndex = resultsModel->index(sourceIndex.row(), 1);
-
-    if (pathIndex.isValid()) {
-        return resultsModel->data(pathIndex).toString();
-    }
-
-    return QString(); // Index was invalid for some reason
+    // The model hands out the full path for any row, whatever column was clicked
+    return resultsModel->path(sourceIndex.row()); // Empty if the index was invalid for some reason
 }
 
 
@@ -9,14 +9,16 @@
 // #include <QPlainTextEdit> // Included via ui_mainwindow.h if added in designer
 
 // <-- New Includes -->
-#include <QStandardItemModel>   // For table view data
 #include <QSortFilterProxyModel>// For filtering/sorting table view
 #include <QItemSelection>       // For context menu selection
 #include <QMenu>                // For context menu
 #include <QPoint>               // For context menu position
+#include <QTimer>               // For polling the index watcher
+#include <memory>
 
 #include "searchworker.h" // Include the worker definition
 #include "searchlogic.h"  // Include SearchConfig definition
+#include "resultsmodel.h" // The results table model + its sorting proxy
 
 // Forward declaration for the UI class generated by Qt Designer
 QT_BEGIN_NAMESPACE
@@ -38,18 +40,27 @@ private slots:
     // --- Slots for UI interaction ---
     void on_browseStartPathButton_clicked();
     void on_browseOutputFileButton_clicked();
+    void on_browseIndexFileButton_clicked();
+    void on_browseTraceFileButton_clicked();
     void on_startButton_clicked();
     void on_cancelButton_clicked();
     void on_pauseButton_clicked(); // <-- New slot for pause/resume button
     void on_resultsFilterLineEdit_textChanged(const QString &text); // <-- New slot for filter input
+    void on_matchModeComboBox_currentIndexChanged(int index); // Fits the placeholder text to the mode
+    void on_saveStatsButton_clicked(); // Saves the last telemetry report as JSON
     void showResultsContextMenu(const QPoint &pos); // <-- New slot for context menu request
 
     // --- Slots to handle signals from SearchWorker ---
-    void handleResultFound(const QString& path); // Path is added to model now
+    void handleResultsBatch(ResultBatchPtr batch); // A few thousand rows at a time
+    void handleRankingUpdate(ResultBatchPtr ranked, quint64 fuzzyMatches); // Fuzzy mode: the whole top K, replacing the table
     void handleErrorOccurred(const QString& message); // Will append to error display
-    void handleSearchFinished(unsigned long long count, double duration);
+    void handleSearchFinished(unsigned long long count, double duration, const QList<quint64>& termCounts); // Per-term counts only for several terms
     void handleProgressUpdate(const QString& message); // General status
     void handleProgressDetailUpdate(quint64 filesScanned, const QString& currentDir); // <-- New slot for detailed progress
+    void handleResultsOrigin(const QString& description); // Index or live walk?
+    void handleTelemetryUpdate(TelemetrySnapshot snapshot);   // Live numbers for the Stats tab
+    void handleTelemetryFinished(TelemetrySnapshot snapshot); // Final numbers + the JSON report
+    void refreshWatcherStatus(); // Polls the live index watcher for the status bar
 
     // --- Slot for thread cleanup ---
     void onSearchThreadFinished();
@@ -66,8 +77,8 @@ private:
     SearchWorker* worker;  // Pointer to the worker object
 
     // --- Data Models for Results Table ---
-    QStandardItemModel *resultsModel;       // <-- New: Holds the actual result data
-    QSortFilterProxyModel *resultsProxyModel; // <-- New: Handles sorting and filtering for the view
+    ResultsModel *resultsModel;             // Holds the actual result data (one arena of paths)
+    ResultsProxyModel *resultsProxyModel;   // Handles sorting and filtering for the view
 
     // --- State Variables ---
     unsigned long long currentFoundCount;   // Counter for found items display
@@ -78,8 +89,25 @@ private:
     QLabel *statusLabel;
     QLabel *countLabel;
     QLabel *scannedLabel; // <-- New: Label for scanned count
+    QLabel *originLabel;  // Where the results came from (index vs. live walk)
+    QLabel *watcherLabel; // Live index watcher health (queue, overflows, last resync)
     QProgressBar *progressBar; // Will still use indeterminate mode mostly
 
+    // --- Live Index Watcher ---
+    // Outlives any single search (workers come and go), so the window owns it
+    std::shared_ptr<IndexWatcher> indexWatcher;
+    QTimer *watcherStatusTimer;
+    SearchConfig lastSearchConfig; // What the search that just finished asked for
+
+    // --- Stats Tab ---
+    // Our side of the result hand-off: how many batches arrived, how long taking them in took,
+    // and how long they sat in the event queue before we got to them
+    quint64 batchesReceived;
+    double batchIntakeSeconds;
+    double batchDelayMaxSeconds;
+    double batchDelayTotalSeconds;
+    QString lastTelemetryJson; // The finished search's report, for "Save JSON..."
+
     // --- Context Menu ---
     QMenu *resultsContextMenu; // <-- New
     QAction *openLocationAction; // <-- New
@@ -91,6 +119,11 @@ private:
     void createContextMenu(); // <-- New: Create context menu actions
     void setGuiEnabled(bool enabled); // Modified to include pause button state
     void customizeCheckbox(QCheckBox* checkbox); // Existing helper
+    void updateIndexWatcher(const SearchConfig& config); // Start/stop watching after a search
+    void resetStatsTab();
+    void addConsumerStats(TelemetrySnapshot& snapshot) const; // Fills in the window's half of the hand-off
+    void showTelemetry(const TelemetrySnapshot& snapshot);
+    void showRootPlan(const SearchConfig& config); // Fills the Mounts tab
 
     // Helper to get selected path from table view for context menu
     QString getSelectedPathFromView() const;
@@ -0,0 +1,166 @@
+// ⏱️ Matcher Micro-Benchmark ⏱️
+// Pits the vectorized SubstringMatcher (every kernel this CPU can run) against the way
+// filenames used to be checked: lowercase a copy with toLower(), then std::string::find().
+//
+//   iys-matcher-bench             synthetic names (deterministic, ~400k of them)
+//   iys-matcher-bench /some/dir   the real names under a folder instead
+//
+// Prints nanoseconds per name for every term / case mode / kernel, plus the speedup over
+// the old path, and double-checks that everybody found the same number of matches.
+
+#include "simdmatch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// The old hot loop, exactly as it was: copy, lowercase, find
+std::string toLowerCopy(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    return s;
+}
+
+// 🎲 Names shaped like a real disk: photos, source files, libraries, docs, hashes, configs
+std::vector<std::string> syntheticNames(std::size_t count)
+{
+    std::mt19937 rng(42);
+    const char* stems[] = {"report", "README", "index", "main", "config", "Makefile", "libssl", "notes",
+                           "IMG_", "DSC", "Screenshot ", "invoice", "backup", "test_", "__init__", "package-lock",
+                           "CMakeLists", "node_modules", "thumbnail", "Cargo", "settings", "Document", "setup"};
+    const char* extensions[] = {".txt", ".cpp", ".h", ".py", ".JPG", ".png", ".so.1.2", ".json", ".md", ".pdf",
+                                ".docx", ".rs", ".js", ".html", ".o", "", ".log", ".tar.gz", ".xml", ".ini"};
+    const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-";
+    std::uniform_int_distribution<int> pickStem(0, sizeof(stems) / sizeof(stems[0]) - 1);
+    std::uniform_int_distribution<int> pickExt(0, sizeof(extensions) / sizeof(extensions[0]) - 1);
+    std::uniform_int_distribution<int> pickChar(0, sizeof(alphabet) - 2);
+    std::lognormal_distribution<double> suffixLength(1.6, 0.9); // Mostly short, occasionally very long
+    std::uniform_int_distribution<int> coin(0, 9);
+
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string name;
+        if (coin(rng) < 2) {
+            // Hash-like names (git objects, cache files): pure random run
+            for (int k = 0; k < 38; ++k) name.push_back(alphabet[pickChar(rng) % 16]);
+        } else {
+            name = stems[pickStem(rng)];
+            const int extra = std::min(200, static_cast<int>(suffixLength(rng)));
+            for (int k = 0; k < extra; ++k) name.push_back(alphabet[pickChar(rng)]);
+            name += extensions[pickExt(rng)];
+        }
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+std::vector<std::string> namesUnder(const fs::path& root, std::size_t limit)
+{
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+         it != end && names.size() < limit; it.increment(ec)) {
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+        names.push_back(it->path().filename().string());
+    }
+    return names;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Runs `pass` enough times to get a stable number; returns ns per name and the match count
+template <typename Pass>
+double nanosPerName(const std::vector<std::string>& names, Pass pass, std::size_t& matches)
+{
+    matches = pass(); // Warm-up (and the count we report)
+    int rounds = 0;
+    const auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        pass();
+        ++rounds;
+        elapsed = Clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(200));
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (double(rounds) * names.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::vector<std::string> names = argc > 1 ? namesUnder(argv[1], 2000000) : syntheticNames(400000);
+    if (names.empty()) {
+        std::fprintf(stderr, "No names to test with.\n");
+        return 1;
+    }
+    std::size_t totalBytes = 0;
+    for (const auto& name : names) totalBytes += name.size();
+    std::printf("%zu names, %.1f bytes on average, best kernel here: %s\n\n", names.size(),
+                double(totalBytes) / names.size(), SimdMatch::kernelName(SimdMatch::bestKernel()));
+
+    const char* terms[] = {"a", "md", "log", "Report", "config", "node_modules", "thisIsNotInAnyName_2024"};
+    const SimdMatch::Kernel kernels[] = {SimdMatch::Kernel::Scalar, SimdMatch::Kernel::SSE42, SimdMatch::Kernel::AVX2};
+
+    std::printf("%-24s %-6s %14s", "term", "case", "toLower+find");
+    for (auto kernel : kernels) std::printf(" %14s", SimdMatch::kernelName(kernel));
+    std::printf("   (ns/name, speedup)\n");
+
+    bool allAgree = true;
+    for (const char* term : terms) {
+        for (bool caseInsensitive : {true, false}) {
+            // The old path
+            const std::string needle = caseInsensitive ? toLowerCopy(term) : std::string(term);
+            std::size_t baselineMatches = 0;
+            const double baseline = nanosPerName(names, [&] {
+                std::size_t found = 0;
+                for (const auto& name : names) {
+                    const std::string candidate = caseInsensitive ? toLowerCopy(name) : name;
+                    found += candidate.find(needle) != std::string::npos;
+                }
+                return found;
+            }, baselineMatches);
+            std::printf("%-24s %-6s %11.2f   ", term, caseInsensitive ? "insens" : "sens", baseline);
+
+            // The new one, kernel by kernel
+            for (auto kernel : kernels) {
+                if (!SimdMatch::isSupported(kernel)) {
+                    std::printf(" %14s", "n/a");
+                    continue;
+                }
+                const SubstringMatcher matcher(term, caseInsensitive, kernel);
+                std::size_t matches = 0;
+                const double perName = nanosPerName(names, [&] {
+                    std::size_t found = 0;
+                    for (const auto& name : names) {
+                        found += matcher.contains(name);
+                    }
+                    return found;
+                }, matches);
+                if (matches != baselineMatches) {
+                    allAgree = false;
+                    std::printf(" %8.2f MISMATCH(%zu vs %zu)", perName, matches, baselineMatches);
+                } else {
+                    std::printf(" %7.2f (%4.1fx)", perName, baseline / perName);
+                }
+            }
+            std::printf("\n");
+        }
+    }
+
+    std::printf("\n%s\n", allAgree ? "All kernels agree with toLower+find." : "Some kernels DISAGREE - see MISMATCH above!");
+    return allAgree ? 0 : 2;
+}
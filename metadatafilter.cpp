@@ -0,0 +1,466 @@
+#include "metadatafilter.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <limits>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <fcntl.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// glibc 2.28+ declares statx() (and its STATX_* masks) - anything older takes the fstatat() road
+#if defined(__linux__) && defined(STATX_BASIC_STATS)
+#define IYS_HAVE_STATX 1
+#endif
+
+namespace {
+
+#ifdef IYS_HAVE_STATX
+// Flipped for good the first time the kernel (or a seccomp filter) says "no statx here"
+std::atomic<bool> statxUnavailable{false};
+
+// Only what we need: on most filesystems that's the same cost, on network ones it can be a round trip saved
+unsigned int statxMaskFor(unsigned fields)
+{
+    unsigned int mask = 0;
+    if (fields & FieldSize) mask |= STATX_SIZE;
+    if (fields & FieldModified) mask |= STATX_MTIME;
+    if (fields & FieldChanged) mask |= STATX_CTIME;
+    if (fields & FieldOwner) mask |= STATX_UID;
+    if (fields & FieldMode) mask |= STATX_MODE;
+    return mask;
+}
+
+// The kernel says which fields it really filled in - it may hand back more, or (rarely) fewer
+void fillFromStatx(const struct statx& stx, FileMetadata& out)
+{
+    out.fields = 0;
+    if (stx.stx_mask & STATX_SIZE) out.fields |= FieldSize;
+    if (stx.stx_mask & STATX_MTIME) out.fields |= FieldModified;
+    if (stx.stx_mask & STATX_CTIME) out.fields |= FieldChanged;
+    if (stx.stx_mask & STATX_UID) out.fields |= FieldOwner;
+    if (stx.stx_mask & STATX_MODE) out.fields |= FieldMode;
+    out.size = stx.stx_size;
+    out.modified = stx.stx_mtime.tv_sec;
+    out.changed = stx.stx_ctime.tv_sec;
+    out.ownerUid = stx.stx_uid;
+    out.mode = stx.stx_mode;
+}
+#endif
+
+std::string formatTime(std::int64_t seconds)
+{
+    char text[32] = "?";
+    const std::time_t when = static_cast<std::time_t>(seconds);
+    if (const std::tm* local = std::localtime(&when)) {
+        std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", local);
+    }
+    return text;
+}
+
+// "from..to" with either end left open when it's the don't-care value
+template <typename T, typename Format>
+std::string formatRange(T from, T to, T anyFrom, T anyTo, Format format)
+{
+    std::string out = from != anyFrom ? format(from) : std::string();
+    out += "..";
+    if (to != anyTo) {
+        out += format(to);
+    }
+    return out;
+}
+
+#ifndef _WIN32
+// Copies what a plain struct stat has into the fields that were asked for
+void fillFromStat(const struct stat& st, unsigned fields, FileMetadata& out)
+{
+    out.fields = fields;
+    out.size = static_cast<std::uint64_t>(st.st_size);
+    out.modified = static_cast<std::int64_t>(st.st_mtime);
+    out.changed = static_cast<std::int64_t>(st.st_ctime);
+    out.ownerUid = static_cast<std::int64_t>(st.st_uid);
+    out.mode = static_cast<std::uint32_t>(st.st_mode);
+}
+#endif
+
+} // namespace
+
+std::string MetadataPredicates::describe() const
+{
+    std::string out;
+    auto add = [&out](const std::string& part) {
+        if (!out.empty()) {
+            out += ", ";
+        }
+        out += part;
+    };
+    if (checksSize()) {
+        add("size " + formatRange(minSize, maxSize, std::uint64_t(0), kAnySize,
+                                  [](std::uint64_t v) { return std::to_string(v); }) + " bytes");
+    }
+    if (checksModified()) {
+        add("modified " + formatRange(modifiedFrom, modifiedTo, kEarliest, kLatest, formatTime));
+    }
+    if (checksChanged()) {
+        add("changed " + formatRange(changedFrom, changedTo, kEarliest, kLatest, formatTime));
+    }
+    if (checksOwner()) {
+        add("owner " + std::to_string(ownerUid));
+    }
+    if (checksPermissions()) {
+        char mode[48];
+        if (permissionsAll != 0 && permissionsAny != 0) {
+            std::snprintf(mode, sizeof(mode), "permissions -%04o and /%04o", permissionsAll, permissionsAny);
+        } else {
+            std::snprintf(mode, sizeof(mode), "permissions %c%04o", permissionsAll != 0 ? '-' : '/',
+                          permissionsAll != 0 ? permissionsAll : permissionsAny);
+        }
+        add(mode);
+    }
+    return out;
+}
+
+MetadataFilter::MetadataFilter(const MetadataPredicates& predicates)
+    : limits(predicates)
+{
+    // 🧮 Work out once which fields the stat has to bring back
+    if (limits.checksSize()) wanted |= FieldSize;
+    if (limits.checksModified()) wanted |= FieldModified;
+    if (limits.checksChanged()) wanted |= FieldChanged;
+    if (limits.checksOwner()) wanted |= FieldOwner;
+    if (limits.checksPermissions()) wanted |= FieldMode;
+}
+
+bool MetadataFilter::accepts(const FileMetadata& metadata) const
+{
+    if ((metadata.fields & wanted) != wanted) {
+        return false; // The filesystem couldn't tell us something we need - can't vouch for it
+    }
+    // Cheapest comparisons first, but they're all just a couple of instructions
+    if ((wanted & FieldSize) && (metadata.size < limits.minSize || metadata.size > limits.maxSize)) {
+        return false;
+    }
+    if ((wanted & FieldModified) && (metadata.modified < limits.modifiedFrom || metadata.modified > limits.modifiedTo)) {
+        return false;
+    }
+    if ((wanted & FieldChanged) && (metadata.changed < limits.changedFrom || metadata.changed > limits.changedTo)) {
+        return false;
+    }
+    if ((wanted & FieldOwner) && metadata.ownerUid != limits.ownerUid) {
+        return false;
+    }
+    if (wanted & FieldMode) {
+        if ((metadata.mode & limits.permissionsAll) != limits.permissionsAll) {
+            return false;
+        }
+        if (limits.permissionsAny != 0 && (metadata.mode & limits.permissionsAny) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifndef _WIN32
+
+bool MetadataFilter::fetchAt(int dirFd, const char* name, unsigned fields, FileMetadata& out)
+{
+#ifdef IYS_HAVE_STATX
+    if (!statxUnavailable.load(std::memory_order_relaxed)) {
+        struct statx stx;
+        if (::statx(dirFd, name, AT_STATX_DONT_SYNC, statxMaskFor(fields), &stx) == 0) {
+            fillFromStatx(stx, out);
+            return true;
+        }
+        if (errno != ENOSYS && errno != EPERM) {
+            return false; // A real answer: the file is gone, or off limits
+        }
+        // 🐢 No statx on this kernel (or a sandbox blocks it) - fstatat from now on
+        statxUnavailable.store(true, std::memory_order_relaxed);
+    }
+#endif
+    struct stat st;
+    if (::fstatat(dirFd, name, &st, 0) != 0) {
+        return false;
+    }
+    fillFromStat(st, fields, out);
+    return true;
+}
+
+bool MetadataFilter::fetchPath(const std::string& path, unsigned fields, FileMetadata& out)
+{
+    return fetchAt(AT_FDCWD, path.c_str(), fields, out);
+}
+
+bool MetadataFilter::matchesAt(int dirFd, const char* name) const
+{
+    FileMetadata metadata;
+    return fetchAt(dirFd, name, wanted, metadata) && accepts(metadata);
+}
+
+const char* MetadataFilter::statMethod()
+{
+#ifdef IYS_HAVE_STATX
+    return statxUnavailable.load(std::memory_order_relaxed) ? "fstatat" : "statx";
+#else
+    return "fstatat";
+#endif
+}
+
+#ifdef IYS_HAVE_IO_URING
+unsigned int MetadataFilter::statxMask(unsigned fields)
+{
+    return statxMaskFor(fields);
+}
+
+void MetadataFilter::fromStatx(const struct statx& result, FileMetadata& out)
+{
+    fillFromStatx(result, out);
+}
+#endif
+
+#else // _WIN32
+
+bool MetadataFilter::fetchPath(const std::string& path, unsigned fields, FileMetadata& out)
+{
+    // The CRT's stat is one FindFirstFile-ish call - fine, since only name matches get here
+    struct _stat64 st;
+    if (::_wstat64(std::filesystem::path(path).c_str(), &st) != 0) {
+        return false;
+    }
+    out.fields = fields;
+    out.size = static_cast<std::uint64_t>(st.st_size);
+    out.modified = static_cast<std::int64_t>(st.st_mtime);
+    out.changed = static_cast<std::int64_t>(st.st_ctime); // Creation time, on Windows
+    out.ownerUid = 0;
+    out.mode = static_cast<std::uint32_t>(st.st_mode);
+    return true;
+}
+
+const char* MetadataFilter::statMethod()
+{
+    return "_wstat64";
+}
+
+#endif // _WIN32
+
+bool MetadataFilter::matchesPath(const std::string& path) const
+{
+    FileMetadata metadata;
+    return fetchPath(path, wanted, metadata) && accepts(metadata);
+}
+
+// --- The text syntax ---
+
+namespace {
+
+bool parseUnsigned(std::string_view text, std::uint64_t& value)
+{
+    if (text.empty()) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9' || value > (std::numeric_limits<std::uint64_t>::max() - 9) / 10) {
+            return false;
+        }
+        value = value * 10 + static_cast<std::uint64_t>(c - '0');
+    }
+    return true;
+}
+
+// Splits "FROM..TO" - no ".." at all leaves both halves the whole text
+void splitRange(std::string_view text, std::string_view& from, std::string_view& to, bool& isRange)
+{
+    const std::size_t dots = text.find("..");
+    isRange = dots != std::string_view::npos;
+    from = isRange ? text.substr(0, dots) : text;
+    to = isRange ? text.substr(dots + 2) : text;
+}
+
+// One point in time; upperEnd = a bare date means its last second rather than its first
+bool parseTimePoint(std::string_view text, std::int64_t now, bool upperEnd, std::int64_t& seconds)
+{
+    if (text.empty()) {
+        return false;
+    }
+    if (text[0] == '@') {
+        std::uint64_t epoch = 0;
+        if (!parseUnsigned(text.substr(1), epoch) || epoch > static_cast<std::uint64_t>(MetadataPredicates::kLatest)) {
+            return false;
+        }
+        seconds = static_cast<std::int64_t>(epoch);
+        return true;
+    }
+
+    // ⏳ An age: a number and a unit
+    std::int64_t unit = 0;
+    switch (text.back()) {
+    case 's': unit = 1; break;
+    case 'm': unit = 60; break;
+    case 'h': unit = 3600; break;
+    case 'd': unit = 86400; break;
+    case 'w': unit = 7 * 86400; break;
+    case 'y': unit = 365 * 86400; break;
+    default: break;
+    }
+    std::uint64_t amount = 0;
+    if (unit != 0 && parseUnsigned(text.substr(0, text.size() - 1), amount)) {
+        if (amount > static_cast<std::uint64_t>(MetadataPredicates::kLatest / unit)) {
+            return false;
+        }
+        seconds = now - static_cast<std::int64_t>(amount) * unit;
+        return true;
+    }
+
+    // 📅 A local date, maybe with a time
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    char tail = 0;
+    const std::string copy(text);
+    const int fields = std::sscanf(copy.c_str(), "%4d-%2d-%2d%c%2d:%2d:%2d", &year, &month, &day, &tail, &hour, &minute, &second);
+    const bool dateOnly = fields == 3;
+    if (!dateOnly && !(fields >= 6 && (tail == 'T' || tail == ' '))) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    std::tm local{};
+    local.tm_year = year - 1900;
+    local.tm_mon = month - 1;
+    local.tm_mday = dateOnly && upperEnd ? day + 1 : day; // mktime rolls the 32nd over into next month
+    local.tm_hour = hour;
+    local.tm_min = minute;
+    local.tm_sec = second;
+    local.tm_isdst = -1; // Let the C library work out summer time
+    const std::time_t when = std::mktime(&local);
+    if (when == static_cast<std::time_t>(-1)) {
+        return false;
+    }
+    seconds = static_cast<std::int64_t>(when) - (dateOnly && upperEnd ? 1 : 0);
+    return true;
+}
+
+} // namespace
+
+bool MetadataSyntax::parseSize(std::string_view text, std::uint64_t& bytes)
+{
+    if (text.empty()) {
+        return false;
+    }
+    unsigned shift = 0;
+    switch (text.back()) { // An optional K/M/G/T (powers of 1024)
+    case 'K': case 'k': shift = 10; break;
+    case 'M': case 'm': shift = 20; break;
+    case 'G': case 'g': shift = 30; break;
+    case 'T': case 't': shift = 40; break;
+    default: break;
+    }
+    if (shift != 0) {
+        text.remove_suffix(1);
+    }
+    if (!parseUnsigned(text, bytes) || bytes > (std::numeric_limits<std::uint64_t>::max() >> shift)) {
+        return false;
+    }
+    bytes <<= shift;
+    return true;
+}
+
+bool MetadataSyntax::parseSizeRange(std::string_view text, std::uint64_t& from, std::uint64_t& to)
+{
+    std::string_view low, high;
+    bool isRange = false;
+    splitRange(text, low, high, isRange);
+    std::uint64_t newFrom = 0;
+    std::uint64_t newTo = MetadataPredicates::kAnySize;
+    if (!isRange || !low.empty()) {
+        if (!parseSize(low, newFrom)) return false;
+    }
+    if (!isRange || !high.empty()) {
+        if (!parseSize(high, newTo)) return false;
+    }
+    if ((isRange && low.empty() && high.empty()) || newFrom > newTo) {
+        return false;
+    }
+    from = newFrom;
+    to = newTo;
+    return true;
+}
+
+bool MetadataSyntax::parseTimeRange(std::string_view text, std::int64_t now, std::int64_t& from, std::int64_t& to)
+{
+    std::string_view low, high;
+    bool isRange = false;
+    splitRange(text, low, high, isRange);
+    if (!isRange) {
+        // A lone date is that whole day; a lone age or timestamp means "since then" (so "7d" = "7d..")
+        const bool dateOnly = text.size() == 10 && text[4] == '-' && text[7] == '-';
+        std::int64_t newFrom = 0;
+        std::int64_t newTo = MetadataPredicates::kLatest;
+        if (!parseTimePoint(text, now, false, newFrom) || (dateOnly && !parseTimePoint(text, now, true, newTo))) {
+            return false;
+        }
+        from = newFrom;
+        to = newTo;
+        return true;
+    }
+    std::int64_t newFrom = MetadataPredicates::kEarliest;
+    std::int64_t newTo = MetadataPredicates::kLatest;
+    if (!low.empty() && !parseTimePoint(low, now, false, newFrom)) return false;
+    if (!high.empty() && !parseTimePoint(high, now, true, newTo)) return false;
+    if ((low.empty() && high.empty()) || newFrom > newTo) {
+        return false;
+    }
+    from = newFrom;
+    to = newTo;
+    return true;
+}
+
+bool MetadataSyntax::parseOwner(const std::string& text, std::int64_t& uid)
+{
+    std::uint64_t number = 0;
+    if (parseUnsigned(text, number)) {
+        if (number > 0xFFFFFFFFull) return false;
+        uid = static_cast<std::int64_t>(number);
+        return true;
+    }
+#ifndef _WIN32
+    if (const passwd* user = ::getpwnam(text.c_str())) {
+        uid = static_cast<std::int64_t>(user->pw_uid);
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool MetadataSyntax::parsePermissions(std::string_view text, std::uint32_t& all, std::uint32_t& any)
+{
+    bool wantsAny = false;
+    if (!text.empty() && (text[0] == '-' || text[0] == '/')) {
+        wantsAny = text[0] == '/';
+        text.remove_prefix(1);
+    }
+    if (text.empty() || text.size() > 4) {
+        return false;
+    }
+    std::uint32_t bits = 0;
+    for (char c : text) {
+        if (c < '0' || c > '7') {
+            return false;
+        }
+        bits = bits * 8 + static_cast<std::uint32_t>(c - '0');
+    }
+    if (bits == 0) {
+        return false; // "No bits" would test nothing
+    }
+    (wantsAny ? any : all) = bits;
+    return true;
+}
@@ -0,0 +1,137 @@
+#ifndef METADATAFILTER_H
+#define METADATAFILTER_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#ifdef IYS_HAVE_IO_URING
+struct statx; // <sys/stat.h>
+#endif
+
+// 🗃️ Filtering by Size, Time and Owner 🗃️
+// "Files over 1 GB touched in the last week" used to mean a search plus a separate stat pass
+// over its output. Now SearchConfig::metadata carries those predicates and the search checks
+// them itself - but only AFTER the name checks, because those are free (the name comes with
+// the directory entry) while a stat is a syscall per file. Most names don't pass, so most
+// files never get stat'ed at all.
+//
+// On Linux the stat is a statx() that asks only for the fields the predicates look at
+// (STATX_SIZE, STATX_MTIME, ...) with AT_STATX_DONT_SYNC, so network filesystems don't
+// go to the server just for us. Older kernels (or sandboxes that block statx) fall back to
+// fstatat(), once and for good. Symlinks are followed - the walk reports a link to a file as
+// a file, so the link's target is what gets filtered. Windows uses _wstat64, where the
+// "change time" is the creation time and there are no owners to speak of.
+//
+// No predicates set = isActive() is false and the search doesn't stat anything.
+
+// What to check - every field has a "don't care" default, so only what's set costs anything
+struct MetadataPredicates {
+    static constexpr std::uint64_t kAnySize = std::numeric_limits<std::uint64_t>::max();
+    static constexpr std::int64_t kEarliest = std::numeric_limits<std::int64_t>::min();
+    static constexpr std::int64_t kLatest = std::numeric_limits<std::int64_t>::max();
+
+    std::uint64_t minSize = 0;             // Bytes, inclusive
+    std::uint64_t maxSize = kAnySize;      // Bytes, inclusive
+    std::int64_t modifiedFrom = kEarliest; // mtime, seconds since the epoch, inclusive
+    std::int64_t modifiedTo = kLatest;
+    std::int64_t changedFrom = kEarliest;  // ctime (inode change), same deal
+    std::int64_t changedTo = kLatest;
+    std::int64_t ownerUid = -1;            // -1 = anybody's
+    std::uint32_t permissionsAll = 0;      // Every one of these mode bits must be set (like find -perm -MODE)
+    std::uint32_t permissionsAny = 0;      // At least one of these must be (like find -perm /MODE); 0 = no test
+
+    bool checksSize() const { return minSize > 0 || maxSize != kAnySize; }
+    bool checksModified() const { return modifiedFrom != kEarliest || modifiedTo != kLatest; }
+    bool checksChanged() const { return changedFrom != kEarliest || changedTo != kLatest; }
+    bool checksOwner() const { return ownerUid >= 0; }
+    bool checksPermissions() const { return permissionsAll != 0 || permissionsAny != 0; }
+    bool isActive() const
+    {
+        return checksSize() || checksModified() || checksChanged() || checksOwner() || checksPermissions();
+    }
+
+    // One line for humans, e.g. "size 1048576.. bytes, owner 1000" (empty when nothing is set)
+    std::string describe() const;
+};
+
+// The fields a stat can fill in - a predicate only asks for the ones it needs
+enum MetadataField : unsigned {
+    FieldSize = 1u << 0,
+    FieldModified = 1u << 1,
+    FieldChanged = 1u << 2,
+    FieldOwner = 1u << 3,
+    FieldMode = 1u << 4
+};
+
+struct FileMetadata {
+    unsigned fields = 0; // Which of the below are filled in (MetadataField bits)
+    std::uint64_t size = 0;
+    std::int64_t modified = 0; // Seconds since the epoch
+    std::int64_t changed = 0;
+    std::int64_t ownerUid = 0;
+    std::uint32_t mode = 0;    // Permission bits (and file type bits, where the platform has them)
+};
+
+// 🔎 The predicates, compiled once per search (CompiledQuery holds one) and shared by every worker
+class MetadataFilter
+{
+public:
+    MetadataFilter() = default;
+    explicit MetadataFilter(const MetadataPredicates& predicates);
+
+    bool isActive() const { return wanted != 0; }
+    unsigned wantedFields() const { return wanted; }
+    const MetadataPredicates& predicates() const { return limits; }
+
+#ifndef _WIN32
+    // Stats name relative to dirFd (AT_FDCWD and a full path work too) and checks it.
+    // False when a predicate says no - or when the file can't be stat'ed (it's gone, say).
+    bool matchesAt(int dirFd, const char* name) const;
+#endif
+    // The same from a full path (the full-path walk and the index use this one)
+    bool matchesPath(const std::string& path) const;
+
+    // Just the check, on fields somebody already has. A field the stat couldn't fill in fails its predicate.
+    bool accepts(const FileMetadata& metadata) const;
+
+    // Fetches the given MetadataField bits - one statx() (or fallback) call. False if the file can't be stat'ed.
+#ifndef _WIN32
+    static bool fetchAt(int dirFd, const char* name, unsigned fields, FileMetadata& out);
+#endif
+    static bool fetchPath(const std::string& path, unsigned fields, FileMetadata& out);
+
+    // Which call fetchAt() is using: "statx", "fstatat" (after a fallback) or "_wstat64"
+    static const char* statMethod();
+
+#ifdef IYS_HAVE_IO_URING
+    // For statx calls somebody else makes (the io_uring batches, see uringbatch.h):
+    // the mask that asks for these MetadataField bits, and the answer turned into FileMetadata
+    static unsigned int statxMask(unsigned fields);
+    static void fromStatx(const struct statx& result, FileMetadata& out);
+#endif
+
+private:
+    MetadataPredicates limits;
+    unsigned wanted = 0; // MetadataField bits the predicates need (0 = no predicates, never stat)
+};
+
+// 🔤 The little text syntax the command line and the window share. All return false on bad input.
+namespace MetadataSyntax {
+// Bytes with an optional K/M/G/T suffix (powers of 1024): "4096", "512K", "1G"
+bool parseSize(std::string_view text, std::uint64_t& bytes);
+// "FROM..TO", either end optional ("1G..", "..10M", "1M..1G"); a lone SIZE means exactly that
+bool parseSizeRange(std::string_view text, std::uint64_t& from, std::uint64_t& to);
+// "FROM..TO" of points in time, either end optional. A point is an age back from now ("30m",
+// "12h", "7d", "2w", "1y"), a local date "2024-03-01" (as an upper end: the whole day),
+// a local "2024-03-01T14:30[:00]", or "@SECONDS" since the epoch. "7d.." = the last week.
+// Without "..": a date is that whole day, anything else means "since then" ("7d" = "7d..").
+bool parseTimeRange(std::string_view text, std::int64_t now, std::int64_t& from, std::int64_t& to);
+// A user name or a numeric uid (names need a POSIX user database)
+bool parseOwner(const std::string& text, std::int64_t& uid);
+// Octal mode bits: "644" or "-644" = all of them set, "/111" = any of them set
+bool parsePermissions(std::string_view text, std::uint32_t& all, std::uint32_t& any);
+} // namespace MetadataSyntax
+
+#endif // METADATAFILTER_H
@@ -0,0 +1,218 @@
+#include "multimatch.h"
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <utility>
+
+#include "simdmatch.h" // SimdMatch::foldAscii
+
+namespace {
+
+constexpr std::size_t kMaxTableEntries = std::size_t(1) << 24; // 64 MB of transitions - thousands of terms still fit
+constexpr std::uint32_t kNoState = UINT32_MAX;
+
+bool isSeparator(char c)
+{
+#ifdef _WIN32
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+}
+
+} // namespace
+
+bool MultiTermMatcher::compile(const std::vector<std::string>& termList, bool caseInsensitive, std::string& problem)
+{
+    *this = MultiTermMatcher();
+    terms = termList;
+
+    std::vector<std::string> folded;
+    folded.reserve(terms.size());
+    for (const std::string& term : terms) {
+        folded.push_back(caseInsensitive ? SimdMatch::foldAscii(term) : term);
+        matchesEverything = matchesEverything || term.empty();
+    }
+
+    // 🔤 Byte classes: every byte some term uses gets a column, everything else shares column 0
+    // (with folding, 'A' rides along in 'a's column). If every byte is used, they all get their own.
+    std::array<bool, 256> used{};
+    for (const std::string& term : folded) {
+        for (const char c : term) {
+            used[static_cast<unsigned char>(c)] = true;
+        }
+    }
+    const std::size_t usedCount = static_cast<std::size_t>(std::count(used.begin(), used.end(), true));
+    classCount = usedCount == 256 ? 256 : static_cast<std::uint32_t>(usedCount + 1);
+    for (unsigned b = 0, nextClass = usedCount == 256 ? 0 : 1; b < 256; ++b) {
+        if (used[b]) {
+            byteClasses[b] = static_cast<std::uint8_t>(nextClass++);
+        }
+    }
+    if (caseInsensitive) {
+        for (unsigned b = 'A'; b <= 'Z'; ++b) {
+            byteClasses[b] = byteClasses[b + 32];
+        }
+    }
+
+    // 🌳 The trie: state 0 is the root, kNoState marks "no child here (yet)"
+    std::size_t totalBytes = 0;
+    for (const std::string& term : folded) {
+        totalBytes += term.size();
+    }
+    if ((totalBytes + 1) * classCount > kMaxTableEntries) {
+        problem = "too many terms to match in one pass (" + std::to_string(terms.size()) + " terms, "
+                  + std::to_string(totalBytes) + " bytes) - split them up";
+        *this = MultiTermMatcher();
+        return false;
+    }
+    std::vector<std::uint32_t> delta(classCount, kNoState);
+    std::vector<std::vector<std::uint32_t>> own(1); // Terms ending exactly at each state
+    for (std::uint32_t id = 0; id < folded.size(); ++id) {
+        std::uint32_t state = 0;
+        for (const char c : folded[id]) {
+            const std::size_t slot = std::size_t(state) * classCount + byteClasses[static_cast<unsigned char>(c)];
+            if (delta[slot] == kNoState) {
+                delta[slot] = static_cast<std::uint32_t>(own.size());
+                own.emplace_back();
+                delta.resize(delta.size() + classCount, kNoState);
+            }
+            state = delta[slot];
+        }
+        own[state].push_back(id);
+    }
+    const std::size_t states = own.size();
+
+    // 🔗 Breadth first: suffix links, and every missing edge filled in from the suffix link's
+    // (already complete) row - the trie turns into a plain DFA, no link-chasing at match time
+    std::vector<std::uint32_t> link(states, 0);
+    std::vector<std::vector<std::uint32_t>> ends(states); // own terms + the suffix link's, sorted
+    std::vector<std::uint32_t> order;                     // BFS order
+    order.reserve(states);
+    std::deque<std::uint32_t> pending;
+    ends[0] = own[0];
+    for (std::uint32_t c = 0; c < classCount; ++c) {
+        std::uint32_t& child = delta[c];
+        if (child == kNoState) {
+            child = 0;
+        } else {
+            pending.push_back(child); // Suffix link: the root
+        }
+    }
+    order.push_back(0);
+    while (!pending.empty()) {
+        const std::uint32_t state = pending.front();
+        pending.pop_front();
+        order.push_back(state);
+        std::set_union(own[state].begin(), own[state].end(), ends[link[state]].begin(), ends[link[state]].end(),
+                       std::back_inserter(ends[state]));
+        for (std::uint32_t c = 0; c < classCount; ++c) {
+            std::uint32_t& child = delta[std::size_t(state) * classCount + c];
+            const std::uint32_t fallback = delta[std::size_t(link[state]) * classCount + c];
+            if (child == kNoState) {
+                child = fallback;
+            } else {
+                link[child] = fallback;
+                pending.push_back(child);
+            }
+        }
+    }
+
+    // 🔢 Renumber: states where a term ends go last, so matchesAny() needs one compare per byte
+    std::vector<std::uint32_t> renumbered(states);
+    std::uint32_t nextId = 0;
+    for (const bool matching : {false, true}) {
+        for (const std::uint32_t state : order) {
+            if (ends[state].empty() != matching) {
+                renumbered[state] = nextId++;
+            }
+        }
+    }
+    // (The root comes first either way: it's first in BFS order, and if an empty term makes it
+    // matching, every state is - they all fall back to the root - so nothing gets moved at all)
+    const auto firstMatching = static_cast<std::uint32_t>(
+        std::count_if(order.begin(), order.end(), [&](std::uint32_t state) { return ends[state].empty(); }));
+
+    table.assign(states * classCount, 0);
+    std::vector<std::vector<std::uint32_t>> rowEnds(states);
+    for (std::uint32_t state = 0; state < states; ++state) {
+        const std::size_t row = std::size_t(renumbered[state]) * classCount;
+        for (std::uint32_t c = 0; c < classCount; ++c) {
+            table[row + c] = renumbered[delta[std::size_t(state) * classCount + c]] * classCount;
+        }
+        rowEnds[renumbered[state]] = std::move(ends[state]);
+    }
+    firstMatchingState = firstMatching * classCount;
+    outputStart.clear();
+    outputStart.reserve(states + 1);
+    for (const auto& row : rowEnds) {
+        outputStart.push_back(static_cast<std::uint32_t>(outputs.size()));
+        outputs.insert(outputs.end(), row.begin(), row.end());
+    }
+    outputStart.push_back(static_cast<std::uint32_t>(outputs.size()));
+    return true;
+}
+
+void MultiTermMatcher::matchingTerms(std::string_view name, std::vector<std::uint32_t>& ids) const
+{
+    ids.clear();
+    auto collect = [&](std::uint32_t state) {
+        const std::uint32_t row = state / classCount;
+        ids.insert(ids.end(), outputs.begin() + outputStart[row], outputs.begin() + outputStart[row + 1]);
+    };
+    const std::uint32_t* next = table.data();
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(name.data());
+    std::uint32_t state = 0;
+    collect(state); // The empty terms, if any
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        state = next[state + byteClasses[bytes[i]]];
+        if (state >= firstMatchingState) {
+            collect(state);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+// --- TermGroups ---
+
+TermGroups::TermGroups(MultiTermMatcher matcher)
+    : terms(std::move(matcher))
+    , perTerm(terms.termCount(), 0)
+    , groups(terms.termCount())
+{
+}
+
+std::size_t TermGroups::add(std::string_view path)
+{
+    std::size_t nameStart = path.size();
+    while (nameStart > 0 && !isSeparator(path[nameStart - 1])) {
+        --nameStart;
+    }
+    terms.matchingTerms(path.substr(nameStart), scratch);
+    for (const std::uint32_t id : scratch) {
+        auto& batches = groups[id];
+        if (batches.empty() || batches.back()->arena.size() >= kBatchBytes) {
+            batches.push_back(std::make_shared<ResultBatch>());
+            batches.back()->termId = static_cast<std::int32_t>(id);
+        }
+        batches.back()->add(path);
+        perTerm[id]++;
+    }
+    return scratch.size();
+}
+
+std::vector<ResultBatchPtr> TermGroups::takeBatches()
+{
+    std::vector<ResultBatchPtr> all;
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& batches : groups) {
+        for (auto& batch : batches) {
+            batch->sealedAt = now;
+            all.push_back(std::move(batch));
+        }
+        batches.clear();
+    }
+    return all;
+}
@@ -0,0 +1,111 @@
+#ifndef MULTIMATCH_H
+#define MULTIMATCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "resultbatch.h" // TermGroups hands its groups out as batches
+
+// 🎯 Many Terms, One Walk 🎯
+// Batch jobs used to scan the same tree once per term - twenty terms, twenty full walks,
+// when the disk (or the page cache) is the expensive part and the name checks are cheap.
+// SearchConfig::searchTerms lets one walk answer all of them: every term goes into ONE
+// Aho-Corasick automaton, a trie of the terms whose dead ends are wired back to the longest
+// suffix that is still a prefix of some term. Reading a name byte by byte through it finds
+// every term in the name, however many terms there are, in one pass - one table lookup per
+// byte, like the glob/regex automaton (dfamatch.h), with the same byte-class squeeze.
+//
+// Two speeds:
+//   matchesAny(name)    - the hot path for the walk: stops at the first term it sees
+//   matchingTerms(name) - only for names that passed: WHICH terms are in there (their IDs,
+//                         the positions in SearchConfig::searchTerms)
+//
+// Terms are folded up front when the search is case-insensitive, and the table sends
+// 'A'..'Z' down the same columns as 'a'..'z' - ASCII only, like the rest of the search.
+
+class MultiTermMatcher
+{
+public:
+    MultiTermMatcher() = default; // No terms: matches nothing
+
+    // Builds the automaton. Returns false (saying why in problem) if the table would get too big.
+    bool compile(const std::vector<std::string>& terms, bool caseInsensitive, std::string& problem);
+
+    // 🔥 The hot path - called once per scanned name
+    bool matchesAny(std::string_view name) const
+    {
+        if (matchesEverything) {
+            return true; // One of the terms is empty
+        }
+        const std::uint32_t* next = table.data();
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(name.data());
+        std::uint32_t state = 0; // The root
+        for (std::size_t i = 0; i < name.size(); ++i) {
+            state = next[state + byteClasses[bytes[i]]];
+            if (state >= firstMatchingState) {
+                return true; // Some term ends right here - no need to read on
+            }
+        }
+        return false;
+    }
+
+    // Every term found in the name: IDs in ascending order, each once. Clears ids first.
+    void matchingTerms(std::string_view name, std::vector<std::uint32_t>& ids) const;
+
+    std::size_t termCount() const { return terms.size(); }
+    const std::string& term(std::size_t id) const { return terms[id]; } // As given (not folded)
+    std::size_t stateCount() const { return table.size() / classCount; }
+    std::size_t byteClassCount() const { return classCount; }
+
+private:
+    // Premultiplied like DfaMatcher's table (state * classCount). States that complete a term
+    // are numbered last, so "did a term just end?" is a single compare in matchesAny().
+    // (The defaults are the automaton for no terms at all: one root that loops on itself.)
+    std::array<std::uint8_t, 256> byteClasses{};
+    std::vector<std::uint32_t> table = std::vector<std::uint32_t>(1, 0);
+    std::uint32_t classCount = 1;
+    std::uint32_t firstMatchingState = 1;
+    bool matchesEverything = false;
+
+    // Per state (table row): which terms end there, its own and those of its suffix links
+    std::vector<std::uint32_t> outputStart = std::vector<std::uint32_t>(2, 0); // Row r's IDs are outputs[outputStart[r] .. outputStart[r + 1])
+    std::vector<std::uint32_t> outputs;
+
+    std::vector<std::string> terms;
+};
+
+// 🗂️ Sorts a multi-term search's hits into one group per term. A path with three of the
+// terms in its name lands in three groups. Not thread-safe - feed it from one thread at a
+// time (the search callback already is: the engine serializes it).
+class TermGroups
+{
+public:
+    explicit TermGroups(MultiTermMatcher matcher);
+
+    TermGroups(const TermGroups&) = delete;
+    TermGroups& operator=(const TermGroups&) = delete;
+
+    // Tags the path with every term in its file name and files it under each. Returns how many.
+    std::size_t add(std::string_view path);
+
+    const std::vector<std::uint64_t>& counts() const { return perTerm; } // Hits per term, by ID
+    const MultiTermMatcher& matcher() const { return terms; }
+
+    // Every group, term by term, as batches tagged with their termId (a big group takes
+    // several). Empties the groups; the counts stay.
+    std::vector<ResultBatchPtr> takeBatches();
+
+private:
+    static constexpr std::size_t kBatchBytes = 1024 * 1024; // Same box size as ResultBatcher's
+
+    const MultiTermMatcher terms;
+    std::vector<std::uint64_t> perTerm;
+    std::vector<std::vector<std::shared_ptr<ResultBatch>>> groups; // Per term: its batches, the last one still filling
+    std::vector<std::uint32_t> scratch; // matchingTerms() output, reused
+};
+
+#endif // MULTIMATCH_H
@@ -0,0 +1,88 @@
+#include "resultbatch.h"
+
+ResultBatcher::ResultBatcher(Sink sink, std::size_t maxResults, std::size_t maxBytes, std::chrono::milliseconds maxAge)
+    : sink(std::move(sink)),
+    maxResults(maxResults),
+    maxBytes(maxBytes),
+    maxAge(maxAge)
+{
+}
+
+void ResultBatcher::add(std::string_view path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingLocked().add(path);
+    sendIfFullLocked();
+}
+
+void ResultBatcher::add(std::string_view path, std::uint64_t line, std::string_view snippet)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingLocked().add(path, line, snippet);
+    sendIfFullLocked();
+}
+
+void ResultBatcher::addToGroup(std::string_view path, std::uint64_t group)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingLocked().addToGroup(path, group);
+    sendIfFullLocked();
+}
+
+ResultBatch& ResultBatcher::pendingLocked()
+{
+    if (!pending) {
+        // A fresh box - sized up front so filling it doesn't reallocate (much)
+        pending = std::make_unique<ResultBatch>();
+        pending->ends.reserve(maxResults);
+        pending->arena.reserve(maxBytes);
+        pendingSince = Clock::now();
+    }
+    return *pending;
+}
+
+void ResultBatcher::sendIfFullLocked()
+{
+    if (pending->size() >= maxResults || pending->arena.size() + pending->snippetArena.size() >= maxBytes
+        || Clock::now() - pendingSince >= maxAge) {
+        sendLocked();
+    }
+}
+
+void ResultBatcher::flushIfDue()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending && Clock::now() - pendingSince >= maxAge) {
+        sendLocked();
+    }
+}
+
+void ResultBatcher::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending) {
+        sendLocked();
+    }
+}
+
+std::uint64_t ResultBatcher::batchesSent() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return batches;
+}
+
+std::uint64_t ResultBatcher::resultsSent() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return results;
+}
+
+void ResultBatcher::sendLocked()
+{
+    // 📮 Off it goes - the batch now belongs to whoever receives it
+    batches++;
+    results += pending->size();
+    pending->sealedAt = Clock::now();
+    ResultBatchPtr batch(std::move(pending));
+    sink(std::move(batch));
+}
@@ -0,0 +1,128 @@
+#ifndef RESULTBATCH_H
+#define RESULTBATCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 📦 Results, by the Box 📦
+// Handing every single match to the GUI as its own QString + queued signal means one heap
+// string and one posted event per file - a search that matches half a million files buries
+// the GUI's event loop and the window ends up seconds behind the workers.
+// So the workers pack matches into a ResultBatch instead: one string arena holding every
+// path back to back, plus where each one ends. A full batch is handed over as a shared
+// pointer - the paths are never copied again on the way, the GUI reads them right out of
+// the arena.
+
+struct ResultBatch
+{
+    std::string arena;                 // Every path, back to back (no separators)
+    std::vector<std::uint32_t> ends;   // Where path i stops in the arena
+    std::chrono::steady_clock::time_point sealedAt; // When the batcher sent it off (for queue-delay stats)
+    std::int32_t termId = -1;          // Multi-term searches: which SearchConfig::searchTerms entry these matched (-1 = not grouped)
+
+    // Content searches (SearchConfig::contentTerm) also say WHERE in the file: one line number and
+    // one snippet (the matching line, trimmed) per path. All empty for filename-only results.
+    std::vector<std::uint64_t> lineNumbers;
+    std::string snippetArena;
+    std::vector<std::uint32_t> snippetEnds;
+
+    // Duplicate searches (SearchConfig::findDuplicates): the group each path is in, 1-based. A group's
+    // paths come one after another (maybe spread over two batches). Empty for every other search.
+    std::vector<std::uint64_t> groupIds;
+
+    std::size_t size() const { return ends.size(); }
+    bool hasSnippets() const { return !lineNumbers.empty(); }
+    bool hasGroups() const { return !groupIds.empty(); }
+    bool empty() const { return ends.empty(); }
+
+    std::string_view path(std::size_t i) const
+    {
+        const std::uint32_t start = i == 0 ? 0 : ends[i - 1];
+        return std::string_view(arena.data() + start, ends[i] - start);
+    }
+
+    void add(std::string_view path)
+    {
+        arena.append(path.data(), path.size());
+        ends.push_back(static_cast<std::uint32_t>(arena.size()));
+    }
+
+    std::string_view snippet(std::size_t i) const
+    {
+        const std::uint32_t start = i == 0 ? 0 : snippetEnds[i - 1];
+        return std::string_view(snippetArena.data() + start, snippetEnds[i] - start);
+    }
+
+    // A content match: the file, the line it's on (1-based) and that line
+    void add(std::string_view path, std::uint64_t line, std::string_view lineSnippet)
+    {
+        add(path);
+        lineNumbers.push_back(line);
+        snippetArena.append(lineSnippet.data(), lineSnippet.size());
+        snippetEnds.push_back(static_cast<std::uint32_t>(snippetArena.size()));
+    }
+
+    // One copy in a duplicate group
+    void addToGroup(std::string_view path, std::uint64_t group)
+    {
+        add(path);
+        groupIds.push_back(group);
+    }
+};
+
+// Read-only once it leaves the worker, so any number of threads may look at it
+using ResultBatchPtr = std::shared_ptr<const ResultBatch>;
+
+// 🧺 Fills batches from the traversal workers and sends each one off when it's full
+// (maxResults paths or maxBytes of arena) or when its oldest path has waited maxAge.
+// Everything is thread-safe; the sink is called with the lock held, so batches arrive in order.
+class ResultBatcher
+{
+public:
+    using Sink = std::function<void(ResultBatchPtr)>;
+
+    explicit ResultBatcher(Sink sink,
+                           std::size_t maxResults = 8192,
+                           std::size_t maxBytes = 1024 * 1024,
+                           std::chrono::milliseconds maxAge = std::chrono::milliseconds(100));
+
+    void add(std::string_view path);
+    void add(std::string_view path, std::uint64_t line, std::string_view snippet); // A content match
+    void addToGroup(std::string_view path, std::uint64_t group);                   // A duplicate
+
+    // The time limit, for when no new path comes along to check it (call it every so often)
+    void flushIfDue();
+
+    // Sends whatever is waiting, right now - call this before announcing the search is over
+    void flush();
+
+    std::uint64_t batchesSent() const;
+    std::uint64_t resultsSent() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ResultBatch& pendingLocked(); // The box being filled (a fresh one if there is none)
+    void sendIfFullLocked();
+    void sendLocked();
+
+    Sink sink;
+    const std::size_t maxResults;
+    const std::size_t maxBytes;
+    const std::chrono::milliseconds maxAge;
+
+    mutable std::mutex mutex;
+    std::unique_ptr<ResultBatch> pending;
+    Clock::time_point pendingSince;
+    std::uint64_t batches = 0;
+    std::uint64_t results = 0;
+};
+
+#endif // RESULTBATCH_H
@@ -0,0 +1,259 @@
+// ⏱️ Result Hand-off Benchmark ⏱️
+// How long does the GUI side need to swallow a flood of matches, and how much memory does
+// each row cost once it's there? A producer thread plays the traversal workers, the main
+// thread's event loop plays the window (with a sorting proxy on top, like the real one):
+//   per-result / items    one QString + queued event per match, two QStandardItems per row (the original way)
+//   batched / items       ResultBatcher boxes, still QStandardItems per row
+//   batched / columnar    ResultBatcher boxes into ResultsModel (what the window uses now)
+//
+//   iys-results-bench                1,000,000 results, sorted proxy like the real window
+//   iys-results-bench 250000         a different count
+//   iys-results-bench 1000000 --unsorted   without sorting (pure model cost)
+//
+// Prints total time, how far the "GUI" trailed the producer after it was done, how many
+// events went through the event loop, and heap bytes per row for both models.
+
+#include "resultbatch.h"
+#include "resultsmodel.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QList>
+#include <QSortFilterProxyModel>
+#include <QStandardItem>
+#include <QStandardItemModel>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define IYS_HAVE_MALLINFO2 1
+#endif
+
+namespace {
+
+struct Outcome {
+    double totalSeconds = 0;  // First result produced -> last row in the model
+    double lagSeconds = 0;    // Producer done -> last row in the model (how far the GUI trailed)
+    std::uint64_t events = 0; // Queued events the GUI thread had to process
+    int rows = 0;
+};
+
+// Paths shaped like a real search hit list: a few thousand folders, lots of files each
+std::vector<std::string> syntheticPaths(std::size_t count)
+{
+    std::vector<std::string> paths;
+    paths.reserve(count);
+    const char* extensions[] = {".txt", ".cpp", ".h", ".jpg", ".json", ".md", ".log", ".so"};
+    for (std::size_t i = 0; i < count; ++i) {
+        paths.push_back("/home/user/projects/area" + std::to_string(i % 97) + "/module" + std::to_string(i % 3001)
+                        + "/file_" + std::to_string((i * 2654435761u) % 1000003) + extensions[i % 8]);
+    }
+    return paths;
+}
+
+// Heap bytes in use right now (glibc), or 0 when we can't tell
+std::size_t heapInUse()
+{
+#ifdef IYS_HAVE_MALLINFO2
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// One row, the way the window used to build it in handleResultFound
+void appendItemRow(QStandardItemModel& model, const QString& path)
+{
+    QFileInfo fileInfo(path);
+    QStandardItem* nameItem = new QStandardItem(fileInfo.fileName());
+    QStandardItem* pathItem = new QStandardItem(path);
+    nameItem->setToolTip(path);
+    nameItem->setEditable(false);
+    pathItem->setEditable(false);
+    model.appendRow(QList<QStandardItem*>{nameItem, pathItem});
+}
+
+// The same rows from a batch (what the window did between batching and the columnar model)
+int appendItemBatch(QStandardItemModel& model, const ResultBatch& batch)
+{
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const std::string_view path = batch.path(i);
+        appendItemRow(model, QString::fromUtf8(path.data(), static_cast<qsizetype>(path.size())));
+    }
+    return static_cast<int>(batch.size());
+}
+
+// Runs a producer thread against the main thread's event loop until every row has landed.
+// produce() posts events; each posted event bumps outcome.rows and outcome.events itself.
+Outcome deliver(std::size_t total, Outcome& outcome, QEventLoop& loop, const std::function<void()>& produce)
+{
+    std::atomic<qint64> producerDoneAt{0};
+    QElapsedTimer timer;
+    timer.start();
+    std::thread producer([&] {
+        produce();
+        producerDoneAt = timer.nsecsElapsed();
+    });
+    if (static_cast<std::size_t>(outcome.rows) < total) {
+        loop.exec();
+    }
+    producer.join();
+
+    const qint64 end = timer.nsecsElapsed();
+    outcome.totalSeconds = end / 1e9;
+    outcome.lagSeconds = (end - producerDoneAt.load()) / 1e9;
+    return outcome;
+}
+
+// 🐌 One event per match into QStandardItems - the original resultFound -> handleResultFound path
+Outcome perResultItems(const std::vector<std::string>& paths, bool sorted)
+{
+    QStandardItemModel model(0, 2);
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    if (sorted) {
+        proxy.sort(0, Qt::AscendingOrder);
+    }
+    QObject receiver;
+    QEventLoop loop;
+    Outcome outcome;
+    return deliver(paths.size(), outcome, loop, [&] {
+        for (const auto& p : paths) {
+            QMetaObject::invokeMethod(&receiver, [&, path = QString::fromStdString(p)] {
+                appendItemRow(model, path);
+                outcome.events++;
+                if (++outcome.rows == static_cast<int>(paths.size())) {
+                    loop.quit();
+                }
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+// 📦 Boxes of results into whatever model append() feeds
+template <typename Append>
+Outcome batchedInto(const std::vector<std::string>& paths, Append append)
+{
+    QObject receiver;
+    QEventLoop loop;
+    Outcome outcome;
+    ResultBatcher batcher([&](ResultBatchPtr batch) {
+        QMetaObject::invokeMethod(&receiver, [&, batch] {
+            outcome.rows += append(*batch);
+            outcome.events++;
+            if (outcome.rows == static_cast<int>(paths.size())) {
+                loop.quit();
+            }
+        }, Qt::QueuedConnection);
+    });
+    return deliver(paths.size(), outcome, loop, [&] {
+        for (const auto& p : paths) {
+            batcher.add(p);
+        }
+        batcher.flush();
+    });
+}
+
+Outcome batchedItems(const std::vector<std::string>& paths, bool sorted)
+{
+    QStandardItemModel model(0, 2);
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    if (sorted) {
+        proxy.sort(0, Qt::AscendingOrder);
+    }
+    return batchedInto(paths, [&](const ResultBatch& batch) { return appendItemBatch(model, batch); });
+}
+
+Outcome batchedColumnar(const std::vector<std::string>& paths, bool sorted)
+{
+    ResultsModel model;
+    ResultsProxyModel proxy;
+    proxy.setSourceModel(&model);
+    if (sorted) {
+        proxy.sort(ResultsModel::NameColumn, Qt::AscendingOrder);
+    }
+    return batchedInto(paths, [&](const ResultBatch& batch) { return model.appendBatch(batch); });
+}
+
+void print(const char* label, const Outcome& outcome)
+{
+    std::printf("%-22s %8.2f s total %8.2f s behind the producer %9llu events %11.0f results/s\n", label,
+                outcome.totalSeconds, outcome.lagSeconds, static_cast<unsigned long long>(outcome.events),
+                outcome.rows / outcome.totalSeconds);
+}
+
+// 📏 Heap bytes per row of each model, filled straight from batches (no proxy, no event loop)
+void measureMemory(const std::vector<std::string>& paths)
+{
+    std::vector<ResultBatchPtr> batches;
+    ResultBatcher batcher([&](ResultBatchPtr batch) { batches.push_back(std::move(batch)); });
+    for (const auto& p : paths) {
+        batcher.add(p);
+    }
+    batcher.flush();
+
+    std::size_t pathBytes = 0;
+    for (const auto& p : paths) pathBytes += p.size();
+    const double rows = static_cast<double>(paths.size());
+    std::printf("\nMemory per row (paths average %.1f bytes):\n", pathBytes / rows);
+
+    {
+        const std::size_t before = heapInUse();
+        ResultsModel model;
+        for (const auto& batch : batches) model.appendBatch(*batch);
+        const std::size_t after = heapInUse();
+        std::printf("  columnar ResultsModel   %7.1f bytes/row (heap)  %7.1f bytes/row (own count)\n",
+                    before || after ? (after - before) / rows : 0.0, model.memoryUsage() / rows);
+    }
+    {
+        const std::size_t before = heapInUse();
+        QStandardItemModel model(0, 2);
+        for (const auto& batch : batches) appendItemBatch(model, *batch);
+        const std::size_t after = heapInUse();
+        std::printf("  QStandardItemModel      %7.1f bytes/row (heap)\n", before || after ? (after - before) / rows : 0.0);
+    }
+#ifndef IYS_HAVE_MALLINFO2
+    std::printf("  (heap numbers need glibc 2.33+ - shown as 0 here)\n");
+#endif
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    std::size_t count = 1000000;
+    bool sorted = true;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--unsorted") == 0) {
+            sorted = false;
+        } else {
+            count = std::strtoull(argv[i], nullptr, 10);
+        }
+    }
+    if (count == 0) {
+        std::fprintf(stderr, "Nothing to do with 0 results.\n");
+        return 1;
+    }
+
+    const std::vector<std::string> paths = syntheticPaths(count);
+    std::printf("%zu results, %s proxy\n\n", paths.size(), sorted ? "sorted" : "unsorted");
+
+    print("batched / columnar", batchedColumnar(paths, sorted));
+    print("batched / items", batchedItems(paths, sorted));
+    print("per-result / items", perResultItems(paths, sorted));
+    measureMemory(paths);
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include "resultsmodel.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// Where the file name starts inside a path - no QFileInfo needed, the workers hand us clean paths
+std::size_t nameStart(std::string_view path)
+{
+#ifdef _WIN32
+    const std::size_t slash = path.find_last_of("/\\");
+#else
+    const std::size_t slash = path.rfind('/');
+#endif
+    return slash == std::string_view::npos ? 0 : slash + 1;
+}
+
+QString toQString(std::string_view bytes)
+{
+    return QString::fromUtf8(bytes.data(), static_cast<qsizetype>(bytes.size()));
+}
+} // namespace
+
+ResultsModel::ResultsModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int ResultsModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(pathEnds.size()); // Flat table, no children
+}
+
+int ResultsModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ResultsModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    // 🐢➡️⚡ Only the rows on screen ever get here, so the QStrings are made on demand
+    switch (role) {
+    case Qt::DisplayRole:
+        if (index.column() == MatchColumn) {
+            if (const std::uint64_t group = groupId(index.row())) {
+                return tr("Group %1").arg(group);
+            }
+            const std::uint64_t line = lineNumber(index.row());
+            return line == 0 ? QString() : QString::number(line) + QStringLiteral(": ") + toQString(snippetBytes(index.row()));
+        }
+        return toQString(columnBytes(index.row(), index.column()));
+    case Qt::ToolTipRole:
+        return index.column() == NameColumn ? path(index.row()) : QVariant(); // Full path over the name
+    default:
+        return QVariant();
+    }
+}
+
+QVariant ResultsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case NameColumn: return tr("Name");
+    case PathColumn: return tr("Path");
+    case MatchColumn: return hasGroups() ? tr("Duplicates") : tr("Match");
+    default: return QVariant();
+    }
+}
+
+Qt::ItemFlags ResultsModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled; // Read-only
+}
+
+int ResultsModel::appendBatch(const ResultBatch& batch)
+{
+    if (batch.empty()) {
+        return 0;
+    }
+    const int first = rowCount();
+    const int count = static_cast<int>(batch.size());
+
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    // The batch arena is already laid out the way ours is - one copy, then just fix up the offsets
+    const std::uint64_t base = arena.size();
+    arena.append(batch.arena);
+    pathEnds.reserve(pathEnds.size() + batch.size());
+    nameStarts.reserve(nameStarts.size() + batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        pathEnds.push_back(base + batch.ends[i]);
+        nameStarts.push_back(static_cast<std::uint32_t>(nameStart(batch.path(i))));
+    }
+    if (batch.hasSnippets() || !snippetEnds.empty()) {
+        // 📖 Rows before the first content match get empty snippets, so row i is entry i again
+        const std::uint64_t padEnd = snippetEnds.empty() ? 0 : snippetEnds.back();
+        snippetEnds.resize(first, padEnd);
+        lineNumbers.resize(first, 0);
+        const std::uint64_t snippetBase = snippetArena.size();
+        const bool has = batch.hasSnippets();
+        if (has) {
+            snippetArena.append(batch.snippetArena); // Same layout trick as the paths
+        }
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            snippetEnds.push_back(has ? snippetBase + batch.snippetEnds[i] : snippetBase);
+            lineNumbers.push_back(has ? batch.lineNumbers[i] : 0);
+        }
+    }
+    const bool firstGroups = batch.hasGroups() && groupIds.empty();
+    if (batch.hasGroups() || !groupIds.empty()) {
+        groupIds.resize(first, 0);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            groupIds.push_back(batch.hasGroups() ? batch.groupIds[i] : 0);
+        }
+    }
+    endInsertRows();
+    if (firstGroups) {
+        emit headerDataChanged(Qt::Horizontal, MatchColumn, MatchColumn); // "Match" -> "Duplicates"
+    }
+    return count;
+}
+
+void ResultsModel::clear()
+{
+    beginResetModel();
+    // Swapping with empties actually hands the memory back (clear() would keep the capacity)
+    std::string().swap(arena);
+    std::vector<std::uint64_t>().swap(pathEnds);
+    std::vector<std::uint32_t>().swap(nameStarts);
+    std::string().swap(snippetArena);
+    std::vector<std::uint64_t>().swap(snippetEnds);
+    std::vector<std::uint64_t>().swap(lineNumbers);
+    std::vector<std::uint64_t>().swap(groupIds);
+    endResetModel();
+}
+
+std::string_view ResultsModel::pathBytes(int row) const
+{
+    const std::uint64_t start = row == 0 ? 0 : pathEnds[row - 1];
+    return std::string_view(arena.data() + start, pathEnds[row] - start);
+}
+
+std::string_view ResultsModel::nameBytes(int row) const
+{
+    return pathBytes(row).substr(nameStarts[row]);
+}
+
+std::string_view ResultsModel::snippetBytes(int row) const
+{
+    if (static_cast<std::size_t>(row) >= snippetEnds.size()) {
+        return std::string_view(); // Filename-only rows
+    }
+    const std::uint64_t start = row == 0 ? 0 : snippetEnds[row - 1];
+    return std::string_view(snippetArena.data() + start, snippetEnds[row] - start);
+}
+
+std::uint64_t ResultsModel::lineNumber(int row) const
+{
+    return static_cast<std::size_t>(row) < lineNumbers.size() ? lineNumbers[row] : 0;
+}
+
+std::uint64_t ResultsModel::groupId(int row) const
+{
+    return static_cast<std::size_t>(row) < groupIds.size() ? groupIds[row] : 0;
+}
+
+std::string_view ResultsModel::columnBytes(int row, int column) const
+{
+    switch (column) {
+    case NameColumn: return nameBytes(row);
+    case MatchColumn: return snippetBytes(row);
+    default: return pathBytes(row);
+    }
+}
+
+QString ResultsModel::path(int row) const
+{
+    if (row < 0 || row >= rowCount()) {
+        return QString();
+    }
+    return toQString(pathBytes(row));
+}
+
+std::size_t ResultsModel::memoryUsage() const
+{
+    return arena.capacity() + pathEnds.capacity() * sizeof(std::uint64_t)
+           + nameStarts.capacity() * sizeof(std::uint32_t) + snippetArena.capacity()
+           + (snippetEnds.capacity() + lineNumbers.capacity() + groupIds.capacity()) * sizeof(std::uint64_t);
+}
+
+bool ResultsProxyModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    const auto* results = qobject_cast<const ResultsModel*>(sourceModel());
+    if (!results) {
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+    if (left.column() == ResultsModel::MatchColumn) {
+        // Groups and line numbers sort as numbers ("Group 10" after "Group 9"), then by the line's text
+        const std::uint64_t a = results->groupId(left.row()) ? results->groupId(left.row()) : results->lineNumber(left.row());
+        const std::uint64_t b = results->groupId(right.row()) ? results->groupId(right.row()) : results->lineNumber(right.row());
+        if (a != b) {
+            return a < b;
+        }
+    }
+    // Byte order of UTF-8 is code point order - no QStrings needed to compare two rows
+    const std::string_view a = results->columnBytes(left.row(), left.column());
+    const std::string_view b = results->columnBytes(right.row(), right.column());
+    return a < b;
+}
@@ -0,0 +1,87 @@
+#ifndef RESULTSMODEL_H
+#define RESULTSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <QString>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "resultbatch.h"
+
+// 📋 The Results Table 📋
+// A model built for exactly one job: holding a LOT of paths. QStandardItemModel spends two
+// heap-allocated items per row, each with its own UTF-16 copy of the text (plus a tooltip),
+// which adds up to hundreds of bytes per hit. Here every path lives in one contiguous UTF-8
+// arena, and two small columns say where each path ends and where its file name starts.
+// Name, Path and the tooltip are only turned into QStrings when the view asks for them in
+// data() - that's a screenful of rows, not the whole list.
+// Batches from the workers go in with a single beginInsertRows/endInsertRows each.
+// Content searches add a third column, "line: text" - its arena only exists once a batch
+// with snippets shows up, so plain filename searches don't pay for it. Duplicate searches
+// use the same column for the group each file is in.
+class ResultsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn = 0, PathColumn = 1, MatchColumn = 2, ColumnCount = 3 };
+
+    explicit ResultsModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    // Appends every path of the batch as new rows (one insert notification). Returns the row count added.
+    int appendBatch(const ResultBatch& batch);
+
+    // Drops every row and gives the memory back
+    void clear();
+
+    // Raw UTF-8 bytes of a row, no QString involved (sorting uses these)
+    std::string_view pathBytes(int row) const;
+    std::string_view nameBytes(int row) const;
+    std::string_view snippetBytes(int row) const; // Empty for rows without a content match
+    std::string_view columnBytes(int row, int column) const;
+
+    QString path(int row) const;
+    std::uint64_t lineNumber(int row) const; // 0 = no content match on this row
+    std::uint64_t groupId(int row) const;    // 0 = not in a duplicate group
+    bool hasMatches() const { return !snippetEnds.empty(); }
+    bool hasGroups() const { return !groupIds.empty(); }
+
+    // Bytes this model holds on the heap (arenas + the index columns, capacity included)
+    std::size_t memoryUsage() const;
+
+private:
+    std::string arena;                     // Every path, back to back, UTF-8
+    std::vector<std::uint64_t> pathEnds;   // Where row i's path stops in the arena
+    std::vector<std::uint32_t> nameStarts; // Where the file name starts inside row i's path
+    // Content matches - empty until the first batch that has them, padded for rows that don't
+    std::string snippetArena;
+    std::vector<std::uint64_t> snippetEnds;
+    std::vector<std::uint64_t> lineNumbers;
+    std::vector<std::uint64_t> groupIds; // Duplicate groups - same deal: empty until the first one arrives
+};
+
+// 🔃 Sorting and filtering on top of ResultsModel. Sorting compares the raw UTF-8 bytes
+// instead of asking data() for two fresh QStrings per comparison - same order (code point
+// order, case-sensitive, like the default), without a million allocations per sort.
+class ResultsProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    using QSortFilterProxyModel::QSortFilterProxyModel;
+
+protected:
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+};
+
+#endif // RESULTSMODEL_H
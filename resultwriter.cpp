@@ -0,0 +1,448 @@
+#include "resultwriter.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kWriteChunk = 1024 * 1024; // The buffer goes to disk once it's this big
+constexpr std::uint8_t kBinaryVersion = 1;
+
+// What a stat() told us about one result (known = false if it failed)
+struct FileFacts {
+    bool known = false;
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0; // Seconds since the epoch
+};
+
+FileFacts factsOf(std::string_view path)
+{
+    FileFacts facts;
+#ifndef _WIN32
+    const std::string pathString(path);
+    struct stat info;
+    if (::stat(pathString.c_str(), &info) == 0) {
+        facts.known = true;
+        facts.size = static_cast<std::uint64_t>(info.st_size);
+        facts.mtime = static_cast<std::int64_t>(info.st_mtime);
+    }
+#else
+    // No stat() with UTF-8 paths here - std::filesystem does the conversion for us
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path filePath = fs::u8path(path);
+    const auto size = fs::file_size(filePath, ec);
+    if (!ec) {
+        const auto written = fs::last_write_time(filePath, ec);
+        if (!ec) {
+            // file_time_type has no fixed epoch in C++17, so hop over via "now" on both clocks
+            const auto asSystem = std::chrono::system_clock::now()
+                                  + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                      written - fs::file_time_type::clock::now());
+            facts.known = true;
+            facts.size = size;
+            facts.mtime = std::chrono::duration_cast<std::chrono::seconds>(asSystem.time_since_epoch()).count();
+        }
+    }
+#endif
+    return facts;
+}
+
+void appendVarint(std::string& out, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+std::uint64_t zigzag(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+// Strict UTF-8 check (no overlongs, no surrogates) - JSON strings can't carry anything else
+bool isValidUtf8(std::string_view text)
+{
+    std::size_t i = 0;
+    while (i < text.size()) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+        std::size_t length;
+        std::uint32_t codePoint;
+        if ((c & 0xE0) == 0xC0) { length = 2; codePoint = c & 0x1F; }
+        else if ((c & 0xF0) == 0xE0) { length = 3; codePoint = c & 0x0F; }
+        else if ((c & 0xF8) == 0xF0) { length = 4; codePoint = c & 0x07; }
+        else { return false; }
+        if (i + length > text.size()) {
+            return false;
+        }
+        for (std::size_t k = 1; k < length; ++k) {
+            const unsigned char next = static_cast<unsigned char>(text[i + k]);
+            if ((next & 0xC0) != 0x80) {
+                return false;
+            }
+            codePoint = (codePoint << 6) | (next & 0x3F);
+        }
+        const std::uint32_t smallest[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (codePoint < smallest[length] || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+void appendJsonString(std::string& out, std::string_view text)
+{
+    static const char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char ch : text) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                out += "\\u00";
+                out.push_back(hex[c >> 4]);
+                out.push_back(hex[c & 0xF]);
+            } else {
+                out.push_back(ch);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+void appendBase64(std::string& out, std::string_view bytes)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::size_t i = 0;
+    for (; i + 3 <= bytes.size(); i += 3) {
+        const std::uint32_t n = (std::uint32_t(std::uint8_t(bytes[i])) << 16) | (std::uint32_t(std::uint8_t(bytes[i + 1])) << 8)
+                                | std::uint8_t(bytes[i + 2]);
+        out.push_back(alphabet[(n >> 18) & 63]);
+        out.push_back(alphabet[(n >> 12) & 63]);
+        out.push_back(alphabet[(n >> 6) & 63]);
+        out.push_back(alphabet[n & 63]);
+    }
+    if (i < bytes.size()) {
+        std::uint32_t n = std::uint32_t(std::uint8_t(bytes[i])) << 16;
+        if (i + 1 < bytes.size()) {
+            n |= std::uint32_t(std::uint8_t(bytes[i + 1])) << 8;
+        }
+        out.push_back(alphabet[(n >> 18) & 63]);
+        out.push_back(alphabet[(n >> 12) & 63]);
+        out.push_back(i + 1 < bytes.size() ? alphabet[(n >> 6) & 63] : '=');
+        out.push_back('=');
+    }
+}
+
+} // namespace
+
+ResultWriter::ResultWriter() = default;
+
+ResultWriter::~ResultWriter()
+{
+    if (isOpen()) {
+        finish(0, 0, 0, true);
+    }
+}
+
+bool ResultWriter::open(const SearchConfig& config, std::string& errorMessage)
+{
+    if (config.outputFile == "-") {
+        stream = &std::cout; // Streaming to whoever is reading our stdout
+        decorated = false;
+    } else {
+        out.open(config.outputFile, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            errorMessage = "can't open " + config.outputFile + " for writing";
+            return false;
+        }
+        stream = &out;
+        decorated = true;
+    }
+    format = config.outputFormat;
+    terms = config.searchTerms;
+    termResults.assign(terms.size(), 0);
+    currentTerm = -1;
+    currentGroup = 0;
+    tally = ResultWriterStats();
+    queuedResults = 0;
+    finishing = false;
+    buffer.reserve(kWriteChunk + 64 * 1024);
+    openedAt = std::chrono::steady_clock::now();
+
+    writeHeader(config);
+    writerThread = std::thread(&ResultWriter::run, this);
+    return true;
+}
+
+void ResultWriter::submit(ResultBatchPtr batch)
+{
+    if (!batch || batch->empty()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (queue.size() >= kMaxQueuedBatches) {
+        // 🐢 The disk can't keep up - wait here rather than pile up memory without end
+        tally.producerWaits++;
+        queueChanged.wait(lock, [this] { return queue.size() < kMaxQueuedBatches || finishing; });
+    }
+    queuedResults += batch->size();
+    queue.push_back(std::move(batch));
+    if (queue.size() > tally.queueHighWater) {
+        tally.queueHighWater = queue.size();
+    }
+    if (queuedResults > tally.queueHighWaterResults) {
+        tally.queueHighWaterResults = queuedResults;
+    }
+    queueChanged.notify_all();
+}
+
+ResultWriterStats ResultWriter::finish(unsigned long long found, std::uint64_t scanned, double searchSeconds, bool cancelled)
+{
+    if (!isOpen()) {
+        return tally;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        finishing = true;
+    }
+    queueChanged.notify_all();
+    writerThread.join(); // It drains the queue before it leaves
+
+    writeFooter(found, scanned, searchSeconds, cancelled);
+    flushBuffer(true);
+    if (stream == &out) {
+        out.close();
+    } else {
+        stream->flush();
+    }
+    if (stream->fail() && tally.error.empty()) {
+        tally.error = "closing the output file failed";
+    }
+    stream = nullptr;
+
+    tally.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - openedAt).count();
+    tally.megabytesPerSecond = tally.seconds > 0 ? tally.bytesWritten / (1024.0 * 1024.0) / tally.seconds : 0;
+    return tally;
+}
+
+// 🧵 The writer thread: take a batch, format it, write in big chunks, repeat
+void ResultWriter::run()
+{
+    for (;;) {
+        ResultBatchPtr batch;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueChanged.wait(lock, [this] { return !queue.empty() || finishing; });
+            if (queue.empty()) {
+                break; // finishing, and nothing left to write
+            }
+            batch = std::move(queue.front());
+            queue.pop_front();
+            queuedResults -= batch->size();
+        }
+        queueChanged.notify_all(); // Room for a waiting submit()
+        writeBatch(*batch);
+    }
+}
+
+void ResultWriter::writeBatch(const ResultBatch& batch)
+{
+    // 🗂️ A multi-term group: a heading when a new one starts (reports), a tag on every line (stdout, JSON)
+    const bool grouped = batch.termId >= 0 && static_cast<std::size_t>(batch.termId) < terms.size();
+    std::string tag;
+    if (grouped) {
+        if (batch.termId != currentTerm && format == OutputFormat::Text && decorated) {
+            buffer += "\n[" + std::to_string(batch.termId) + "] '" + terms[batch.termId] + "'\n";
+        }
+        currentTerm = batch.termId;
+        termResults[batch.termId] += batch.size();
+        tag = std::to_string(batch.termId);
+    }
+
+    const bool snippets = batch.hasSnippets();
+    const bool duplicates = batch.hasGroups();
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const std::string_view path = batch.path(i);
+        if (duplicates && batch.groupIds[i] != currentGroup && format == OutputFormat::Text) {
+            // 👯 A new group of identical files: a heading in a report, a blank line on stdout
+            if (decorated) {
+                const FileFacts facts = factsOf(path);
+                buffer += "\n[group " + std::to_string(batch.groupIds[i]) + "]"
+                          + (facts.known ? " " + std::to_string(facts.size) + " bytes each" : std::string()) + "\n";
+            } else if (currentGroup != 0) {
+                buffer.push_back('\n');
+            }
+        }
+        if (duplicates) {
+            currentGroup = batch.groupIds[i];
+        }
+        switch (format) {
+        case OutputFormat::Text:
+            if (grouped && !decorated) {
+                buffer += tag;
+                buffer.push_back('\t');
+            }
+            buffer.append(path.data(), path.size());
+            if (snippets) {
+                // path:line:snippet, the way grep -n prints it
+                const std::string_view snippet = batch.snippet(i);
+                buffer += ":" + std::to_string(batch.lineNumbers[i]) + ":";
+                buffer.append(snippet.data(), snippet.size());
+            }
+            buffer.push_back('\n');
+            break;
+        case OutputFormat::NulSeparated:
+            buffer.append(path.data(), path.size());
+            buffer.push_back('\0');
+            break;
+        case OutputFormat::JsonLines: {
+            const FileFacts facts = factsOf(path);
+            tally.statFailures += !facts.known;
+            buffer.push_back('{');
+            if (grouped) {
+                buffer += "\"term\":" + tag + ",";
+            }
+            if (duplicates) {
+                buffer += "\"group\":" + std::to_string(batch.groupIds[i]) + ",";
+            }
+            if (isValidUtf8(path)) {
+                buffer += "\"path\":";
+                appendJsonString(buffer, path);
+            } else {
+                buffer += "\"pathBytes\":\"";
+                appendBase64(buffer, path);
+                buffer.push_back('"');
+            }
+            if (snippets) {
+                const std::string_view snippet = batch.snippet(i);
+                buffer += ",\"line\":" + std::to_string(batch.lineNumbers[i]);
+                if (isValidUtf8(snippet)) {
+                    buffer += ",\"snippet\":";
+                    appendJsonString(buffer, snippet);
+                } else {
+                    buffer += ",\"snippetBytes\":\"";
+                    appendBase64(buffer, snippet);
+                    buffer.push_back('"');
+                }
+            }
+            if (facts.known) {
+                buffer += ",\"size\":" + std::to_string(facts.size) + ",\"mtime\":" + std::to_string(facts.mtime) + "}\n";
+            } else {
+                buffer += ",\"size\":null,\"mtime\":null}\n";
+            }
+            break;
+        }
+        case OutputFormat::Binary: {
+            const FileFacts facts = factsOf(path);
+            tally.statFailures += !facts.known;
+            appendVarint(buffer, path.size());
+            buffer.append(path.data(), path.size());
+            appendVarint(buffer, facts.known ? facts.size + 1 : 0);
+            appendVarint(buffer, facts.known ? zigzag(facts.mtime) : 0);
+            break;
+        }
+        }
+        tally.results++;
+    }
+    flushBuffer(false);
+}
+
+void ResultWriter::writeHeader(const SearchConfig& config)
+{
+    switch (format) {
+    case OutputFormat::Text:
+        if (!decorated) {
+            break; // Just the paths, please
+        }
+        // Add a nice header to the file
+        buffer += "🔍 IYS Searcher Results 🔍\n";
+        if (config.searchTerms.empty()) {
+            buffer += "Search term: '" + config.searchTerm + "'\n";
+        } else {
+            buffer += "Search terms (" + std::to_string(config.searchTerms.size()) + ", in one pass):";
+            for (const std::string& term : config.searchTerms) {
+                buffer += " '" + term + "'";
+            }
+            buffer += "\n";
+        }
+        if (!config.contentTerm.empty()) {
+            buffer += "Containing: '" + config.contentTerm + "'\n";
+        }
+        if (config.findDuplicates) {
+            buffer += "Looking for: duplicate files (same size, same content)\n";
+        }
+        buffer += "Starting from: " + (config.startPath.empty() ? std::string("All Drives") : config.startPath) + "\n";
+        buffer += "------------------------------------------\n";
+        break;
+    case OutputFormat::Binary:
+        buffer += "IYSR";
+        buffer.push_back(static_cast<char>(kBinaryVersion));
+        break;
+    case OutputFormat::NulSeparated:
+    case OutputFormat::JsonLines:
+        break; // Nothing but records - that's the point
+    }
+}
+
+void ResultWriter::writeFooter(unsigned long long found, std::uint64_t scanned, double searchSeconds, bool cancelled)
+{
+    switch (format) {
+    case OutputFormat::Text: {
+        if (!decorated) {
+            break;
+        }
+        buffer += "------------------------------------------\n";
+        if (cancelled) {
+            buffer += "Search was cancelled. Found " + std::to_string(found) + " file(s) before stopping.\n";
+        } else {
+            buffer += "Search complete! Found " + std::to_string(found) + " file(s).\n";
+        }
+        for (std::size_t id = 0; id < terms.size(); ++id) {
+            buffer += "  [" + std::to_string(id) + "] '" + terms[id] + "': " + std::to_string(termResults[id]) + " file(s)\n";
+        }
+        buffer += "Checked approximately " + std::to_string(scanned) + " items.\n";
+        char seconds[32];
+        std::snprintf(seconds, sizeof(seconds), "%g", searchSeconds);
+        buffer += "Search took " + std::string(seconds) + " seconds.\n";
+        break;
+    }
+    case OutputFormat::Binary:
+        appendVarint(buffer, 0); // A zero-length path marks the end...
+        appendVarint(buffer, tally.results); // ...followed by the record count
+        break;
+    case OutputFormat::NulSeparated:
+    case OutputFormat::JsonLines:
+        break;
+    }
+}
+
+void ResultWriter::flushBuffer(bool force)
+{
+    if (buffer.empty() || (!force && buffer.size() < kWriteChunk)) {
+        return;
+    }
+    if (stream->write(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+        tally.bytesWritten += buffer.size();
+    } else if (tally.error.empty()) {
+        tally.error = "writing the output file failed (disk full?)";
+    }
+    buffer.clear();
+}
@@ -0,0 +1,122 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <ostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "resultbatch.h" // The writer eats the same batches the GUI gets
+#include "searchlogic.h" // SearchConfig, OutputFormat
+
+// ✍️ The Result Writer ✍️
+// Saving results used to happen right inside the search: every match went through
+// `<< std::endl`, which flushes the file each time - so a slow disk slowed the walk down.
+// Now the output file belongs to its own thread. The search just drops each ResultBatch
+// into a queue (the very same shared batch the GUI gets - nothing is copied), and the
+// writer formats it into a big buffer that goes to disk a megabyte at a time.
+//
+// Formats (SearchConfig::outputFormat):
+//   Text          the decorated report: header, one path per line, summary at the end
+//   NulSeparated  paths ending in '\0' and nothing else - ready for `xargs -0`
+//   JsonLines     one {"path":...,"size":...,"mtime":...} object per line. A path that
+//                 isn't valid UTF-8 comes as "pathBytes" (base64) instead of "path";
+//                 size/mtime are null if the file vanished before we could stat it
+//   Binary        compact records, see below
+//
+// Binary layout (all integers are unsigned LEB128 varints unless said otherwise):
+//   header   "IYSR" + 1 byte version (1)
+//   record   pathLength, path bytes, size + 1 (0 = unknown), mtime (zigzag-encoded, seconds since the epoch)
+//   trailer  pathLength 0, then the record count - a file without it was cut short
+//
+// size and mtime come from a stat() on the writer thread, so they cost the walk nothing.
+//
+// An outputFile of "-" means standard output (that's how iys-search streams its results).
+// Text on stdout is just the paths - the header and summary only make sense in a saved report.
+//
+// Content searches (SearchConfig::contentTerm) report one line per record: Text writes it like
+// grep does, "path:line:snippet"; JsonLines adds "line" and "snippet" (or "snippetBytes",
+// base64, when it isn't UTF-8); NulSeparated and Binary keep to the path.
+//
+// Multi-term searches (SearchConfig::searchTerms) hand over their results grouped, one term
+// after another, in batches tagged with a termId. Text gets a heading per term in a report and
+// "ID<TAB>path" lines on stdout; JsonLines adds a "term":ID field; NulSeparated and Binary stay
+// bare paths, just in group order.
+//
+// Duplicate searches (SearchConfig::findDuplicates) hand over one group of identical files after
+// another, each path tagged with its groupId. Text gets a "[group N] SIZE bytes" heading per group
+// in a report and a blank line between groups on stdout (the way fdupes prints them); JsonLines
+// adds a "group":N field; NulSeparated and Binary stay bare paths, in group order.
+
+struct ResultWriterStats {
+    std::uint64_t results = 0;          // Paths written
+    std::uint64_t bytesWritten = 0;     // Including headers and trailers
+    double seconds = 0;                 // Writer thread lifetime (open -> finish)
+    double megabytesPerSecond = 0;      // bytesWritten over seconds
+    std::size_t queueHighWater = 0;     // Most batches that were ever waiting at once
+    std::uint64_t queueHighWaterResults = 0; // ...and how many paths those held
+    std::uint64_t statFailures = 0;     // Paths whose size/mtime we couldn't get (JSON/binary)
+    std::uint64_t producerWaits = 0;    // Times the search had to wait for a full queue
+    std::string error;                  // Empty unless writing failed somewhere
+};
+
+class ResultWriter
+{
+public:
+    // Batches allowed in the queue before submit() waits. Each batch is at most ~1 MB,
+    // so this caps the memory a really slow disk can make us hold on to.
+    static constexpr std::size_t kMaxQueuedBatches = 256;
+
+    ResultWriter();
+    ~ResultWriter(); // Finishes (as cancelled) if nobody called finish()
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    // Opens config.outputFile ("-" = stdout) in config.outputFormat, writes the header and starts the thread.
+    bool open(const SearchConfig& config, std::string& errorMessage);
+    bool isOpen() const { return writerThread.joinable(); }
+
+    // Hands a batch over to the writer thread. Thread-safe; only waits if the queue is full.
+    void submit(ResultBatchPtr batch);
+
+    // Writes out everything still queued, adds the summary/trailer and closes the file.
+    ResultWriterStats finish(unsigned long long found, std::uint64_t scanned, double searchSeconds, bool cancelled);
+
+private:
+    void run();
+    void writeBatch(const ResultBatch& batch);
+    void writeHeader(const SearchConfig& config);
+    void writeFooter(unsigned long long found, std::uint64_t scanned, double searchSeconds, bool cancelled);
+    void flushBuffer(bool force);
+
+    OutputFormat format = OutputFormat::Text;
+    std::ofstream out;
+    std::ostream* stream = nullptr;     // &out, or std::cout for "-"
+    bool decorated = true;              // Text header/summary? (not on stdout)
+    std::string buffer;                 // Formatted output waiting for the next big write
+    std::thread writerThread;
+
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<ResultBatchPtr> queue;
+    std::uint64_t queuedResults = 0;    // Paths sitting in the queue right now
+    bool finishing = false;
+
+    std::vector<std::string> terms;     // Multi-term searches: the terms, for headings and the summary
+    std::vector<std::uint64_t> termResults; // ...and the paths written under each
+    std::int32_t currentTerm = -1;      // The group being written (writer thread only)
+    std::uint64_t currentGroup = 0;     // Duplicate searches: the group of the last path written (0 = none yet)
+
+    ResultWriterStats tally;            // Queue numbers under queueMutex, the rest writer-thread only
+    std::chrono::steady_clock::time_point openedAt;
+};
+
+#endif // RESULTWRITER_H
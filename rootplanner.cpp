@@ -0,0 +1,486 @@
+#include "rootplanner.h"
+#include "searchlogic.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h> // GetLogicalDrives - Windows hands us the drive letters directly
+#elif defined(__APPLE__)
+#include <sys/param.h>
+#include <sys/ucred.h>
+#include <sys/mount.h> // getmntinfo - the Mac's list of mounted volumes 🍏
+#else
+#include <mntent.h>        // getmntent - the fallback when there's no /proc/self/mountinfo
+#include <sys/stat.h>
+#include <sys/sysmacros.h> // makedev, major, minor
+#endif
+
+void MountBoundaries::add(const std::string& mountPoint)
+{
+    std::string path = mountPoint;
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
+    }
+    const std::size_t slash = path.rfind('/');
+    if (path.size() <= 1 || slash == std::string::npos) {
+        return; // "/" (or something that isn't absolute) - nobody ever steps INTO those
+    }
+    std::string parent = slash == 0 ? std::string("/") : path.substr(0, slash);
+    std::string name = path.substr(slash + 1);
+
+    auto it = std::lower_bound(byParent.begin(), byParent.end(), parent,
+                               [](const auto& entry, const std::string& key) { return entry.first < key; });
+    if (it == byParent.end() || it->first != parent) {
+        it = byParent.insert(it, {std::move(parent), {}});
+    }
+    if (!contains(it->second, name)) {
+        it->second.push_back(std::move(name));
+    }
+}
+
+std::size_t MountBoundaries::size() const
+{
+    std::size_t count = 0;
+    for (const auto& entry : byParent) {
+        count += entry.second.size();
+    }
+    return count;
+}
+
+const std::vector<std::string>* MountBoundaries::inside(std::string_view dir) const
+{
+    while (dir.size() > 1 && dir.back() == '/') {
+        dir.remove_suffix(1);
+    }
+    auto it = std::lower_bound(byParent.begin(), byParent.end(), dir,
+                               [](const auto& entry, std::string_view key) { return std::string_view(entry.first) < key; });
+    return it != byParent.end() && it->first == dir ? &it->second : nullptr;
+}
+
+bool MountBoundaries::contains(const std::vector<std::string>& names, std::string_view name)
+{
+    for (const std::string& candidate : names) {
+        if (candidate == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+#ifndef _WIN32 // (Windows gets drive letters - none of this is needed there)
+
+// One line of the mount table
+struct MountRecord {
+    std::string mountPoint;
+    std::string fsType;
+    std::string source;
+    std::string subtree = "/";
+    std::uint64_t device = 0;
+    bool readOnly = false;
+};
+
+// Kernel bookkeeping filesystems - they're mounted, but there are no user files in them
+bool isPseudoFilesystem(const std::string& type)
+{
+    static const char* const pseudo[] = {
+        "proc", "sysfs", "devtmpfs", "devpts", "cgroup", "cgroup2", "securityfs", "debugfs",
+        "tracefs", "pstore", "bpf", "mqueue", "hugetlbfs", "configfs", "fusectl", "autofs",
+        "binfmt_misc", "rpc_pipefs", "nsfs", "efivarfs", "selinuxfs", "overlay_internal",
+        "devfs", "fdesc", // macOS
+    };
+    for (const char* name : pseudo) {
+        if (type == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Memory-backed: real files, but they're gone on reboot and usually not what anybody is looking for
+bool isVirtualFilesystem(const std::string& type)
+{
+    return type == "tmpfs" || type == "ramfs";
+}
+
+// "ro" as a whole mount option (not just a prefix of "rootcontext=...")
+bool isReadOnlyMount(const char* options)
+{
+    const char* at = options;
+    while ((at = std::strstr(at, "ro")) != nullptr) {
+        const bool startsOption = at == options || at[-1] == ',';
+        const bool endsOption = at[2] == '\0' || at[2] == ',';
+        if (startsOption && endsOption) {
+            return true;
+        }
+        at += 2;
+    }
+    return false;
+}
+
+// Is path dir itself, or somewhere below it? Both absolute, no trailing slashes (except "/")
+bool isWithin(std::string_view path, std::string_view dir)
+{
+    if (dir == "/") {
+        return !path.empty() && path.front() == '/';
+    }
+    return path.size() >= dir.size() && path.compare(0, dir.size(), dir) == 0
+           && (path.size() == dir.size() || path[dir.size()] == '/');
+}
+
+std::string withoutTrailingSlashes(std::string path)
+{
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
+    }
+    return path;
+}
+
+// Tree order: a folder, then everything inside it, then its next sibling ('/' sorts before every other byte)
+bool treeLess(const std::string& a, const std::string& b)
+{
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+        const int keyX = x == '/' ? -1 : static_cast<unsigned char>(x);
+        const int keyY = y == '/' ? -1 : static_cast<unsigned char>(y);
+        return keyX < keyY;
+    });
+}
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+// The kernel writes spaces, tabs and newlines in mountinfo paths as \040, \011, \012
+std::string unescapeOctal(const std::string& text)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\\' && i + 3 < text.size() && text[i + 1] >= '0' && text[i + 1] <= '3'
+            && text[i + 2] >= '0' && text[i + 2] <= '7' && text[i + 3] >= '0' && text[i + 3] <= '7') {
+            out.push_back(static_cast<char>((text[i + 1] - '0') * 64 + (text[i + 2] - '0') * 8 + (text[i + 3] - '0')));
+            i += 3;
+        } else {
+            out.push_back(text[i]);
+        }
+    }
+    return out;
+}
+
+// /proc/self/mountinfo has what /proc/self/mounts doesn't: the device number and which
+// folder of the filesystem is mounted (that's how a bind mount gives itself away)
+bool readMountInfo(std::vector<MountRecord>& table)
+{
+    std::ifstream in("/proc/self/mountinfo");
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        // 36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+        std::istringstream fields(line);
+        std::string id, parentId, majorMinor, root, mountPoint, options, field;
+        if (!(fields >> id >> parentId >> majorMinor >> root >> mountPoint >> options)) {
+            continue;
+        }
+        while (fields >> field && field != "-") {
+            // Optional fields (shared:N, master:N...) - not our business
+        }
+        MountRecord record;
+        if (!(fields >> record.fsType >> record.source)) {
+            continue;
+        }
+        unsigned int major = 0;
+        unsigned int minor = 0;
+        if (std::sscanf(majorMinor.c_str(), "%u:%u", &major, &minor) != 2) {
+            continue;
+        }
+        record.device = static_cast<std::uint64_t>(makedev(major, minor)); // The same number stat() puts in st_dev
+        record.mountPoint = unescapeOctal(mountPoint);
+        record.subtree = unescapeOctal(root);
+        record.source = unescapeOctal(record.source);
+        record.readOnly = isReadOnlyMount(options.c_str());
+        table.push_back(std::move(record));
+    }
+    return true;
+}
+#endif
+
+std::vector<MountRecord> readMountTable()
+{
+    std::vector<MountRecord> table;
+#if defined(__APPLE__)
+    struct statfs* mounts = nullptr;
+    const int count = getmntinfo(&mounts, MNT_NOWAIT);
+    for (int i = 0; i < count; ++i) {
+        MountRecord record;
+        record.mountPoint = mounts[i].f_mntonname;
+        record.fsType = mounts[i].f_fstypename;
+        record.source = mounts[i].f_mntfromname;
+        record.device = static_cast<std::uint32_t>(mounts[i].f_fsid.val[0]); // What st_dev says on a Mac
+        record.readOnly = (mounts[i].f_flags & MNT_RDONLY) != 0;
+        table.push_back(std::move(record));
+    }
+#else
+    if (!readMountInfo(table)) {
+        // No mountinfo (a very old kernel, or /proc from somewhere else): the plain list, plus a stat() each
+        if (FILE* mtab = setmntent("/proc/self/mounts", "r")) {
+            while (const struct mntent* mount = getmntent(mtab)) {
+                MountRecord record;
+                record.mountPoint = mount->mnt_dir;
+                record.fsType = mount->mnt_type;
+                record.source = mount->mnt_fsname;
+                record.readOnly = isReadOnlyMount(mount->mnt_opts);
+                struct stat st;
+                if (::stat(mount->mnt_dir, &st) == 0) {
+                    record.device = static_cast<std::uint64_t>(st.st_dev);
+                }
+                table.push_back(std::move(record));
+            }
+            endmntent(mtab);
+        }
+    }
+#endif
+
+    // Something mounted over something else hides it - only the last mount on a path is what you see
+    std::vector<MountRecord> visible;
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i].mountPoint = withoutTrailingSlashes(table[i].mountPoint);
+        bool hidden = false;
+        for (std::size_t later = i + 1; later < table.size() && !hidden; ++later) {
+            hidden = withoutTrailingSlashes(table[later].mountPoint) == table[i].mountPoint;
+        }
+        std::error_code ec;
+        if (!hidden && fs::is_directory(table[i].mountPoint, ec)) { // (Docker likes to bind-mount single files)
+            visible.push_back(std::move(table[i]));
+        }
+    }
+    std::stable_sort(visible.begin(), visible.end(),
+                     [](const MountRecord& a, const MountRecord& b) { return treeLess(a.mountPoint, b.mountPoint); });
+    return visible;
+}
+
+// Which folder of its filesystem a path below a mount is: the mount's subtree plus the rest of the path
+std::string subtreeOf(const MountRecord& mount, const std::string& path)
+{
+    const std::string rest = mount.mountPoint == "/" ? path : path.substr(mount.mountPoint.size());
+    if (rest.empty() || rest == "/") {
+        return mount.subtree;
+    }
+    return mount.subtree == "/" ? rest : mount.subtree + rest;
+}
+
+#endif // _WIN32
+
+} // namespace
+
+const char* mountDecisionName(MountDecision decision)
+{
+    switch (decision) {
+    case MountDecision::Root: return "search";
+    case MountDecision::Pseudo: return "skip (kernel)";
+    case MountDecision::Virtual: return "skip (memory only)";
+    case MountDecision::ReadOnly: return "skip (read-only)";
+    case MountDecision::Duplicate: return "skip (duplicate)";
+    case MountDecision::OtherFilesystem: return "skip (other filesystem)";
+    }
+    return "?";
+}
+
+RootPlan planRoots(const SearchConfig& config)
+{
+    RootPlan plan;
+#ifdef _WIN32
+    if (config.searchAllRoots) {
+        // On Windows, we'll check all drive letters A-Z
+        DWORD drives = GetLogicalDrives();
+        for (char driveLetter = 'A'; driveLetter <= 'Z'; ++driveLetter) {
+            if ((drives >> (driveLetter - 'A')) & 1) {
+                std::string driveStr = ""; driveStr += driveLetter; driveStr += ":\\";
+                std::error_code ec;
+                if (fs::is_directory(driveStr, ec)) { // Make sure it exists and is a directory before adding
+                    plan.roots.push_back(fs::path(driveStr));
+                    MountPlanEntry entry;
+                    entry.mountPoint = driveStr;
+                    plan.mounts.push_back(entry);
+                }
+            }
+        }
+    } else {
+        std::error_code ec;
+        const fs::path start = fs::absolute(config.startPath, ec);
+        if (!ec && fs::is_directory(start, ec)) {
+            plan.roots.push_back(start);
+        }
+    }
+    return plan;
+#else
+    const bool allRoots = config.searchAllRoots;
+    // The start folder two ways: as the user wrote it (that's how results get reported) and
+    // resolved (that's how the mount table writes it)
+    std::string startSpelled;
+    std::string start;
+    if (!allRoots) {
+        std::error_code ec;
+        const fs::path absolute = fs::absolute(config.startPath, ec);
+        if (ec || !fs::is_directory(absolute, ec)) {
+            return plan;
+        }
+        startSpelled = withoutTrailingSlashes(absolute.lexically_normal().string());
+        const fs::path resolved = fs::canonical(absolute, ec);
+        start = ec ? startSpelled : withoutTrailingSlashes(resolved.string());
+    }
+    // Anything below the start, spelled the user's way
+    auto spell = [&](const std::string& path) {
+        if (allRoots || start == startSpelled) {
+            return path;
+        }
+        const std::string rest = start == "/" ? path : path.substr(start.size());
+        return startSpelled == "/" ? (rest.empty() ? startSpelled : rest) : startSpelled + rest;
+    };
+
+    const std::vector<MountRecord> table = readMountTable();
+
+    // The mount that holds the start folder: the deepest one whose mount point it is inside
+    const MountRecord* startMount = nullptr;
+    for (const MountRecord& mount : table) {
+        if (!allRoots && isWithin(start, mount.mountPoint)
+            && (!startMount || mount.mountPoint.size() > startMount->mountPoint.size())) {
+            startMount = &mount;
+        }
+    }
+
+    // Which parts of which filesystems the roots so far already cover - a bind mount of any of those is a repeat
+    struct Covered {
+        std::uint64_t device;
+        std::string subtree;
+        std::string where;
+    };
+    std::vector<Covered> covered;
+    auto coveredBy = [&](const MountRecord& mount) -> const Covered* {
+        for (const Covered& part : covered) {
+            if (part.device == mount.device && isWithin(mount.subtree, part.subtree)) {
+                return &part;
+            }
+        }
+        return nullptr;
+    };
+
+    if (!allRoots) {
+        plan.roots.push_back(fs::path(startSpelled)); // Asked for by name, so it's searched whatever it is
+        if (startMount) {
+            covered.push_back({startMount->device, subtreeOf(*startMount, start), startSpelled});
+        }
+    }
+
+    for (const MountRecord& mount : table) {
+        const bool holdsStart = &mount == startMount;
+        if (!allRoots && !holdsStart && !(isWithin(mount.mountPoint, start) && mount.mountPoint != start)) {
+            continue; // Nothing to do with this search
+        }
+
+        MountPlanEntry entry;
+        entry.mountPoint = holdsStart ? mount.mountPoint : spell(mount.mountPoint);
+        entry.fsType = mount.fsType;
+        entry.source = mount.source;
+        entry.subtree = mount.subtree;
+        entry.device = mount.device;
+        for (const MountPlanEntry& outer : plan.mounts) { // Parents are listed first (tree order)
+            entry.depth += isWithin(entry.mountPoint, outer.mountPoint) && outer.mountPoint != entry.mountPoint;
+        }
+
+        if (holdsStart) {
+            entry.note = mount.mountPoint == start ? "start folder" : "holds the start folder " + startSpelled;
+            plan.mounts.push_back(std::move(entry));
+            continue;
+        }
+
+        const Covered* repeat = nullptr;
+        if (isPseudoFilesystem(mount.fsType)) {
+            entry.decision = MountDecision::Pseudo;
+        } else if (isVirtualFilesystem(mount.fsType) && !config.includeVirtualFilesystems) {
+            entry.decision = MountDecision::Virtual;
+        } else if (allRoots && mount.readOnly) {
+            entry.decision = MountDecision::ReadOnly;
+        } else if ((repeat = coveredBy(mount)) != nullptr) {
+            entry.decision = MountDecision::Duplicate;
+            entry.note = "same filesystem as " + repeat->where;
+        } else if (!allRoots && config.filesystemScope == FilesystemScope::OneFilesystem) {
+            entry.decision = MountDecision::OtherFilesystem;
+        } else {
+            entry.decision = MountDecision::Root;
+            plan.roots.push_back(fs::path(entry.mountPoint));
+            covered.push_back({mount.device, mount.subtree, entry.mountPoint});
+        }
+        // Searched from its own root or not at all - either way, no other root's walk goes in there
+        plan.boundaries.add(entry.mountPoint);
+        plan.mounts.push_back(std::move(entry));
+    }
+
+    // Just in case the OS didn't tell us anything useful, we have a backup plan
+    if (allRoots && plan.roots.empty()) {
+        std::error_code ec;
+        if (fs::is_directory("/", ec)) {
+            plan.roots.push_back(fs::path("/")); // At least check root
+        }
+    }
+    return plan;
+#endif
+}
+
+std::vector<fs::path> outermostRoots(const std::vector<fs::path>& roots)
+{
+    auto isInside = [](const fs::path& inner, const fs::path& outer) {
+        const fs::path a = inner.lexically_normal();
+        const fs::path b = outer.lexically_normal();
+        auto ai = a.begin();
+        for (auto bi = b.begin(); bi != b.end(); ++bi, ++ai) {
+            if (bi->empty() && std::next(bi) == b.end()) {
+                break; // outer had a trailing slash
+            }
+            if (ai == a.end() || *ai != *bi) {
+                return false;
+            }
+        }
+        return ai != a.end() && !ai->empty(); // Strictly below, not the same folder
+    };
+    std::vector<fs::path> outermost;
+    for (const fs::path& root : roots) {
+        bool nested = false;
+        for (const fs::path& other : roots) {
+            nested = nested || isInside(root, other);
+        }
+        if (!nested) {
+            outermost.push_back(root);
+        }
+    }
+    return outermost;
+}
+
+std::string deviceName(std::uint64_t device)
+{
+#if defined(_WIN32) || defined(__APPLE__)
+    return std::to_string(device);
+#else
+    const dev_t number = static_cast<dev_t>(device);
+    return std::to_string(major(number)) + ":" + std::to_string(minor(number));
+#endif
+}
+
+std::string describePlan(const RootPlan& plan)
+{
+    std::string text;
+    for (const MountPlanEntry& entry : plan.mounts) {
+        const std::string indented = std::string(entry.depth * 2, ' ') + entry.mountPoint;
+        char line[1024];
+        std::snprintf(line, sizeof(line), "%-32s %-10s %-24s %s%s%s\n", indented.c_str(), entry.fsType.c_str(),
+                      mountDecisionName(entry.decision), entry.source.c_str(), entry.note.empty() ? "" : " - ",
+                      entry.note.c_str());
+        text += line;
+    }
+    return text;
+}
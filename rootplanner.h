@@ -0,0 +1,104 @@
+#ifndef ROOTPLANNER_H
+#define ROOTPLANNER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct SearchConfig; // searchlogic.h
+
+// 🗺️ Planning Where to Walk 🗺️
+// "Search all drives" used to mean "every writable mount, one after the other". On Linux that
+// list has "/" AND "/home" AND "/boot", and the walk from "/" went straight down into /home and
+// /boot too, so they got scanned twice (and their matches counted twice). It also went through
+// /proc, /sys and every tmpfs on the way.
+//
+// Now the mount table gets read first, and every filesystem (st_dev) goes to exactly ONE root:
+//   - each mount that should be searched becomes a root of its own,
+//   - a walk never steps into another mount's folder (the MountBoundaries below), so /home is
+//     walked once, by the /home root, and never again from "/",
+//   - a mount showing a part of a filesystem that's already being walked (bind mounts, mostly)
+//     is left out,
+//   - kernel filesystems (proc, sysfs, cgroup...) are never walked, and memory-only ones
+//     (tmpfs, ramfs) only when asked for.
+// A start folder works the same way below it: FilesystemScope says whether the mounts under it
+// get walked as roots of their own, or not at all (like find -xdev).
+//
+// The plan lists every mount it looked at and what it decided, so the window and
+// iys-search --plan can show it. Windows has drive letters and no nesting, so there it's just those.
+
+// What a start folder's search does with the other filesystems mounted below it
+enum class FilesystemScope {
+    AllFilesystems, // Each one is searched too, as a root of its own
+    OneFilesystem   // Only the start folder's own filesystem (find -xdev, du -x)
+};
+
+// 🚧 Folders the walk must not step into: mount points of other roots, or of filesystems left out.
+// Kept as "parent folder -> names of the mount points in it", so the walk asks once per folder
+// (is there a boundary in here at all?) and then compares plain names, with no strings built.
+class MountBoundaries
+{
+public:
+    void add(const std::string& mountPoint); // Absolute path; "/" itself is never a boundary
+    bool empty() const { return byParent.empty(); }
+    std::size_t size() const;
+
+    // The mount point names directly inside dir (trailing slashes don't matter), or nullptr when none
+    const std::vector<std::string>* inside(std::string_view dir) const;
+    static bool contains(const std::vector<std::string>& names, std::string_view name);
+
+private:
+    std::vector<std::pair<std::string, std::vector<std::string>>> byParent; // Sorted by parent
+};
+
+// What the planner made of one mount
+enum class MountDecision {
+    Root,            // Searched, as a root of its own (or it holds the start folder)
+    Pseudo,          // proc, sysfs, cgroup... - kernel bookkeeping, never searched
+    Virtual,         // tmpfs, ramfs... - memory only, searched only with includeVirtualFilesystems
+    ReadOnly,        // All-drives search: read-only mounts are left out, same as always
+    Duplicate,       // Shows a part of a filesystem another root already covers (bind mounts)
+    OtherFilesystem  // FilesystemScope::OneFilesystem: a different filesystem below the start folder
+};
+
+struct MountPlanEntry {
+    std::string mountPoint;
+    std::string fsType;
+    std::string source;       // /dev/sda1, server:/export, ...
+    std::string subtree;      // Which folder of that filesystem is mounted here ("/" unless it's a bind mount)
+    std::uint64_t device = 0; // The st_dev of everything on it
+    unsigned int depth = 0;   // Mounts it is nested in (for indenting a tree)
+    MountDecision decision = MountDecision::Root;
+    std::string note;         // Why, in a few words ("same filesystem as /", "start folder")
+};
+
+struct RootPlan {
+    std::vector<fs::path> roots;         // Walk these, in this order
+    MountBoundaries boundaries;          // ...and never step into any of these
+    std::vector<MountPlanEntry> mounts;  // Everything looked at, parents before children
+};
+
+// Builds the plan for config.startPath (or every drive, with config.searchAllRoots),
+// config.filesystemScope and config.includeVirtualFilesystems.
+// A start folder that doesn't exist gives an empty plan - the caller says so.
+RootPlan planRoots(const SearchConfig& config);
+
+// "search", "skip (kernel)", "skip (duplicate)", ... for listings
+const char* mountDecisionName(MountDecision decision);
+
+// The roots that aren't inside another one of them. The index keeps no mount boundaries, so a query
+// of "/" already answers for "/home" - querying both would list everything in /home twice.
+std::vector<fs::path> outermostRoots(const std::vector<fs::path>& roots);
+
+// A device number the way the mount table writes it ("8:1" on Linux)
+std::string deviceName(std::uint64_t device);
+
+// The plan as text: one line per mount, indented by depth
+std::string describePlan(const RootPlan& plan);
+
+#endif // ROOTPLANNER_H
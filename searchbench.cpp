@@ -0,0 +1,1018 @@
+// 📊 Search Benchmark Suite 📊
+// "Did my change make the walk faster?" - this answers it, on a tree that's the same every
+// time: it builds a synthetic tree from a seed (synthtree.h), then times
+//   traversal.warm.*   full walks with the page cache warm, one per thread count
+//   traversal.cold.*   the same with the page cache dropped before every run
+//                      (Linux, and only when we're allowed to - skipped otherwise)
+//   matcher.*          CompiledQuery alone over every file name, held in memory
+//   delivery.*         what reporting results costs: a walk where every file matches vs. one
+//                      where none does, and ResultWriter formatting every path in each format
+//   content.*          SubstringMatcher::find() over text in memory, per kernel, and the
+//                      ContentSearcher reader pool going through every file of the tree
+//   duplicates.*       the XXH64 hash alone, and DuplicateFinder over every file of the tree
+//                      (with --file-size N every file has the same size, so all of them get
+//                      their edges hashed - the worst case for stage 2)
+//   metadata.*         a size predicate that every file passes, checked after a 1% name match
+//                      vs. on every file (what stat-first would cost), against no predicate at all
+//   io.*               the synchronous syscalls against io_uring batches (SearchConfig::ioBackend):
+//                      a plain walk (only the subfolder opens batch) and one that stats every file,
+//                      warm, and cold too where the page cache can be dropped
+//   order.*            folders walked and stat-ed as the directory lists them vs. in inode order
+//                      (SearchConfig::entryOrder), cold where the page cache can be dropped - that's
+//                      where the seeks are - and warm, to show what the sorting costs
+// and writes one JSON document with every sample, so runs from two commits can be diffed
+// (one result per line) or compared directly with --compare.
+//
+//   iys-bench                               default tree in the temp folder, JSON on stdout
+//   iys-bench --files 1000000 --depth 5     a bigger tree
+//   iys-bench --json after.json --compare before.json
+//   iys-bench --root /usr --only traversal  time a real folder instead
+//
+// Human-readable lines go to stderr, so stdout (or --json) is nothing but the JSON.
+
+#include "compiledquery.h"
+#include "contentsearch.h"
+#include "devicescheduler.h"
+#include "duplicatefinder.h"
+#include "resultbatch.h"
+#include "resultwriter.h"
+#include "rootplanner.h"
+#include "searchlogic.h"
+#include "searchtelemetry.h"
+#include "simdmatch.h"
+#include "synthtree.h"
+#include "uringbatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifndef _WIN32
+#include <sys/utsname.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSchemaVersion = 1;
+constexpr const char* kNoMatchTerm = "zq-term-that-matches-nothing-zq";
+
+struct BenchOptions {
+    SyntheticTreeSpec spec;
+    std::string treeDir;                // Where the synthetic tree goes (default: temp folder)
+    std::string externalRoot;           // --root: time this folder instead of a synthetic tree
+    std::vector<unsigned> threadCounts; // 0 = one per core
+    int repetitions = 5;
+    bool tryCold = true;
+    std::string only;                   // Comma list of groups to run (empty = all)
+    std::string jsonFile;               // Empty = stdout
+    std::string compareFile;
+};
+
+// One benchmark: every sample, plus how much work one sample did (for a rate)
+struct Measurement {
+    std::string name;
+    std::string unit = "s";
+    std::vector<double> samples;
+    double work = 0;                    // Items handled per sample
+    std::string workUnit;               // "entries", "names", "results"
+    std::string skipped;                // Why it didn't run (empty = it did)
+    std::map<std::string, double> extra; // Anything else worth keeping (sorted keys - stable output)
+
+    double median() const
+    {
+        if (samples.empty()) return 0;
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        const std::size_t mid = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+    }
+    double minimum() const { return samples.empty() ? 0 : *std::min_element(samples.begin(), samples.end()); }
+    double maximum() const { return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end()); }
+    double rate() const { const double m = median(); return m > 0 ? work / m : 0; }
+};
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool wanted(const BenchOptions& options, const char* group)
+{
+    if (options.only.empty()) return true;
+    std::stringstream list(options.only);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        if (item == group) return true;
+    }
+    return false;
+}
+
+std::string threadLabel(unsigned threads)
+{
+    return threads == 0 ? "auto" : std::to_string(threads);
+}
+
+// 🧊 Empties the page cache (and dentry/inode caches) so the next walk has to hit the disk.
+// Needs root on Linux; anywhere else (or without the privilege) it explains why not.
+bool dropPageCache(std::string& whyNot)
+{
+#ifdef __linux__
+    ::sync();
+    const int fd = ::open("/proc/sys/vm/drop_caches", O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        whyNot = std::string("can't open /proc/sys/vm/drop_caches (") + std::strerror(errno) + ") - run as root for cold-cache numbers";
+        return false;
+    }
+    const bool ok = ::write(fd, "3", 1) == 1;
+    const int savedErrno = errno;
+    ::close(fd);
+    if (!ok) {
+        whyNot = std::string("writing /proc/sys/vm/drop_caches failed (") + std::strerror(savedErrno) + ")";
+    }
+    return ok;
+#else
+    whyNot = "dropping the page cache is only done on Linux";
+    return false;
+#endif
+}
+
+// One full walk of root with the real engine. Returns seconds; fills scanned and found.
+double timeWalk(const fs::path& root, const SearchConfig& config, const SearchCallback& onResult,
+                std::uint64_t& scanned, unsigned long long& found, SearchTelemetry* telemetry = nullptr)
+{
+    const CompiledQuery query(config);
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> paused{false};
+    std::atomic<std::uint64_t> scannedCount{0};
+    std::mutex pauseMutex;
+    std::condition_variable pauseCondition;
+    found = 0;
+
+    const auto start = Clock::now();
+    searchDirectoryParallel(root, config, query, onResult, found, cancelled, scannedCount,
+                            paused, pauseMutex, pauseCondition, ProgressCallback(), nullptr, telemetry);
+    const double seconds = secondsSince(start);
+    scanned = scannedCount.load();
+    return seconds;
+}
+
+SearchConfig walkConfig(const fs::path& root, unsigned threads, const std::string& term)
+{
+    SearchConfig config;
+    config.searchTerm = term;
+    config.startPath = root.string();
+    config.threadCount = threads;
+    return config;
+}
+
+// 🚶 traversal.warm.* / traversal.cold.*
+void benchTraversal(const BenchOptions& options, const fs::path& root, std::vector<Measurement>& results)
+{
+    const SearchCallback ignore = [](const std::string&, const std::string&) {};
+
+    for (unsigned threads : options.threadCounts) {
+        const SearchConfig config = walkConfig(root, threads, kNoMatchTerm);
+        Measurement warm;
+        warm.name = "traversal.warm.threads=" + threadLabel(threads);
+        warm.workUnit = "entries";
+        std::uint64_t scanned = 0;
+        unsigned long long found = 0;
+        timeWalk(root, config, ignore, scanned, found); // Warm-up run: fills the caches, not timed
+        for (int rep = 0; rep < options.repetitions; ++rep) {
+            warm.samples.push_back(timeWalk(root, config, ignore, scanned, found));
+        }
+        warm.work = static_cast<double>(scanned);
+        warm.extra["threads"] = resolveThreadCount(config);
+        results.push_back(warm);
+        std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f entries/s\n", warm.name.c_str(), warm.median(), warm.rate());
+    }
+
+    if (!options.tryCold) {
+        return;
+    }
+    for (unsigned threads : options.threadCounts) {
+        const SearchConfig config = walkConfig(root, threads, kNoMatchTerm);
+        Measurement cold;
+        cold.name = "traversal.cold.threads=" + threadLabel(threads);
+        cold.workUnit = "entries";
+        for (int rep = 0; rep < options.repetitions && cold.skipped.empty(); ++rep) {
+            if (!dropPageCache(cold.skipped)) {
+                cold.samples.clear();
+                break;
+            }
+            std::uint64_t scanned = 0;
+            unsigned long long found = 0;
+            cold.samples.push_back(timeWalk(root, config, ignore, scanned, found));
+            cold.work = static_cast<double>(scanned);
+        }
+        cold.extra["threads"] = resolveThreadCount(config);
+        if (!cold.skipped.empty()) {
+            std::fprintf(stderr, "  %-34s skipped: %s\n", cold.name.c_str(), cold.skipped.c_str());
+        } else {
+            std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f entries/s\n", cold.name.c_str(), cold.median(), cold.rate());
+        }
+        results.push_back(cold);
+    }
+}
+
+// Every file under root: full paths and the offset where each name starts
+struct NameList {
+    std::vector<std::string> paths;
+    std::vector<std::size_t> nameStarts;
+};
+
+NameList collectNames(const fs::path& root)
+{
+    NameList list;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        std::error_code typeError;
+        if (it->is_regular_file(typeError)) {
+            std::string path = it->path().string();
+            list.nameStarts.push_back(path.size() - it->path().filename().string().size());
+            list.paths.push_back(std::move(path));
+        }
+    }
+    return list;
+}
+
+// 🔍 matcher.* - CompiledQuery on names in memory, through dispatch() like the walk uses it
+void benchMatcher(const BenchOptions& options, const NameList& names, std::vector<Measurement>& results)
+{
+    struct Case {
+        const char* label;
+        const char* term;
+        const char* extension;
+        bool caseInsensitive;
+        MatchMode mode = MatchMode::Substring;
+        const char* terms = nullptr; // '|'-separated: several terms in one pass (SearchConfig::searchTerms)
+    };
+    const Case cases[] = {
+        {"substring.case", "needle", "", false},
+        {"substring.icase", "needle", "", true},
+        {"substring-miss.icase", "needle-never-there", "", true},
+        {"byte.case", "q", "", false},
+        {"byte.icase", "q", "", true},
+        {"extension-only", "", "log", false},
+        {"substring+extension.icase", "needle", "txt", true},
+        {"glob-literal.icase", "*needle*", "", true, MatchMode::Glob},
+        {"glob.case", "*-1??.txt", "", false, MatchMode::Glob},
+        {"glob-alternatives.icase", "*needle*.{jpg,png}", "", true, MatchMode::Glob},
+        {"regex.case", "needle.*-[0-9]+\\.(txt|log)$", "", false, MatchMode::Regex},
+        {"regex-short-literal.case", "^[a-z]+-[0-9]{3}\\.h$", "", false, MatchMode::Regex},
+        {"fuzzy.icase", "ndltx", "", true, MatchMode::Fuzzy},
+        {"multi-8.icase", "", "", true, MatchMode::Substring, "needle|report|backup|photo|draft|invoice|-99|.tmp"},
+        {"multi-32.case", "", "", false, MatchMode::Substring,
+         "needle|report|backup|photo|draft|invoice|-99|.tmp|alpha|beta|gamma|delta|final|copy|old|new|"
+         "2019|2020|2021|2022|readme|notes|todo|build|cache|index|main|test|data|log|dump|core"},
+    };
+
+    std::vector<std::string_view> views;
+    views.reserve(names.paths.size());
+    for (std::size_t i = 0; i < names.paths.size(); ++i) {
+        views.push_back(std::string_view(names.paths[i]).substr(names.nameStarts[i]));
+    }
+
+    for (const Case& c : cases) {
+        SearchConfig config;
+        config.searchTerm = c.term;
+        config.extensionFilter = c.extension;
+        config.caseInsensitive = c.caseInsensitive;
+        config.matchMode = c.mode;
+        for (std::string_view rest = c.terms ? c.terms : ""; !rest.empty();) {
+            const std::size_t bar = rest.find('|');
+            config.searchTerms.emplace_back(rest.substr(0, bar));
+            rest = bar == std::string_view::npos ? std::string_view() : rest.substr(bar + 1);
+        }
+        const CompiledQuery query(config);
+
+        Measurement m;
+        m.name = std::string("matcher.") + c.label;
+        m.unit = "s";
+        m.workUnit = "names";
+        m.work = static_cast<double>(views.size());
+        std::uint64_t hits = 0;
+        for (int rep = 0; rep <= options.repetitions; ++rep) {
+            const auto start = Clock::now();
+            hits = query.dispatch([&](auto match) {
+                std::uint64_t count = 0;
+                for (const std::string_view name : views) {
+                    count += match(name);
+                }
+                return count;
+            });
+            if (rep > 0) { // The first pass just pulls the names into cache
+                m.samples.push_back(secondsSince(start));
+            }
+        }
+        m.extra["matches"] = static_cast<double>(hits);
+        m.extra["nsPerName"] = views.empty() ? 0 : m.median() * 1e9 / views.size();
+        results.push_back(m);
+        std::fprintf(stderr, "  %-34s %9.2f ns/name  %10llu matches\n", m.name.c_str(), m.extra["nsPerName"],
+                     static_cast<unsigned long long>(hits));
+    }
+}
+
+// 📬 delivery.* - what it costs to hand results on, apart from finding them
+void benchDelivery(const BenchOptions& options, const fs::path& root, const NameList& names,
+                   std::vector<Measurement>& results)
+{
+    // 1) A walk where every file matches, batched like SearchWorker does it, against the
+    //    no-match walk from traversal.warm: the difference is the per-result cost of the engine
+    const unsigned threads = options.threadCounts.back();
+    {
+        std::uint64_t delivered = 0;
+        ResultBatcher batcher([&](ResultBatchPtr batch) { delivered += batch->size(); });
+        const SearchCallback collect = [&](const std::string& path, const std::string&) {
+            if (!path.empty()) batcher.add(path);
+        };
+        const SearchConfig config = walkConfig(root, threads, "");
+        Measurement m;
+        m.name = "delivery.walk-all-match.threads=" + threadLabel(threads);
+        m.workUnit = "results";
+        std::uint64_t scanned = 0;
+        unsigned long long found = 0;
+        timeWalk(root, config, collect, scanned, found);
+        batcher.flush();
+        for (int rep = 0; rep < options.repetitions; ++rep) {
+            m.samples.push_back(timeWalk(root, config, collect, scanned, found));
+            batcher.flush();
+        }
+        m.work = static_cast<double>(found);
+        m.extra["batches"] = static_cast<double>(batcher.batchesSent());
+
+        const std::string baselineName = "traversal.warm.threads=" + threadLabel(threads);
+        for (const Measurement& base : results) {
+            if (base.name == baselineName && found > 0) {
+                m.extra["nsPerResultOverNoMatch"] = (m.median() - base.median()) * 1e9 / found;
+            }
+        }
+        results.push_back(m);
+        std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f results/s\n", m.name.c_str(), m.median(), m.rate());
+    }
+
+    // 2) ResultWriter formatting every path into the bit bucket, per format
+#ifdef _WIN32
+    const char* nullDevice = "NUL";
+#else
+    const char* nullDevice = "/dev/null";
+#endif
+    const std::pair<OutputFormat, const char*> formats[] = {
+        {OutputFormat::Text, "text"},
+        {OutputFormat::NulSeparated, "nul"},
+        {OutputFormat::JsonLines, "jsonl"},
+        {OutputFormat::Binary, "binary"},
+    };
+    for (const auto& [format, label] : formats) {
+        Measurement m;
+        m.name = std::string("delivery.writer.") + label;
+        m.workUnit = "results";
+        m.work = static_cast<double>(names.paths.size());
+        ResultWriterStats stats;
+        for (int rep = 0; rep < options.repetitions; ++rep) {
+            SearchConfig config;
+            config.outputFile = nullDevice;
+            config.outputFormat = format;
+            ResultWriter writer;
+            std::string problem;
+            if (!writer.open(config, problem)) {
+                m.skipped = problem;
+                break;
+            }
+            const auto start = Clock::now();
+            ResultBatcher batcher([&](ResultBatchPtr batch) { writer.submit(std::move(batch)); });
+            for (const std::string& path : names.paths) {
+                batcher.add(path);
+            }
+            batcher.flush();
+            stats = writer.finish(names.paths.size(), names.paths.size(), 0, false);
+            m.samples.push_back(secondsSince(start));
+        }
+        m.extra["bytes"] = static_cast<double>(stats.bytesWritten);
+        m.extra["producerWaits"] = static_cast<double>(stats.producerWaits);
+        results.push_back(m);
+        std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f results/s\n", m.name.c_str(), m.median(), m.rate());
+    }
+}
+
+// 📖 content.* - what looking inside files costs: the find kernel alone, then the whole reader pool
+void benchContent(const BenchOptions& options, const NameList& names, std::vector<Measurement>& results)
+{
+    // 1) 32 MB of text-like bytes (lowercase words, a newline every ~60), no match anywhere -
+    //    the kernel has to go through all of it, which is what most files look like to it
+    std::string text(32u << 20, ' ');
+    std::uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (char& c : text) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        const unsigned roll = static_cast<unsigned>(state >> 58); // 0..63
+        c = roll == 0 ? '\n' : roll < 10 ? ' ' : static_cast<char>('a' + (state >> 40) % 26);
+    }
+    const std::pair<SimdMatch::Kernel, const char*> kernels[] = {
+        {SimdMatch::Kernel::Scalar, "scalar"},
+        {SimdMatch::Kernel::SSE42, "sse4.2"},
+        {SimdMatch::Kernel::AVX2, "avx2"},
+    };
+    for (const auto& [kernel, label] : kernels) {
+        for (const bool fold : {false, true}) {
+            Measurement m;
+            m.name = std::string("content.find.") + label + (fold ? ".icase" : ".case");
+            m.workUnit = "bytes";
+            m.work = static_cast<double>(text.size());
+            if (!SimdMatch::isSupported(kernel)) {
+                m.skipped = "this CPU can't run it";
+                std::fprintf(stderr, "  %-34s skipped: %s\n", m.name.c_str(), m.skipped.c_str());
+                results.push_back(m);
+                continue;
+            }
+            const SubstringMatcher matcher(kNoMatchTerm, fold, kernel);
+            std::size_t at = 0;
+            for (int rep = 0; rep <= options.repetitions; ++rep) {
+                const auto start = Clock::now();
+                at = matcher.find(text);
+                if (rep > 0) {
+                    m.samples.push_back(secondsSince(start));
+                }
+            }
+            m.extra["found"] = at == SubstringMatcher::npos ? 0 : 1;
+            results.push_back(m);
+            std::fprintf(stderr, "  %-34s %9.2f GB/s\n", m.name.c_str(), m.rate() / 1e9);
+        }
+    }
+
+    // 2) Every file of the tree through the reader pool (open, read or map, NUL probe, search).
+    //    On a tree of empty files (--file-size 0) that's the per-file cost and nothing else.
+    SearchConfig config;
+    config.contentTerm = kNoMatchTerm;
+    Measurement m;
+    m.name = "content.readers=auto";
+    m.workUnit = "files";
+    m.work = static_cast<double>(names.paths.size());
+    std::atomic<bool> cancelled{false};
+    ContentSearchStats stats;
+    for (int rep = 0; rep < options.repetitions; ++rep) {
+        const auto start = Clock::now();
+        ContentSearcher searcher(config, [](std::string_view, std::uint64_t, std::string_view) {}, cancelled);
+        for (const std::string& path : names.paths) {
+            searcher.submit(path);
+        }
+        stats = searcher.finish();
+        m.samples.push_back(secondsSince(start));
+    }
+    m.extra["bytesPerRun"] = static_cast<double>(stats.bytesSearched);
+    m.extra["mappedFiles"] = static_cast<double>(stats.mappedFiles);
+    m.extra["producerWaits"] = static_cast<double>(stats.producerWaits);
+    m.extra["readers"] = stats.readers;
+    results.push_back(m);
+    std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f files/s  %8.1f MB/s\n", m.name.c_str(), m.median(), m.rate(),
+                 m.median() > 0 ? stats.bytesSearched / m.median() / (1024.0 * 1024.0) : 0.0);
+}
+
+// 👯 duplicates.* - the hash on its own, then the whole size/edges/full pipeline
+void benchDuplicates(const BenchOptions& options, const NameList& names, std::vector<Measurement>& results)
+{
+    {
+        const std::string data(64u << 20, 'x');
+        Measurement m;
+        m.name = "duplicates.hash.xxh64";
+        m.workUnit = "bytes";
+        m.work = static_cast<double>(data.size());
+        std::uint64_t sink = 0;
+        for (int rep = 0; rep <= options.repetitions; ++rep) {
+            const auto start = Clock::now();
+            sink ^= DuplicateFinder::hash(data, static_cast<std::uint64_t>(rep));
+            if (rep > 0) {
+                m.samples.push_back(secondsSince(start));
+            }
+        }
+        m.extra["checksum"] = static_cast<double>(sink & 0xFFFF); // Keeps the loop from being optimized away
+        results.push_back(m);
+        std::fprintf(stderr, "  %-34s %9.2f GB/s\n", m.name.c_str(), m.rate() / 1e9);
+    }
+
+    SearchConfig config;
+    config.findDuplicates = true;
+    Measurement m;
+    m.name = "duplicates.finder.readers=auto";
+    m.workUnit = "files";
+    m.work = static_cast<double>(names.paths.size());
+    std::atomic<bool> cancelled{false};
+    DuplicateStats stats;
+    for (int rep = 0; rep < options.repetitions; ++rep) {
+        DuplicateFinder finder(config, cancelled);
+        for (const std::string& path : names.paths) {
+            finder.add(path);
+        }
+        const auto start = Clock::now();
+        finder.find();
+        m.samples.push_back(secondsSince(start));
+        stats = finder.stats();
+    }
+    m.extra["groups"] = static_cast<double>(stats.groups);
+    m.extra["sizeMatched"] = static_cast<double>(stats.sizeMatched);
+    m.extra["fullHashed"] = static_cast<double>(stats.fullHashed);
+    m.extra["bytesRead"] = static_cast<double>(stats.bytesRead);
+    m.extra["bytesAvoided"] = static_cast<double>(stats.bytesAvoided);
+    m.extra["readers"] = stats.readers;
+    results.push_back(m);
+    std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f files/s  read %.1f of %.1f MB, %llu group(s)\n", m.name.c_str(),
+                 m.median(), m.rate(), stats.bytesRead / (1024.0 * 1024.0), stats.totalBytes / (1024.0 * 1024.0),
+                 static_cast<unsigned long long>(stats.groups));
+}
+
+// 🗃️ metadata.* - what the name-first ordering saves. The predicate lets every file through,
+// so the three walks find the same names and only the number of stats differs.
+void benchMetadata(const BenchOptions& options, const fs::path& root, std::vector<Measurement>& results)
+{
+    struct Case {
+        const char* label;
+        const char* term;
+        bool predicate;
+    };
+    const Case cases[] = {
+        {"off.term=needle", "needle", false},
+        {"name-first.term=needle", "needle", true},
+        {"stat-all.term=none", "", true},
+    };
+    const unsigned threads = options.threadCounts.back();
+    const SearchCallback ignore = [](const std::string&, const std::string&) {};
+    for (const Case& c : cases) {
+        SearchConfig config = walkConfig(root, threads, c.term);
+        if (c.predicate) {
+            config.metadata.maxSize = std::uint64_t(1) << 40; // 1 TiB: nobody's synthetic file is that big
+        }
+        Measurement m;
+        m.name = std::string("metadata.") + c.label;
+        m.workUnit = "entries";
+        std::uint64_t scanned = 0;
+        unsigned long long found = 0;
+        timeWalk(root, config, ignore, scanned, found); // Warm-up
+        SearchTelemetry telemetry(resolveThreadCount(config));
+        for (int rep = 0; rep < options.repetitions; ++rep) {
+            m.samples.push_back(timeWalk(root, config, ignore, scanned, found, rep == 0 ? &telemetry : nullptr));
+        }
+        const TelemetrySnapshot numbers = telemetry.snapshot();
+        m.work = static_cast<double>(scanned);
+        m.extra["found"] = static_cast<double>(found);
+        m.extra["stats"] = static_cast<double>(numbers.counter(TelemetryCounter::MetadataStats));
+        m.extra["statsSaved"] = static_cast<double>(numbers.counter(TelemetryCounter::MetadataStatsSaved));
+        results.push_back(m);
+        std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f entries/s  %llu stat(s), %llu saved (%s)\n", m.name.c_str(),
+                     m.median(), m.rate(), static_cast<unsigned long long>(numbers.counter(TelemetryCounter::MetadataStats)),
+                     static_cast<unsigned long long>(numbers.counter(TelemetryCounter::MetadataStatsSaved)),
+                     c.predicate ? MetadataFilter::statMethod() : "no predicate");
+    }
+}
+
+// 💍 io.* - one statx/openat at a time vs. a folder's worth of them per io_uring_enter().
+// The uring cases are skipped (and say why) where the kernel won't give us a ring.
+void benchIo(const BenchOptions& options, const fs::path& root, std::vector<Measurement>& results)
+{
+    struct Case {
+        const char* label;
+        bool statEveryFile; // A size predicate with an empty term: one metadata statx per file
+    };
+    const Case cases[] = {
+        {"walk", false},
+        {"stat-all", true},
+    };
+    std::string uringProblem;
+    const bool haveUring = UringBatch::available(&uringProblem);
+    const unsigned threads = options.threadCounts.back();
+    const SearchCallback ignore = [](const std::string&, const std::string&) {};
+
+    for (const bool cold : {false, true}) {
+        if (cold && !options.tryCold) {
+            break;
+        }
+        for (const Case& c : cases) {
+            for (const IoBackend backend : {IoBackend::Sync, IoBackend::IoUring}) {
+                SearchConfig config = walkConfig(root, threads, c.statEveryFile ? "" : kNoMatchTerm);
+                config.ioBackend = backend;
+                if (c.statEveryFile) {
+                    config.metadata.maxSize = std::uint64_t(1) << 40; // Everything passes, so only the stats differ
+                }
+                const bool uring = backend == IoBackend::IoUring;
+                Measurement m;
+                m.name = std::string("io.") + (cold ? "cold." : "warm.") + c.label + (uring ? ".uring" : ".sync");
+                m.workUnit = "entries";
+                m.extra["queueDepth"] = uring ? config.ioQueueDepth : 0;
+                if (uring && !haveUring) {
+                    m.skipped = uringProblem;
+                }
+                std::uint64_t scanned = 0;
+                unsigned long long found = 0;
+                SearchTelemetry telemetry(resolveThreadCount(config));
+                if (!cold && m.skipped.empty()) {
+                    timeWalk(root, config, ignore, scanned, found); // Warm-up
+                }
+                for (int rep = 0; rep < options.repetitions && m.skipped.empty(); ++rep) {
+                    if (cold && !dropPageCache(m.skipped)) {
+                        m.samples.clear();
+                        break;
+                    }
+                    m.samples.push_back(timeWalk(root, config, ignore, scanned, found, rep == 0 ? &telemetry : nullptr));
+                }
+                if (!m.skipped.empty()) {
+                    std::fprintf(stderr, "  %-34s skipped: %s\n", m.name.c_str(), m.skipped.c_str());
+                    results.push_back(m);
+                    continue;
+                }
+                const TelemetrySnapshot numbers = telemetry.snapshot();
+                const std::uint64_t submits = numbers.counter(TelemetryCounter::RingSubmits);
+                const std::uint64_t requests = numbers.counter(TelemetryCounter::RingRequests);
+                m.work = static_cast<double>(scanned);
+                m.extra["ringSubmits"] = static_cast<double>(submits);
+                m.extra["ringRequests"] = static_cast<double>(requests);
+                results.push_back(m);
+                std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f entries/s", m.name.c_str(), m.median(), m.rate());
+                if (uring) {
+                    std::fprintf(stderr, "  %.1f request(s) per submit", submits ? double(requests) / double(submits) : 0.0);
+                }
+                std::fprintf(stderr, "\n");
+            }
+        }
+    }
+}
+
+// 💿 order.* - directory order against inode order, one worker, synchronous syscalls.
+// Only a cold run shows what it's for (and only on a spinning disk, really); the warm runs are
+// there to show the sort is cheap. The extra "rotational" says which kind of disk the tree is on.
+void benchOrder(const BenchOptions& options, const fs::path& root, std::vector<Measurement>& results)
+{
+    struct Case {
+        const char* label;
+        bool statEveryFile; // A size predicate with an empty term: one metadata stat per file, in order
+    };
+    const Case cases[] = {
+        {"walk", false},
+        {"stat-all", true},
+    };
+    const unsigned threads = options.threadCounts.front();
+    const SearchCallback ignore = [](const std::string&, const std::string&) {};
+
+    const SearchConfig probe = walkConfig(root, threads, kNoMatchTerm);
+    const std::vector<DeviceGroup> groups = groupRootsByDevice(planRoots(probe), probe);
+    const bool rotational = !groups.empty() && groups.front().kind == DeviceKind::Rotational;
+
+    for (const bool cold : {false, true}) {
+        if (cold && !options.tryCold) {
+            break;
+        }
+        for (const Case& c : cases) {
+            for (const EntryOrder order : {EntryOrder::Directory, EntryOrder::Inode}) {
+                SearchConfig config = walkConfig(root, threads, c.statEveryFile ? "" : kNoMatchTerm);
+                config.entryOrder = order;
+                if (c.statEveryFile) {
+                    config.metadata.maxSize = std::uint64_t(1) << 40; // Everything passes, so only the order differs
+                }
+                Measurement m;
+                m.name = std::string("order.") + (cold ? "cold." : "warm.") + c.label
+                         + (order == EntryOrder::Inode ? ".inode" : ".directory");
+                m.workUnit = "entries";
+                m.extra["threads"] = resolveThreadCount(config);
+                m.extra["rotational"] = rotational ? 1 : 0;
+                std::uint64_t scanned = 0;
+                unsigned long long found = 0;
+                if (!cold) {
+                    timeWalk(root, config, ignore, scanned, found); // Warm-up
+                }
+                for (int rep = 0; rep < options.repetitions && m.skipped.empty(); ++rep) {
+                    if (cold && !dropPageCache(m.skipped)) {
+                        m.samples.clear();
+                        break;
+                    }
+                    m.samples.push_back(timeWalk(root, config, ignore, scanned, found));
+                }
+                if (!m.skipped.empty()) {
+                    std::fprintf(stderr, "  %-34s skipped: %s\n", m.name.c_str(), m.skipped.c_str());
+                } else {
+                    m.work = static_cast<double>(scanned);
+                    std::fprintf(stderr, "  %-34s %9.4f s median  %12.0f entries/s\n", m.name.c_str(), m.median(), m.rate());
+                }
+                results.push_back(m);
+            }
+        }
+    }
+}
+
+// --- JSON out (hand-rolled: fixed key order and one result per line, so `diff` reads well) ---
+
+std::string jsonString(std::string_view text)
+{
+    std::string out = "\"";
+    for (char ch : text) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        if (c == '"' || c == '\\') { out += '\\'; out += ch; }
+        else if (c < 0x20) { char escaped[8]; std::snprintf(escaped, sizeof(escaped), "\\u%04x", c); out += escaped; }
+        else out += ch;
+    }
+    return out + "\"";
+}
+
+std::string jsonNumber(double value)
+{
+    char text[40];
+    std::snprintf(text, sizeof(text), "%.9g", value);
+    return text;
+}
+
+std::string machineJson()
+{
+    std::string compiler;
+#if defined(__clang__)
+    compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+    compiler = "unknown";
+#endif
+    std::string system = "unknown";
+#ifndef _WIN32
+    struct utsname name;
+    if (::uname(&name) == 0) {
+        system = std::string(name.sysname) + " " + name.release + " " + name.machine;
+    }
+#else
+    system = "Windows";
+#endif
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+#ifdef IYS_HAVE_GETDENTS64
+    const bool getdents = true;
+#else
+    const bool getdents = false;
+#endif
+    return "{\"cpus\": " + std::to_string(std::thread::hardware_concurrency()) + ", \"system\": " + jsonString(system)
+           + ", \"compiler\": " + jsonString(compiler) + ", \"build\": " + jsonString(build)
+           + ", \"getdents64\": " + (getdents ? "true" : "false")
+           + ", \"simd\": " + jsonString(SimdMatch::kernelName(SimdMatch::bestKernel())) + "}";
+}
+
+std::string measurementJson(const Measurement& m)
+{
+    std::string out = "{\"name\": " + jsonString(m.name);
+    if (!m.skipped.empty()) {
+        return out + ", \"skipped\": " + jsonString(m.skipped) + "}";
+    }
+    out += ", \"unit\": " + jsonString(m.unit) + ", \"median\": " + jsonNumber(m.median())
+           + ", \"min\": " + jsonNumber(m.minimum()) + ", \"max\": " + jsonNumber(m.maximum())
+           + ", \"work\": " + jsonNumber(m.work) + ", \"workUnit\": " + jsonString(m.workUnit)
+           + ", \"rate\": " + jsonNumber(m.rate());
+    for (const auto& [key, value] : m.extra) {
+        out += ", " + jsonString(key) + ": " + jsonNumber(value);
+    }
+    out += ", \"samples\": [";
+    for (std::size_t i = 0; i < m.samples.size(); ++i) {
+        out += (i ? ", " : "") + jsonNumber(m.samples[i]);
+    }
+    return out + "]}";
+}
+
+std::string documentJson(const BenchOptions& options, const SyntheticTreeStats* tree, const fs::path& root,
+                         const std::vector<Measurement>& results)
+{
+    std::string out = "{\n";
+    out += "  \"schema\": " + std::to_string(kSchemaVersion) + ",\n";
+    out += "  \"tool\": \"iys-bench\",\n";
+    out += "  \"machine\": " + machineJson() + ",\n";
+    out += "  \"repetitions\": " + std::to_string(options.repetitions) + ",\n";
+    if (tree) {
+        char fingerprint[32];
+        std::snprintf(fingerprint, sizeof(fingerprint), "%016llx", static_cast<unsigned long long>(tree->fingerprint));
+        out += "  \"tree\": {\"kind\": \"synthetic\", \"spec\": " + jsonString(options.spec.describe())
+               + ", \"fingerprint\": \"" + fingerprint + "\", \"dirs\": " + std::to_string(tree->dirs)
+               + ", \"files\": " + std::to_string(tree->files) + ", \"nameBytes\": " + std::to_string(tree->nameBytes)
+               + ", \"needleLower\": " + std::to_string(tree->needleLower)
+               + ", \"needleUpper\": " + std::to_string(tree->needleUpper) + "},\n";
+    } else {
+        out += "  \"tree\": {\"kind\": \"external\", \"root\": " + jsonString(root.string()) + "},\n";
+    }
+    out += "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        out += "    " + measurementJson(results[i]) + (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out += "  ]\n}\n";
+    return out;
+}
+
+// 🆚 --compare: median change per benchmark against an earlier iys-bench JSON file.
+// We only ever read our own output, where each result sits on one line - no JSON parser needed.
+void compareWith(const std::string& file, const std::vector<Measurement>& results)
+{
+    std::ifstream in(file);
+    if (!in) {
+        std::fprintf(stderr, "Can't read %s - nothing to compare against.\n", file.c_str());
+        return;
+    }
+    std::map<std::string, double> before;
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::size_t nameAt = line.find("{\"name\": \"");
+        const std::size_t medianAt = line.find("\"median\": ");
+        if (nameAt == std::string::npos || medianAt == std::string::npos) continue;
+        const std::size_t nameStart = nameAt + 10;
+        const std::size_t nameEnd = line.find('"', nameStart);
+        before[line.substr(nameStart, nameEnd - nameStart)] = std::strtod(line.c_str() + medianAt + 10, nullptr);
+    }
+
+    std::fprintf(stderr, "\nAgainst %s (median, negative = faster now):\n", file.c_str());
+    for (const Measurement& m : results) {
+        const auto it = before.find(m.name);
+        if (it == before.end() || !m.skipped.empty() || it->second <= 0) {
+            std::fprintf(stderr, "  %-34s %s\n", m.name.c_str(), m.skipped.empty() ? "(new)" : "(skipped)");
+            continue;
+        }
+        const double change = (m.median() - it->second) / it->second * 100.0;
+        std::fprintf(stderr, "  %-34s %11.6f -> %11.6f s  %+6.1f%%\n", m.name.c_str(), it->second, m.median(), change);
+    }
+}
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "Usage: iys-bench [options]\n"
+        "Tree:\n"
+        "  --tree DIR          where the synthetic tree lives (default: <temp>/iys-bench-<fingerprint>)\n"
+        "  --root DIR          benchmark an existing folder instead of a synthetic tree\n"
+        "  --seed N            (1)          --depth N   (4)       --fanout N (8)\n"
+        "  --files N           (200000)     --file-size BYTES (0)\n"
+        "  --names uniform|lognormal (lognormal)  --name-min N (3)  --name-max N (64)\n"
+        "  --name-median N     (12)         --name-sigma X (0.5)  --match-fraction X (0.01)\n"
+        "Runs:\n"
+        "  --threads LIST      comma list, 0 = one per core (default 1,0)\n"
+        "  --reps N            timed runs per benchmark (5)\n"
+        "  --only LIST         traversal,matcher,delivery,content,duplicates,metadata,io,order\n"
+        "                      (default all)\n"
+        "  --no-cold           don't even try dropping the page cache\n"
+        "Output:\n"
+        "  --json FILE         write the JSON here instead of stdout\n"
+        "  --compare FILE      print the change against an earlier run\n");
+}
+
+bool parseArguments(int argc, char** argv, BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--tree") options.treeDir = value();
+        else if (arg == "--root") options.externalRoot = value();
+        else if (arg == "--seed") options.spec.seed = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--depth") options.spec.depth = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        else if (arg == "--fanout") options.spec.fanout = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        else if (arg == "--files") options.spec.fileCount = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--file-size") options.spec.fileSize = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--name-min") options.spec.nameLengthMin = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        else if (arg == "--name-max") options.spec.nameLengthMax = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        else if (arg == "--name-median") options.spec.nameLengthMedian = std::strtod(value(), nullptr);
+        else if (arg == "--name-sigma") options.spec.nameLengthSigma = std::strtod(value(), nullptr);
+        else if (arg == "--match-fraction") options.spec.matchFraction = std::strtod(value(), nullptr);
+        else if (arg == "--names") {
+            const std::string kind = value();
+            if (kind == "uniform") options.spec.nameLengths = NameLengthDistribution::Uniform;
+            else if (kind == "lognormal") options.spec.nameLengths = NameLengthDistribution::LogNormal;
+            else { std::fprintf(stderr, "--names is uniform or lognormal\n"); return false; }
+        }
+        else if (arg == "--threads") {
+            options.threadCounts.clear();
+            std::stringstream list(value());
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                options.threadCounts.push_back(static_cast<unsigned>(std::strtoul(item.c_str(), nullptr, 10)));
+            }
+        }
+        else if (arg == "--reps") options.repetitions = std::max(1, std::atoi(value()));
+        else if (arg == "--only") options.only = value();
+        else if (arg == "--no-cold") options.tryCold = false;
+        else if (arg == "--json") options.jsonFile = value();
+        else if (arg == "--compare") options.compareFile = value();
+        else { printUsage(); return false; }
+    }
+    if (options.threadCounts.empty()) {
+        options.threadCounts = {1, 0};
+    }
+    if (options.spec.fanout == 0) {
+        options.spec.depth = 0; // No subfolders at all, then
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 2;
+    }
+
+    // 🌳 The tree: synthetic (made or reused) unless --root says otherwise
+    fs::path root;
+    SyntheticTreeStats tree;
+    const bool synthetic = options.externalRoot.empty();
+    if (synthetic) {
+        const SyntheticTreeStats plan = planSyntheticTree(options.spec);
+        if (options.treeDir.empty()) {
+            char name[48];
+            std::snprintf(name, sizeof(name), "iys-bench-%016llx", static_cast<unsigned long long>(plan.fingerprint));
+            root = fs::temp_directory_path() / name;
+        } else {
+            root = options.treeDir;
+        }
+        std::fprintf(stderr, "Tree %s\n  %s\n", root.string().c_str(), options.spec.describe().c_str());
+        std::string problem;
+        if (!generateSyntheticTree(root, options.spec, tree, problem)) {
+            std::fprintf(stderr, "Couldn't make the tree: %s\n", problem.c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "  %llu folders, %llu files (%s)\n", static_cast<unsigned long long>(tree.dirs),
+                     static_cast<unsigned long long>(tree.files),
+                     tree.reused ? "reused" : (std::to_string(tree.seconds) + " s to create").c_str());
+    } else {
+        root = fs::absolute(options.externalRoot);
+        std::fprintf(stderr, "Folder %s\n", root.string().c_str());
+    }
+
+    std::vector<Measurement> results;
+    if (wanted(options, "traversal")) {
+        std::fprintf(stderr, "Traversal\n");
+        benchTraversal(options, root, results);
+    }
+    NameList names;
+    if (wanted(options, "matcher") || wanted(options, "delivery") || wanted(options, "content")
+        || wanted(options, "duplicates")) {
+        names = collectNames(root);
+    }
+    if (wanted(options, "matcher")) {
+        std::fprintf(stderr, "Matcher (%zu names in memory)\n", names.paths.size());
+        benchMatcher(options, names, results);
+    }
+    if (wanted(options, "delivery")) {
+        std::fprintf(stderr, "Delivery\n");
+        benchDelivery(options, root, names, results);
+    }
+    if (wanted(options, "content")) {
+        std::fprintf(stderr, "Content\n");
+        benchContent(options, names, results);
+    }
+    if (wanted(options, "duplicates")) {
+        std::fprintf(stderr, "Duplicates\n");
+        benchDuplicates(options, names, results);
+    }
+    if (wanted(options, "metadata")) {
+        std::fprintf(stderr, "Metadata\n");
+        benchMetadata(options, root, results);
+    }
+    if (wanted(options, "io")) {
+        std::fprintf(stderr, "I/O backend\n");
+        benchIo(options, root, results);
+    }
+    if (wanted(options, "order")) {
+        std::fprintf(stderr, "Entry order\n");
+        benchOrder(options, root, results);
+    }
+
+    const std::string json = documentJson(options, synthetic ? &tree : nullptr, root, results);
+    if (options.jsonFile.empty()) {
+        std::fwrite(json.data(), 1, json.size(), stdout);
+    } else {
+        std::ofstream out(options.jsonFile, std::ios::binary | std::ios::trunc);
+        out << json;
+        if (!out) {
+            std::fprintf(stderr, "Couldn't write %s\n", options.jsonFile.c_str());
+            return 1;
+        }
+    }
+    if (!options.compareFile.empty()) {
+        compareWith(options.compareFile, results);
+    }
+    return 0;
+}
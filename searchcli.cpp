@@ -0,0 +1,1028 @@
+// 🖥️ iys-search - IYS Searcher Without the Window 🖥️
+// The very same engine the GUI drives (iys-core), for scripts, cron jobs and pipes.
+// Every SearchConfig option has a flag, results stream to stdout as they're found,
+// and the exit status says how it went:
+//
+//   0    found at least one match
+//   1    searched everything, found nothing
+//   2    bad command line
+//   3    something went wrong (missing folder, unwritable output, ...)
+//   130  interrupted (Ctrl+C / SIGTERM) - whatever was found so far was still printed
+//
+//   iys-search report                          every file under . with "report" in its name
+//   iys-search -i -e pdf invoice -p ~/Documents
+//   iys-search --glob 'IMG_????.{jpg,png}' -p ~/Pictures
+//   iys-search --regex '^core\.[0-9]+$' -p /var/crash
+//   iys-search --fuzzy --top 20 mwcpp -p ~/src       the 20 best fuzzy matches, best first
+//   iys-search -t invoice -t receipt -t contract -p /archive   three terms, ONE walk, grouped by term
+//   iys-search --all-roots --format nul core | xargs -0 ls -l
+//   iys-search -e cpp --content TODO -p ~/src        every line with TODO in a .cpp file, grep-style
+//   iys-search --duplicates --min-size 1M -p /share  identical files, grouped, biggest waste first
+//   iys-search --size 1G.. --mtime 7d -e iso -p /srv  ISOs over 1 GB touched in the last week
+//   iys-search -p /data --index-mode build --index data.iys x   walk once, save an index
+//   iys-search -p /data --index-mode query --index data.iys log answer from it next time
+
+#include "compiledquery.h"
+#include "contentsearch.h"
+#include "devicescheduler.h"
+#include "duplicatefinder.h"
+#include "fileindex.h"
+#include "fuzzymatch.h"
+#include "multimatch.h"
+#include "indexwatcher.h"
+#include "resultbatch.h"
+#include "resultwriter.h"
+#include "searchlogic.h"
+#include "searchtelemetry.h"
+#include "searchtrace.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum ExitCode {
+    ExitFound = 0,
+    ExitNothingFound = 1,
+    ExitUsage = 2,
+    ExitFailure = 3,
+    ExitInterrupted = 130
+};
+
+// Set from the signal handler - std::atomic<bool> is lock-free, so that's allowed
+std::atomic<bool> cancelRequested{false};
+
+extern "C" void onInterrupt(int)
+{
+    cancelRequested.store(true);
+}
+
+struct CliOptions {
+    SearchConfig config;
+    OutputFormat stdoutFormat = OutputFormat::Text;
+    bool quiet = false; // No results on stdout (exit status / -o file only)
+    bool stats = false; // Summary on stderr at the end
+    std::string telemetryFile; // Full telemetry as JSON at the end ("-" = stderr)
+    bool planOnly = false; // --plan: show which mounts would be searched, and stop there
+};
+
+void printUsage(std::FILE* to)
+{
+    std::fprintf(to,
+        "Usage: iys-search [options] TERM\n"
+        "       iys-search [options] -t TERM -t TERM ... [TERM]\n"
+        "       iys-search [options] --content TEXT [TERM]\n"
+        "       iys-search [options] --duplicates [TERM]\n"
+        "Finds files whose name contains TERM (or fits it, with --glob / --regex).\n"
+        "With --content, also looks inside them and prints path:line:text for every line with TEXT.\n"
+        "With --duplicates, prints the ones with identical content instead, one group after another.\n"
+        "\n"
+        "Where to look:\n"
+        "  -p, --path DIR          start here (default: the current folder)\n"
+        "      --all-roots         search every mounted, writable drive instead\n"
+        "  -x, --one-file-system   don't search other filesystems mounted below the start folder\n"
+        "                          (by default each one is searched as a root of its own, once)\n"
+        "      --include-virtual   also search tmpfs and ramfs mounts (proc, sysfs & co. never are)\n"
+        "      --plan              print which mounts would be searched, and why not the others; no search\n"
+        "\n"
+        "What to match:\n"
+        "  -e, --ext EXT           only files ending in .EXT\n"
+        "  -g, --glob              TERM is a shell pattern for the whole name: * ? [a-z] [!x] {a,b}\n"
+        "  -E, --regex             TERM is a regular expression, found anywhere in the name\n"
+        "  -z, --fuzzy             TERM's letters in order, anything between; printed best first at the end\n"
+        "      --top K             fuzzy: keep the K best matches (default 100)\n"
+        "  -t, --term TERM         one more term (repeatable): one walk answers them all, results come out\n"
+        "                          grouped by term at the end, tagged with the term's number (0, 1, ...)\n"
+        "      --terms-file FILE   ...or read the terms from FILE, one per line\n"
+        "  -i, --ignore-case       case-insensitive matching (names and content)\n"
+        "\n"
+        "Inside the files:\n"
+        "  -c, --content TEXT      only files containing TEXT - every matching line is printed\n"
+        "                          (TERM becomes optional: no TERM = every file; binary files are skipped)\n"
+        "  -m, --max-count N       stop reading a file after N matching lines\n"
+        "      --readers N         reader threads for --content / --duplicates (0 = automatic, the default)\n"
+        "\n"
+        "Duplicates:\n"
+        "  -D, --duplicates        group files with identical content (TERM optional: no TERM = every file);\n"
+        "                          only sizes shared by 2+ files are read, and then just the first and\n"
+        "                          last 4 KiB unless those match too. Groups are separated by a blank line\n"
+        "      --min-size N        leave out files smaller than N bytes (K, M, G suffixes; default 1)\n"
+        "\n"
+        "Size, time, owner (checked only for names that pass - one statx() each; TERM becomes optional):\n"
+        "      --size RANGE        FROM..TO bytes, either end optional, K/M/G/T suffixes: 1G..  ..10M  1M..1G\n"
+        "      --mtime RANGE       modified FROM..TO: ages back from now (30m 12h 7d 2w 1y), dates (2024-03-01,\n"
+        "                          a whole day as the upper end), 2024-03-01T14:30 or @EPOCH; 7d = 7d.. = last week\n"
+        "      --ctime RANGE       same, for the inode change time\n"
+        "      --owner USER        owned by USER (a name or a uid)\n"
+        "      --perm MODE         octal mode bits: 644 / -644 all of them set, /111 any of them\n"
+        "\n"
+        "How to walk:\n"
+        "  -j, --threads N         traversal workers (0 = one per core, the default)\n"
+        "      --backend B         auto | std | getdents\n"
+        "      --traversal T       auto | full | dirfd\n"
+        "      --io B              sync | uring: send each folder's stats and opens through io_uring in\n"
+        "                          batches (Linux 5.6+; falls back to sync when the kernel says no)\n"
+        "      --queue-depth N     io_uring requests in flight per worker (default 64)\n"
+        "      --hdd-threads N     most workers on one spinning disk (default 2)\n"
+        "      --net-threads N     most workers on one file server (default 4)\n"
+        "      --no-device-scheduling  walk the roots one after the other with every worker, whatever\n"
+        "                          disk they're on (by default separate disks are walked at the same time)\n"
+        "      --order O           auto | directory | inode: read each folder in full, then stat and open\n"
+        "                          its entries by inode number (auto = on spinning disks only, the default)\n"
+        "\n"
+        "Index:\n"
+        "      --index-mode M      off | build | query (default off)\n"
+        "      --index FILE        the index file to build or query\n"
+        "      --watch-index       after the search, keep the index live until Ctrl+C\n"
+        "\n"
+        "Output:\n"
+        "      --format F          stdout format: text | nul | jsonl | binary (default text)\n"
+        "  -o, --output FILE       also write the results to FILE\n"
+        "      --output-format F   format for FILE (default text, the decorated report)\n"
+        "  -q, --quiet             nothing on stdout (use the exit status or -o)\n"
+        "  -v, --verbose-errors    report folders we couldn't read on stderr\n"
+        "      --stats             print a summary on stderr when done\n"
+        "      --telemetry FILE    write counters and timings as JSON when done (- = stderr)\n"
+        "      --trace FILE        record a Chrome trace (chrome://tracing, Perfetto) of every folder\n"
+        "      --trace-min-ms X    ...but only folders that took at least X ms (default 0)\n"
+        "      --trace-buffer N    spans kept per worker, oldest dropped first (default 4096)\n"
+        "  -h, --help              this text\n"
+        "\n"
+        "Exit status: 0 found something, 1 found nothing, 2 usage error, 3 failure, 130 interrupted.\n");
+}
+
+bool parseFormat(const std::string& text, OutputFormat& format)
+{
+    if (text == "text") format = OutputFormat::Text;
+    else if (text == "nul") format = OutputFormat::NulSeparated;
+    else if (text == "jsonl" || text == "json") format = OutputFormat::JsonLines;
+    else if (text == "binary") format = OutputFormat::Binary;
+    else return false;
+    return true;
+}
+
+bool parseBackend(const std::string& text, EnumerationBackend& backend)
+{
+    if (text == "auto") backend = EnumerationBackend::Auto;
+    else if (text == "std") backend = EnumerationBackend::StdFilesystem;
+    else if (text == "getdents") backend = EnumerationBackend::Getdents64;
+    else return false;
+    return true;
+}
+
+bool parseIoBackend(const std::string& text, IoBackend& backend)
+{
+    if (text == "sync") backend = IoBackend::Sync;
+    else if (text == "uring" || text == "io_uring") backend = IoBackend::IoUring;
+    else return false;
+    return true;
+}
+
+bool parseEntryOrder(const std::string& text, EntryOrder& order)
+{
+    if (text == "auto") order = EntryOrder::Auto;
+    else if (text == "directory" || text == "dir") order = EntryOrder::Directory;
+    else if (text == "inode") order = EntryOrder::Inode;
+    else return false;
+    return true;
+}
+
+bool parseTraversal(const std::string& text, TraversalMode& mode)
+{
+    if (text == "auto") mode = TraversalMode::Auto;
+    else if (text == "full") mode = TraversalMode::FullPaths;
+    else if (text == "dirfd") mode = TraversalMode::DirFdRelative;
+    else return false;
+    return true;
+}
+
+// One term per line; blank lines don't count. False if the file can't be read.
+bool readTermsFile(const std::string& fileName, std::vector<std::string>& terms)
+{
+    std::ifstream in(fileName);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back(); // Written on Windows
+        }
+        if (!line.empty()) {
+            terms.push_back(line);
+        }
+    }
+    return !in.bad();
+}
+
+bool parseIndexMode(const std::string& text, IndexMode& mode)
+{
+    if (text == "off") mode = IndexMode::Off;
+    else if (text == "build") mode = IndexMode::Build;
+    else if (text == "query") mode = IndexMode::Query;
+    else return false;
+    return true;
+}
+
+// Fills options from argv. Returns false (after saying why on stderr) on a bad command line.
+bool parseArguments(int argc, char** argv, CliOptions& options, bool& wantsHelp)
+{
+    SearchConfig& config = options.config;
+    bool haveTerm = false;
+    bool multiTerm = false;         // -t / --terms-file seen
+    std::vector<std::string> terms; // Every term, in command line order (the positional one included)
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+        bool hasInlineValue = false;
+        if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            const std::size_t equals = arg.find('=');
+            if (equals != std::string::npos) {
+                value = arg.substr(equals + 1);
+                arg.resize(equals);
+                hasInlineValue = true;
+            }
+        }
+        // Grabs the option's value: "--opt=value" or the next argument
+        auto takeValue = [&]() -> bool {
+            if (hasInlineValue) {
+                return true;
+            }
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "iys-search: %s needs a value\n", arg.c_str());
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+        auto badValue = [&]() {
+            std::fprintf(stderr, "iys-search: '%s' isn't a valid value for %s\n", value.c_str(), arg.c_str());
+            return false;
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            wantsHelp = true;
+            return true;
+        } else if (arg == "-p" || arg == "--path") {
+            if (!takeValue()) return false;
+            config.startPath = value;
+        } else if (arg == "--all-roots") {
+            config.searchAllRoots = true;
+        } else if (arg == "-x" || arg == "--one-file-system") {
+            config.filesystemScope = FilesystemScope::OneFilesystem;
+        } else if (arg == "--include-virtual") {
+            config.includeVirtualFilesystems = true;
+        } else if (arg == "--plan") {
+            options.planOnly = true;
+        } else if (arg == "-e" || arg == "--ext") {
+            if (!takeValue()) return false;
+            config.extensionFilter = value;
+        } else if (arg == "-g" || arg == "--glob") {
+            config.matchMode = MatchMode::Glob;
+        } else if (arg == "-E" || arg == "--regex") {
+            config.matchMode = MatchMode::Regex;
+        } else if (arg == "-z" || arg == "--fuzzy") {
+            config.matchMode = MatchMode::Fuzzy;
+        } else if (arg == "--top") {
+            if (!takeValue()) return false;
+            char* end = nullptr;
+            const unsigned long top = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || top == 0 || top > (1ul << 24)) return badValue();
+            config.fuzzyTopK = top;
+        } else if (arg == "-t" || arg == "--term") {
+            if (!takeValue()) return false;
+            if (value.empty()) return badValue();
+            terms.push_back(value);
+            multiTerm = true;
+        } else if (arg == "--terms-file") {
+            if (!takeValue()) return false;
+            if (!readTermsFile(value, terms)) {
+                std::fprintf(stderr, "iys-search: can't read terms from %s\n", value.c_str());
+                return false;
+            }
+            multiTerm = true;
+        } else if (arg == "-c" || arg == "--content") {
+            if (!takeValue()) return false;
+            if (value.empty()) return badValue();
+            config.contentTerm = value;
+        } else if (arg == "-m" || arg == "--max-count") {
+            if (!takeValue()) return false;
+            char* end = nullptr;
+            const unsigned long count = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || count == 0) return badValue();
+            config.contentMaxMatchesPerFile = count;
+        } else if (arg == "--readers") {
+            if (!takeValue()) return false;
+            char* end = nullptr;
+            const unsigned long count = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || count > 256) return badValue();
+            config.contentReaders = static_cast<unsigned int>(count);
+            config.duplicateReaders = static_cast<unsigned int>(count);
+        } else if (arg == "-D" || arg == "--duplicates") {
+            config.findDuplicates = true;
+        } else if (arg == "--min-size") {
+            if (!takeValue()) return false;
+            if (!MetadataSyntax::parseSize(value, config.duplicateMinSize)) return badValue();
+        } else if (arg == "--size") {
+            if (!takeValue()) return false;
+            if (!MetadataSyntax::parseSizeRange(value, config.metadata.minSize, config.metadata.maxSize)) return badValue();
+        } else if (arg == "--mtime") {
+            if (!takeValue()) return false;
+            if (!MetadataSyntax::parseTimeRange(value, std::time(nullptr), config.metadata.modifiedFrom,
+                                                config.metadata.modifiedTo)) return badValue();
+        } else if (arg == "--ctime") {
+            if (!takeValue()) return false;
+            if (!MetadataSyntax::parseTimeRange(value, std::time(nullptr), config.metadata.changedFrom,
+                                                config.metadata.changedTo)) return badValue();
+        } else if (arg == "--owner") {
+            if (!takeValue()) return false;
+            if (!MetadataSyntax::parseOwner(value, config.metadata.ownerUid)) return badValue();
+        } else if (arg == "--perm") {
+            if (!takeValue()) return false;
+            if (!MetadataSyntax::parsePermissions(value, config.metadata.permissionsAll,
+                                                  config.metadata.permissionsAny)) return badValue();
+        } else if (arg == "-i" || arg == "--ignore-case") {
+            config.caseInsensitive = true;
+        } else if (arg == "-v" || arg == "--verbose-errors") {
+            config.verboseErrors = true;
+        } else if (arg == "-j" || arg == "--threads") {
+            if (!takeValue()) return false;
+            char* end = nullptr;
+            const unsigned long count = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || count > 4096) return badValue();
+            config.threadCount = static_cast<unsigned int>(count);
+        } else if (arg == "--hdd-threads" || arg == "--net-threads") {
+            if (!takeValue()) return false;
+            char* end = nullptr;
+            const unsigned long count = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || count == 0 || count > 4096) return badValue();
+            (arg == "--hdd-threads" ? config.rotationalThreads : config.networkThreads) = static_cast<unsigned int>(count);
+        } else if (arg == "--no-device-scheduling") {
+            config.deviceScheduling = false;
+        } else if (arg == "--order") {
+            if (!takeValue()) return false;
+            if (!parseEntryOrder(value, config.entryOrder)) return badValue();
+        } else if (arg == "--backend") {
+            if (!takeValue()) return false;
+            if (!parseBackend(value, config.enumerationBackend)) return badValue();
+        } else if (arg == "--traversal") {
+            if (!takeValue()) return false;
+            if (!parseTraversal(value, config.traversalMode)) return badValue();
+        } else if (arg == "--io") {
+            if (!takeValue()) return false;
+            if (!parseIoBackend(value, config.ioBackend)) return badValue();
+        } else if (arg == "--queue-depth") {
+            if (!takeValue()) return false;
+            char* end = nullptr;
+            const unsigned long depth = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || depth == 0 || depth > 4096) return badValue();
+            config.ioQueueDepth = static_cast<unsigned int>(depth);
+        } else if (arg == "--index-mode") {
+            if (!takeValue()) return false;
+            if (!parseIndexMode(value, config.indexMode)) return badValue();
+        } else if (arg == "--index") {
+            if (!takeValue()) return false;
+            config.indexFile = value;
+        } else if (arg == "--watch-index") {
+            config.watchIndex = true;
+        } else if (arg == "--format") {
+            if (!takeValue()) return false;
+            if (!parseFormat(value, options.stdoutFormat)) return badValue();
+        } else if (arg == "-o" || arg == "--output") {
+            if (!takeValue()) return false;
+            config.outputFile = value;
+        } else if (arg == "--output-format") {
+            if (!takeValue()) return false;
+            if (!parseFormat(value, config.outputFormat)) return badValue();
+        } else if (arg == "-q" || arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--telemetry") {
+            if (!takeValue()) return false;
+            options.telemetryFile = value;
+        } else if (arg == "--trace") {
+            if (!takeValue()) return false;
+            config.traceFile = value;
+        } else if (arg == "--trace-min-ms") {
+            if (!takeValue()) return false;
+            char* end = nullptr;
+            const double millis = std::strtod(value.c_str(), &end);
+            if (value.empty() || *end != '\0' || !(millis >= 0)) return badValue();
+            config.traceMinMillis = millis;
+        } else if (arg == "--trace-buffer") {
+            if (!takeValue()) return false;
+            char* end = nullptr;
+            const unsigned long spans = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || spans == 0 || spans > (1ul << 24)) return badValue();
+            config.traceSpansPerWorker = spans;
+        } else if (arg == "--") {
+            // Everything after this is the term, even if it starts with a dash
+            if (i + 1 < argc && !haveTerm) {
+                config.searchTerm = argv[++i];
+                terms.push_back(config.searchTerm);
+                haveTerm = true;
+            }
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::fprintf(stderr, "iys-search: unknown option %s\n", arg.c_str());
+            return false;
+        } else if (!haveTerm) {
+            config.searchTerm = arg;
+            terms.push_back(arg);
+            haveTerm = true;
+        } else {
+            std::fprintf(stderr, "iys-search: only one search term, please (got '%s' and '%s' - use -t for several)\n",
+                         config.searchTerm.c_str(), arg.c_str());
+            return false;
+        }
+    }
+
+    if (multiTerm) {
+        if (terms.empty()) {
+            std::fprintf(stderr, "iys-search: the terms file had no terms in it\n");
+            return false;
+        }
+        config.searchTerms = terms;
+        config.searchTerm.clear();
+        const CompiledQuery check(config); // Only glob/regex/fuzzy mixed in, or a giant list, can fail
+        if (!check.isValid()) {
+            std::fprintf(stderr, "iys-search: %s\n", check.problem().c_str());
+            return false;
+        }
+    } else if ((!haveTerm || config.searchTerm.empty()) && config.contentTerm.empty() && !config.findDuplicates
+               && !config.metadata.isActive() && !options.planOnly) {
+        std::fprintf(stderr, "iys-search: what should I look for? (try --help)\n");
+        return false;
+    }
+    if (!config.contentTerm.empty() && config.matchMode == MatchMode::Fuzzy) {
+        std::fprintf(stderr, "iys-search: --content and --fuzzy don't go together\n");
+        return false;
+    }
+    if (config.findDuplicates && (config.matchMode == MatchMode::Fuzzy || multiTerm || !config.contentTerm.empty())) {
+        std::fprintf(stderr, "iys-search: --duplicates takes one plain, glob or regex TERM (no --fuzzy, -t or --content)\n");
+        return false;
+    }
+    if (config.matchMode == MatchMode::Glob || config.matchMode == MatchMode::Regex) {
+        const CompiledQuery check(config); // Cheap - better to hear about a typo now than after a walk
+        if (!check.isValid()) {
+            std::fprintf(stderr, "iys-search: bad %s '%s': %s\n", config.matchMode == MatchMode::Glob ? "glob" : "regex",
+                         config.searchTerm.c_str(), check.problem().c_str());
+            return false;
+        }
+    }
+    if (config.searchAllRoots && !config.startPath.empty()) {
+        std::fprintf(stderr, "iys-search: --path and --all-roots don't go together\n");
+        return false;
+    }
+    if (config.indexMode != IndexMode::Off && config.indexFile.empty()) {
+        std::fprintf(stderr, "iys-search: --index-mode needs --index FILE\n");
+        return false;
+    }
+    if (config.watchIndex && config.indexMode == IndexMode::Off) {
+        std::fprintf(stderr, "iys-search: --watch-index needs --index-mode build or query\n");
+        return false;
+    }
+    if (!config.searchAllRoots && config.startPath.empty()) {
+        config.startPath = "."; // A shell tool starts where you are
+    }
+    return true;
+}
+
+// 🔍 One search, start to finish - the same steps SearchWorker::doSearch takes, minus the GUI
+class CliSearch
+{
+public:
+    explicit CliSearch(const CliOptions& options)
+        : options(options), config(options.config)
+    {
+    }
+
+    int run()
+    {
+        const auto started = std::chrono::steady_clock::now();
+        // 🧭 Where to look
+        if (!config.searchAllRoots) {
+            std::error_code ec;
+            const fs::path start = config.startPath;
+            if (!fs::exists(start, ec)) {
+                std::fprintf(stderr, "iys-search: no such folder: %s\n", config.startPath.c_str());
+                return ExitFailure;
+            }
+            if (!fs::is_directory(start, ec)) {
+                std::fprintf(stderr, "iys-search: not a folder: %s\n", config.startPath.c_str());
+                return ExitFailure;
+            }
+        }
+        // Every filesystem goes to exactly one root, and no walk wanders into another root's mount
+        RootPlan plan = planRoots(config);
+        if (plan.roots.empty()) {
+            std::fprintf(stderr, "iys-search: couldn't find any drives to search\n");
+            return ExitFailure;
+        }
+        deviceGroups = groupRootsByDevice(plan, config); // Separate disks walk side by side
+        if (options.planOnly) {
+            std::fputs(describePlan(plan).c_str(), stdout);
+            for (const fs::path& root : plan.roots) {
+                std::printf("root: %s\n", root.string().c_str());
+            }
+            std::fputs(describeDeviceGroups(deviceGroups).c_str(), stdout);
+            return ExitFound;
+        }
+        config.mountBoundaries = std::move(plan.boundaries);
+        const std::vector<fs::path>& roots = plan.roots;
+
+        // (--stats wants the metadata, io_uring, mount and per-disk counters too, and they only live in the telemetry)
+        if (!options.telemetryFile.empty()
+            || (options.stats && (config.metadata.isActive() || config.ioBackend == IoBackend::IoUring
+                                  || !config.mountBoundaries.empty() || deviceGroups.size() > 1))) {
+            telemetry = std::make_unique<SearchTelemetry>(resolveThreadCount(config));
+        }
+        if (!config.traceFile.empty()) {
+            trace = std::make_unique<SearchTrace>(resolveThreadCount(config), config.traceMinMillis,
+                                                  config.traceSpansPerWorker);
+        }
+
+        // 📦 Results go out in batches, to stdout and/or the -o file (each on its own writer thread)
+        if (!options.quiet) {
+            SearchConfig stdoutConfig = config;
+            stdoutConfig.outputFile = "-";
+            stdoutConfig.outputFormat = options.stdoutFormat;
+            stdoutWriter = std::make_unique<ResultWriter>();
+            std::string problem;
+            stdoutWriter->open(stdoutConfig, problem); // stdout is always there
+        }
+        if (!config.outputFile.empty()) {
+            fileWriter = std::make_unique<ResultWriter>();
+            std::string problem;
+            if (!fileWriter->open(config, problem)) {
+                std::fprintf(stderr, "iys-search: %s\n", problem.c_str());
+                return ExitFailure;
+            }
+        }
+        batcher = std::make_unique<ResultBatcher>([this](ResultBatchPtr batch) {
+            const std::uint64_t handOffStart = telemetry ? telemetryNow() : 0;
+            const std::size_t results = batch->size();
+            if (stdoutWriter) stdoutWriter->submit(batch);
+            if (fileWriter) fileWriter->submit(batch);
+            if (telemetry) {
+                telemetry->noteBatch(results, telemetryNow() - handOffStart);
+            }
+        });
+
+        const CompiledQuery query(config);
+        if (query.patternKind() == PatternKind::Fuzzy) {
+            ranking = std::make_unique<FuzzyRanking>(query.fuzzyMatcher(), config.fuzzyTopK);
+        }
+        if (!config.contentTerm.empty()) {
+            // 📖 Names that pass go to the readers instead; their matching lines come back as results
+            ContentSearcher::ErrorSink onError;
+            if (config.verboseErrors) {
+                onError = [](const std::string& message) { std::fprintf(stderr, "iys-search: %s\n", message.c_str()); };
+            }
+            contentSearcher = std::make_unique<ContentSearcher>(
+                config,
+                [this](std::string_view path, std::uint64_t line, std::string_view snippet) { batcher->add(path, line, snippet); },
+                cancelRequested, onError);
+        } else if (query.patternKind() == PatternKind::MultiTerm) {
+            termGroups = std::make_unique<TermGroups>(query.multiTermMatcher());
+        }
+        if (config.findDuplicates) {
+            // 👯 Names that pass are only candidates - the groups come out once the walk is over
+            DuplicateFinder::ErrorSink onError;
+            if (config.verboseErrors) {
+                onError = [](const std::string& message) { std::fprintf(stderr, "iys-search: %s\n", message.c_str()); };
+            }
+            duplicateFinder = std::make_unique<DuplicateFinder>(config, cancelRequested, onError);
+        }
+
+        bool answeredFromIndex = false;
+        if (config.indexMode == IndexMode::Query) {
+            markPhase(SearchPhase::IndexQuery);
+            answeredFromIndex = searchFromIndex(roots, query);
+        }
+        if (!answeredFromIndex) {
+            std::unique_ptr<FileIndexBuilder> indexBuilder;
+            if (config.indexMode == IndexMode::Build) {
+                indexBuilder = std::make_unique<FileIndexBuilder>(resolveThreadCount(config));
+                for (const auto& root : roots) {
+                    indexBuilder->addRoot(root);
+                }
+            }
+            markPhase(SearchPhase::Walk);
+            walkRoots(deviceGroups, query, indexBuilder.get());
+            if (indexBuilder) {
+                markPhase(SearchPhase::IndexSave);
+                if (cancelRequested.load()) {
+                    origin = "live walk (interrupted - index not saved)";
+                } else if (!saveIndex(*indexBuilder)) {
+                    failed = true;
+                }
+            } else if (config.indexMode != IndexMode::Query) {
+                origin = "live walk";
+            }
+        }
+
+        if (contentSearcher) {
+            // The walk is done, the readers may not be - let them get through the queue
+            markPhase(SearchPhase::ContentDrain);
+            contentStats = contentSearcher->finish();
+            found = contentStats.matchingFiles; // Files whose CONTENT matched, not just the name
+        }
+        if (duplicateFinder) {
+            // Sizes, then edges, then whole files - only as far as each candidate needs
+            markPhase(SearchPhase::Duplicates);
+            const std::vector<DuplicateGroup> groups = duplicateFinder->find();
+            duplicateStats = duplicateFinder->stats();
+            found = duplicateStats.duplicateFiles;
+            for (std::size_t g = 0; g < groups.size(); ++g) {
+                for (const std::string& path : groups[g].paths) {
+                    batcher->addToGroup(path, g + 1);
+                }
+            }
+        }
+
+        // 🏁 Wrap up: last batch out, writers drained and closed
+        markPhase(SearchPhase::Finish);
+        if (ranking) {
+            // Fuzzy results can't stream - a better one may turn up last - so the leaders go out now, best first
+            for (const FuzzyHit& hit : ranking->ranked()) {
+                batcher->add(hit.path);
+            }
+        }
+        if (termGroups) {
+            // Same for several terms: the groups are only complete once the walk is, so they go out now, term by term
+            // (straight to the writers - the batches already carry their termId)
+            for (const ResultBatchPtr& group : termGroups->takeBatches()) {
+                if (stdoutWriter) stdoutWriter->submit(group);
+                if (fileWriter) fileWriter->submit(group);
+            }
+        }
+        batcher->flush();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        const bool interrupted = cancelRequested.load();
+        ResultWriterStats stdoutStats;
+        ResultWriterStats fileStats;
+        if (stdoutWriter) {
+            stdoutStats = stdoutWriter->finish(found, scanned.load(), seconds, interrupted);
+            if (!stdoutStats.error.empty()) {
+                std::fprintf(stderr, "iys-search: stdout: %s\n", stdoutStats.error.c_str());
+                failed = true;
+            }
+        }
+        if (fileWriter) {
+            fileStats = fileWriter->finish(found, scanned.load(), seconds, interrupted);
+            if (!fileStats.error.empty()) {
+                std::fprintf(stderr, "iys-search: %s: %s\n", config.outputFile.c_str(), fileStats.error.c_str());
+                failed = true;
+            }
+        }
+
+        if (telemetry && !options.telemetryFile.empty() && !writeTelemetry(fileWriter ? &fileStats : nullptr)) {
+            failed = true;
+        }
+        if (trace && !writeTrace()) {
+            failed = true;
+        }
+
+        if (options.stats) {
+            std::fprintf(stderr, "%llu match(es), %llu entries checked in %.3f s (%s)%s\n", found,
+                         static_cast<unsigned long long>(scanned.load()), seconds, origin.c_str(),
+                         interrupted ? " - interrupted" : "");
+            if (config.metadata.isActive()) {
+                const TelemetrySnapshot numbers = telemetry->snapshot();
+                std::fprintf(stderr,
+                             "metadata: %s - %llu %s call(s) for the names that passed (%llu turned down), "
+                             "%llu stat(s) saved by checking names first\n",
+                             config.metadata.describe().c_str(),
+                             static_cast<unsigned long long>(numbers.counter(TelemetryCounter::MetadataStats)),
+                             MetadataFilter::statMethod(),
+                             static_cast<unsigned long long>(numbers.counter(TelemetryCounter::MetadataRejected)),
+                             static_cast<unsigned long long>(numbers.counter(TelemetryCounter::MetadataStatsSaved)));
+            }
+            if (!config.mountBoundaries.empty()) {
+                const TelemetrySnapshot numbers = telemetry->snapshot();
+                std::fprintf(stderr, "mounts: %zu root(s), %zu other mount point(s) kept out of the walk (%llu stepped around)\n",
+                             roots.size(), config.mountBoundaries.size(),
+                             static_cast<unsigned long long>(numbers.counter(TelemetryCounter::MountsSkipped)));
+            }
+            if (deviceGroups.size() > 1) {
+                // Side by side, so the slowest disk is how long the walk took
+                for (const DeviceTelemetry& device : telemetry->snapshot().devices) {
+                    std::fprintf(stderr, "device %s (%s, %u worker(s)): %llu entries in %.3f s (%.0f/s), %u of %u root(s)\n",
+                                 device.name.c_str(), device.kind.c_str(), device.threads,
+                                 static_cast<unsigned long long>(device.entries), device.seconds, device.entriesPerSecond,
+                                 device.rootsDone, device.roots);
+                }
+            }
+            std::string inodeOrdered;
+            for (const DeviceGroup& group : deviceGroups) {
+                if (walked && group.inodeOrder) { // An index answer never read a folder in any order
+                    inodeOrdered += (inodeOrdered.empty() ? "" : ", ") + group.name;
+                }
+            }
+            if (!inodeOrdered.empty()) {
+                std::fprintf(stderr, "order: entries stat-ed and opened by inode on %s\n", inodeOrdered.c_str());
+            }
+            if (config.ioBackend == IoBackend::IoUring) {
+                std::string whyNot;
+                if (UringBatch::available(&whyNot)) {
+                    const TelemetrySnapshot numbers = telemetry->snapshot();
+                    std::fprintf(stderr, "io: io_uring, depth %u - %llu request(s) in %llu submit(s)\n",
+                                 config.ioQueueDepth,
+                                 static_cast<unsigned long long>(numbers.counter(TelemetryCounter::RingRequests)),
+                                 static_cast<unsigned long long>(numbers.counter(TelemetryCounter::RingSubmits)));
+                } else {
+                    std::fprintf(stderr, "io: synchronous - %s\n", whyNot.c_str());
+                }
+            }
+            if (ranking) {
+                std::fprintf(stderr, "fuzzy: best %zu of %llu matches listed\n", ranking->size(),
+                             static_cast<unsigned long long>(ranking->offered()));
+            }
+            if (contentSearcher) {
+                std::fprintf(stderr,
+                             "content: %llu line(s) in %llu of %llu candidate file(s), %.1f MB read by %u readers "
+                             "(%llu mapped, %llu binary skipped, %llu unreadable)\n",
+                             static_cast<unsigned long long>(contentStats.matchingLines),
+                             static_cast<unsigned long long>(contentStats.matchingFiles),
+                             static_cast<unsigned long long>(contentStats.candidates),
+                             contentStats.bytesSearched / (1024.0 * 1024.0), contentStats.readers,
+                             static_cast<unsigned long long>(contentStats.mappedFiles),
+                             static_cast<unsigned long long>(contentStats.binarySkipped),
+                             static_cast<unsigned long long>(contentStats.unreadable));
+            }
+            if (duplicateFinder) {
+                const DuplicateStats& d = duplicateStats;
+                std::fprintf(stderr,
+                             "duplicates: %llu group(s), %llu file(s), %.1f MB could be freed; of %llu candidate(s) "
+                             "%llu shared a size, %llu needed a full read\n",
+                             static_cast<unsigned long long>(d.groups), static_cast<unsigned long long>(d.duplicateFiles),
+                             d.wastedBytes / (1024.0 * 1024.0), static_cast<unsigned long long>(d.candidates),
+                             static_cast<unsigned long long>(d.sizeMatched), static_cast<unsigned long long>(d.fullHashed));
+                std::fprintf(stderr,
+                             "duplicates: read %.1f MB of %.1f MB (%.1f MB not read) with %u readers; "
+                             "size %.3f s, edges %.3f s, full %.3f s (%llu same-file links, %llu unreadable)\n",
+                             d.bytesRead / (1024.0 * 1024.0), d.totalBytes / (1024.0 * 1024.0),
+                             d.bytesAvoided / (1024.0 * 1024.0), d.readers, d.statSeconds, d.edgeSeconds, d.fullSeconds,
+                             static_cast<unsigned long long>(d.sameFile),
+                             static_cast<unsigned long long>(d.statFailures + d.readFailures));
+            }
+            if (termGroups) {
+                const std::vector<std::uint64_t>& counts = termGroups->counts();
+                for (std::size_t id = 0; id < counts.size(); ++id) {
+                    std::fprintf(stderr, "term %zu '%s': %llu match(es)\n", id, termGroups->matcher().term(id).c_str(),
+                                 static_cast<unsigned long long>(counts[id]));
+                }
+            }
+            if (fileWriter) {
+                std::fprintf(stderr, "output file: %llu results, %.1f MB at %.1f MB/s, queue peaked at %zu batches\n",
+                             static_cast<unsigned long long>(fileStats.results), fileStats.bytesWritten / (1024.0 * 1024.0),
+                             fileStats.megabytesPerSecond, fileStats.queueHighWater);
+            }
+        }
+
+        // 👁️ Keep the index fresh until somebody tells us to stop
+        if (config.watchIndex && !interrupted && !failed) {
+            watchIndex();
+        }
+
+        if (interrupted) return ExitInterrupted;
+        if (failed) return ExitFailure;
+        return found > 0 ? ExitFound : ExitNothingFound;
+    }
+
+private:
+    void onResult(const std::string& foundPath, const std::string& errorMessage)
+    {
+        if (!foundPath.empty()) {
+            if (duplicateFinder) {
+                duplicateFinder->add(foundPath); // Just a candidate until find() has compared it
+            } else if (contentSearcher) {
+                contentSearcher->submit(foundPath); // The name passed - now the readers look inside
+            } else if (ranking) {
+                ranking->offer(foundPath); // Fuzzy: up against the leaderboard first
+            } else if (termGroups) {
+                termGroups->add(foundPath); // Several terms: tagged and filed under each of its terms
+            } else {
+                batcher->add(foundPath); // The engine serializes these calls for us
+            }
+        } else if (!errorMessage.empty() && config.verboseErrors) {
+            std::fprintf(stderr, "iys-search: %s\n", errorMessage.c_str());
+        }
+    }
+
+    void walkRoots(const std::vector<DeviceGroup>& groups, const CompiledQuery& query, FileObserver* observer)
+    {
+        auto callback = [this](const std::string& foundPath, const std::string& errorMessage) {
+            onResult(foundPath, errorMessage);
+        };
+        // A slow trickle of matches still reaches the pipe promptly
+        auto progress = [this](std::uint64_t) { batcher->flushIfDue(); };
+        walked = true;
+        searchDeviceGroups(groups, config, query, callback, found, cancelRequested, scanned,
+                           paused, pauseMutex, pauseCondition, progress, observer, telemetry.get(), trace.get());
+    }
+
+    // Same rules as the GUI: fall back to a live walk unless the index is there, covers every root and is fresh
+    bool searchFromIndex(const std::vector<fs::path>& roots, const CompiledQuery& query)
+    {
+        FileIndex index;
+        std::string problem;
+        if (!index.open(config.indexFile, problem)) {
+            std::fprintf(stderr, "iys-search: couldn't use the index: %s\n", problem.c_str());
+            origin = "live walk (index unusable)";
+            return false;
+        }
+        for (const auto& root : roots) {
+            if (!index.covers(root)) {
+                origin = "live walk (index doesn't cover " + root.string() + ")";
+                return false;
+            }
+        }
+        if (index.isStale(problem)) {
+            origin = "live walk (index is stale: " + problem + ")";
+            return false;
+        }
+
+        auto callback = [this](const std::string& foundPath, const std::string& errorMessage) {
+            onResult(foundPath, errorMessage);
+        };
+        const std::uint64_t scannedBefore = scanned.load();
+        const unsigned long long foundBefore = found;
+        for (const auto& root : outermostRoots(roots)) { // ("/" already holds "/home")
+            if (cancelRequested.load()) break;
+            found += index.search(root, query, callback, cancelRequested, scanned, {},
+                                  telemetry ? &telemetry->worker(0) : nullptr);
+        }
+        if (telemetry) {
+            // The index doesn't have workers - book what it did on the first slot
+            telemetry->worker(0).add(TelemetryCounter::EntriesRead, scanned.load() - scannedBefore);
+            telemetry->worker(0).add(TelemetryCounter::Matches, found - foundBefore);
+        }
+        char builtAt[32] = "?";
+        const std::time_t when = static_cast<std::time_t>(index.builtAt());
+        if (const std::tm* local = std::localtime(&when)) {
+            std::strftime(builtAt, sizeof(builtAt), "%Y-%m-%dT%H:%M:%S", local);
+        }
+        origin = std::string("index, built ") + builtAt;
+        return true;
+    }
+
+    bool saveIndex(FileIndexBuilder& builder)
+    {
+        std::string problem;
+        IndexBuildStats stats;
+        if (!builder.write(config.indexFile, problem, &stats)) {
+            std::fprintf(stderr, "iys-search: couldn't save the index: %s\n", problem.c_str());
+            origin = "live walk (index NOT saved)";
+            return false;
+        }
+        origin = "live walk, index rebuilt";
+        if (options.stats) {
+            std::fprintf(stderr, "index saved: %llu files in %llu folders, %.1f MB, built in %.2f s\n",
+                         static_cast<unsigned long long>(stats.fileCount), static_cast<unsigned long long>(stats.dirCount),
+                         stats.bytesWritten / (1024.0 * 1024.0), stats.buildSeconds);
+        }
+        return true;
+    }
+
+    void markPhase(SearchPhase phase)
+    {
+        if (telemetry) {
+            telemetry->startPhase(phase);
+        }
+    }
+
+    // 📈 --telemetry: the whole report, as JSON, once everything is closed
+    bool writeTelemetry(const ResultWriterStats* fileStats)
+    {
+        if (fileStats) {
+            telemetry->noteOutputFile(*fileStats);
+        }
+        telemetry->finish();
+        const std::string json = SearchTelemetry::toJson(telemetry->snapshot());
+
+        if (options.telemetryFile == "-") {
+            std::fputs(json.c_str(), stderr);
+            return true;
+        }
+        std::FILE* out = std::fopen(options.telemetryFile.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "iys-search: can't write telemetry to %s: %s\n",
+                         options.telemetryFile.c_str(), std::strerror(errno));
+            return false;
+        }
+        const bool written = std::fputs(json.c_str(), out) >= 0;
+        if (std::fclose(out) != 0 || !written) {
+            std::fprintf(stderr, "iys-search: couldn't finish writing %s\n", options.telemetryFile.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // 🧭 --trace: every span the workers kept, as Chrome trace-event JSON
+    bool writeTrace()
+    {
+        std::string problem;
+        if (!trace->writeFile(config.traceFile, "iys-search " + config.searchTerm, problem)) {
+            std::fprintf(stderr, "iys-search: trace: %s\n", problem.c_str());
+            return false;
+        }
+        if (options.stats) {
+            const TraceSummary summary = trace->summary();
+            std::fprintf(stderr, "trace: %llu spans written to %s (%llu faster than %g ms left out, %llu overwritten)\n",
+                         static_cast<unsigned long long>(summary.spansKept), config.traceFile.c_str(),
+                         static_cast<unsigned long long>(summary.belowThreshold), config.traceMinMillis,
+                         static_cast<unsigned long long>(summary.spansOverwritten));
+        }
+        return true;
+    }
+
+    void watchIndex()
+    {
+        IndexWatcher watcher(config.indexFile, config);
+        std::string problem;
+        if (!watcher.start(problem)) {
+            std::fprintf(stderr, "iys-search: couldn't keep the index live: %s\n", problem.c_str());
+            failed = true;
+            return;
+        }
+        std::fprintf(stderr, "iys-search: keeping %s live - Ctrl+C to stop\n", config.indexFile.c_str());
+        while (!cancelRequested.load() && watcher.isRunning()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+        watcher.stop(); // Folds the changes it collected back into the file
+        const IndexWatcherStats stats = watcher.stats();
+        if (options.stats) {
+            std::fprintf(stderr, "watcher: %llu events, %llu batches, %llu merges, %llu overflows, %llu resyncs\n",
+                         static_cast<unsigned long long>(stats.eventsSeen), static_cast<unsigned long long>(stats.batchesApplied),
+                         static_cast<unsigned long long>(stats.merges), static_cast<unsigned long long>(stats.overflows),
+                         static_cast<unsigned long long>(stats.resyncs));
+        }
+        if (!stats.lastError.empty()) {
+            std::fprintf(stderr, "iys-search: watcher: %s\n", stats.lastError.c_str());
+        }
+        cancelRequested.store(false); // Stopping the watcher is how watch mode ends, not an interruption
+    }
+
+    const CliOptions& options;
+    SearchConfig config; // Our own copy - the root plan adds its mount boundaries
+    std::vector<DeviceGroup> deviceGroups; // The plan's roots, by disk
+
+    std::unique_ptr<SearchTelemetry> telemetry; // Only with --telemetry (or --stats with metadata predicates)
+    std::unique_ptr<SearchTrace> trace;         // Only with --trace
+    std::unique_ptr<ResultWriter> stdoutWriter;
+    std::unique_ptr<ResultWriter> fileWriter;
+    std::unique_ptr<ResultBatcher> batcher;
+    std::unique_ptr<FuzzyRanking> ranking;      // Only with --fuzzy
+    std::unique_ptr<TermGroups> termGroups;     // Only with -t / --terms-file
+    std::unique_ptr<ContentSearcher> contentSearcher; // Only with --content
+    ContentSearchStats contentStats;
+    std::unique_ptr<DuplicateFinder> duplicateFinder; // Only with --duplicates
+    DuplicateStats duplicateStats;
+
+    unsigned long long found = 0;
+    std::atomic<std::uint64_t> scanned{0};
+    std::atomic<bool> paused{false}; // Nobody pauses a CLI search, but the engine wants the plumbing
+    std::mutex pauseMutex;
+    std::condition_variable pauseCondition;
+
+    std::string origin = "live walk"; // Where the results came from, for --stats
+    bool walked = false;              // walkRoots() ran (the index didn't answer on its own)
+    bool failed = false;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CliOptions options;
+    bool wantsHelp = false;
+    if (!parseArguments(argc, argv, options, wantsHelp)) {
+        return ExitUsage;
+    }
+    if (wantsHelp) {
+        printUsage(stdout);
+        return 0;
+    }
+
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+
+    CliSearch search(options);
+    return search.run();
+}
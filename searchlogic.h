@@ -2,47 +2,147 @@
 #define SEARCHLOGIC_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 #include <functional> // For our callback magic ✨
 #include <atomic>     // For thread-safe flags that won't get us in trouble
-#include <QtGlobal>   // For some Qt goodness (quint64)
-#include <QMutex>     // For our pause/resume dance 🕺
-#include <QWaitCondition> // The partner for our pause waltz
+#include <cstddef>
+#include <cstdint>    // std::uint64_t for the big counters
+#include <mutex>      // For our pause/resume dance 🕺
+#include <condition_variable> // The partner for our pause waltz
+
+#include "direnumerator.h" // EnumerationBackend
+#include "metadatafilter.h" // MetadataPredicates
+#include "uringbatch.h"     // IoBackend
+#include "rootplanner.h"    // FilesystemScope, MountBoundaries
 
 namespace fs = std::filesystem;
 
+// How the traversal workers find their way around the tree
+enum class TraversalMode {
+    Auto,          // dirfd-relative whenever the enumeration backend can do it, full paths otherwise
+    FullPaths,     // Every folder gets opened by its full path (the classic way)
+    DirFdRelative  // Subfolders are opened with openat() on their parent's descriptor (POSIX + getdents64)
+};
+
+// 💿 In which order a folder's subfolders get walked and its files stat-ed (see devicescheduler.h)
+enum class EntryOrder {
+    Auto,      // By inode on spinning disks, as the directory lists them everywhere else
+    Directory, // As the directory lists them - hash order on ext4/XFS, which is all over the disk
+    Inode      // Whole folder read first, then everything by inode number - near each other on disk, fewer seeks
+};
+
+// What to do with the on-disk filename index (see fileindex.h)
+enum class IndexMode {
+    Off,   // Always walk the disk, never touch an index
+    Build, // Walk the disk AND save everything we saw to indexFile
+    Query  // Answer from indexFile when it's fresh and covers the search; walk the disk otherwise
+};
+
+// How the output file is written (see resultwriter.h)
+enum class OutputFormat {
+    Text,         // The decorated report: header, one path per line, summary
+    NulSeparated, // Bare paths ending in '\0', for xargs -0
+    JsonLines,    // One JSON object per line with path, size and mtime
+    Binary        // Compact varint records with size and mtime
+};
+
+// How the search term is read (see compiledquery.h and dfamatch.h)
+enum class MatchMode {
+    Substring, // The name contains the term somewhere - the classic
+    Glob,      // The whole name fits a shell pattern: *.conf, IMG_????.jpg, *.{c,h}
+    Regex,     // A regular expression, found anywhere in the name unless anchored with ^ / $
+    Fuzzy      // The letters appear in order, anything in between - ranked, best K kept (see fuzzymatch.h)
+};
+
 // Hey, this is where we keep all your search preferences in one neat package! 📦
 struct SearchConfig {
     std::string searchTerm;
+    std::vector<std::string> searchTerms; // Several terms in ONE walk (see multimatch.h) - when set, searchTerm is ignored
+    MatchMode matchMode = MatchMode::Substring; // Plain text, a glob, a regex, or fuzzy?
+    std::size_t fuzzyTopK = 100;      // Fuzzy mode keeps only this many of the best matches
     std::string startPath = "";       // Empty? We'll check all drives!
     std::string extensionFilter = ""; // Looking for .txt or jpg? Pop it here
+    MetadataPredicates metadata;      // Size, time, owner, permissions - checked only for names that pass (see metadatafilter.h)
+    std::string contentTerm = "";     // Also look INSIDE the files whose names pass (see contentsearch.h) - empty = names only
+    unsigned int contentReaders = 0;  // Reader threads for that (0 = automatic)
+    std::size_t contentMaxMatchesPerFile = 0; // Stop reading a file after this many matching lines (0 = no limit)
+    bool findDuplicates = false;      // Group the files whose names pass by identical content (see duplicatefinder.h)
+    unsigned int duplicateReaders = 0; // Reader threads for that - also the most files open at once (0 = automatic)
+    std::uint64_t duplicateMinSize = 1; // Smaller files are left out (the default skips empty ones)
     std::string outputFile = "";      // Want to save results? Tell me where!
+    OutputFormat outputFormat = OutputFormat::Text; // ...and in which shape
     bool caseInsensitive = false;     // Don't care about CAPS or lowercase?
     bool verboseErrors = false;       // Want to know why I can't peek somewhere?
     bool searchAllRoots = false;      // Flag to signal we're checking ALL the drives
+    FilesystemScope filesystemScope = FilesystemScope::AllFilesystems; // Mounts below the start folder: search them too?
+    bool includeVirtualFilesystems = false; // tmpfs & co. are skipped unless this is set (proc, sysfs... always are)
+    MountBoundaries mountBoundaries;  // Filled in from planRoots(): mount points no walk steps into
+    unsigned int threadCount = 0;     // How many workers walk the tree (0 = one per CPU core)
+    bool deviceScheduling = true;     // Roots on different disks walk at the same time, each disk with its own worker limit (see devicescheduler.h)
+    unsigned int rotationalThreads = 2; // ...no more than this many workers on a spinning disk
+    unsigned int networkThreads = 4;  // ...or on one file server
+    EntryOrder entryOrder = EntryOrder::Auto; // Subfolders and stats in inode order? (Auto = on spinning disks; needs deviceScheduling to tell)
+    EnumerationBackend enumerationBackend = EnumerationBackend::Auto; // How directories get read (Auto = fastest available)
+    TraversalMode traversalMode = TraversalMode::Auto; // Full paths vs. openat() on the parent's descriptor
+    IoBackend ioBackend = IoBackend::Sync; // Batch the walk's statx/openat calls through io_uring? (see uringbatch.h)
+    unsigned int ioQueueDepth = 64;   // ...with at most this many of them in flight per worker
+    IndexMode indexMode = IndexMode::Off; // Build or use a saved filename index?
+    std::string indexFile = "";       // Where that index lives
+    bool watchIndex = false;          // Keep that index fresh in the background (see indexwatcher.h)
+    std::string traceFile = "";       // Record a Chrome trace of the folders we visit here (see searchtrace.h)
+    double traceMinMillis = 0;        // ...keeping only folders that took at least this long
+    std::size_t traceSpansPerWorker = 4096; // Ring size per worker - the oldest spans go first when it's full
 };
 
 // This is our secret handshake with the worker - how we communicate findings
 // It'll get called with either (filepath, "") for finds or ("", error_msg) for oopsies
 using SearchCallback = std::function<void(const std::string&, const std::string&)>;
 
+// Gets poked every now and then with the live "files scanned" count while a search runs
+using ProgressCallback = std::function<void(std::uint64_t)>;
+
+// 👂 Wants to hear about EVERY regular file the walk meets, match or not (the index builder does).
+// onFile() gets called from the traversal workers at the same time - worker is 0..threadCount-1,
+// so implementations can keep one bucket per worker and skip the locking.
+// The views are only valid during the call.
+class CompiledQuery; // compiledquery.h - the search term, compiled once per search
+class SearchTelemetry; // searchtelemetry.h - optional counters for the curious
+class SearchTrace;     // searchtrace.h - optional per-folder spans for the really curious
+
+class FileObserver
+{
+public:
+    virtual ~FileObserver() = default;
+    virtual void onFile(unsigned int worker, std::string_view dirPath, std::string_view name) = 0;
+};
+
 // 🔍 The Heart of Our Search Engine 🔍
-// This little explorer goes through directories, checking each file it meets
-// Reports back immediately when it finds something good!
+// A whole crew of worker threads (config.threadCount of them) explores the tree under
+// rootPath together, checking each file they meet and reporting finds right away.
+// The callback is never called from two threads at once, so it doesn't need its own lock.
 // We can pause it, cancel it, or let it run wild until it's checked everything
-void searchDirectoryRecursive(
-    const fs::path& currentPath,
+void searchDirectoryParallel(
+    const fs::path& rootPath,
     const SearchConfig& config,
+    const CompiledQuery& query,         // What we're looking for, compiled once by the caller
     const SearchCallback& reportResult, // Our messenger pigeon
     unsigned long long& foundCount,     // How many treasures we've found
     std::atomic<bool>& cancellationFlag, // Emergency stop button
-    std::atomic<quint64>& filesScannedCount, // How many files we've checked
+    std::atomic<std::uint64_t>& filesScannedCount, // How many files we've checked
     std::atomic<bool>& pauseFlag,       // Our "freeze!" command
-    QMutex& pauseMutexRef,              // Lock for safe pausing
-    QWaitCondition& pauseConditionRef   // Our "wake up!" alarm
+    std::mutex& pauseMutexRef,          // Lock for safe pausing
+    std::condition_variable& pauseConditionRef, // Our "wake up!" alarm
+    const ProgressCallback& onProgress = ProgressCallback(), // Optional live progress ticker
+    FileObserver* fileObserver = nullptr, // Optional: sees every file, not just matches
+    SearchTelemetry* telemetry = nullptr, // Optional: per-worker counters and timers
+    SearchTrace* trace = nullptr          // Optional: one span per visited folder
     );
 
+// Turns config.threadCount (0 = auto) into the number of workers a search will really use
+unsigned int resolveThreadCount(const SearchConfig& config);
+
 // Just a little helper to make text lowercase
 // Because sometimes we don't care about SHOUTING or whispering
 std::string toLower(std::string s);
@@ -0,0 +1,289 @@
+#include "searchtelemetry.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+double toSeconds(std::uint64_t nanos)
+{
+    return nanos / 1e9;
+}
+
+std::string number(double value)
+{
+    char text[40];
+    std::snprintf(text, sizeof(text), "%.9g", value);
+    return text;
+}
+
+std::string number(std::uint64_t value)
+{
+    return std::to_string(value);
+}
+
+// A JSON string - the disk names come from sysfs and mount sources, so quotes and backslashes are possible
+std::string quoted(const std::string& text)
+{
+    std::string out = "\"";
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+double TelemetrySnapshot::matchingSeconds() const
+{
+    const double other = seconds(TelemetryTimer::DirectoryRead) + seconds(TelemetryTimer::Stat)
+                         + seconds(TelemetryTimer::Reporting);
+    return std::max(0.0, seconds(TelemetryTimer::Busy) - other);
+}
+
+SearchTelemetry::SearchTelemetry(unsigned int workerSlots)
+    : slotCount(std::max(1u, workerSlots)),
+    workerBlocks(new ThreadTelemetry[slotCount]),
+    startedAt(telemetryNow()),
+    phaseStartedAt(startedAt),
+    lastSnapshotAt(startedAt)
+{
+}
+
+void SearchTelemetry::startPhase(SearchPhase next)
+{
+    const std::uint64_t now = telemetryNow();
+    phaseNanos[static_cast<std::size_t>(phase)] += now - phaseStartedAt;
+    phase = next;
+    phaseStartedAt = now;
+}
+
+void SearchTelemetry::finish()
+{
+    if (finishedAt != 0) {
+        return;
+    }
+    finishedAt = telemetryNow();
+    phaseNanos[static_cast<std::size_t>(phase)] += finishedAt - phaseStartedAt;
+    phaseStartedAt = finishedAt;
+}
+
+void SearchTelemetry::noteBatch(std::uint64_t results, std::uint64_t nanosInSink)
+{
+    batches.fetch_add(1, std::memory_order_relaxed);
+    batchedResults.fetch_add(results, std::memory_order_relaxed);
+    deliveryNanos.fetch_add(nanosInSink, std::memory_order_relaxed);
+}
+
+void SearchTelemetry::noteOutputFile(const ResultWriterStats& stats)
+{
+    hasOutputFile = true;
+    outputFile = stats;
+}
+
+DeviceTally& SearchTelemetry::addDevice(const std::string& name, const std::string& kind, unsigned int threads,
+                                       unsigned int roots)
+{
+    devices.push_back(std::make_unique<Device>());
+    Device& device = *devices.back();
+    device.info.name = name;
+    device.info.kind = kind;
+    device.info.threads = threads;
+    device.info.roots = roots;
+    return device.tally;
+}
+
+TelemetrySnapshot SearchTelemetry::snapshot()
+{
+    TelemetrySnapshot snap;
+    const std::uint64_t now = finishedAt ? finishedAt : telemetryNow();
+    snap.elapsedSeconds = toSeconds(now - startedAt);
+    snap.finished = finishedAt != 0;
+    snap.currentPhase = phase;
+
+    // 🧮 Add up every worker's block
+    snap.workers.resize(slotCount);
+    for (unsigned int i = 0; i < slotCount; ++i) {
+        const ThreadTelemetry& slot = workerBlocks[i];
+        for (std::size_t c = 0; c < kTelemetryCounters; ++c) {
+            snap.counters[c] += slot.counter(static_cast<TelemetryCounter>(c));
+        }
+        for (std::size_t t = 0; t < kTelemetryTimers; ++t) {
+            snap.workerSeconds[t] += toSeconds(slot.nanos(static_cast<TelemetryTimer>(t)));
+        }
+        WorkerTelemetry& row = snap.workers[i];
+        row.entries = slot.counter(TelemetryCounter::EntriesRead);
+        row.dirs = slot.counter(TelemetryCounter::DirsOpened);
+        row.matches = slot.counter(TelemetryCounter::Matches);
+        row.steals = slot.counter(TelemetryCounter::Steals);
+        row.busySeconds = toSeconds(slot.nanos(TelemetryTimer::Busy));
+        row.idleSeconds = toSeconds(slot.nanos(TelemetryTimer::Idle));
+    }
+
+    // 💽 Each disk since its walk started
+    for (const auto& device : devices) {
+        DeviceTelemetry row = device->info;
+        const std::uint64_t started = device->tally.startedAt.load(std::memory_order_relaxed);
+        const std::uint64_t ended = device->tally.finishedAt.load(std::memory_order_relaxed);
+        row.entries = device->tally.entries.load(std::memory_order_relaxed);
+        row.rootsDone = device->tally.rootsDone.load(std::memory_order_relaxed);
+        row.started = started != 0;
+        row.finished = ended != 0;
+        row.seconds = started ? toSeconds((ended ? ended : now) - std::min(now, started)) : 0;
+        row.entriesPerSecond = row.seconds > 0 ? row.entries / row.seconds : 0;
+        snap.devices.push_back(std::move(row));
+    }
+
+    for (std::size_t p = 0; p < kSearchPhases; ++p) {
+        snap.phaseSeconds[p] = toSeconds(phaseNanos[p]);
+    }
+    if (!snap.finished) {
+        snap.phaseSeconds[static_cast<std::size_t>(phase)] += toSeconds(now - phaseStartedAt);
+    }
+
+    // 🏎️ Live rate since the last look, plus the average so far
+    const std::uint64_t entries = snap.counter(TelemetryCounter::EntriesRead);
+    if (now > lastSnapshotAt) {
+        snap.entriesPerSecond = (entries - std::min(entries, lastSnapshotEntries)) / toSeconds(now - lastSnapshotAt);
+    }
+    snap.averageEntriesPerSecond = snap.elapsedSeconds > 0 ? entries / snap.elapsedSeconds : 0;
+    lastSnapshotAt = now;
+    lastSnapshotEntries = entries;
+
+    snap.batchesSent = batches.load(std::memory_order_relaxed);
+    snap.resultsSent = batchedResults.load(std::memory_order_relaxed);
+    snap.deliverySeconds = toSeconds(deliveryNanos.load(std::memory_order_relaxed));
+    snap.hasOutputFile = hasOutputFile;
+    snap.outputFile = outputFile;
+    return snap;
+}
+
+std::string SearchTelemetry::toJson(const TelemetrySnapshot& snap)
+{
+    std::string out = "{\n";
+    out += "  \"elapsedSeconds\": " + number(snap.elapsedSeconds) + ",\n";
+    out += "  \"finished\": " + std::string(snap.finished ? "true" : "false") + ",\n";
+    out += "  \"averageEntriesPerSecond\": " + number(snap.averageEntriesPerSecond) + ",\n";
+
+    out += "  \"counters\": {";
+    for (std::size_t c = 0; c < kTelemetryCounters; ++c) {
+        out += std::string(c ? ", " : "") + "\"" + counterName(static_cast<TelemetryCounter>(c)) + "\": " + number(snap.counters[c]);
+    }
+    out += "},\n";
+
+    out += "  \"workerSeconds\": {";
+    for (std::size_t t = 0; t < kTelemetryTimers; ++t) {
+        out += std::string(t ? ", " : "") + "\"" + timerName(static_cast<TelemetryTimer>(t)) + "\": " + number(snap.workerSeconds[t]);
+    }
+    out += ", \"matching\": " + number(snap.matchingSeconds()) + "},\n";
+
+    out += "  \"phaseSeconds\": {";
+    for (std::size_t p = 0; p < kSearchPhases; ++p) {
+        out += std::string(p ? ", " : "") + "\"" + phaseName(static_cast<SearchPhase>(p)) + "\": " + number(snap.phaseSeconds[p]);
+    }
+    out += "},\n";
+
+    out += "  \"delivery\": {\"batches\": " + number(snap.batchesSent) + ", \"results\": " + number(snap.resultsSent)
+           + ", \"sinkSeconds\": " + number(snap.deliverySeconds);
+    if (snap.consumerBatches > 0) {
+        out += ", \"consumerBatches\": " + number(snap.consumerBatches)
+               + ", \"consumerSeconds\": " + number(snap.consumerSeconds)
+               + ", \"queueDelayMaxSeconds\": " + number(snap.consumerMaxDelaySeconds)
+               + ", \"queueDelayAverageSeconds\": " + number(snap.consumerTotalDelaySeconds / snap.consumerBatches);
+    }
+    out += "},\n";
+
+    if (snap.hasOutputFile) {
+        const ResultWriterStats& file = snap.outputFile;
+        out += "  \"outputFile\": {\"results\": " + number(file.results) + ", \"bytes\": " + number(file.bytesWritten)
+               + ", \"seconds\": " + number(file.seconds) + ", \"megabytesPerSecond\": " + number(file.megabytesPerSecond)
+               + ", \"queueHighWater\": " + number(static_cast<std::uint64_t>(file.queueHighWater))
+               + ", \"producerWaits\": " + number(file.producerWaits) + ", \"statFailures\": " + number(file.statFailures)
+               + "},\n";
+    }
+
+    if (!snap.devices.empty()) {
+        out += "  \"devices\": [\n";
+        for (std::size_t i = 0; i < snap.devices.size(); ++i) {
+            const DeviceTelemetry& row = snap.devices[i];
+            out += "    {\"name\": " + quoted(row.name) + ", \"kind\": " + quoted(row.kind)
+                   + ", \"workers\": " + number(static_cast<std::uint64_t>(row.threads))
+                   + ", \"roots\": " + number(static_cast<std::uint64_t>(row.roots))
+                   + ", \"rootsDone\": " + number(static_cast<std::uint64_t>(row.rootsDone))
+                   + ", \"entries\": " + number(row.entries) + ", \"seconds\": " + number(row.seconds)
+                   + ", \"entriesPerSecond\": " + number(row.entriesPerSecond)
+                   + ", \"finished\": " + (row.finished ? "true" : "false") + "}"
+                   + (i + 1 < snap.devices.size() ? ",\n" : "\n");
+        }
+        out += "  ],\n";
+    }
+
+    out += "  \"workers\": [\n";
+    for (std::size_t i = 0; i < snap.workers.size(); ++i) {
+        const WorkerTelemetry& row = snap.workers[i];
+        out += "    {\"entries\": " + number(row.entries) + ", \"dirs\": " + number(row.dirs)
+               + ", \"matches\": " + number(row.matches) + ", \"steals\": " + number(row.steals)
+               + ", \"busySeconds\": " + number(row.busySeconds) + ", \"idleSeconds\": " + number(row.idleSeconds) + "}"
+               + (i + 1 < snap.workers.size() ? ",\n" : "\n");
+    }
+    out += "  ]\n}\n";
+    return out;
+}
+
+const char* SearchTelemetry::counterName(TelemetryCounter counter)
+{
+    switch (counter) {
+    case TelemetryCounter::DirsOpened: return "dirsOpened";
+    case TelemetryCounter::EntriesRead: return "entriesRead";
+    case TelemetryCounter::ReadCalls: return "readCalls";
+    case TelemetryCounter::StatCalls: return "statCalls";
+    case TelemetryCounter::Matches: return "matches";
+    case TelemetryCounter::MetadataStats: return "metadataStats";
+    case TelemetryCounter::MetadataStatsSaved: return "metadataStatsSaved";
+    case TelemetryCounter::MetadataRejected: return "metadataRejected";
+    case TelemetryCounter::Errors: return "errors";
+    case TelemetryCounter::Steals: return "steals";
+    case TelemetryCounter::MountsSkipped: return "mountsSkipped";
+    case TelemetryCounter::RingSubmits: return "ringSubmits";
+    case TelemetryCounter::RingRequests: return "ringRequests";
+    case TelemetryCounter::Count: break;
+    }
+    return "?";
+}
+
+const char* SearchTelemetry::timerName(TelemetryTimer timer)
+{
+    switch (timer) {
+    case TelemetryTimer::DirectoryRead: return "directoryRead";
+    case TelemetryTimer::Stat: return "stat";
+    case TelemetryTimer::Busy: return "busy";
+    case TelemetryTimer::Reporting: return "reporting";
+    case TelemetryTimer::Idle: return "idle";
+    case TelemetryTimer::Count: break;
+    }
+    return "?";
+}
+
+const char* SearchTelemetry::phaseName(SearchPhase phase)
+{
+    switch (phase) {
+    case SearchPhase::Setup: return "setup";
+    case SearchPhase::IndexQuery: return "indexQuery";
+    case SearchPhase::Walk: return "walk";
+    case SearchPhase::IndexSave: return "indexSave";
+    case SearchPhase::ContentDrain: return "contentDrain";
+    case SearchPhase::Duplicates: return "duplicates";
+    case SearchPhase::Finish: return "finish";
+    case SearchPhase::Count: break;
+    }
+    return "?";
+}
@@ -0,0 +1,256 @@
+#ifndef SEARCHTELEMETRY_H
+#define SEARCHTELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "resultwriter.h" // ResultWriterStats, for the output file part of the report
+
+// 📈 Search Telemetry 📈
+// "The search was slow" - but slow WHERE? Reading folders, stat-ing, matching, handing
+// results over, or writing the output file? These counters tell us.
+//
+// Every traversal worker gets its own ThreadTelemetry block (its own cache line, too), and
+// only that worker ever writes to it - plain load + store on relaxed atomics, no locked
+// instructions, so counting costs about as much as a local variable. Anybody may read the
+// blocks at any time (the numbers are just a moment old), and snapshot() adds them up.
+// Time is taken per directory or per syscall, never per entry, to keep the clock calls cheap.
+//
+// On top of that the search thread marks its phases (setup, index query, walk, index save,
+// finish), and the result hand-off and output file add their own numbers at the end.
+
+enum class TelemetryCounter : unsigned {
+    DirsOpened,  // Folders actually opened (open / openat / directory_iterator)
+    EntriesRead, // Directory entries looked at ("." and ".." don't count)
+    ReadCalls,   // getdents64 calls (std::filesystem: iterator steps)
+    StatCalls,   // stat()s the enumerator had to make (no d_type, or a symlink to follow)
+    Matches,     // Files that passed the query
+    MetadataStats,      // stat()s made for SearchConfig::metadata - only ever for names that passed
+    MetadataStatsSaved, // Files whose NAME failed while metadata predicates were set: stats we didn't make
+    MetadataRejected,   // Names that passed but whose size/time/owner/permissions didn't
+    Errors,      // Folders or entries we couldn't read (whether or not they were reported)
+    Steals,      // Work items a worker took from someone else's deque
+    MountsSkipped, // Subfolders left alone because they're another mount (see rootplanner.h)
+    RingSubmits,  // io_uring_enter() calls (SearchConfig::ioBackend = IoUring; see uringbatch.h)
+    RingRequests, // statx/openat requests those calls completed - requests per submit is the batching we got
+    Count
+};
+
+enum class TelemetryTimer : unsigned {
+    DirectoryRead, // open/openat + getdents64 (or directory_iterator) time
+    Stat,          // Time in those stat() calls (and in the metadata predicates' ones)
+    Busy,          // Everything a worker did with its work items (includes the two above)
+    Reporting,     // Handing matches to the callback, waiting for its lock included
+    Idle,          // Out of work: looking for some, or napping
+    Count
+};
+
+enum class SearchPhase : unsigned {
+    Setup,      // Finding roots, compiling the query, opening the output file
+    IndexQuery, // Answering from a saved index
+    Walk,       // The live traversal
+    IndexSave,  // Writing a freshly built index
+    ContentDrain, // Content search: reading the candidate files still queued when the walk ended
+    Duplicates, // Duplicate search: sizes, edge hashes and full hashes of the candidates
+    Finish,     // Last batch out, output file drained and closed
+    Count
+};
+
+constexpr std::size_t kTelemetryCounters = static_cast<std::size_t>(TelemetryCounter::Count);
+constexpr std::size_t kTelemetryTimers = static_cast<std::size_t>(TelemetryTimer::Count);
+constexpr std::size_t kSearchPhases = static_cast<std::size_t>(SearchPhase::Count);
+
+// Nanoseconds on the steady clock - what the stopwatches below measure with
+inline std::uint64_t telemetryNow()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// 🧮 One worker's tallies. Written by that worker only, read by anyone.
+class alignas(64) ThreadTelemetry
+{
+public:
+    void add(TelemetryCounter counter, std::uint64_t amount = 1)
+    {
+        bump(counters[static_cast<std::size_t>(counter)], amount);
+    }
+
+    void addNanos(TelemetryTimer timer, std::uint64_t nanos)
+    {
+        bump(timers[static_cast<std::size_t>(timer)], nanos);
+    }
+
+    std::uint64_t counter(TelemetryCounter counter) const
+    {
+        return counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t nanos(TelemetryTimer timer) const
+    {
+        return timers[static_cast<std::size_t>(timer)].load(std::memory_order_relaxed);
+    }
+
+private:
+    // Single writer, so no read-modify-write instruction needed - just don't tear the value
+    static void bump(std::atomic<std::uint64_t>& value, std::uint64_t amount)
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, kTelemetryCounters> counters{};
+    std::array<std::atomic<std::uint64_t>, kTelemetryTimers> timers{};
+};
+
+// ⏱️ Adds the time until it goes out of scope to one timer
+class TelemetryStopwatch
+{
+public:
+    TelemetryStopwatch(ThreadTelemetry& telemetry, TelemetryTimer timer)
+        : telemetry(telemetry), timer(timer), start(telemetryNow()) {}
+    ~TelemetryStopwatch() { telemetry.addNanos(timer, telemetryNow() - start); }
+
+    TelemetryStopwatch(const TelemetryStopwatch&) = delete;
+    TelemetryStopwatch& operator=(const TelemetryStopwatch&) = delete;
+
+private:
+    ThreadTelemetry& telemetry;
+    TelemetryTimer timer;
+    std::uint64_t start;
+};
+
+// 💽 One disk's walk (see devicescheduler.h). Every engine on that disk adds to it, anybody reads it.
+struct DeviceTally {
+    std::atomic<std::uint64_t> entries{0};
+    std::atomic<std::uint64_t> startedAt{0};  // 0 = still waiting for its workers
+    std::atomic<std::uint64_t> finishedAt{0}; // 0 = not done yet
+    std::atomic<unsigned int> rootsDone{0};
+};
+
+// One disk's row in the report
+struct DeviceTelemetry {
+    std::string name;  // "sda", "nvme0n1", a file server...
+    std::string kind;  // "rotational", "nvme", "network"...
+    unsigned int threads = 0;
+    unsigned int roots = 0;
+    unsigned int rootsDone = 0;
+    std::uint64_t entries = 0;
+    double seconds = 0;          // Walking so far (all of it, once finished)
+    double entriesPerSecond = 0; // Over that time - the slowest disk is the one to look at
+    bool started = false;
+    bool finished = false;
+};
+
+// One worker's row in the report
+struct WorkerTelemetry {
+    std::uint64_t entries = 0;
+    std::uint64_t dirs = 0;
+    std::uint64_t matches = 0;
+    std::uint64_t steals = 0;
+    double busySeconds = 0;
+    double idleSeconds = 0;
+};
+
+// 📸 Everything added up at one moment - plain values, safe to copy across threads
+struct TelemetrySnapshot {
+    double elapsedSeconds = 0;                             // Since the search started
+    bool finished = false;
+    SearchPhase currentPhase = SearchPhase::Setup;
+    std::array<std::uint64_t, kTelemetryCounters> counters{};
+    std::array<double, kTelemetryTimers> workerSeconds{};  // Summed over all workers
+    std::array<double, kSearchPhases> phaseSeconds{};      // Wall clock per phase (the current one so far)
+    double entriesPerSecond = 0;                           // Live: since the previous snapshot
+    double averageEntriesPerSecond = 0;                    // Over the whole search so far
+    std::vector<WorkerTelemetry> workers;
+    std::vector<DeviceTelemetry> devices;                  // Per-disk walks (empty unless the scheduler set them up)
+
+    // Result hand-off: batches leaving the search (to the window / stdout and the output file)
+    std::uint64_t batchesSent = 0;
+    std::uint64_t resultsSent = 0;
+    double deliverySeconds = 0;                            // Time spent inside the batch sink
+
+    // Whoever consumed the batches at the far end (the window fills these in itself)
+    std::uint64_t consumerBatches = 0;
+    double consumerSeconds = 0;                            // Time spent taking batches in
+    double consumerMaxDelaySeconds = 0;                    // Longest a batch waited in the queue
+    double consumerTotalDelaySeconds = 0;
+
+    bool hasOutputFile = false;
+    ResultWriterStats outputFile;
+
+    std::uint64_t counter(TelemetryCounter which) const { return counters[static_cast<std::size_t>(which)]; }
+    double seconds(TelemetryTimer which) const { return workerSeconds[static_cast<std::size_t>(which)]; }
+    double phase(SearchPhase which) const { return phaseSeconds[static_cast<std::size_t>(which)]; }
+
+    // Worker time not spent reading, stat-ing or reporting: matching and bookkeeping
+    double matchingSeconds() const;
+};
+
+// 📊 All the telemetry of one search
+class SearchTelemetry
+{
+public:
+    explicit SearchTelemetry(unsigned int workerSlots);
+
+    SearchTelemetry(const SearchTelemetry&) = delete;
+    SearchTelemetry& operator=(const SearchTelemetry&) = delete;
+
+    unsigned int workerSlots() const { return slotCount; }
+    ThreadTelemetry& worker(unsigned int index) { return workerBlocks[index]; }
+
+    // Search thread only: ends the current phase and starts the next one
+    void startPhase(SearchPhase phase);
+    // Search thread only: ends the last phase and stops the clock
+    void finish();
+
+    // Called with each batch as it leaves (from whichever thread flushed it - hence atomics)
+    void noteBatch(std::uint64_t results, std::uint64_t nanosInSink);
+
+    void noteOutputFile(const ResultWriterStats& stats);
+
+    // Search thread, before the walk: a disk that gets walked - its engines count into what comes back
+    DeviceTally& addDevice(const std::string& name, const std::string& kind, unsigned int threads, unsigned int roots);
+
+    // Search thread only (it remembers the last one, for the live rate)
+    TelemetrySnapshot snapshot();
+
+    // The whole report as one JSON object
+    static std::string toJson(const TelemetrySnapshot& snapshot);
+
+    static const char* counterName(TelemetryCounter counter);
+    static const char* timerName(TelemetryTimer timer);
+    static const char* phaseName(SearchPhase phase);
+
+private:
+    unsigned int slotCount;
+    std::unique_ptr<ThreadTelemetry[]> workerBlocks;
+
+    std::uint64_t startedAt;
+    std::uint64_t finishedAt = 0;
+    SearchPhase phase = SearchPhase::Setup;
+    std::uint64_t phaseStartedAt;
+    std::array<std::uint64_t, kSearchPhases> phaseNanos{};
+
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::uint64_t> batchedResults{0};
+    std::atomic<std::uint64_t> deliveryNanos{0};
+
+    bool hasOutputFile = false;
+    ResultWriterStats outputFile;
+
+    struct Device {
+        DeviceTelemetry info; // The fixed part: name, kind, workers, roots
+        DeviceTally tally;
+    };
+    std::vector<std::unique_ptr<Device>> devices; // (Pointers, so a tally never moves while it's counted into)
+
+    std::uint64_t lastSnapshotAt;
+    std::uint64_t lastSnapshotEntries = 0;
+};
+
+#endif // SEARCHTELEMETRY_H
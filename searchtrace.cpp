@@ -0,0 +1,235 @@
+#include "searchtrace.h"
+#include "searchtelemetry.h" // telemetryNow()
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+// Length of the UTF-8 sequence starting at text[i], or 0 if it isn't valid UTF-8
+std::size_t utf8SequenceLength(std::string_view text, std::size_t i)
+{
+    const unsigned char lead = static_cast<unsigned char>(text[i]);
+    std::size_t length;
+    std::uint32_t codePoint;
+    if (lead < 0x80) return 1;
+    else if ((lead & 0xE0) == 0xC0) { length = 2; codePoint = lead & 0x1F; }
+    else if ((lead & 0xF0) == 0xE0) { length = 3; codePoint = lead & 0x0F; }
+    else if ((lead & 0xF8) == 0xF0) { length = 4; codePoint = lead & 0x07; }
+    else return 0;
+    if (i + length > text.size()) return 0;
+    for (std::size_t k = 1; k < length; ++k) {
+        const unsigned char c = static_cast<unsigned char>(text[i + k]);
+        if ((c & 0xC0) != 0x80) return 0;
+        codePoint = (codePoint << 6) | (c & 0x3F);
+    }
+    const std::uint32_t smallest[] = {0, 0, 0x80, 0x800, 0x10000};
+    if (codePoint < smallest[length] || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        return 0;
+    }
+    return length;
+}
+
+// A JSON string that's valid no matter what bytes the file system gave us (bad UTF-8 becomes U+FFFD)
+void appendJsonText(std::string& out, std::string_view text)
+{
+    static const char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    for (std::size_t i = 0; i < text.size();) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x80) {
+            const std::size_t length = utf8SequenceLength(text, i);
+            if (length == 0) {
+                out += "\\ufffd";
+                ++i;
+            } else {
+                out.append(text.data() + i, length);
+                i += length;
+            }
+            continue;
+        }
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                out += "\\u00";
+                out.push_back(hex[c >> 4]);
+                out.push_back(hex[c & 0xF]);
+            } else {
+                out.push_back(static_cast<char>(c));
+            }
+        }
+        ++i;
+    }
+    out.push_back('"');
+}
+
+void appendMicros(std::string& out, std::uint64_t nanos)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03u", static_cast<unsigned long long>(nanos / 1000),
+                  static_cast<unsigned>(nanos % 1000));
+    out += text;
+}
+
+// The bar's label: the folder's own name (the full path goes into args)
+std::string_view lastComponent(std::string_view path)
+{
+    while (path.size() > 1 && path.back() == '/') {
+        path.remove_suffix(1);
+    }
+    const std::size_t slash = path.find_last_of('/');
+    return slash == std::string_view::npos || path.size() == 1 ? path : path.substr(slash + 1);
+}
+
+} // namespace
+
+void TraceLane::record(TraceSpanKind kind, std::uint64_t startNanos, std::uint64_t endNanos,
+                       std::uint64_t entries, std::string_view path)
+{
+    const std::uint64_t duration = endNanos > startNanos ? endNanos - startNanos : 0;
+    if (kind == TraceSpanKind::Directory && duration < minimumNanos) {
+        skipped.store(skipped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    const std::uint64_t at = head.load(std::memory_order_relaxed);
+    TraceSpan& span = spans[at % spanCapacity];
+    span.startNanos = startNanos > origin ? startNanos - origin : 0;
+    span.durationNanos = duration;
+    span.entries = entries;
+    span.kind = kind;
+    span.clipped = path.size() > TraceSpan::kPathBytes;
+    if (span.clipped) {
+        path.remove_prefix(path.size() - TraceSpan::kPathBytes);
+        // Don't start in the middle of a multi-byte character
+        while (!path.empty() && (static_cast<unsigned char>(path.front()) & 0xC0) == 0x80) {
+            path.remove_prefix(1);
+        }
+    }
+    std::memcpy(span.path, path.data(), path.size());
+    span.pathLength = static_cast<std::uint16_t>(path.size());
+    head.store(at + 1, std::memory_order_release); // Published
+}
+
+const TraceSpan& TraceLane::span(std::size_t i) const
+{
+    const std::uint64_t count = recorded();
+    const std::uint64_t oldest = count > spanCapacity ? count - spanCapacity : 0;
+    return spans[(oldest + i) % spanCapacity];
+}
+
+SearchTrace::SearchTrace(unsigned int workerSlots, double minimumMillis, std::size_t spansPerLane)
+    : slotCount(std::max(1u, workerSlots)),
+    lanes(new TraceLane[slotCount + 1]),
+    minimumMillis(std::max(0.0, minimumMillis))
+{
+    // Every span we'll ever keep is allocated right here, before the walk starts
+    const std::uint64_t origin = telemetryNow();
+    const std::size_t capacity = std::max<std::size_t>(16, spansPerLane);
+    for (unsigned int i = 0; i <= slotCount; ++i) {
+        lanes[i].spans.reset(new TraceSpan[capacity]);
+        lanes[i].spanCapacity = capacity;
+        lanes[i].origin = origin;
+        lanes[i].minimumNanos = static_cast<std::uint64_t>(this->minimumMillis * 1e6);
+    }
+}
+
+TraceSummary SearchTrace::summary() const
+{
+    TraceSummary total;
+    for (unsigned int i = 0; i <= slotCount; ++i) {
+        const std::uint64_t recorded = lanes[i].recorded();
+        const std::uint64_t kept = std::min<std::uint64_t>(recorded, lanes[i].capacity());
+        total.spansKept += kept;
+        total.spansOverwritten += recorded - kept;
+        total.belowThreshold += lanes[i].belowThreshold();
+    }
+    return total;
+}
+
+// 📝 Chrome trace-event format: one "X" (complete) event per span, "M" events naming the lanes.
+// Lane 0 is the search thread, worker i is lane i + 1. Written in chunks, never as one big string.
+bool SearchTrace::write(std::FILE* out, const std::string& processName) const
+{
+    std::string chunk;
+    chunk.reserve(1 << 16);
+    bool ok = true;
+    auto flushChunk = [&]() {
+        if (!chunk.empty() && std::fwrite(chunk.data(), 1, chunk.size(), out) != chunk.size()) {
+            ok = false;
+        }
+        chunk.clear();
+    };
+
+    chunk += "{\"traceEvents\":[\n";
+    chunk += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":";
+    appendJsonText(chunk, processName);
+    chunk += "}}";
+    for (unsigned int i = 0; i <= slotCount; ++i) {
+        const unsigned int tid = i == slotCount ? 0 : i + 1;
+        const std::string laneName = i == slotCount ? "search" : "worker " + std::to_string(i);
+        chunk += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid)
+                 + ",\"args\":{\"name\":\"" + laneName + "\"}}";
+        chunk += ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid)
+                 + ",\"args\":{\"sort_index\":" + std::to_string(tid) + "}}";
+    }
+
+    for (unsigned int i = 0; i <= slotCount && ok; ++i) {
+        const TraceLane& lane = lanes[i];
+        const unsigned int tid = i == slotCount ? 0 : i + 1;
+        const std::size_t kept = static_cast<std::size_t>(std::min<std::uint64_t>(lane.recorded(), lane.capacity()));
+        for (std::size_t s = 0; s < kept; ++s) {
+            const TraceSpan& span = lane.span(s);
+            const std::string_view path(span.path, span.pathLength);
+            const std::string shownPath = span.clipped ? "..." + std::string(path) : std::string(path);
+
+            chunk += ",\n{\"name\":";
+            appendJsonText(chunk, span.kind == TraceSpanKind::Root ? std::string_view("walk") : lastComponent(path));
+            chunk += span.kind == TraceSpanKind::Root ? ",\"cat\":\"root\"" : ",\"cat\":\"dir\"";
+            chunk += ",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(tid) + ",\"ts\":";
+            appendMicros(chunk, span.startNanos);
+            chunk += ",\"dur\":";
+            appendMicros(chunk, span.durationNanos);
+            chunk += ",\"args\":{\"path\":";
+            appendJsonText(chunk, shownPath);
+            chunk += ",\"entries\":" + std::to_string(span.entries) + "}}";
+
+            if (chunk.size() > (1 << 16) - 1024) {
+                flushChunk();
+            }
+        }
+    }
+
+    const TraceSummary totals = summary();
+    char other[256];
+    std::snprintf(other, sizeof(other),
+                  "\n],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"minimumMillis\":%g,\"spansKept\":%llu,"
+                  "\"spansOverwritten\":%llu,\"spansBelowThreshold\":%llu}}\n",
+                  minimumMillis, static_cast<unsigned long long>(totals.spansKept),
+                  static_cast<unsigned long long>(totals.spansOverwritten),
+                  static_cast<unsigned long long>(totals.belowThreshold));
+    chunk += other;
+    flushChunk();
+    return ok;
+}
+
+bool SearchTrace::writeFile(const std::string& file, const std::string& processName, std::string& problem) const
+{
+    std::FILE* out = std::fopen(file.c_str(), "wb");
+    if (!out) {
+        problem = "can't create " + file + ": " + std::strerror(errno);
+        return false;
+    }
+    const bool written = write(out, processName);
+    const int writeErrno = errno;
+    if (std::fclose(out) != 0 || !written) {
+        problem = "couldn't finish writing " + file + ": " + std::strerror(written ? errno : writeErrno);
+        return false;
+    }
+    return true;
+}
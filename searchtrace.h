@@ -0,0 +1,108 @@
+#ifndef SEARCHTRACE_H
+#define SEARCHTRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// 🧭 Search Tracing 🧭
+// The telemetry counters say HOW MUCH time went into reading folders - a trace says WHICH
+// folders. Every visited folder becomes one span (when it started, how long it took, how many
+// entries it had) on its worker's lane, and the whole thing is written out as Chrome
+// trace-event JSON that chrome://tracing or ui.perfetto.dev open directly. That one NFS mount
+// that held a worker for 20 seconds shows up as one very wide bar.
+//
+// Each lane is a ring of spans allocated up front. Only its own worker writes to it (so no
+// locks and no atomic read-modify-writes - the head is published with a release store), and
+// when it's full the oldest spans get overwritten. Spans shorter than the threshold are only
+// counted, never stored, which keeps a trace of a million folders down to the slow ones.
+// With tracing off the engine holds a null pointer and a span costs one branch.
+
+// What kind of bar this is
+enum class TraceSpanKind : std::uint8_t {
+    Directory, // One folder: open + read + match, not counting its subfolders
+    Root       // One whole root walk, on the search thread's lane
+};
+
+// One bar in the trace. Fixed size, so recording one never allocates.
+struct TraceSpan {
+    static constexpr std::size_t kPathBytes = 118; // Longer paths keep their tail (the interesting end)
+
+    std::uint64_t startNanos = 0;   // Since the trace started
+    std::uint64_t durationNanos = 0;
+    std::uint64_t entries = 0;
+    TraceSpanKind kind = TraceSpanKind::Directory;
+    bool clipped = false;           // Path lost its beginning
+    std::uint16_t pathLength = 0;
+    char path[kPathBytes];
+};
+
+// 🛤️ One worker's ring of spans. One writer, read only once the writer is done.
+class alignas(64) TraceLane
+{
+public:
+    TraceLane() = default;
+    TraceLane(const TraceLane&) = delete;
+    TraceLane& operator=(const TraceLane&) = delete;
+
+    // startNanos/endNanos are telemetryNow() readings; shorter-than-threshold folders are only counted
+    void record(TraceSpanKind kind, std::uint64_t startNanos, std::uint64_t endNanos,
+                std::uint64_t entries, std::string_view path);
+
+    std::uint64_t recorded() const { return head.load(std::memory_order_acquire); }   // Ever stored
+    std::uint64_t belowThreshold() const { return skipped.load(std::memory_order_relaxed); }
+    std::size_t capacity() const { return spanCapacity; }
+
+    // Span i of the ones still in the ring, oldest first (i < min(recorded(), capacity()))
+    const TraceSpan& span(std::size_t i) const;
+
+private:
+    friend class SearchTrace;
+
+    std::unique_ptr<TraceSpan[]> spans;
+    std::size_t spanCapacity = 0;
+    std::uint64_t origin = 0;          // The trace's start, so spans store small offsets
+    std::uint64_t minimumNanos = 0;
+    std::atomic<std::uint64_t> head{0};
+    std::atomic<std::uint64_t> skipped{0};
+};
+
+// What a finished trace holds, for the status line
+struct TraceSummary {
+    std::uint64_t spansKept = 0;       // Written to the file
+    std::uint64_t spansOverwritten = 0; // Lost because a ring wrapped (raise the buffer size)
+    std::uint64_t belowThreshold = 0;  // Folders faster than the threshold
+};
+
+// 📼 All the lanes of one search: one per traversal worker, plus one for the search thread
+class SearchTrace
+{
+public:
+    static constexpr std::size_t kDefaultSpansPerLane = 4096;
+
+    SearchTrace(unsigned int workerSlots, double minimumMillis, std::size_t spansPerLane = kDefaultSpansPerLane);
+
+    SearchTrace(const SearchTrace&) = delete;
+    SearchTrace& operator=(const SearchTrace&) = delete;
+
+    unsigned int workerSlots() const { return slotCount; }
+    TraceLane& worker(unsigned int index) { return lanes[index]; }
+    TraceLane& searchLane() { return lanes[slotCount]; } // Root walks
+
+    // Only once every writer is finished: the trace as Chrome trace-event JSON
+    bool write(std::FILE* out, const std::string& processName) const;
+    bool writeFile(const std::string& file, const std::string& processName, std::string& problem) const;
+
+    TraceSummary summary() const;
+
+private:
+    unsigned int slotCount;
+    std::unique_ptr<TraceLane[]> lanes;
+    double minimumMillis;
+};
+
+#endif // SEARCHTRACE_H
@@ -1,9 +1,20 @@
 #include "searchworker.h"
 #include <QDebug> // For my diagnostic chatter
 #include <QDir>   // For helping with paths
-#include <QMutexLocker> // For safe pausing without any drama
+#include <QCoreApplication> // To let our own slots run while the workers dig
+#include <QStringList>
 #include <vector>
 #include <filesystem> // Modern C++ file stuff - so much nicer!
+#include <memory>
+#include <QDateTime> // For "index built at" timestamps
+
+#include "compiledquery.h" // The search term, compiled once per search
+#include "fileindex.h" // The saved filename index
+#include "indexwatcher.h" // ...and the thing that keeps it fresh
+#include "fuzzymatch.h" // Fuzzy mode's top-K ranking
+#include "multimatch.h" // Multi-term mode's per-term groups
+#include "contentsearch.h" // Looking inside the files, on a pool of readers
+#include "duplicatefinder.h" // Files with the same content, read as little as possible
 
 namespace fs = std::filesystem;
 
@@ -14,14 +25,18 @@ SearchWorker::SearchWorker(QObject *parent)
     isPaused(false), // Start ready to roll!
     filesScannedCount(0) // No files checked yet
 {
-    // Nothing special needed here - we're all initialized and ready to go!
+    // Batches cross threads through queued connections, so Qt needs to know the type
+    qRegisterMetaType<ResultBatchPtr>();
+    qRegisterMetaType<TelemetrySnapshot>();
 }
 
 SearchWorker::~SearchWorker() {
-    // Let's be tidy - close any open files before we leave
-    if (outputFileStream.is_open()) {
-        outputFileStream.close();
-    }
+    // Let's be tidy - the writer (if a search left one behind) closes its file on the way out
+    resultWriter.reset();
+}
+
+void SearchWorker::setIndexWatcher(std::shared_ptr<IndexWatcher> watcher) {
+    indexWatcher = std::move(watcher);
 }
 
 // 🛑 Pause Button Handler 🛑
@@ -38,8 +53,8 @@ void SearchWorker::resumeSearch() {
     if (isPaused.load()) {
         isPaused.store(false); // Lower the yellow flag
         // Tap on the shoulder of any waiting threads
-        QMutexLocker locker(&pauseMutex); // Lock for safety
-        pauseCondition.wakeAll(); // Ring the bell! "Everyone back to work!"
+        std::lock_guard<std::mutex> locker(pauseMutex); // Lock for safety
+        pauseCondition.notify_all(); // Ring the bell! "Everyone back to work!"
         qDebug() << "Wake up call sent to the search thread!";
     }
 }
@@ -53,16 +68,12 @@ void SearchWorker::cancelSearch() {
     // If we're paused, we need to wake up to see the cancel flag
     if (isPaused.load()) {
         isPaused.store(false); // Don't pause again right away
-        QMutexLocker locker(&pauseMutex); // Lock for safety
-        pauseCondition.wakeAll();
+        std::lock_guard<std::mutex> locker(pauseMutex); // Lock for safety
+        pauseCondition.notify_all();
         qDebug() << "Had to wake the paused thread to tell it we're cancelling.";
     }
 
-    // Let's close up any output file and note that we got cancelled
-    if (outputFileStream.is_open()) {
-        outputFileStream << "\nSearch was cancelled by user." << std::endl;
-        outputFileStream.close();
-    }
+    // The output file gets its "cancelled" summary once doSearch wraps up
 
     // Tell the UI we're on it
     emit progressUpdate(tr("Cancelling search...")); // Use tr() for translation goodness
@@ -71,6 +82,8 @@ void SearchWorker::cancelSearch() {
 // 🔍 The Big Search Function - This Is Where It All Happens! 🔍
 void SearchWorker::doSearch(SearchConfig config) {
     // 🔄 Reset Everything For A Fresh Start
+    contentSearcher.reset(); // (Finished with the last search - but it feeds the batcher, so it goes first)
+    duplicateFinder.reset();
     isCancelled.store(false);
     isPaused.store(false);
     fileCount = 0;
@@ -78,93 +91,235 @@ void SearchWorker::doSearch(SearchConfig config) {
     currentConfig = config;
     currentSearchDir = ""; // No current directory yet
     timer.start(); // Start the stopwatch!
+    telemetry = std::make_unique<SearchTelemetry>(resolveThreadCount(config)); // Setup phase starts now
+    trace.reset();
+    if (!config.traceFile.empty()) {
+        // Every span buffer is allocated up front, so the walk itself never waits on the heap for them
+        trace = std::make_unique<SearchTrace>(resolveThreadCount(config), config.traceMinMillis,
+                                              config.traceSpansPerWorker);
+    }
+
+    // 📦 Matches go to the GUI in batches, straight from whichever worker found them
+    // (the output file gets the very same batches, on the writer's own thread)
+    resultBatcher = std::make_unique<ResultBatcher>([this](ResultBatchPtr batch) {
+        const std::uint64_t handOffStart = telemetryNow();
+        const std::size_t results = batch->size();
+        if (resultWriter && !termGroups) { // (Several terms: the file gets the grouped listing at the end)
+            resultWriter->submit(batch);
+        }
+        emit resultsBatch(batch);
+        telemetry->noteBatch(results, telemetryNow() - handOffStart);
+    });
 
     // 📄 Set Up Output File If Requested
-    if (outputFileStream.is_open()) {
-        outputFileStream.close(); // Close any previous file
-    }
+    resultWriter.reset(); // Finishes any file a previous search left open
     if (!config.outputFile.empty()) {
-        outputFileStream.open(config.outputFile);
-        if (!outputFileStream.is_open()) {
+        resultWriter = std::make_unique<ResultWriter>();
+        std::string problem;
+        if (!resultWriter->open(config, problem)) {
             emit errorOccurred(tr("Oops! Can't open the output file: %1").arg(QString::fromStdString(config.outputFile)));
-            // We'll continue anyway, just without saving to a file
-        } else {
-            // Add a nice header to the file
-            outputFileStream << "🔍 IYS Searcher Results 🔍" << std::endl;
-            outputFileStream << "Search term: '" << config.searchTerm << "'" << std::endl;
-            outputFileStream << "Starting from: " << (config.startPath.empty() ? "All Drives" : config.startPath) << std::endl;
-            outputFileStream << "------------------------------------------" << std::endl;
+            resultWriter.reset(); // We'll continue anyway, just without saving to a file
         }
     }
 
     // 🧭 Figure Out Where To Start Looking
-    std::vector<fs::path> rootsToSearch;
     if (config.searchAllRoots) {
         emit progressUpdate(tr("Figuring out what drives you have..."));
-        rootsToSearch = getRootPaths();
-        if (rootsToSearch.empty()) {
-            emit errorOccurred(tr("Hmm, couldn't find any drives to search. That's strange!"));
-            emit searchFinished(0, timer.elapsed() / 1000.0);
-            return;
-        }
     } else {
-        // The user specified a particular folder
-        fs::path userPath = config.startPath;
-        // Let's make sure it exists before we try to search it
+        // The user specified a particular folder - let's make sure it exists before we try to search it
+        const fs::path userPath = config.startPath;
         if (!fs::exists(userPath)) {
             emit errorOccurred(tr("I couldn't find that folder: %1").arg(QString::fromStdString(config.startPath)));
+            publishFinalTelemetry();
             emit searchFinished(0, timer.elapsed() / 1000.0);
             return;
         }
         if (!fs::is_directory(userPath)) {
             emit errorOccurred(tr("Hey, that's not a folder: %1").arg(QString::fromStdString(config.startPath)));
+            publishFinalTelemetry();
             emit searchFinished(0, timer.elapsed() / 1000.0);
             return;
         }
-        // Get the absolute path (full path) to avoid confusion
-        fs::path absoluteUserPath = fs::absolute(userPath);
-        rootsToSearch.push_back(absoluteUserPath);
     }
+    // 🗺️ One root per filesystem, and the walks keep out of each other's mount points
+    // (the Mounts tab shows the same plan, with the reasons)
+    RootPlan plan = planRoots(config);
+    if (plan.roots.empty()) {
+        emit errorOccurred(tr("Hmm, couldn't find any drives to search. That's strange!"));
+        publishFinalTelemetry();
+        emit searchFinished(0, timer.elapsed() / 1000.0);
+        return;
+    }
+    const std::vector<DeviceGroup> deviceGroups = groupRootsByDevice(plan, config); // Separate disks walk side by side
+    config.mountBoundaries = std::move(plan.boundaries);
+    currentConfig.mountBoundaries = config.mountBoundaries; // walkRoots reads currentConfig
+    const std::vector<fs::path> rootsToSearch = std::move(plan.roots);
 
-    // 🚀 Let's Start Searching!
-    for (const auto& root : rootsToSearch) {
-        if (isCancelled.load()) break; // Bail if cancelled
-
-        // Pause check now happens inside searchDirectoryRecursive
-        // This way we can pause even deep in the file tree!
+    // 🧩 Compile the term + extension ONCE - every walk worker and index scan below shares it
+    const CompiledQuery query(config);
+    if (!query.isValid()) { // A glob or regex with a typo - the window checks first, but just in case
+        emit errorOccurred(tr("That pattern won't work: %1").arg(QString::fromStdString(query.problem())));
+        publishFinalTelemetry();
+        emit searchFinished(0, timer.elapsed() / 1000.0);
+        return;
+    }
 
-        // Update the UI about where we're looking
-        currentSearchDir = QString::fromStdString(root.string());
-        emit progressUpdate(tr("Digging through: %1...").arg(currentSearchDir));
-        // Also update the detailed counts
-        emit progressDetailUpdate(filesScannedCount.load(), currentSearchDir);
+    // 🏆 Fuzzy matches get ranked as they come in - only the best fuzzyTopK are ever kept
+    ranking.reset();
+    rankingPublished = 0;
+    if (query.patternKind() == PatternKind::Fuzzy) {
+        ranking = std::make_unique<FuzzyRanking>(query.fuzzyMatcher(), config.fuzzyTopK);
+    }
+    // 🗂️ Several terms: each hit gets tagged with every term in its name, and filed under each
+    termGroups.reset();
+    if (config.findDuplicates) {
+        // 👯 Duplicate search: names that pass are just candidates - the groups come after the walk
+        DuplicateFinder::ErrorSink onError;
+        if (config.verboseErrors) {
+            onError = [this](const std::string& message) { emit errorOccurred(QString::fromStdString(message)); };
+        }
+        duplicateFinder = std::make_unique<DuplicateFinder>(config, isCancelled, onError);
+    } else if (!config.contentTerm.empty()) {
+        // 📖 Content search: names that pass go to the readers, and their matching LINES are the results
+        ContentSearcher::ErrorSink onError;
+        if (config.verboseErrors) {
+            onError = [this](const std::string& message) { emit errorOccurred(QString::fromStdString(message)); };
+        }
+        contentSearcher = std::make_unique<ContentSearcher>(
+            config,
+            [this](std::string_view path, std::uint64_t line, std::string_view snippet) {
+                resultBatcher->add(path, line, snippet);
+            },
+            isCancelled, onError);
+    } else if (query.patternKind() == PatternKind::MultiTerm) {
+        termGroups = std::make_unique<TermGroups>(query.multiTermMatcher());
+    }
 
+    // 🗂️ Maybe the saved index can answer this one without touching the disk tree?
+    bool answeredFromIndex = false;
+    if (config.indexMode == IndexMode::Query) {
+        markPhase(SearchPhase::IndexQuery);
+        answeredFromIndex = searchFromIndex(rootsToSearch, query);
+    }
 
-        // Set up our callback for handling finds and errors
-        auto callback = std::bind(&SearchWorker::handleSearchResult, this,
-                                  std::placeholders::_1, std::placeholders::_2);
+    // 🚀 Let's Start Searching! (the old-fashioned way, walking the real folders)
+    if (!answeredFromIndex) {
+        std::unique_ptr<FileIndexBuilder> indexBuilder;
+        if (config.indexMode == IndexMode::Build && !config.indexFile.empty()) {
+            indexBuilder = std::make_unique<FileIndexBuilder>(resolveThreadCount(config));
+            for (const auto& root : rootsToSearch) {
+                indexBuilder->addRoot(root);
+            }
+        }
 
-        // 🔍 Call our recursive explorer with all the tools it needs
-        searchDirectoryRecursive(root, config, callback, fileCount, isCancelled, filesScannedCount, 
-                                isPaused, pauseMutex, pauseCondition);
+        markPhase(SearchPhase::Walk);
+        walkRoots(deviceGroups, query, indexBuilder.get());
 
-        // Update counts after finishing each root
-        emit progressDetailUpdate(filesScannedCount.load(), currentSearchDir);
+        if (indexBuilder) {
+            markPhase(SearchPhase::IndexSave);
+            if (!isCancelled.load()) {
+                saveIndex(*indexBuilder);
+            } else {
+                emit resultsOrigin(tr("Live walk (cancelled - index not saved)"));
+            }
+        } else if (config.indexMode != IndexMode::Query) {
+            emit resultsOrigin(tr("Live walk")); // (Query already explained why it fell back)
+        }
+    }
 
-    } // End of loop over roots
 
+    QString modeSummary; // What the content readers or the duplicate finder have to say, for the status bar
+    if (contentSearcher) {
+        // The walk is done, the readers may not be - let them get through what's queued
+        markPhase(SearchPhase::ContentDrain);
+        emit progressUpdate(tr("Reading the last few files..."));
+        const ContentSearchStats stats = contentSearcher->finish();
+        fileCount = stats.matchingFiles; // Files whose CONTENT matched, not just the name
+        modeSummary = tr("%1 matching line(s) in %2 of %3 file(s) read (%4 MB, %5 binary skipped).")
+                             .arg(stats.matchingLines).arg(stats.matchingFiles).arg(stats.candidates)
+                             .arg(stats.bytesSearched / (1024.0 * 1024.0), 0, 'f', 1).arg(stats.binarySkipped);
+    }
+    if (duplicateFinder) {
+        // Sizes first, then the edges of what's left, then whole files - only as far as each one needs
+        markPhase(SearchPhase::Duplicates);
+        emit progressUpdate(tr("Comparing %1 candidate files...").arg(filesScannedCount.load()));
+        const std::vector<DuplicateGroup> groups = duplicateFinder->find(
+            [this](const char* stage, std::uint64_t done, std::uint64_t total) {
+                emit progressUpdate(tr("Comparing files (%1): %2 of %3...").arg(QString::fromLatin1(stage)).arg(done).arg(total));
+            });
+        for (std::size_t g = 0; g < groups.size(); ++g) {
+            for (const std::string& path : groups[g].paths) {
+                resultBatcher->addToGroup(path, g + 1); // Through the batcher like any result - GUI and output file both
+            }
+        }
+        const DuplicateStats stats = duplicateFinder->stats();
+        fileCount = stats.duplicateFiles;
+        modeSummary = tr("%1 duplicate group(s), %2 file(s), %3 MB could be freed. Read %4 MB of %5 MB (%6 MB never read).")
+                             .arg(stats.groups).arg(stats.duplicateFiles)
+                             .arg(stats.wastedBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                             .arg(stats.bytesRead / (1024.0 * 1024.0), 0, 'f', 1)
+                             .arg(stats.totalBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                             .arg(stats.bytesAvoided / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    if (currentConfig.metadata.isActive()) {
+        // Every name that didn't pass is a stat we never had to make
+        const TelemetrySnapshot numbers = telemetry->snapshot();
+        const QString metadataSummary = tr("%1 stat(s) for size/time/owner (%2 turned down), %3 saved by checking names first.")
+                                            .arg(numbers.counter(TelemetryCounter::MetadataStats))
+                                            .arg(numbers.counter(TelemetryCounter::MetadataRejected))
+                                            .arg(numbers.counter(TelemetryCounter::MetadataStatsSaved));
+        modeSummary = modeSummary.isEmpty() ? metadataSummary : metadataSummary + " " + modeSummary;
+    }
+    if (currentConfig.ioBackend == IoBackend::IoUring) {
+        // Requests per submit is how much batching the folders allowed
+        const TelemetrySnapshot numbers = telemetry->snapshot();
+        const QString ioSummary = numbers.counter(TelemetryCounter::RingSubmits) != 0
+            ? tr("io_uring: %1 request(s) in %2 submit(s).")
+                  .arg(numbers.counter(TelemetryCounter::RingRequests))
+                  .arg(numbers.counter(TelemetryCounter::RingSubmits))
+            : tr("io_uring: nothing batched.");
+        modeSummary = modeSummary.isEmpty() ? ioSummary : modeSummary + " " + ioSummary;
+    }
+    if (!currentConfig.mountBoundaries.empty()) {
+        // Mount points another root covers (or the plan left out) that the walk went around
+        const std::uint64_t skipped = telemetry->snapshot().counter(TelemetryCounter::MountsSkipped);
+        if (skipped != 0) {
+            const QString mountSummary = tr("%1 mount point(s) left to their own root or skipped.").arg(skipped);
+            modeSummary = modeSummary.isEmpty() ? mountSummary : modeSummary + " " + mountSummary;
+        }
+    }
 
     // 🏁 We're Done! Let's Wrap Things Up
-    if (outputFileStream.is_open()) {
-        outputFileStream << "------------------------------------------" << std::endl;
-        if (isCancelled.load()) {
-            outputFileStream << "Search was cancelled. Found " << fileCount << " file(s) before stopping." << std::endl;
-        } else {
-            outputFileStream << "Search complete! Found " << fileCount << " file(s)." << std::endl;
+    markPhase(SearchPhase::Finish);
+    if (ranking) {
+        // The final leaderboard, for the window and (best first) for the output file
+        const ResultBatchPtr best = publishRanking(true);
+        if (resultWriter) {
+            resultWriter->submit(best);
+        }
+    }
+    resultBatcher->flush(); // The last few matches go out before "finished" does
+    QList<quint64> termCounts;
+    if (termGroups) {
+        // The grouped listing, term by term - for the output file and whoever's listening
+        QList<ResultBatchPtr> groups;
+        for (ResultBatchPtr& group : termGroups->takeBatches()) {
+            if (resultWriter) {
+                resultWriter->submit(group);
+            }
+            groups.append(std::move(group));
         }
-        outputFileStream << "Checked approximately " << filesScannedCount.load() << " items." << std::endl;
-        outputFileStream << "Search took " << timer.elapsed() / 1000.0 << " seconds." << std::endl;
-        outputFileStream.close();
+        emit termResults(groups);
+        for (const std::uint64_t count : termGroups->counts()) {
+            termCounts.append(count);
+        }
+    }
+    QString outputSummary;
+    if (resultWriter) {
+        outputSummary = finishOutputFile();
+    }
+    if (trace) {
+        writeTrace();
     }
 
     // Final update for the UI
@@ -174,28 +329,261 @@ void SearchWorker::doSearch(SearchConfig config) {
     } else {
         finalMessage = tr("All done! Search finished.");
     }
+    if (!modeSummary.isEmpty()) {
+        finalMessage += " " + modeSummary;
+    }
+    if (!outputSummary.isEmpty()) {
+        finalMessage += " " + outputSummary; // Writer throughput + queue high-water mark
+    }
     emit progressUpdate(finalMessage);
     emit progressDetailUpdate(filesScannedCount.load(), ""); // Final count update
+    publishFinalTelemetry(); // The Stats tab gets its last numbers before "finished" arrives
 
 
-    emit searchFinished(fileCount, timer.elapsed() / 1000.0);
+    emit searchFinished(fileCount, timer.elapsed() / 1000.0, termCounts);
     qDebug() << "Search complete! Signaled the UI we're done.";
 }
 
 
+// 🚶 Walks every root for real with the traversal crew - separate disks at the same time, each with its own crew.
+// If an index builder is passed in, it gets to see every file along the way.
+void SearchWorker::walkRoots(const std::vector<DeviceGroup>& deviceGroups, const CompiledQuery& query, FileObserver* fileObserver) {
+    // Update the UI about where we're looking (per-disk progress shows up in the Stats tab)
+    QStringList where;
+    QStringList disks;
+    for (const DeviceGroup& group : deviceGroups) {
+        for (const fs::path& root : group.roots) {
+            where << QString::fromStdString(root.string());
+        }
+        disks << tr("%1 (%2, %3 workers%4)").arg(QString::fromStdString(group.name))
+                                            .arg(QString::fromLatin1(deviceKindName(group.kind))).arg(group.threads)
+                                            .arg(group.inodeOrder ? tr(", in inode order") : QString());
+    }
+    currentSearchDir = where.join(QStringLiteral(", "));
+    if (deviceGroups.size() > 1) {
+        emit progressUpdate(tr("Digging through %1 disks at once: %2...").arg(deviceGroups.size()).arg(disks.join(QStringLiteral(", "))));
+    } else {
+        emit progressUpdate(tr("Digging through: %1...").arg(currentSearchDir));
+    }
+    emit progressDetailUpdate(filesScannedCount.load(), currentSearchDir);
+
+    // Set up our callback for handling finds and errors
+    auto callback = std::bind(&SearchWorker::handleSearchResult, this,
+                              std::placeholders::_1, std::placeholders::_2);
+
+    // While the crews are out walking, this thread is free - keep the UI posted and
+    // let our own queued cancel/pause/resume slots run so the buttons actually do something
+    // (Pause checks happen inside every traversal worker, so we can pause even deep in the file tree!)
+    auto progress = [this](std::uint64_t scanned) {
+        resultBatcher->flushIfDue(); // A slow trickle of matches still shows up promptly
+        if (ranking) {
+            publishRanking(false); // The leaders so far, if they changed
+        }
+        emit progressDetailUpdate(scanned, currentSearchDir);
+        emit telemetryUpdate(telemetry->snapshot()); // Same beat as the progress ticker
+        QCoreApplication::processEvents();
+    };
+
+    // 🔍 Send the crews in with all the tools they need
+    searchDeviceGroups(deviceGroups, currentConfig, query, callback, fileCount, isCancelled, filesScannedCount,
+                       isPaused, pauseMutex, pauseCondition, progress, fileObserver, telemetry.get(), trace.get());
+
+    // Update counts now that every disk is done
+    emit progressDetailUpdate(filesScannedCount.load(), currentSearchDir);
+}
+
+// 🗂️ Tries to answer the search from the saved index.
+// Returns false (after telling the UI why) when a live walk is needed instead:
+// no index, a damaged one, one that doesn't cover these roots, or one that's out of date.
+bool SearchWorker::searchFromIndex(const std::vector<fs::path>& rootsToSearch, const CompiledQuery& query) {
+    if (currentConfig.indexFile.empty()) {
+        emit resultsOrigin(tr("Live walk (no index file chosen)"));
+        return false;
+    }
+
+    // 👁️ Is a live watcher already keeping this very index fresh? Then no staleness worries.
+    if (indexWatcher && indexWatcher->isRunning() && indexWatcher->indexFile() == currentConfig.indexFile) {
+        return searchFromWatcher(rootsToSearch, query);
+    }
+
+    FileIndex index;
+    std::string problem;
+    if (!index.open(currentConfig.indexFile, problem)) {
+        emit errorOccurred(tr("Couldn't use the index: %1").arg(QString::fromStdString(problem)));
+        emit resultsOrigin(tr("Live walk (index unusable)"));
+        return false;
+    }
+    for (const auto& root : rootsToSearch) {
+        if (!index.covers(root)) {
+            emit resultsOrigin(tr("Live walk (index doesn't cover %1)").arg(QString::fromStdString(root.string())));
+            return false;
+        }
+    }
+    if (index.isStale(problem)) {
+        emit resultsOrigin(tr("Live walk (index is stale: %1)").arg(QString::fromStdString(problem)));
+        return false;
+    }
+
+    // ⚡ All good - scan the memory-mapped tables instead of the disk
+    const QString builtAt = QDateTime::fromSecsSinceEpoch(index.builtAt()).toString(Qt::ISODate);
+    emit progressUpdate(tr("Answering from the index (%1 files)...").arg(index.fileCount()));
+    auto callback = std::bind(&SearchWorker::handleSearchResult, this,
+                              std::placeholders::_1, std::placeholders::_2);
+    const std::uint64_t scannedBefore = filesScannedCount.load();
+    const unsigned long long foundBefore = fileCount;
+    for (const auto& root : outermostRoots(rootsToSearch)) { // ("/" already holds "/home")
+        if (isCancelled.load()) break;
+        currentSearchDir = QString::fromStdString(root.string());
+        fileCount += index.search(root, query, callback, isCancelled, filesScannedCount, {}, &telemetry->worker(0));
+        emit progressDetailUpdate(filesScannedCount.load(), currentSearchDir);
+    }
+    bookIndexWork(scannedBefore, foundBefore);
+    emit resultsOrigin(tr("Index (built %1)").arg(builtAt));
+    return true;
+}
+
+// 👁️ Same as above, but through the live watcher: the index file plus every change since
+bool SearchWorker::searchFromWatcher(const std::vector<fs::path>& rootsToSearch, const CompiledQuery& query) {
+    for (const auto& root : rootsToSearch) {
+        if (!indexWatcher->covers(root)) {
+            emit resultsOrigin(tr("Live walk (index doesn't cover %1)").arg(QString::fromStdString(root.string())));
+            return false;
+        }
+    }
+
+    emit progressUpdate(tr("Answering from the live index (%1 files)...").arg(indexWatcher->fileCount()));
+    auto callback = std::bind(&SearchWorker::handleSearchResult, this,
+                              std::placeholders::_1, std::placeholders::_2);
+    const std::uint64_t scannedBefore = filesScannedCount.load();
+    const unsigned long long foundBefore = fileCount;
+    for (const auto& root : outermostRoots(rootsToSearch)) {
+        if (isCancelled.load()) break;
+        currentSearchDir = QString::fromStdString(root.string());
+        fileCount += indexWatcher->search(root, query, callback, isCancelled, filesScannedCount, &telemetry->worker(0));
+        emit progressDetailUpdate(filesScannedCount.load(), currentSearchDir);
+    }
+    bookIndexWork(scannedBefore, foundBefore);
+    emit resultsOrigin(tr("Index (kept live, %1 changes not merged yet)").arg(indexWatcher->stats().pendingChanges));
+    return true;
+}
+
+// 💾 Writes out everything the walk collected as the new index
+void SearchWorker::saveIndex(FileIndexBuilder& indexBuilder) {
+    emit progressUpdate(tr("Saving the index..."));
+    std::string problem;
+    IndexBuildStats stats;
+    if (indexBuilder.write(currentConfig.indexFile, problem, &stats)) {
+        emit resultsOrigin(tr("Live walk (index rebuilt: %1 files in %2 folders)")
+                               .arg(stats.fileCount).arg(stats.dirCount));
+        // 📏 How big did it get, and how long did it take? (Trigram lists are part of both numbers.)
+        emit progressUpdate(tr("Index saved: %1 MB (trigram lists %2 MB, %3 grams), built in %4 s (trigrams %5 s)")
+                                .arg(stats.bytesWritten / (1024.0 * 1024.0), 0, 'f', 1)
+                                .arg(stats.trigramBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                                .arg(stats.gramCount)
+                                .arg(stats.buildSeconds, 0, 'f', 2)
+                                .arg(stats.trigramSeconds, 0, 'f', 2));
+    } else {
+        emit errorOccurred(tr("Couldn't save the index: %1").arg(QString::fromStdString(problem)));
+        emit resultsOrigin(tr("Live walk (index NOT saved)"));
+    }
+}
+
+// ✍️ Lets the writer catch up, closes the output file and tells everyone how fast it went
+QString SearchWorker::finishOutputFile() {
+    const ResultWriterStats stats = resultWriter->finish(fileCount, filesScannedCount.load(),
+                                                         timer.elapsed() / 1000.0, isCancelled.load());
+    resultWriter.reset();
+    telemetry->noteOutputFile(stats);
+    if (!stats.error.empty()) {
+        emit errorOccurred(tr("Trouble with the output file: %1").arg(QString::fromStdString(stats.error)));
+    }
+    const QString summary = tr("Output file: %1 results, %2 MB at %3 MB/s, queue peaked at %4 batches (%5 results)")
+                                .arg(stats.results)
+                                .arg(stats.bytesWritten / (1024.0 * 1024.0), 0, 'f', 1)
+                                .arg(stats.megabytesPerSecond, 0, 'f', 1)
+                                .arg(stats.queueHighWater)
+                                .arg(stats.queueHighWaterResults);
+    qDebug() << summary << "- search had to wait" << stats.producerWaits << "times,"
+             << stats.statFailures << "files couldn't be stat'ed";
+    return summary;
+}
+
+
+// 📈 Telemetry bookkeeping - the phases are marked from this thread only
+void SearchWorker::markPhase(SearchPhase phase) {
+    telemetry->startPhase(phase);
+}
+
+// The index scan is one loop on this thread, so its numbers go into the first worker slot
+void SearchWorker::bookIndexWork(std::uint64_t scannedBefore, unsigned long long foundBefore) {
+    ThreadTelemetry& slot = telemetry->worker(0);
+    slot.add(TelemetryCounter::EntriesRead, filesScannedCount.load() - scannedBefore);
+    slot.add(TelemetryCounter::Matches, fileCount - foundBefore);
+}
+
+// 🧭 The trace goes out in one go at the end - the workers only ever filled their preallocated rings
+void SearchWorker::writeTrace() {
+    std::string problem;
+    if (!trace->writeFile(currentConfig.traceFile, "IYS Searcher: " + currentConfig.searchTerm, problem)) {
+        emit errorOccurred(tr("Couldn't save the trace: %1").arg(QString::fromStdString(problem)));
+    } else {
+        const TraceSummary summary = trace->summary();
+        emit progressUpdate(tr("Trace saved: %1 folders (%2 faster than %3 ms left out, %4 overwritten)")
+                                .arg(summary.spansKept).arg(summary.belowThreshold)
+                                .arg(currentConfig.traceMinMillis).arg(summary.spansOverwritten));
+    }
+    trace.reset(); // Hand the span buffers back right away
+}
+
+// 🏆 Packs the current top K into one batch (best first) and sends it off, unless nothing changed
+ResultBatchPtr SearchWorker::publishRanking(bool force) {
+    const std::uint64_t changes = ranking->changes();
+    if (!force && changes == rankingPublished) {
+        return nullptr;
+    }
+    rankingPublished = changes;
+    auto batch = std::make_shared<ResultBatch>();
+    for (const FuzzyHit& hit : ranking->ranked()) {
+        batch->add(hit.path);
+    }
+    batch->sealedAt = std::chrono::steady_clock::now();
+    emit rankingUpdate(batch, ranking->offered());
+    return batch;
+}
+
+void SearchWorker::publishFinalTelemetry() {
+    telemetry->finish();
+    const TelemetrySnapshot snapshot = telemetry->snapshot();
+    emit telemetryUpdate(snapshot);
+    emit telemetryFinished(snapshot);
+}
+
+
 // 📬 This Is How We Handle Findings & Errors During The Search
-// Gets called from inside searchDirectoryRecursive whenever it finds something
+// Gets called from the traversal workers whenever they find something
+// (one at a time - the engine serializes calls - but NOT on this object's own thread)
 void SearchWorker::handleSearchResult(const std::string& foundPath, const std::string& errorMessage) {
     // Don't bother reporting if we're cancelled or paused
     if (isCancelled.load() || isPaused.load()) return;
 
     if (!foundPath.empty()) {
         // Found a file! 🎉
-        if (outputFileStream.is_open()) {
-            outputFileStream << foundPath << std::endl;
+        // Into the current batch it goes - the GUI (and the output file) get it with the rest of the box.
+        // Fuzzy matches go up against the leaderboard instead, and only the best K ever get shown.
+        // Several terms: still shown once each as they come, but also tagged and grouped for the end.
+        // Content search: the name only gets it as far as the readers - they decide.
+        if (duplicateFinder) {
+            duplicateFinder->add(foundPath); // Compared with the rest once the walk is done
+        } else if (contentSearcher) {
+            contentSearcher->submit(foundPath);
+        } else if (ranking) {
+            ranking->offer(foundPath);
+        } else {
+            if (termGroups) {
+                termGroups->add(foundPath);
+            }
+            resultBatcher->add(foundPath);
         }
-        // Tell the UI about our find
-        emit resultFound(QString::fromStdString(foundPath));
     } else if (!errorMessage.empty() && currentConfig.verboseErrors) {
         // Hit an error 😕
         emit errorOccurred(QString::fromStdString(errorMessage));
@@ -4,13 +4,29 @@
 #include <QObject>
 #include <QString>
 #include <QElapsedTimer> // For timing
-#include <QMutex>         // <-- Added for pausing
-#include <QWaitCondition> // <-- Added for pausing
-#include <fstream>        // For file output handling
 #include <atomic>         // For atomic flags
+#include <condition_variable> // <-- Added for pausing
+#include <cstdint>
+#include <mutex>          // <-- Added for pausing
 #include <QtGlobal>       // <-- Added for quint64
+#include <QList>
+#include <vector>
+#include <memory>
 
 #include "searchlogic.h" // Include the logic definitions
+#include "devicescheduler.h" // Roots grouped by disk, walked side by side
+#include "resultbatch.h" // Matches travel to the GUI in batches
+#include "resultwriter.h" // ...and to the output file, on a thread of its own
+#include "searchtelemetry.h" // Counters and timings for the Stats tab
+#include "searchtrace.h"     // ...and, if asked for, a trace of every folder
+
+class FileIndexBuilder;
+class IndexWatcher;
+class CompiledQuery;
+class FuzzyRanking;
+class TermGroups;
+class ContentSearcher;
+class DuplicateFinder;
 
 class SearchWorker : public QObject
 {
@@ -20,17 +36,22 @@ public:
     explicit SearchWorker(QObject *parent = nullptr);
     ~SearchWorker(); // Destructor to close the file if open
 
+    // The live index watcher (if the window is running one) - index queries go through it
+    void setIndexWatcher(std::shared_ptr<IndexWatcher> watcher);
+
 signals:
     // --- Existing Signals ---
-    // Signal emitted when a matching file is found
-    void resultFound(const QString& path);
+    // Signal emitted with a batch of matching files (a few thousand paths, or whatever
+    // piled up in the last 100 ms). Sent from the traversal workers' threads - always connect queued.
+    void resultsBatch(ResultBatchPtr batch);
 
     // Signal emitted when a verbose error/warning occurs
     void errorOccurred(const QString& message); // Keep this for errors
 
     // Signal emitted when the search is complete
-    // Params: count, time_in_seconds
-    void searchFinished(unsigned long long count, double duration);
+    // Params: count, time_in_seconds, and for a multi-term search the hits per term
+    // (by position in SearchConfig::searchTerms; empty otherwise)
+    void searchFinished(unsigned long long count, double duration, QList<quint64> termCounts = QList<quint64>());
 
     // Signal to update general progress text (e.g., "Searching C:\...")
     void progressUpdate(const QString& message); // Keep for general status
@@ -39,6 +60,24 @@ signals:
     // Signal for more detailed progress update
     void progressDetailUpdate(quint64 filesScanned, const QString& currentDir); // <-- New
 
+    // Where this search's results came from ("Index (built ...)" or "Live walk (...)")
+    void resultsOrigin(const QString& description);
+
+    // 📈 Live counters and timings, about four times a second while the search runs
+    void telemetryUpdate(TelemetrySnapshot snapshot);
+    // ...and the final numbers, just before searchFinished
+    void telemetryFinished(TelemetrySnapshot snapshot);
+
+    // 🏆 Fuzzy mode: the best matches so far, best first - REPLACES whatever was shown before.
+    // Sent on the progress beat whenever the leaders change, and once more at the end.
+    // fuzzyMatches counts every name that matched at all, ranked in or not.
+    void rankingUpdate(ResultBatchPtr ranked, quint64 fuzzyMatches);
+
+    // 🗂️ Multi-term searches: every hit again, grouped by term (term 0's first, each batch tagged
+    // with its termId; a path with two of the terms is in both groups). Sent once, just before
+    // searchFinished - the resultsBatch stream during the walk has each path only once.
+    void termResults(QList<ResultBatchPtr> groups);
+
 
 public slots:
     // Slot to start the search process
@@ -59,20 +98,46 @@ private:
     // Callback function wrapper to emit signals (no signature change needed yet)
     void handleSearchResult(const std::string& foundPath, const std::string& errorMessage);
 
+    // The ways to answer a search (walk, saved index, live-watched index), plus saving what a walk saw as a new index
+    // They all share the one CompiledQuery that doSearch() builds
+    void walkRoots(const std::vector<DeviceGroup>& deviceGroups, const CompiledQuery& query, FileObserver* fileObserver);
+    bool searchFromIndex(const std::vector<fs::path>& rootsToSearch, const CompiledQuery& query);
+    bool searchFromWatcher(const std::vector<fs::path>& rootsToSearch, const CompiledQuery& query);
+    void saveIndex(FileIndexBuilder& indexBuilder);
+    QString finishOutputFile(); // Drains the writer, closes the file; returns how it went, for the status bar
+    void markPhase(SearchPhase phase);
+    void bookIndexWork(std::uint64_t scannedBefore, unsigned long long foundBefore); // Index answers have no workers
+    void publishFinalTelemetry(); // Stops the clocks and sends the last snapshot
+    void writeTrace(); // Saves the trace file (if tracing) once every worker is done
+    ResultBatchPtr publishRanking(bool force); // Sends the current top K (if it changed, or if forced)
+
     // --- Member Variables ---
     SearchConfig currentConfig;
     QElapsedTimer timer;
     unsigned long long fileCount;       // Counter for *found* files
-    std::ofstream outputFileStream;     // Keep file stream here
 
     std::atomic<bool> isCancelled;      // Flag for cancellation
     std::atomic<bool> isPaused;         // <-- New: Flag for pausing
-    std::atomic<quint64> filesScannedCount; // <-- New: Counter for *scanned* files
+    std::atomic<std::uint64_t> filesScannedCount; // <-- New: Counter for *scanned* files
 
-    QMutex pauseMutex;                  // <-- New: Mutex for pause condition
-    QWaitCondition pauseCondition;      // <-- New: Wait condition for pausing
+    std::mutex pauseMutex;              // <-- New: Mutex for pause condition
+    std::condition_variable pauseCondition; // <-- New: Wait condition for pausing
 
     QString currentSearchDir;           // <-- New: Store current dir for detailed progress signal
+
+    std::shared_ptr<IndexWatcher> indexWatcher; // Shared with the window, which starts and stops it
+    std::unique_ptr<ResultBatcher> resultBatcher; // Packs matches into batches for resultsBatch, one per search
+    std::unique_ptr<ResultWriter> resultWriter;   // Owns the output file (and its thread) while a search runs
+    std::unique_ptr<SearchTelemetry> telemetry;   // This search's counters, one slot per traversal worker
+    std::unique_ptr<SearchTrace> trace;           // Per-folder spans, only when config.traceFile is set
+    std::unique_ptr<FuzzyRanking> ranking;        // Fuzzy mode: matches go here instead of the batcher
+    std::uint64_t rankingPublished = 0;           // The ranking's changes() when we last sent it
+    std::unique_ptr<TermGroups> termGroups;       // Multi-term mode: every hit, tagged and grouped by term
+    std::unique_ptr<ContentSearcher> contentSearcher; // Content search: names that pass get read by its pool (after the batcher - it feeds it)
+    std::unique_ptr<DuplicateFinder> duplicateFinder; // Duplicate search: names that pass are collected, compared after the walk
 };
 
+Q_DECLARE_METATYPE(ResultBatchPtr)
+Q_DECLARE_METATYPE(TelemetrySnapshot)
+
 #endif // SEARCHWORKER_H
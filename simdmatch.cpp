@@ -0,0 +1,299 @@
+#include "simdmatch.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IYS_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang compile each kernel for its own instruction set, so the rest of the program
+// doesn't need -mavx2. MSVC hands out every intrinsic without asking.
+#if defined(__GNUC__) || defined(__clang__)
+#define IYS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define IYS_TARGET(isa)
+#endif
+
+namespace {
+
+using SimdMatch::foldAscii;
+
+constexpr std::size_t kNotFound = SubstringMatcher::npos;
+
+// Compares the needle's inner bytes (the first and last already matched)
+template <bool Fold>
+inline bool middleEquals(const char* haystack, const char* needle, std::size_t length)
+{
+    if (!Fold) {
+        return std::memcmp(haystack, needle, length) == 0;
+    }
+    for (std::size_t k = 0; k < length; ++k) {
+        if (foldAscii(haystack[k]) != needle[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 🐢 Scalar fallback: same first/last-byte filter, one position at a time
+template <bool Fold>
+std::size_t findScalar(const char* needle, std::size_t n, const char* haystack, std::size_t size)
+{
+    if (n == 0) {
+        return 0;
+    }
+    if (n > size) {
+        return kNotFound;
+    }
+    if (!Fold) {
+        return std::string_view(haystack, size).find(std::string_view(needle, n));
+    }
+    const char first = needle[0];
+    const char last = needle[n - 1];
+    for (std::size_t i = 0; i + n <= size; ++i) {
+        if (foldAscii(haystack[i]) == first && foldAscii(haystack[i + n - 1]) == last
+            && middleEquals<true>(haystack + i + 1, needle + 1, n > 2 ? n - 2 : 0)) {
+            return i;
+        }
+    }
+    return kNotFound;
+}
+
+#ifdef IYS_SIMD_X86
+
+// Where to load a block from. Most names are shorter than one block, so the tail is the
+// common case: if a full-width load can't cross into the next page it can't fault either,
+// so we read straight from the name and mask off the extra bytes afterwards. Only a tail
+// that sits right at the end of a page gets copied into a zero-padded buffer.
+constexpr std::uintptr_t kPageSize = 4096;
+
+template <std::size_t Width>
+inline const char* blockAt(const char* p, std::size_t available, char* spill)
+{
+    if (available >= Width || (reinterpret_cast<std::uintptr_t>(p) & (kPageSize - 1)) <= kPageSize - Width) {
+        return p;
+    }
+    std::memset(spill, 0, Width);
+    std::memcpy(spill, p, available);
+    return spill;
+}
+
+// The over-read above is deliberate, so keep AddressSanitizer from flagging it
+#if defined(__clang__) || defined(__GNUC__)
+#define IYS_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define IYS_NO_SANITIZE_ADDRESS
+#endif
+
+// 🔡 Lowercase A-Z inside the register: x + 0x3F lands 'A'..'Z' (and only them) in the
+// signed range [-128, -103], one compare finds them, and OR-ing in 0x20 lowercases them
+IYS_TARGET("sse4.2")
+inline __m128i foldBlock128(__m128i x)
+{
+    const __m128i shifted = _mm_add_epi8(x, _mm_set1_epi8(0x3F));
+    const __m128i isUpper = _mm_cmpgt_epi8(_mm_set1_epi8(-102), shifted);
+    return _mm_or_si128(x, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+}
+
+IYS_TARGET("avx2")
+inline __m256i foldBlock256(__m256i x)
+{
+    const __m256i shifted = _mm256_add_epi8(x, _mm256_set1_epi8(0x3F));
+    const __m256i isUpper = _mm256_cmpgt_epi8(_mm256_set1_epi8(-102), shifted);
+    return _mm256_or_si256(x, _mm256_and_si256(isUpper, _mm256_set1_epi8(0x20)));
+}
+
+inline unsigned lowestBit(std::uint32_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// ⚡ 16 candidate start positions per step
+template <bool Fold>
+IYS_TARGET("sse4.2") IYS_NO_SANITIZE_ADDRESS
+std::size_t findSse42(const char* needle, std::size_t n, const char* haystack, std::size_t size)
+{
+    if (n == 0) {
+        return 0;
+    }
+    if (n > size) {
+        return kNotFound;
+    }
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    const std::size_t starts = size - n + 1;
+    alignas(16) char spillFirst[16];
+    alignas(16) char spillLast[16];
+
+    for (std::size_t i = 0; i < starts; i += 16) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockAt<16>(haystack + i, size - i, spillFirst)));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockAt<16>(haystack + i + n - 1, starts - i, spillLast)));
+        if (Fold) {
+            head = foldBlock128(head);
+            tail = foldBlock128(tail);
+        }
+        std::uint32_t mask = static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+        if (starts - i < 16) {
+            mask &= (1u << (starts - i)) - 1; // Positions past the last possible start don't count
+        }
+        while (mask != 0) {
+            const unsigned j = lowestBit(mask);
+            if (n <= 2 || middleEquals<Fold>(haystack + i + j + 1, needle + 1, n - 2)) {
+                return i + j;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return kNotFound;
+}
+
+// ⚡⚡ 32 candidate start positions per step
+template <bool Fold>
+IYS_TARGET("avx2") IYS_NO_SANITIZE_ADDRESS
+std::size_t findAvx2(const char* needle, std::size_t n, const char* haystack, std::size_t size)
+{
+    if (n == 0) {
+        return 0;
+    }
+    if (n > size) {
+        return kNotFound;
+    }
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[n - 1]);
+    const std::size_t starts = size - n + 1;
+    alignas(32) char spillFirst[32];
+    alignas(32) char spillLast[32];
+
+    for (std::size_t i = 0; i < starts; i += 32) {
+        __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blockAt<32>(haystack + i, size - i, spillFirst)));
+        __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blockAt<32>(haystack + i + n - 1, starts - i, spillLast)));
+        if (Fold) {
+            head = foldBlock256(head);
+            tail = foldBlock256(tail);
+        }
+        std::uint32_t mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last))));
+        if (starts - i < 32) {
+            mask &= (1u << (starts - i)) - 1;
+        }
+        while (mask != 0) {
+            const unsigned j = lowestBit(mask);
+            if (n <= 2 || middleEquals<Fold>(haystack + i + j + 1, needle + 1, n - 2)) {
+                return i + j;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return kNotFound;
+}
+
+#endif // IYS_SIMD_X86
+
+// 🧐 Asks the CPU (and, for AVX, the OS) what it can do
+bool cpuHas(SimdMatch::Kernel kernel)
+{
+#ifdef IYS_SIMD_X86
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    switch (kernel) {
+    case SimdMatch::Kernel::AVX2: return __builtin_cpu_supports("avx2");
+    case SimdMatch::Kernel::SSE42: return __builtin_cpu_supports("sse4.2");
+    default: return true;
+    }
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool sse42 = (info[2] & (1 << 20)) != 0;
+    const bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    const bool avx2 = osSavesAvx && (info[1] & (1 << 5)) != 0;
+    switch (kernel) {
+    case SimdMatch::Kernel::AVX2: return avx2;
+    case SimdMatch::Kernel::SSE42: return sse42;
+    default: return true;
+    }
+#else
+    return kernel == SimdMatch::Kernel::Scalar;
+#endif
+#else
+    return kernel == SimdMatch::Kernel::Scalar;
+#endif
+}
+
+} // namespace
+
+namespace SimdMatch {
+
+bool isSupported(Kernel kernel)
+{
+    if (kernel == Kernel::Auto || kernel == Kernel::Scalar) {
+        return true;
+    }
+    return cpuHas(kernel);
+}
+
+Kernel bestKernel()
+{
+    static const Kernel best = isSupported(Kernel::AVX2)    ? Kernel::AVX2
+                               : isSupported(Kernel::SSE42) ? Kernel::SSE42
+                                                            : Kernel::Scalar;
+    return best;
+}
+
+const char* kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Auto: return kernelName(bestKernel());
+    case Kernel::AVX2: return "avx2";
+    case Kernel::SSE42: return "sse4.2";
+    case Kernel::Scalar: break;
+    }
+    return "scalar";
+}
+
+std::string foldAscii(std::string_view text)
+{
+    std::string folded(text);
+    for (char& c : folded) {
+        c = foldAscii(c);
+    }
+    return folded;
+}
+
+} // namespace SimdMatch
+
+SubstringMatcher::SubstringMatcher(std::string_view needle, bool caseInsensitive, SimdMatch::Kernel kernel)
+    : needleBytes(caseInsensitive ? SimdMatch::foldAscii(needle) : std::string(needle))
+{
+    if (kernel == SimdMatch::Kernel::Auto || !SimdMatch::isSupported(kernel)) {
+        kernel = kernel == SimdMatch::Kernel::Auto ? SimdMatch::bestKernel() : SimdMatch::Kernel::Scalar;
+    }
+    selectedKernel = kernel;
+
+    switch (kernel) {
+#ifdef IYS_SIMD_X86
+    case SimdMatch::Kernel::AVX2:
+        finder = caseInsensitive ? &findAvx2<true> : &findAvx2<false>;
+        return;
+    case SimdMatch::Kernel::SSE42:
+        finder = caseInsensitive ? &findSse42<true> : &findSse42<false>;
+        return;
+#endif
+    default:
+        selectedKernel = SimdMatch::Kernel::Scalar;
+        finder = caseInsensitive ? &findScalar<true> : &findScalar<false>;
+        return;
+    }
+}
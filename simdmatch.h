@@ -0,0 +1,80 @@
+#ifndef SIMDMATCH_H
+#define SIMDMATCH_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// ⚡ Vectorized Substring Search ⚡
+// The matcher runs once per scanned entry, so it's the hottest loop we have. Instead of
+// lowercasing a copy of every filename and calling find(), this looks at 16 or 32 bytes
+// per step: it compares the needle's first AND last byte against the haystack at once,
+// and only the (rare) positions where both agree get a full comparison.
+// For case-insensitive searches the haystack bytes are folded to lowercase right there
+// in the vector registers, so no lowered copy is ever made.
+//
+// The kernel is picked at runtime from what the CPU supports (AVX2, then SSE4.2, then
+// plain scalar code), so one binary runs everywhere. Only ASCII letters are folded -
+// the same thing toLower() does for the UTF-8 names we see in practice.
+
+namespace SimdMatch {
+
+enum class Kernel {
+    Auto,   // Best one this CPU supports
+    Scalar, // Portable fallback
+    SSE42,  // 16 bytes per step (x86 only)
+    AVX2    // 32 bytes per step (x86 only)
+};
+
+// What Auto resolves to on this machine
+Kernel bestKernel();
+
+// Can this machine (and this build) run the kernel?
+bool isSupported(Kernel kernel);
+
+// "avx2", "sse4.2", "scalar"
+const char* kernelName(Kernel kernel);
+
+// ASCII-only lowercase, byte by byte
+inline char foldAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+std::string foldAscii(std::string_view text);
+
+} // namespace SimdMatch
+
+// 🔎 One needle, searched for in as many haystacks as you like.
+// Read-only after construction, so threads can share one.
+class SubstringMatcher
+{
+public:
+    // caseInsensitive: the needle gets folded here, haystacks get folded on the fly.
+    // kernel: leave on Auto unless you're benchmarking (unsupported ones fall back to Scalar).
+    SubstringMatcher(std::string_view needle, bool caseInsensitive,
+                     SimdMatch::Kernel kernel = SimdMatch::Kernel::Auto);
+
+    static constexpr std::size_t npos = std::string_view::npos;
+
+    bool contains(std::string_view haystack) const { return find(haystack) != npos; }
+
+    // Where the first match starts, or npos (content search wants the spot, not just a yes)
+    std::size_t find(std::string_view haystack) const
+    {
+        return finder(needleBytes.data(), needleBytes.size(), haystack.data(), haystack.size());
+    }
+
+    SimdMatch::Kernel kernel() const { return selectedKernel; }
+    const std::string& needle() const { return needleBytes; }
+
+    using FindFunction = std::size_t (*)(const char* needle, std::size_t needleLength,
+                                         const char* haystack, std::size_t haystackLength);
+
+private:
+    std::string needleBytes;
+    SimdMatch::Kernel selectedKernel;
+    FindFunction finder;
+};
+
+#endif // SIMDMATCH_H
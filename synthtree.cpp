@@ -0,0 +1,282 @@
+#include "synthtree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// splitmix64 - tiny, fast, and the same sequence everywhere (unlike std::mt19937 + std:: distributions)
+class Random
+{
+public:
+    explicit Random(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next()
+    {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, bound)
+    std::uint64_t below(std::uint64_t bound) { return bound ? next() % bound : 0; }
+
+    // [0, 1) with 53 random bits
+    double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Standard normal via Box-Muller (one value per call keeps the sequence simple)
+    double normal()
+    {
+        const double u1 = 1.0 - unit(); // (0, 1] so the log is finite
+        const double u2 = unit();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+private:
+    std::uint64_t state;
+};
+
+constexpr std::uint64_t kFnvOffset = 0xCBF29CE484222325ull;
+constexpr std::uint64_t kFnvPrime = 0x100000001B3ull;
+
+void fnv(std::uint64_t& hash, std::string_view bytes)
+{
+    for (char c : bytes) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * kFnvPrime;
+    }
+    hash = (hash ^ 0xFF) * kFnvPrime; // Separator, so "ab"+"c" != "a"+"bc"
+}
+
+// A realistic-ish mix of extensions (repeats make the common ones more likely)
+const char* const kExtensions[] = {
+    ".txt", ".txt", ".jpg", ".jpg", ".jpg", ".png", ".cpp", ".h", ".h", ".json", ".md", ".log",
+    ".log", ".so", ".pdf", ".html", ".js", ".js", ".py", ".xml", ".dat", "", "",
+};
+constexpr std::size_t kExtensionCount = sizeof(kExtensions) / sizeof(kExtensions[0]);
+
+const char kStemAlphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789_-";
+constexpr std::size_t kStemAlphabetSize = sizeof(kStemAlphabet) - 1;
+
+unsigned stemLength(Random& random, const SyntheticTreeSpec& spec)
+{
+    const unsigned low = std::max(1u, spec.nameLengthMin);
+    const unsigned high = std::max(low, spec.nameLengthMax);
+    double length;
+    if (spec.nameLengths == NameLengthDistribution::Uniform) {
+        length = low + static_cast<double>(random.below(high - low + 1));
+    } else {
+        length = std::round(std::max(1.0, spec.nameLengthMedian) * std::exp(spec.nameLengthSigma * random.normal()));
+    }
+    return static_cast<unsigned>(std::clamp(length, static_cast<double>(low), static_cast<double>(high)));
+}
+
+std::string randomStem(Random& random, unsigned length)
+{
+    std::string stem(length, 'a');
+    for (char& c : stem) {
+        c = kStemAlphabet[random.below(kStemAlphabetSize)];
+        if (c >= 'a' && c <= 'z' && random.below(10) == 0) {
+            c = static_cast<char>(c - 'a' + 'A'); // A few capitals, so case folding has work to do
+        }
+    }
+    return stem;
+}
+
+// Everything the generator decides, handed to whoever wants it (the disk writer, or nobody)
+struct TreeVisitor {
+    std::function<bool(const std::string& relativeDir)> onDir;                 // Create this folder
+    std::function<bool(const std::string& relativePath)> onFile;               // Create this file
+};
+
+// 🌱 Walks the planned tree depth-first, deciding every name. Same spec -> same calls, always.
+class Planner
+{
+public:
+    Planner(const SyntheticTreeSpec& spec, const TreeVisitor& visitor, SyntheticTreeStats& stats)
+        : spec(spec), visitor(visitor), stats(stats), random(spec.seed)
+    {
+        // Folders below the root: fanout + fanout^2 + ... + fanout^depth
+        std::uint64_t level = 1;
+        std::uint64_t below = 0;
+        for (unsigned d = 0; d < spec.depth; ++d) {
+            level *= spec.fanout;
+            below += level;
+        }
+        folders = below + 1; // ...plus the root itself
+        filesPerFolder = spec.fileCount / folders;
+        foldersWithExtra = spec.fileCount % folders;
+    }
+
+    bool run()
+    {
+        stats.fingerprint = kFnvOffset;
+        return visit(std::string(), 0);
+    }
+
+private:
+    bool visit(const std::string& dir, unsigned depth)
+    {
+        const std::uint64_t fileTotal = filesPerFolder + (folderIndex < foldersWithExtra ? 1 : 0);
+        folderIndex++;
+
+        for (std::uint64_t i = 0; i < fileTotal; ++i) {
+            unsigned length = stemLength(random, spec);
+            const bool needle = random.unit() < spec.matchFraction;
+            if (needle) {
+                length = std::max(length, 6u);
+            }
+            std::string stem = randomStem(random, length);
+            if (needle) {
+                const bool upper = random.below(2) == 0;
+                stem.replace(random.below(length - 6 + 1), 6, upper ? "NEEDLE" : "needle");
+                (upper ? stats.needleUpper : stats.needleLower)++;
+            }
+            const std::string name = stem + "-" + std::to_string(i) + kExtensions[random.below(kExtensionCount)];
+            const std::string path = dir.empty() ? name : dir + "/" + name;
+            fnv(stats.fingerprint, path);
+            stats.files++;
+            stats.nameBytes += name.size();
+            if (visitor.onFile && !visitor.onFile(path)) {
+                return false;
+            }
+        }
+
+        if (depth == spec.depth) {
+            return true;
+        }
+        for (unsigned k = 0; k < spec.fanout; ++k) {
+            const std::string name = "d" + std::to_string(k) + "_" + randomStem(random, 3 + static_cast<unsigned>(random.below(10)));
+            const std::string path = dir.empty() ? name : dir + "/" + name;
+            fnv(stats.fingerprint, path);
+            stats.dirs++;
+            if (visitor.onDir && !visitor.onDir(path)) {
+                return false;
+            }
+            if (!visit(path, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const SyntheticTreeSpec& spec;
+    const TreeVisitor& visitor;
+    SyntheticTreeStats& stats;
+    Random random;
+    std::uint64_t folders = 1;
+    std::uint64_t filesPerFolder = 0;
+    std::uint64_t foldersWithExtra = 0;
+    std::uint64_t folderIndex = 0;
+};
+
+std::string manifestText(const SyntheticTreeSpec& spec, const SyntheticTreeStats& stats)
+{
+    char fingerprint[32];
+    std::snprintf(fingerprint, sizeof(fingerprint), "%016llx", static_cast<unsigned long long>(stats.fingerprint));
+    return spec.describe() + "\nfingerprint " + fingerprint + "\n";
+}
+
+fs::path manifestPath(const fs::path& root)
+{
+    fs::path manifest = root;
+    manifest += ".manifest";
+    return manifest;
+}
+
+} // namespace
+
+std::string SyntheticTreeSpec::describe() const
+{
+    std::ostringstream out;
+    out << "seed=" << seed << " depth=" << depth << " fanout=" << fanout << " files=" << fileCount
+        << " names=" << (nameLengths == NameLengthDistribution::Uniform ? "uniform" : "lognormal")
+        << " min=" << nameLengthMin << " max=" << nameLengthMax;
+    if (nameLengths == NameLengthDistribution::LogNormal) {
+        out << " median=" << nameLengthMedian << " sigma=" << nameLengthSigma;
+    }
+    out << " match=" << matchFraction << " size=" << fileSize;
+    return out.str();
+}
+
+SyntheticTreeStats planSyntheticTree(const SyntheticTreeSpec& spec)
+{
+    SyntheticTreeStats stats;
+    TreeVisitor nobody;
+    Planner(spec, nobody, stats).run();
+    return stats;
+}
+
+bool generateSyntheticTree(const fs::path& root, const SyntheticTreeSpec& spec,
+                           SyntheticTreeStats& stats, std::string& errorMessage)
+{
+    const auto started = std::chrono::steady_clock::now();
+    stats = planSyntheticTree(spec);
+    const std::string manifest = manifestText(spec, stats);
+
+    // ♻️ Same tree already on disk? (Big trees take a while to make - don't do it twice.)
+    std::error_code ec;
+    if (fs::exists(root, ec)) {
+        std::ifstream existing(manifestPath(root), std::ios::binary);
+        const std::string found((std::istreambuf_iterator<char>(existing)), std::istreambuf_iterator<char>());
+        if (found == manifest) {
+            stats.reused = true;
+            return true;
+        }
+        // Never delete something we can't prove is ours
+        errorMessage = root.string() + " already exists and isn't this tree - remove it or pick another folder";
+        return false;
+    }
+
+    if (!fs::create_directories(root, ec) && ec) {
+        errorMessage = "can't create " + root.string() + ": " + ec.message();
+        return false;
+    }
+
+    const std::string filler(static_cast<std::size_t>(std::min<std::uint64_t>(spec.fileSize, 1 << 20)), 'x');
+    TreeVisitor writer;
+    writer.onDir = [&](const std::string& relativeDir) {
+        std::error_code dirError;
+        fs::create_directory(root / relativeDir, dirError);
+        if (dirError) {
+            errorMessage = "can't create " + (root / relativeDir).string() + ": " + dirError.message();
+            return false;
+        }
+        return true;
+    };
+    writer.onFile = [&](const std::string& relativePath) {
+        std::ofstream file(root / relativePath, std::ios::binary | std::ios::trunc);
+        for (std::uint64_t left = spec.fileSize; file && left > 0;) {
+            const std::size_t chunk = static_cast<std::size_t>(std::min<std::uint64_t>(left, filler.size()));
+            file.write(filler.data(), static_cast<std::streamsize>(chunk));
+            left -= chunk;
+        }
+        if (!file) {
+            errorMessage = "can't write " + (root / relativePath).string();
+            return false;
+        }
+        return true;
+    };
+
+    SyntheticTreeStats written;
+    if (!Planner(spec, writer, written).run()) {
+        return false; // Half a tree, and no manifest - it will never be mistaken for a finished one
+    }
+
+    std::ofstream manifestFile(manifestPath(root), std::ios::binary | std::ios::trunc);
+    manifestFile << manifest;
+    if (!manifestFile) {
+        errorMessage = "can't write " + manifestPath(root).string();
+        return false;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef SYNTHTREE_H
+#define SYNTHTREE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// 🌳 Synthetic Directory Trees 🌳
+// Benchmarks are only worth comparing when they walk the same tree, and "my home folder"
+// is different on every box (and changes every day). This builds a made-up tree from a
+// handful of knobs and a seed instead: same spec, same seed -> the same folders and the
+// same file names, byte for byte, on any machine. (We use our own random generator and
+// our own distributions - std:: ones are allowed to differ between standard libraries.)
+//
+// Layout: `depth` levels of folders below the root, `fanout` subfolders in each, and
+// `fileCount` empty files spread evenly over every folder (root included). File names are
+// a random stem (length drawn from the name-length distribution), a counter that keeps
+// them unique, and an extension picked from a realistic mix. About `matchFraction` of the
+// files carry the marker "needle" in their stem - half as "needle", half as "NEEDLE" - so
+// a benchmark knows exactly how many matches to expect in either case mode.
+
+enum class NameLengthDistribution {
+    Uniform,  // Every length between nameLengthMin and nameLengthMax is equally likely
+    LogNormal // Mostly around nameLengthMedian with a long tail - closer to real disks
+};
+
+struct SyntheticTreeSpec {
+    std::uint64_t seed = 1;
+    unsigned depth = 4;                 // Levels of folders below the root
+    unsigned fanout = 8;                // Subfolders per folder
+    std::uint64_t fileCount = 200000;   // Files over the whole tree
+    NameLengthDistribution nameLengths = NameLengthDistribution::LogNormal;
+    unsigned nameLengthMin = 3;         // Stem length limits (the counter and extension come on top)
+    unsigned nameLengthMax = 64;
+    double nameLengthMedian = 12;       // LogNormal only
+    double nameLengthSigma = 0.5;       // LogNormal only: spread, in log space
+    double matchFraction = 0.01;        // Share of files with "needle"/"NEEDLE" in the name
+    std::uint64_t fileSize = 0;         // Bytes of filler in each file (0 = empty files)
+
+    // One line describing every knob (stable, so it can go in benchmark output)
+    std::string describe() const;
+};
+
+struct SyntheticTreeStats {
+    std::uint64_t dirs = 0;             // Folders below the root
+    std::uint64_t files = 0;
+    std::uint64_t nameBytes = 0;        // Sum of all file name lengths
+    std::uint64_t needleLower = 0;      // Files with "needle" in the name (case-sensitive hits)
+    std::uint64_t needleUpper = 0;      // Files with "NEEDLE" in the name
+    std::uint64_t fingerprint = 0;      // FNV-1a over every relative path in creation order
+    bool reused = false;                // An identical tree was already there, nothing was written
+    double seconds = 0;                 // Time spent creating it
+};
+
+// Creates the tree described by spec under root (which must not exist yet, or must hold a
+// tree made from the very same spec - then it is reused as is). A small manifest next to the
+// root (root + ".manifest") records the spec and the fingerprint for that check.
+// Returns false and fills errorMessage when the disk says no.
+bool generateSyntheticTree(const fs::path& root, const SyntheticTreeSpec& spec,
+                           SyntheticTreeStats& stats, std::string& errorMessage);
+
+// Just the numbers generateSyntheticTree would produce, without touching the disk
+SyntheticTreeStats planSyntheticTree(const SyntheticTreeSpec& spec);
+
+#endif // SYNTHTREE_H
@@ -0,0 +1,834 @@
+#include "traversalengine.h"
+
+#include "alloccounter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// How long an idle worker naps before it goes looking for work again.
+// Short enough that a thief reacts quickly, long enough not to burn a core.
+constexpr auto kIdleNap = std::chrono::milliseconds(2);
+// How often the calling thread reports the live scanned count
+constexpr auto kProgressInterval = std::chrono::milliseconds(250);
+// io_uring: subfolders opened together, and how many opened-ahead descriptors a worker may hold in all
+constexpr std::size_t kChildOpenBatch = 16;
+constexpr unsigned int kHeldFdBudget = 256;
+
+// Debug bookkeeping: allocations made while handing a match over to the callback
+// are the price of reporting, not of walking, so they get subtracted from the walk's total
+thread_local std::uint64_t reportingAllocations = 0;
+
+class ReportingScope
+{
+public:
+    ReportingScope() : start(AllocationCounter::threadAllocations()) {}
+    ~ReportingScope() { reportingAllocations += AllocationCounter::threadAllocations() - start; }
+private:
+    std::uint64_t start;
+};
+
+// Glue one more path component onto a path string, without doubling up slashes (think "/")
+inline void appendComponent(std::string& path, std::string_view name)
+{
+    if (!path.empty() && path.back() != '/') {
+        path.push_back('/');
+    }
+    path.append(name.data(), name.size());
+}
+
+// 🗃️ The name passed, so now the metadata predicates get their stat (timed like the enumerator's)
+template <typename Check>
+inline bool statForMetadata(ThreadTelemetry& tally, Check&& check)
+{
+    const std::uint64_t statStart = telemetryNow();
+    const bool passes = check();
+    tally.add(TelemetryCounter::MetadataStats);
+    tally.addNanos(TelemetryTimer::Stat, telemetryNow() - statStart);
+    if (!passes) {
+        tally.add(TelemetryCounter::MetadataRejected);
+    }
+    return passes;
+}
+} // namespace
+
+TraversalEngine::TraversalEngine(const SearchConfig& config,
+                                 const CompiledQuery& query,
+                                 const SearchCallback& reportResult,
+                                 std::atomic<bool>& cancellationFlag,
+                                 std::atomic<std::uint64_t>& filesScannedCount,
+                                 std::atomic<bool>& pauseFlag,
+                                 std::mutex& pauseMutexRef,
+                                 std::condition_variable& pauseConditionRef)
+    : config(config),
+    query(query),
+    reportResult(reportResult),
+    cancellationFlag(cancellationFlag),
+    filesScannedCount(filesScannedCount),
+    pauseFlag(pauseFlag),
+    pauseMutexRef(pauseMutexRef),
+    pauseConditionRef(pauseConditionRef)
+{
+    workerCount = resolveThreadCount(config);
+
+    ownCounters.reset(new ThreadTelemetry[workerCount]);
+    counters.resize(workerCount);
+    traceLanes.resize(workerCount, nullptr);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+        enumerators.push_back(makeDirectoryEnumerator(config.enumerationBackend));
+    }
+
+    // dirfd-relative walking needs a backend that can read descriptors; otherwise full paths it is
+#ifndef _WIN32
+    useDirFd = config.traversalMode != TraversalMode::FullPaths && enumerators.front()->supportsDirFd();
+#endif
+    // 💿 Auto means "ask the disk" - groupRootsByDevice() already did, and wrote down Inode or Directory.
+    // An engine handed Auto straight away has no disk to ask, so it keeps the directory's order.
+    inodeOrder = config.entryOrder == EntryOrder::Inode;
+#ifdef IYS_HAVE_IO_URING
+    // 💍 Every worker gets its own ring - or, if the kernel turns down even one, nobody does
+    if (config.ioBackend == IoBackend::IoUring) {
+        for (unsigned int i = 0; i < workerCount; ++i) {
+            rings.push_back(std::make_unique<UringBatch>(config.ioQueueDepth));
+            if (!rings.back()->isReady()) {
+                rings.clear();
+                break;
+            }
+        }
+        for (unsigned int i = 0; i < rings.size(); ++i) {
+            enumerators[i]->setBatchIo(rings[i].get());
+        }
+    }
+#endif
+
+    if (useDirFd) {
+        scratch.resize(workerCount);
+        for (auto& space : scratch) {
+            space.pathBuffer.reserve(4096); // PATH_MAX-ish, so deep trees rarely need to grow it
+            space.childNames.reserve(16 * 1024);
+        }
+    }
+}
+
+TraversalEngine::~TraversalEngine() = default;
+
+// 🚀 Kick off the crew and wait for them to finish this root
+unsigned long long TraversalEngine::run(const fs::path& root, const ProgressCallback& onProgress)
+{
+    foundCount.store(0);
+    traversalAllocations.store(0);
+    const std::uint64_t scannedBefore = scannedHere.load();
+
+    try {
+        // If the path doesn't exist or isn't a directory, nothing to do here! 🤷‍♂️
+        if (!fs::exists(root) || !fs::is_directory(root)) {
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        if (config.verboseErrors) {
+            report("", "Warning: Had trouble with folder " + root.string() + " - " + e.what());
+        }
+        return 0;
+    }
+
+    // 📈 Every worker (and its enumerator) counts into its own block
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        const unsigned int slot = slotBase + i;
+        counters[i] = (telemetry && slot < telemetry->workerSlots()) ? &telemetry->worker(slot) : &ownCounters[i];
+        enumerators[i]->setTelemetry(counters[i]);
+        traceLanes[i] = (trace && slot < trace->workerSlots()) ? &trace->worker(slot) : nullptr;
+    }
+    const std::uint64_t walkStart = trace ? telemetryNow() : 0;
+
+    // Seed the first worker with the root, everyone else starts out stealing
+    pushWork(0, root);
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&TraversalEngine::workerLoop, this, i);
+    }
+
+    // 👀 The calling thread just keeps an eye on things until the tree is exhausted
+    {
+        std::unique_lock<std::mutex> lock(idleMutex);
+        while (pendingDirs.load() != 0 && !cancellationFlag.load()) {
+            idleCondition.wait_for(lock, kProgressInterval);
+            if (onProgress) {
+                lock.unlock(); // Don't hold up the workers while the UI gets its update
+                onProgress(filesScannedCount.load());
+                lock.lock();
+            }
+        }
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (trace && !sharedSearch) {
+        trace->searchLane().record(TraceSpanKind::Root, walkStart, telemetryNow(),
+                                   scannedHere.load() - scannedBefore, root.native());
+    }
+
+    // Leftovers only exist if we got cancelled - toss them so the next root starts clean
+    for (auto& queue : queues) {
+        queue->pending.clear();
+    }
+    pendingDirs.store(0);
+
+    // 🧮 Debug builds: prove the walk itself doesn't allocate per entry
+    if (AllocationCounter::enabled()) {
+        std::fprintf(stderr, "Traversal of %s made %llu heap allocations (match reporting excluded) for %llu entries %s\n",
+                     root.string().c_str(), static_cast<unsigned long long>(traversalAllocations.load()),
+                     static_cast<unsigned long long>(scannedHere.load() - scannedBefore),
+                     useDirFd ? "[dirfd-relative]" : "[full paths]");
+    }
+
+    return foundCount.load();
+}
+
+void TraversalEngine::workerLoop(unsigned int self)
+{
+    const std::uint64_t allocationsAtStart = AllocationCounter::threadAllocations();
+    const std::uint64_t reportingAtStart = reportingAllocations;
+
+    ThreadTelemetry& tally = *counters[self];
+    fs::path dir;
+    while (!cancellationFlag.load()) {
+        if (takeWork(self, dir)) {
+            {
+                TelemetryStopwatch busy(tally, TelemetryTimer::Busy);
+                if (useDirFd) {
+                    processDirectoryRelative(self, dir);
+                } else {
+                    processDirectory(self, dir);
+                }
+            }
+            // Last directory in the whole tree? Wake everybody up so they can go home
+            if (pendingDirs.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                idleCondition.notify_all();
+            }
+            continue;
+        }
+
+        if (pendingDirs.load() == 0) {
+            break; // Nothing queued, nothing in flight - we're done!
+        }
+
+        // Somebody is still busy and might hand out more work soon - take a tiny nap
+        TelemetryStopwatch idle(tally, TelemetryTimer::Idle);
+        std::unique_lock<std::mutex> lock(idleMutex);
+        idleWorkers++;
+        idleCondition.wait_for(lock, kIdleNap);
+        idleWorkers--;
+    }
+
+    traversalAllocations += (AllocationCounter::threadAllocations() - allocationsAtStart)
+                            - (reportingAllocations - reportingAtStart);
+}
+
+bool TraversalEngine::takeWork(unsigned int self, fs::path& out)
+{
+    // Our own deque first - newest directory, so we stay depth-first
+    {
+        WorkerQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.pending.empty()) {
+            out = std::move(own.pending.back());
+            own.pending.pop_back();
+            return true;
+        }
+    }
+
+    // 🥷 Nothing left at home - go steal the OLDEST directory from a neighbour.
+    // Old entries sit near the top of the tree, so one steal usually buys a lot of work.
+    for (unsigned int i = 1; i < workerCount; ++i) {
+        WorkerQueue& victim = *queues[(self + i) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.pending.empty()) {
+            out = std::move(victim.pending.front());
+            victim.pending.pop_front();
+            counters[self]->add(TelemetryCounter::Steals);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TraversalEngine::pushWork(unsigned int self, fs::path dir)
+{
+    pendingDirs++; // Count it BEFORE it becomes visible, so nobody thinks we're finished
+    {
+        WorkerQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.pending.push_back(std::move(dir));
+    }
+    if (idleWorkers.load() > 0) {
+        idleCondition.notify_one(); // Psst, there's work over here!
+    }
+}
+
+// ⏸️ Same pause dance as before - every worker waits on the shared condition
+bool TraversalEngine::waitIfPaused()
+{
+    if (pauseFlag.load()) {
+        std::unique_lock<std::mutex> locker(pauseMutexRef);
+        while (pauseFlag.load() && !cancellationFlag.load()) {
+            pauseConditionRef.wait(locker);
+        }
+    }
+    return !cancellationFlag.load();
+}
+
+void TraversalEngine::report(const std::string& foundPath, const std::string& errorMessage)
+{
+    std::lock_guard<std::mutex> lock(reportMutex);
+    reportResult(foundPath, errorMessage);
+}
+
+// The shared counter gets one add per folder - with a dozen workers, one per entry was a hot cache line
+void TraversalEngine::countScanned(unsigned int self, std::uint64_t entries)
+{
+    filesScannedCount += entries;
+    scannedHere.fetch_add(entries, std::memory_order_relaxed);
+    if (deviceTally) {
+        deviceTally->entries.fetch_add(entries, std::memory_order_relaxed);
+    }
+    counters[self]->add(TelemetryCounter::EntriesRead, entries);
+}
+
+// 💿 ext4 and XFS list a folder in hash order, which jumps all over the inode table. Sorted by inode
+// number, the stats and opens read that table front to back instead - on a spinning disk it's the
+// difference between a seek per entry and one long read. spare is reused, so this allocates once.
+void TraversalEngine::sortNamesByInode(std::string& names, std::size_t from, std::vector<InodeName>& order, std::string& spare)
+{
+    if (order.size() > 1) {
+        std::sort(order.begin(), order.end(), [](const InodeName& a, const InodeName& b) {
+            return a.inode != b.inode ? a.inode < b.inode : a.offset < b.offset;
+        });
+        spare.clear();
+        for (const InodeName& name : order) {
+            spare.append(names.data() + name.offset, std::strlen(names.data() + name.offset) + 1); // With its NUL
+        }
+        names.replace(from, std::string::npos, spare);
+    }
+    order.clear();
+}
+
+// 📋 Sits between the enumerator and the engine for one directory:
+// files get matched right off the borrowed name bytes, subfolders go on our deque
+template <typename Match>
+class TraversalEngine::EntryHandler : public DirEntryVisitor
+{
+public:
+    EntryHandler(TraversalEngine& engine, unsigned int self, const fs::path& currentPath, const Match& match)
+        : engine(engine), self(self), currentPath(currentPath), match(match), tally(*engine.counters[self]),
+        metadata(engine.query.metadata()), checkMetadata(metadata.isActive())
+    {
+        if (engine.fileObserver) {
+            dirPath = currentPath.string(); // Once per folder, only if somebody's listening
+        }
+        if (!engine.config.mountBoundaries.empty()) {
+            boundaryNames = engine.config.mountBoundaries.inside(currentPath.string());
+        }
+    }
+
+    bool visit(const DirEntryView& entry) override
+    {
+        if (engine.cancellationFlag.load() || !engine.waitIfPaused()) {
+            return false; // Mission aborted!
+        }
+
+        entries++; // One more file checked! (Handed to the shared counter once the folder is done)
+
+        // 📁 Subfolder? Queue it up - whoever is free (maybe us) will dive in
+        if (entry.type == EntryType::Directory) {
+            if (boundaryNames && MountBoundaries::contains(*boundaryNames, entry.nameView())) {
+                tally.add(TelemetryCounter::MountsSkipped); // Another root's filesystem (or one left out on purpose)
+            } else if (engine.inodeOrder) {
+                subfolders.emplace_back(entry.inode, currentPath / entry.nameView()); // Queued in finish()
+            } else {
+                engine.pushWork(self, currentPath / entry.nameView());
+            }
+        }
+        // 📄 A file? Let's see if it's what we're after
+        else if (entry.type == EntryType::RegularFile) {
+            if (engine.fileObserver) {
+                engine.fileObserver->onFile(engine.slotBase + self, dirPath, entry.nameView());
+            }
+            if (!match(entry.nameView())) {
+                statsSaved += checkMetadata; // Name checks first: a file that fails here never costs a stat
+            } else if (!checkMetadata) {
+                // 🎉 Success! Only now do we bother building the full path
+                engine.foundCount++;
+                tally.add(TelemetryCounter::Matches);
+                ReportingScope reporting;
+                TelemetryStopwatch reportTime(tally, TelemetryTimer::Reporting);
+                engine.report((currentPath / entry.nameView()).string(), "");
+            } else if (engine.inodeOrder) {
+                statPaths.emplace_back(entry.inode, (currentPath / entry.nameView()).string()); // Stat-ed in finish()
+            } else {
+                // The name is right - size, time and owner decide now, off the very path we'd report
+                ReportingScope reporting;
+                checkAndReport((currentPath / entry.nameView()).string());
+            }
+        }
+        // Ignore other file-system objects (devices, links to folders, etc.) - we're just after regular files
+        return true;
+    }
+
+    void entryError(std::string_view name, const std::string& what) override
+    {
+        tally.add(TelemetryCounter::Errors);
+        if (engine.config.verboseErrors) {
+            engine.report("", "Warning: Can't check " + (currentPath / name).string() + " - " + what);
+        }
+    }
+
+    std::uint64_t entries = 0;    // Entries seen in this folder
+    std::uint64_t statsSaved = 0; // ...files among them the name ruled out before any stat
+
+    // 💿 Inode order: the folder has been read in full, so now the stats and subfolders go in inode order.
+    // The deque hands out its newest folder first, so they get pushed highest inode first.
+    void finish()
+    {
+        std::sort(statPaths.begin(), statPaths.end());
+        for (const auto& candidate : statPaths) {
+            if (engine.cancellationFlag.load()) {
+                return;
+            }
+            ReportingScope reporting;
+            checkAndReport(candidate.second);
+        }
+        std::sort(subfolders.begin(), subfolders.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (auto& subfolder : subfolders) {
+            engine.pushWork(self, std::move(subfolder.second));
+        }
+    }
+
+private:
+    // The name is right - size, time and owner decide now, off the very path we'd report
+    void checkAndReport(const std::string& foundPath)
+    {
+        if (statForMetadata(tally, [&] { return metadata.matchesPath(foundPath); })) {
+            engine.foundCount++;
+            tally.add(TelemetryCounter::Matches);
+            TelemetryStopwatch reportTime(tally, TelemetryTimer::Reporting);
+            engine.report(foundPath, "");
+        }
+    }
+
+    TraversalEngine& engine;
+    unsigned int self;
+    const fs::path& currentPath;
+    const Match& match;
+    ThreadTelemetry& tally;
+    const MetadataFilter& metadata;
+    const bool checkMetadata; // Any metadata predicates at all? Otherwise nothing here ever stats
+    std::string dirPath; // currentPath as a plain string, for the file observer
+    const std::vector<std::string>* boundaryNames = nullptr; // Mount points in this folder the walk stays out of
+    std::vector<std::pair<std::uint64_t, fs::path>> subfolders; // Inode order: waiting for the folder to be read in full
+    std::vector<std::pair<std::uint64_t, std::string>> statPaths; // ...and so are the stats
+};
+
+// 🔍 Look through one directory with this worker's enumerator
+void TraversalEngine::processDirectory(unsigned int self, const fs::path& currentPath)
+{
+    if (!waitIfPaused()) {
+        return;
+    }
+
+    TraceLane* lane = traceLanes[self];
+    const std::uint64_t visitStart = lane ? telemetryNow() : 0;
+    std::string errorMessage;
+    try {
+        // One pick of the specialized check per folder, not per entry
+        std::uint64_t entries = 0;
+        const bool readable = query.dispatch([&](const auto& match) {
+            EntryHandler<std::decay_t<decltype(match)>> handler(*this, self, currentPath, match);
+            const bool ok = enumerators[self]->enumerate(currentPath, handler, errorMessage);
+            handler.finish();
+            entries = handler.entries;
+            countScanned(self, entries);
+            if (handler.statsSaved != 0) {
+                counters[self]->add(TelemetryCounter::MetadataStatsSaved, handler.statsSaved);
+            }
+            return ok;
+        });
+        if (lane) {
+            lane->record(TraceSpanKind::Directory, visitStart, telemetryNow(), entries, currentPath.native());
+        }
+        if (!readable) {
+            counters[self]->add(TelemetryCounter::Errors);
+            if (config.verboseErrors) {
+                report("", "Warning: Oops! Can't look into " + currentPath.string() + " - " + errorMessage);
+            }
+        }
+    } catch (const std::exception& e) {
+        // Some other kind of trouble (out of memory, weird path encoding...)
+        counters[self]->add(TelemetryCounter::Errors);
+        if (config.verboseErrors) {
+            report("", "Warning: Unexpected issue with folder " + currentPath.string() + " - " + e.what());
+        }
+    }
+}
+
+#ifndef _WIN32
+
+// 📋 The dirfd-relative flavour of EntryHandler.
+// Nothing here touches the heap per entry: subfolder names are stacked in the worker's
+// reusable childNames arena and a real std::string only appears when we report a match.
+template <typename Match>
+class TraversalEngine::RelativeEntryHandler : public DirEntryVisitor
+{
+public:
+    RelativeEntryHandler(TraversalEngine& engine, unsigned int self, WorkerScratch& space, const Match& match, int dirFd)
+        : engine(engine), self(self), space(space), match(match), tally(*engine.counters[self]),
+        metadata(engine.query.metadata()), checkMetadata(metadata.isActive()), dirFd(dirFd),
+        ring(checkMetadata && !engine.rings.empty() ? engine.rings[self].get() : nullptr) {}
+
+    bool visit(const DirEntryView& entry) override
+    {
+        if (engine.cancellationFlag.load() || !engine.waitIfPaused()) {
+            return false; // Mission aborted!
+        }
+
+        entries++; // One more file checked!
+
+        if (entry.type == EntryType::Directory) {
+            // Can't dive in yet - the enumerator is still using its buffer for this folder
+            if (engine.inodeOrder) {
+                space.childOrder.push_back(InodeName{entry.inode, space.childNames.size()});
+            }
+            space.childNames.append(entry.name, entry.nameLength);
+            space.childNames.push_back('\0');
+        } else if (entry.type == EntryType::RegularFile) {
+            if (engine.fileObserver) {
+                engine.fileObserver->onFile(engine.slotBase + self, space.pathBuffer, entry.nameView());
+            }
+            if (!match(entry.nameView())) {
+                statsSaved += checkMetadata; // Name checks first: a file that fails here never costs a stat
+            } else if (deferStats) {
+                // 💍💿 The stat waits for the rest of the folder - flushMetadata() sends them all together, or in inode order
+                if (engine.inodeOrder) {
+                    space.statOrder.push_back(InodeName{entry.inode, space.statNames.size()});
+                }
+                space.statNames.append(entry.name, entry.nameLength);
+                space.statNames.push_back('\0');
+            } else if (!checkMetadata // getdents names are NUL-terminated, so statx can take entry.name as is
+                       || statForMetadata(tally, [&] { return metadata.matchesAt(dirFd, entry.name); })) {
+                reportMatch(entry.nameView());
+            }
+        }
+        return true;
+    }
+
+    void entryError(std::string_view name, const std::string& what) override
+    {
+        tally.add(TelemetryCounter::Errors);
+        if (engine.config.verboseErrors) {
+            std::string entryPath = space.pathBuffer;
+            appendComponent(entryPath, name);
+            engine.report("", "Warning: Can't check " + entryPath + " - " + what);
+        }
+    }
+
+    std::uint64_t entries = 0;    // Entries seen in this folder
+    std::uint64_t statsSaved = 0; // ...files among them the name ruled out before any stat
+
+    // The stat for every name visit() put aside: io_uring sends them as one batch, then the passes get reported.
+    // In inode order they get sorted first (and without a ring, stat-ed one at a time in that order).
+    void flushMetadata()
+    {
+        if (space.statNames.empty()) {
+            return;
+        }
+        if (engine.inodeOrder) {
+            sortNamesByInode(space.statNames, 0, space.statOrder, space.sortedNames);
+        }
+        const char* names = space.statNames.data();
+        if (!ring) {
+            for (std::size_t pos = 0; pos < space.statNames.size() && !engine.cancellationFlag.load();) {
+                const char* name = names + pos;
+                const std::size_t nameLength = std::strlen(name);
+                pos += nameLength + 1;
+                if (statForMetadata(tally, [&] { return metadata.matchesAt(dirFd, name); })) {
+                    reportMatch(std::string_view(name, nameLength));
+                }
+            }
+            space.statNames.clear();
+            return;
+        }
+#ifdef IYS_HAVE_IO_URING
+        const unsigned int mask = MetadataFilter::statxMask(metadata.wantedFields());
+        for (std::size_t pos = 0; pos < space.statNames.size(); pos += std::strlen(names + pos) + 1) {
+            ring->addStatx(dirFd, names + pos, AT_STATX_DONT_SYNC, mask); // Followed, like matchesAt()
+        }
+        tally.add(TelemetryCounter::MetadataStats, ring->pending());
+        const std::uint64_t statStart = telemetryNow();
+        ring->run(&tally);
+        tally.addNanos(TelemetryTimer::Stat, telemetryNow() - statStart);
+
+        std::size_t request = 0;
+        for (std::size_t pos = 0; pos < space.statNames.size() && !engine.cancellationFlag.load(); ++request) {
+            const std::string_view name(names + pos);
+            pos += name.size() + 1;
+            FileMetadata found;
+            if (ring->result(request) == 0) {
+                MetadataFilter::fromStatx(ring->statxResult(request), found);
+            }
+            if (!metadata.accepts(found)) { // Nothing filled in (the stat failed) fails every predicate
+                tally.add(TelemetryCounter::MetadataRejected);
+                continue;
+            }
+            reportMatch(name);
+        }
+        space.statNames.clear();
+#endif
+    }
+
+private:
+    void reportMatch(std::string_view name)
+    {
+        engine.foundCount++;
+        tally.add(TelemetryCounter::Matches);
+        ReportingScope reporting;
+        TelemetryStopwatch reportTime(tally, TelemetryTimer::Reporting);
+        std::string foundPath = space.pathBuffer;
+        appendComponent(foundPath, name);
+        engine.report(foundPath, "");
+    }
+
+    TraversalEngine& engine;
+    unsigned int self;
+    WorkerScratch& space;
+    const Match& match;
+    ThreadTelemetry& tally;
+    const MetadataFilter& metadata;
+    const bool checkMetadata; // Any metadata predicates at all? Otherwise nothing here ever stats
+    int dirFd;                // The folder being read - statx goes relative to it
+    UringBatch* ring;         // This worker's ring when metadata stats get batched (nullptr = one at a time)
+    const bool deferStats = ring || (checkMetadata && engine.inodeOrder); // Stats wait for flushMetadata()
+};
+
+// 🔗 A work item from the deque: open it by its full path once, then go relative
+void TraversalEngine::processDirectoryRelative(unsigned int self, const fs::path& currentPath)
+{
+    if (!waitIfPaused()) {
+        return;
+    }
+
+    WorkerScratch& space = scratch[self];
+    ThreadTelemetry& tally = *counters[self];
+    try {
+        space.pathBuffer.assign(currentPath.native());
+        const std::uint64_t openStart = telemetryNow();
+        int fd = ::open(space.pathBuffer.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        const int openErrno = errno;
+        tally.add(TelemetryCounter::DirsOpened);
+        tally.addNanos(TelemetryTimer::DirectoryRead, telemetryNow() - openStart);
+        if (fd < 0) {
+            tally.add(TelemetryCounter::Errors);
+            if (openErrno != EACCES && openErrno != EPERM && config.verboseErrors) {
+                report("", "Warning: Oops! Can't look into " + space.pathBuffer + " - " + std::strerror(openErrno));
+            }
+            return;
+        }
+        // Closed on the way out, thrown out or not
+        struct FolderFd {
+            int fd;
+            ~FolderFd() { ::close(fd); }
+        } folder{fd};
+        // The whole subtree below this work item shares one specialized check
+        query.dispatch([&](const auto& match) { walkOpenDirectory(self, folder.fd, match, openStart); });
+    } catch (const std::exception& e) {
+        tally.add(TelemetryCounter::Errors);
+        if (config.verboseErrors) {
+            report("", "Warning: Unexpected issue with folder " + currentPath.string() + " - " + e.what());
+        }
+    }
+}
+
+// Reads one open directory, then visits its subfolders depth-first through openat().
+// space.pathBuffer always holds the path of dirFd while we're in here.
+template <typename Match>
+void TraversalEngine::walkOpenDirectory(unsigned int self, int dirFd, const Match& match, std::uint64_t openedAt)
+{
+    WorkerScratch& space = scratch[self];
+    const std::size_t namesStart = space.childNames.size();
+    UringBatch* ring = rings.empty() ? nullptr : rings[self].get();
+
+    constexpr int kOpenFlags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW;
+    struct ChildOpen {
+        std::size_t nameOffset;
+        std::size_t nameLength;
+        int fd;           // Or -errno
+        bool handedOff;   // Somebody idle gets this one instead
+    };
+
+    // 🧹 However we leave this folder - done, or on the way up with an exception (a failed
+    // allocation, mostly) - the children opened ahead get closed, and the worker's scratch is
+    // put back the way we found it, so the next folder doesn't start on our leftovers.
+    // That includes the inode-order lists: sorted, they'd point the next folder at our offsets.
+    struct FolderGuard {
+        WorkerScratch& space;
+        UringBatch* ring;
+        std::size_t namesStart;
+        std::size_t pathMark;
+        const ChildOpen* batch = nullptr;
+        std::size_t unvisited = 0; // batch[unvisited..opened) still hold descriptors
+        std::size_t opened = 0;
+
+        ~FolderGuard()
+        {
+            for (std::size_t i = unvisited; i < opened; ++i) {
+                if (!batch[i].handedOff && batch[i].fd >= 0) {
+                    ::close(batch[i].fd);
+                    space.heldFds -= ring != nullptr;
+                }
+            }
+#ifdef IYS_HAVE_IO_URING
+            if (ring) {
+                ring->discard(); // Requests queued and never sent
+            }
+#endif
+            space.childNames.resize(namesStart);
+            space.statNames.clear();
+            space.childOrder.clear();
+            space.statOrder.clear();
+            space.pathBuffer.resize(pathMark);
+        }
+    } guard{space, ring, namesStart, space.pathBuffer.size()};
+
+    ThreadTelemetry& tally = *counters[self];
+    RelativeEntryHandler<Match> handler(*this, self, space, match, dirFd);
+    std::string errorMessage;
+    const bool readable = enumerators[self]->enumerateFd(dirFd, handler, errorMessage);
+    handler.flushMetadata();
+    if (inodeOrder) {
+        sortNamesByInode(space.childNames, namesStart, space.childOrder, space.sortedNames); // 💿 Children by inode too
+    }
+    countScanned(self, handler.entries);
+    if (handler.statsSaved != 0) {
+        tally.add(TelemetryCounter::MetadataStatsSaved, handler.statsSaved);
+    }
+    if (TraceLane* lane = traceLanes[self]) {
+        // Just this folder's own open + read - its subfolders get bars of their own below
+        lane->record(TraceSpanKind::Directory, openedAt, telemetryNow(), handler.entries, space.pathBuffer);
+    }
+    if (!readable) {
+        tally.add(TelemetryCounter::Errors);
+        if (config.verboseErrors) {
+            report("", "Warning: Oops! Can't look into " + space.pathBuffer + " - " + errorMessage);
+        }
+    }
+
+    // 📁 Now the subfolders. We work with offsets because childNames may grow (and move)
+    // while we're down in a child.
+    // Synchronously that's one openat at a time, right before each visit. With io_uring a few of
+    // them get opened together first (kChildOpenBatch, fewer once the worker holds kHeldFdBudget).
+    // 🚧 Mount points in here that belong to another root (or to nobody) - one lookup per folder
+    const std::vector<std::string>* boundaryNames =
+        config.mountBoundaries.empty() ? nullptr : config.mountBoundaries.inside(space.pathBuffer);
+    std::size_t pos = namesStart;
+    while (pos < space.childNames.size() && !cancellationFlag.load()) {
+        ChildOpen batch[kChildOpenBatch];
+        const std::size_t batchLimit = !ring ? 1
+            : std::min<std::size_t>(kChildOpenBatch, space.heldFds < kHeldFdBudget ? kHeldFdBudget - space.heldFds : 1);
+        std::size_t batchSize = 0;
+        std::size_t opens = 0;
+        guard.batch = batch;
+        guard.unvisited = guard.opened = 0;
+        const std::uint64_t openStart = telemetryNow();
+        while (batchSize < batchLimit && pos < space.childNames.size()) {
+            const char* name = space.childNames.data() + pos;
+            const std::size_t nameLength = std::strlen(name);
+            if (boundaryNames && MountBoundaries::contains(*boundaryNames, std::string_view(name, nameLength))) {
+                tally.add(TelemetryCounter::MountsSkipped); // Another root's filesystem (or one left out on purpose)
+                pos += nameLength + 1;
+                continue;
+            }
+            ChildOpen& child = batch[batchSize++];
+            child = ChildOpen{pos, nameLength, -ENOENT, idleWorkers.load() > 0};
+            pos += nameLength + 1;
+            if (child.handedOff) {
+                continue;
+            }
+            ++opens;
+#ifdef IYS_HAVE_IO_URING
+            if (ring) {
+                child.fd = static_cast<int>(ring->addOpenat(dirFd, name, kOpenFlags)); // The request index, for now
+                continue;
+            }
+#endif
+            const int childFd = ::openat(dirFd, name, kOpenFlags);
+            child.fd = childFd >= 0 ? childFd : -errno;
+            guard.opened = batchSize; // A real descriptor already (io_uring ones only are after run())
+        }
+#ifdef IYS_HAVE_IO_URING
+        if (ring && ring->pending() != 0) {
+            ring->run(&tally);
+            for (std::size_t i = 0; i < batchSize; ++i) {
+                if (!batch[i].handedOff) {
+                    batch[i].fd = ring->result(static_cast<std::size_t>(batch[i].fd));
+                    space.heldFds += batch[i].fd >= 0;
+                }
+            }
+            guard.opened = batchSize;
+        }
+#endif
+        if (opens != 0) {
+            tally.add(TelemetryCounter::DirsOpened, opens);
+            tally.addNanos(TelemetryTimer::DirectoryRead, telemetryNow() - openStart);
+        }
+
+        for (std::size_t i = 0; i < batchSize; ++i) {
+            const ChildOpen& child = batch[i];
+            const std::size_t pathMark = space.pathBuffer.size();
+            appendComponent(space.pathBuffer, std::string_view(space.childNames.data() + child.nameOffset, child.nameLength));
+
+            if (child.handedOff) {
+                // Somebody's twiddling their thumbs - hand them this subtree (one allocation per folder shared)
+                pushWork(self, fs::path(space.pathBuffer));
+            } else if (child.fd >= 0) {
+                if (!cancellationFlag.load()) {
+                    walkOpenDirectory(self, child.fd, match, openStart);
+                }
+                ::close(child.fd);
+                space.heldFds -= ring != nullptr;
+                guard.unvisited = i + 1;
+            } else if (child.fd == -EMFILE || child.fd == -ENFILE) {
+                // Out of descriptors (very deep tree) - queue it to be reopened from its full path later
+                pushWork(self, fs::path(space.pathBuffer));
+            } else {
+                tally.add(TelemetryCounter::Errors);
+                if (child.fd != -EACCES && child.fd != -EPERM && child.fd != -ENOENT && config.verboseErrors) {
+                    report("", "Warning: Oops! Can't look into " + space.pathBuffer + " - " + std::strerror(-child.fd));
+                }
+            }
+
+            space.pathBuffer.resize(pathMark);
+        }
+    }
+}
+
+#else
+
+// No descriptors to be relative to on Windows - useDirFd is never set there
+void TraversalEngine::processDirectoryRelative(unsigned int self, const fs::path& currentPath)
+{
+    processDirectory(self, currentPath);
+}
+
+#endif // _WIN32
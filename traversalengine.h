@@ -0,0 +1,155 @@
+#ifndef TRAVERSALENGINE_H
+#define TRAVERSALENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "searchlogic.h"  // SearchConfig, SearchCallback & friends
+#include "direnumerator.h" // How we actually read each directory
+#include "compiledquery.h" // Is this the file we want?
+#include "searchtelemetry.h" // Per-worker counters and timers
+#include "searchtrace.h"     // Per-folder spans, when somebody is tracing
+
+// 🧵 The Parallel Traversal Engine 🧵
+// A little crew of worker threads that share the directory tree between them.
+// Every worker owns a deque of directories it still has to visit:
+//   - it pushes/pops at the BACK of its own deque (depth-first, keeps memory small)
+//   - idle workers STEAL from the FRONT of someone else's deque (big chunks of tree)
+// The pause/cancel flags and the scanned counter are the very same ones
+// the old single-threaded walk used, so SearchWorker doesn't have to care.
+class TraversalEngine
+{
+public:
+    TraversalEngine(const SearchConfig& config,
+                    const CompiledQuery& query,
+                    const SearchCallback& reportResult,
+                    std::atomic<bool>& cancellationFlag,
+                    std::atomic<std::uint64_t>& filesScannedCount,
+                    std::atomic<bool>& pauseFlag,
+                    std::mutex& pauseMutexRef,
+                    std::condition_variable& pauseConditionRef);
+    ~TraversalEngine();
+
+    TraversalEngine(const TraversalEngine&) = delete;
+    TraversalEngine& operator=(const TraversalEngine&) = delete;
+
+    // Walks everything below root and blocks until the crew is done (or cancelled).
+    // onProgress gets poked from the calling thread every so often with the live scanned count.
+    // Returns how many matching files were found under this root.
+    unsigned long long run(const fs::path& root, const ProgressCallback& onProgress = ProgressCallback());
+
+    // How many workers we ended up with after resolving "0 = auto"
+    unsigned int threadCount() const { return workerCount; }
+
+    // Somebody who wants to see every regular file, not just the matches (nullptr = nobody)
+    void setFileObserver(FileObserver* observer) { fileObserver = observer; }
+
+    // Where worker i keeps its counters: slot i of this (nullptr = the engine keeps its own).
+    // Set it before run(); workers beyond the telemetry's slots fall back to the engine's own.
+    void setTelemetry(SearchTelemetry* searchTelemetry) { telemetry = searchTelemetry; }
+
+    // Record one span per visited folder into worker i's lane of this (nullptr = no tracing).
+    // Workers beyond the trace's lanes simply don't trace.
+    void setTrace(SearchTrace* searchTrace) { trace = searchTrace; }
+
+    // Did config.ioBackend = IoUring really get its rings? (false = synchronous, asked for or not)
+    bool usesIoUring() const { return !rings.empty(); }
+
+    // Worker i counts into slot first + i of the telemetry, the trace and the file observer (default: slot i).
+    // Engines walking side by side (one per disk, see devicescheduler.h) each get their own run of slots -
+    // besideOthers says so, and then the root's trace span is left to the caller (the search lane has one writer).
+    void setWorkerSlots(unsigned int first, bool besideOthers) { slotBase = first; sharedSearch = besideOthers; }
+
+    // The disk this engine walks: its entries are counted there too, for per-disk progress (nullptr = nobody asks)
+    void setDeviceTally(DeviceTally* tally) { deviceTally = tally; }
+
+    // Entries this engine has looked at, over all its runs (filesScannedCount may be shared with other engines)
+    std::uint64_t entriesScanned() const { return scannedHere.load(); }
+
+private:
+    // One of these per worker - the mutex is only ever contended by thieves
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<fs::path> pending;
+    };
+
+    // 💿 Inode order: where one name sits in a NUL-separated list, and the inode it belongs to
+    struct InodeName {
+        std::uint64_t inode;
+        std::size_t offset;
+    };
+
+    // Per-worker scratch space for dirfd-relative walking - it grows once, then gets reused forever
+    struct WorkerScratch {
+        std::string pathBuffer; // Path of the folder being read; appended to and truncated as we descend
+        std::string childNames; // Stack of NUL-terminated subfolder names still waiting for a visit
+        std::string statNames;  // io_uring: this folder's names that passed, waiting for their batched metadata statx
+        unsigned int heldFds = 0; // io_uring: children opened ahead of their visit (keeps deep trees off EMFILE)
+        std::vector<InodeName> childOrder; // Inode order: this folder's subfolders in childNames...
+        std::vector<InodeName> statOrder;  // ...and its stat candidates in statNames
+        std::string sortedNames;           // Where either list gets put back together in order
+    };
+
+    // Both are templated on the query's specialized matcher, so the per-entry check is inlined
+    template <typename Match> class EntryHandler;         // Looks at the entries of one directory on behalf of one worker
+    template <typename Match> class RelativeEntryHandler; // Same job, but for the dirfd-relative walk
+
+    void workerLoop(unsigned int self);
+    bool takeWork(unsigned int self, fs::path& out); // Own deque first, then go stealing
+    void pushWork(unsigned int self, fs::path dir);
+    void processDirectory(unsigned int self, const fs::path& currentPath);
+    void processDirectoryRelative(unsigned int self, const fs::path& currentPath);
+    template <typename Match>
+    void walkOpenDirectory(unsigned int self, int dirFd, const Match& match, // Reads dirFd, then dives into its children via openat()
+                           std::uint64_t openedAt); // When the open started (the folder's trace span starts there)
+    bool waitIfPaused(); // Returns false if we got cancelled while napping
+    void report(const std::string& foundPath, const std::string& errorMessage);
+    void countScanned(unsigned int self, std::uint64_t entries); // Once per folder, not per entry
+    // Rewrites the names from offset from on in inode order (order has one entry per name, and is emptied)
+    static void sortNamesByInode(std::string& names, std::size_t from, std::vector<InodeName>& order, std::string& spare);
+
+    const SearchConfig& config;
+    const CompiledQuery& query; // Search term + extension, compiled once per search for every worker to share
+    const SearchCallback& reportResult;
+    FileObserver* fileObserver = nullptr;
+    SearchTelemetry* telemetry = nullptr;
+    SearchTrace* trace = nullptr;
+    DeviceTally* deviceTally = nullptr;
+    unsigned int slotBase = 0;  // Our worker 0's slot in the telemetry, trace and file observer
+    bool sharedSearch = false;  // Other engines are walking at the same time
+    std::atomic<bool>& cancellationFlag;
+    std::atomic<std::uint64_t>& filesScannedCount;
+    std::atomic<bool>& pauseFlag;
+    std::mutex& pauseMutexRef;
+    std::condition_variable& pauseConditionRef;
+
+
+    unsigned int workerCount;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::unique_ptr<DirectoryEnumerator>> enumerators; // One per worker, buffers and all
+    std::vector<WorkerScratch> scratch;                              // Only used in dirfd-relative mode
+    std::unique_ptr<ThreadTelemetry[]> ownCounters;                  // For when nobody handed us telemetry
+    std::vector<ThreadTelemetry*> counters;                          // counters[i] belongs to worker i alone
+    std::vector<TraceLane*> traceLanes;                              // Same idea for tracing (nullptr = not tracing)
+    std::vector<std::unique_ptr<UringBatch>> rings;                  // One per worker for IoBackend::IoUring (empty = synchronous)
+    bool useDirFd = false;                                           // Resolved from config.traversalMode
+    bool inodeOrder = false;                                         // config.entryOrder == Inode (Auto gets settled per disk, earlier)
+
+    std::atomic<std::uint64_t> traversalAllocations{0}; // Debug builds: heap allocations made while walking
+    std::atomic<std::uint64_t> scannedHere{0};          // Our share of filesScannedCount
+
+    std::atomic<unsigned long long> foundCount{0};
+    std::atomic<std::size_t> pendingDirs{0};   // Queued or in-flight directories; 0 means we're done
+    std::atomic<unsigned int> idleWorkers{0};
+
+    std::mutex idleMutex;                      // Parking spot for workers with nothing to do
+    std::condition_variable idleCondition;
+    std::mutex reportMutex;                    // The callback is never called from two threads at once
+};
+
+#endif // TRAVERSALENGINE_H
@@ -0,0 +1,199 @@
+#include "trigramindex.h"
+#include "simdmatch.h" // foldAscii - the same folding the matcher uses
+
+#include <algorithm>
+
+namespace {
+
+inline unsigned char foldByte(unsigned char c)
+{
+    return static_cast<unsigned char>(SimdMatch::foldAscii(static_cast<char>(c)));
+}
+
+inline std::uint32_t packGram(unsigned char a, unsigned char b, unsigned char c)
+{
+    return (std::uint32_t(a) << 16) | (std::uint32_t(b) << 8) | std::uint32_t(c);
+}
+
+void appendVarint(std::string& out, std::uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Walks one delta-encoded posting list, one ID at a time
+class PostingCursor
+{
+public:
+    PostingCursor(const unsigned char* begin, const unsigned char* end) : p(begin), end(end) {}
+
+    // Moves to the next ID; false once the list (or a damaged varint) runs out
+    bool next()
+    {
+        std::uint32_t delta = 0;
+        int shift = 0;
+        while (p < end && shift <= 28) {
+            const unsigned char byte = *p++;
+            delta |= std::uint32_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                value = started ? value + delta : delta;
+                started = true;
+                return true;
+            }
+            shift += 7;
+        }
+        return false;
+    }
+
+    std::uint32_t current() const { return value; }
+
+private:
+    const unsigned char* p;
+    const unsigned char* end;
+    std::uint32_t value = 0;
+    bool started = false;
+};
+
+} // namespace
+
+// --- Building ---
+
+void TrigramIndexBuilder::addName(std::uint32_t id, std::string_view name)
+{
+    addGrams(exact, id, name, false);
+    addGrams(folded, id, name, true);
+}
+
+void TrigramIndexBuilder::addGrams(GramMap& grams, std::uint32_t id, std::string_view name, bool fold)
+{
+    if (name.size() < 3) {
+        return; // Too short to have a single gram - these are only ever found by a full scan
+    }
+    for (std::size_t i = 0; i + 3 <= name.size(); ++i) {
+        unsigned char a = static_cast<unsigned char>(name[i]);
+        unsigned char b = static_cast<unsigned char>(name[i + 1]);
+        unsigned char c = static_cast<unsigned char>(name[i + 2]);
+        if (fold) {
+            a = foldByte(a);
+            b = foldByte(b);
+            c = foldByte(c);
+        }
+
+        PostingList& list = grams[packGram(a, b, c)];
+        if (list.count != 0 && list.lastId == id) {
+            continue; // Same gram twice in one name ("aaaa") - the list only needs the ID once
+        }
+        appendVarint(list.bytes, list.count == 0 ? id : id - list.lastId);
+        list.lastId = id;
+        list.count++;
+    }
+}
+
+void TrigramIndexBuilder::finish(std::vector<GramRecord>& exactGrams, std::vector<GramRecord>& foldedGrams, std::string& postings)
+{
+    flatten(exact, exactGrams, postings);
+    flatten(folded, foldedGrams, postings);
+}
+
+void TrigramIndexBuilder::flatten(GramMap& grams, std::vector<GramRecord>& table, std::string& postings)
+{
+    std::vector<std::uint32_t> keys;
+    keys.reserve(grams.size());
+    for (const auto& entry : grams) {
+        keys.push_back(entry.first);
+    }
+    std::sort(keys.begin(), keys.end()); // Sorted table = binary search at query time
+
+    table.clear();
+    table.reserve(keys.size());
+    for (std::uint32_t gram : keys) {
+        PostingList& list = grams[gram];
+        table.push_back(GramRecord{gram, list.count, postings.size(),
+                                   static_cast<std::uint32_t>(list.bytes.size()), 0});
+        postings += list.bytes;
+        std::string().swap(list.bytes); // Hand the memory back as we go
+    }
+    GramMap().swap(grams);
+}
+
+// --- Querying ---
+
+TrigramIndexView::TrigramIndexView(const GramRecord* grams, std::size_t gramCount,
+                                   const unsigned char* postings, std::uint64_t postingsSize)
+    : grams(grams), gramCount(gramCount), postings(postings), postingsSize(postingsSize)
+{
+}
+
+const GramRecord* TrigramIndexView::find(std::uint32_t gram) const
+{
+    const GramRecord* end = grams + gramCount;
+    const GramRecord* it = std::lower_bound(grams, end, gram,
+                                            [](const GramRecord& record, std::uint32_t value) { return record.gram < value; });
+    if (it == end || it->gram != gram || it->offset + it->byteLength > postingsSize) {
+        return nullptr; // Not there (or pointing outside the blob, which we treat the same)
+    }
+    return it;
+}
+
+bool TrigramIndexView::candidates(const std::vector<std::string_view>& literals, std::vector<std::uint32_t>& out) const
+{
+    out.clear();
+
+    // 1️⃣ Every distinct gram of every literal
+    std::vector<std::uint32_t> wanted;
+    for (std::string_view literal : literals) {
+        for (std::size_t i = 0; i + 3 <= literal.size(); ++i) {
+            wanted.push_back(packGram(static_cast<unsigned char>(literal[i]),
+                                      static_cast<unsigned char>(literal[i + 1]),
+                                      static_cast<unsigned char>(literal[i + 2])));
+        }
+    }
+    if (wanted.empty()) {
+        return false; // Nothing long enough to look up
+    }
+    std::sort(wanted.begin(), wanted.end());
+    wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+    // 2️⃣ Find their lists - one missing gram means nothing can match at all
+    std::vector<const GramRecord*> lists;
+    for (std::uint32_t gram : wanted) {
+        const GramRecord* record = find(gram);
+        if (!record) {
+            return true; // Empty result, but a definite one
+        }
+        lists.push_back(record);
+    }
+
+    // 3️⃣ Intersect, rarest list first so the candidate set starts (and stays) small
+    std::sort(lists.begin(), lists.end(),
+              [](const GramRecord* a, const GramRecord* b) { return a->count < b->count; });
+
+    const GramRecord* rarest = lists.front();
+    PostingCursor seed(postings + rarest->offset, postings + rarest->offset + rarest->byteLength);
+    out.reserve(rarest->count);
+    while (seed.next()) {
+        out.push_back(seed.current());
+    }
+
+    for (std::size_t l = 1; l < lists.size() && !out.empty(); ++l) {
+        PostingCursor cursor(postings + lists[l]->offset, postings + lists[l]->offset + lists[l]->byteLength);
+        bool more = cursor.next();
+        std::size_t kept = 0;
+        for (std::uint32_t id : out) {
+            while (more && cursor.current() < id) {
+                more = cursor.next();
+            }
+            if (!more) {
+                break;
+            }
+            if (cursor.current() == id) {
+                out[kept++] = id;
+            }
+        }
+        out.resize(kept);
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 🔤 Trigram Posting Lists 🔤
+// For every 3-byte chunk ("gram") that appears in any indexed filename, we keep the sorted
+// list of name IDs containing it. A name can only contain "report" if it contains
+// "rep", "epo", "por" AND "ort", so intersecting those four lists leaves a handful of
+// candidates; only those get the real substring check.
+//
+// Lists are stored delta-encoded as LEB128 varints (IDs only ever go up, so the gaps are
+// small and mostly fit in one byte). There are two flavours of every index:
+// exact grams for case-sensitive searches and ASCII-folded grams for caseInsensitive ones.
+
+// One row of the on-disk gram table (sorted by gram so lookups can binary search)
+struct GramRecord {
+    std::uint32_t gram;       // Three bytes packed as (b0 << 16) | (b1 << 8) | b2
+    std::uint32_t count;      // How many names contain it
+    std::uint64_t offset;     // Where its list starts in the posting blob
+    std::uint32_t byteLength; // How many bytes of varints it takes
+    std::uint32_t reserved;
+};
+
+// 🏗️ Collects grams name by name, then flattens everything into tables + one posting blob
+class TrigramIndexBuilder
+{
+public:
+    // IDs have to be handed in increasing order (that's what keeps the deltas positive)
+    void addName(std::uint32_t id, std::string_view name);
+
+    // Appends both posting flavours to `postings` and fills the two sorted gram tables.
+    // Offsets in the tables are relative to the start of `postings`.
+    void finish(std::vector<GramRecord>& exactGrams, std::vector<GramRecord>& foldedGrams, std::string& postings);
+
+private:
+    struct PostingList {
+        std::uint32_t lastId = 0;
+        std::uint32_t count = 0;
+        std::string bytes;
+    };
+    using GramMap = std::unordered_map<std::uint32_t, PostingList>;
+
+    static void addGrams(GramMap& grams, std::uint32_t id, std::string_view name, bool fold);
+    static void flatten(GramMap& grams, std::vector<GramRecord>& table, std::string& postings);
+
+    GramMap exact;
+    GramMap folded;
+};
+
+// 🔎 Read-only view of one gram table + the posting blob it points into (straight from the mmap)
+class TrigramIndexView
+{
+public:
+    TrigramIndexView() = default;
+    TrigramIndexView(const GramRecord* grams, std::size_t gramCount, const unsigned char* postings, std::uint64_t postingsSize);
+
+    bool isEmpty() const { return gramCount == 0; }
+
+    // Every name ID that contains all the grams of all the literals, in increasing order.
+    // Literals must already be folded if this is the folded view.
+    // Returns false when no literal is at least 3 bytes long - then the grams can't help
+    // and the caller should fall back to checking every name.
+    bool candidates(const std::vector<std::string_view>& literals, std::vector<std::uint32_t>& out) const;
+
+private:
+    const GramRecord* find(std::uint32_t gram) const;
+
+    const GramRecord* grams = nullptr;
+    std::size_t gramCount = 0;
+    const unsigned char* postings = nullptr;
+    std::uint64_t postingsSize = 0;
+};
+
+#endif // TRIGRAMINDEX_H
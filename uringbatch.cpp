@@ -0,0 +1,320 @@
+#include "uringbatch.h"
+#include "searchtelemetry.h"
+
+#ifdef IYS_HAVE_IO_URING
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef IYS_HAVE_IO_URING
+
+namespace {
+
+// No liburing, so the three syscalls by hand
+int ringSetup(unsigned int entries, io_uring_params* params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ringEnter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ringRegister(int fd, unsigned int opcode, void* arg, unsigned int count)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+// The ring indexes are shared with the kernel: acquire what it wrote, release what we did
+inline unsigned int loadAcquire(const unsigned int* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+inline void storeRelease(unsigned int* p, unsigned int v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+template <typename T>
+T* at(void* base, std::size_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+constexpr unsigned int kMaxDepth = 4096;
+constexpr int kNotRun = INT_MIN; // A request's result until somebody (the ring or the fallback) answers it - never a real one
+
+} // namespace
+
+UringBatch::UringBatch(unsigned int queueDepth)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    const unsigned int wanted = std::clamp(queueDepth, 1u, kMaxDepth);
+    const int fd = ringSetup(wanted, &params);
+    if (fd < 0) {
+        const int setupErrno = errno;
+        whyNot = setupErrno == ENOSYS ? "this kernel has no io_uring"
+                 : setupErrno == EPERM ? "io_uring is switched off here (sysctl or seccomp)"
+                                       : std::string("io_uring_setup failed: ") + std::strerror(setupErrno);
+        return;
+    }
+
+    // statx and openat came with 5.6 - so did the probe, so a failed probe means "too old" as well
+    const std::size_t probeBytes = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    std::vector<unsigned char> probeSpace(probeBytes, 0);
+    auto* probe = reinterpret_cast<io_uring_probe*>(probeSpace.data());
+    const bool probed = ringRegister(fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+    auto supports = [&](unsigned int op) {
+        return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    };
+    if (!probed || !supports(IORING_OP_STATX) || !supports(IORING_OP_OPENAT)) {
+        whyNot = "this kernel's io_uring can't do statx/openat (needs Linux 5.6)";
+        ::close(fd);
+        return;
+    }
+
+    // One mapping for the submission ring, one for completions (shared when the kernel allows), one for the SQEs
+    sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+    }
+    sqRing = ::mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+    } else if (singleMap) {
+        cqRing = sqRing;
+    } else {
+        cqRing = ::mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+        }
+    }
+    sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+    sqeArea = ::mmap(nullptr, sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqeArea == MAP_FAILED) {
+        sqeArea = nullptr;
+    }
+    if (!sqRing || !cqRing || !sqeArea) {
+        whyNot = std::string("couldn't map the io_uring rings: ") + std::strerror(errno);
+        ringFd = fd;
+        teardown();
+        return;
+    }
+
+    sqTail = at<unsigned int>(sqRing, params.sq_off.tail);
+    sqMask = *at<unsigned int>(sqRing, params.sq_off.ring_mask);
+    cqHead = at<unsigned int>(cqRing, params.cq_off.head);
+    cqTail = at<unsigned int>(cqRing, params.cq_off.tail);
+    cqMask = *at<unsigned int>(cqRing, params.cq_off.ring_mask);
+    cqes = at<void>(cqRing, params.cq_off.cqes);
+
+    // SQE slot i always sits at position i of the index array - we fill the SQEs in ring order
+    unsigned int* sqArray = at<unsigned int>(sqRing, params.sq_off.array);
+    for (unsigned int i = 0; i < params.sq_entries; ++i) {
+        sqArray[i] = i;
+    }
+
+    entries = params.sq_entries;
+    ringFd = fd;
+    requests.reserve(entries);
+}
+
+UringBatch::~UringBatch()
+{
+    teardown();
+}
+
+void UringBatch::teardown()
+{
+    if (sqeArea) {
+        ::munmap(sqeArea, sqeBytes);
+    }
+    if (cqRing && cqRing != sqRing) {
+        ::munmap(cqRing, cqRingBytes);
+    }
+    if (sqRing) {
+        ::munmap(sqRing, sqRingBytes);
+    }
+    if (ringFd >= 0) {
+        ::close(ringFd); // Anything still in flight gets cancelled by the kernel
+    }
+    sqRing = cqRing = sqeArea = nullptr;
+    ringFd = -1;
+}
+
+bool UringBatch::available(std::string* whyNot)
+{
+    UringBatch probe(1);
+    if (whyNot) {
+        *whyNot = probe.problem();
+    }
+    return probe.isReady();
+}
+
+void UringBatch::startBatch()
+{
+    if (finished) {
+        requests.clear();
+        statxCount = 0;
+        finished = false;
+    }
+}
+
+std::size_t UringBatch::addStatx(int dirFd, const char* name, int flags, unsigned int mask)
+{
+    startBatch();
+    const std::size_t slot = statxCount++;
+    if (slot >= statxBuffers.size()) {
+        statxBuffers.resize(std::max<std::size_t>(statxBuffers.size() * 2, 64)); // Only addresses taken in run() count
+    }
+    requests.push_back(Request{IORING_OP_STATX, dirFd, name, flags, mask, slot, kNotRun});
+    return requests.size() - 1;
+}
+
+std::size_t UringBatch::addOpenat(int dirFd, const char* name, int flags)
+{
+    startBatch();
+    requests.push_back(Request{IORING_OP_OPENAT, dirFd, name, flags, 0, 0, kNotRun});
+    return requests.size() - 1;
+}
+
+void UringBatch::run(ThreadTelemetry* telemetry)
+{
+    const std::size_t total = pending(); // Not the last batch over again - its descriptors are somebody's already
+    finished = true;
+    if (total == 0) {
+        return;
+    }
+    if (!isReady()) {
+        runSynchronously();
+        return;
+    }
+
+    std::size_t next = 0;      // First request not yet written into the submission ring
+    std::size_t completed = 0;
+    unsigned int unsent = 0;   // Written into the ring, not yet taken by the kernel
+    unsigned int inFlight = 0; // Taken by the kernel, no completion yet
+    std::uint64_t enters = 0;
+    // Collect whatever finished
+    auto reap = [&] {
+        unsigned int head = *cqHead;
+        const unsigned int cqEnd = loadAcquire(cqTail);
+        for (; head != cqEnd; ++head) {
+            const io_uring_cqe* cqe = at<io_uring_cqe>(cqes, (head & cqMask) * sizeof(io_uring_cqe));
+            requests[static_cast<std::size_t>(cqe->user_data)].result = cqe->res;
+            ++completed;
+            --inFlight;
+        }
+        storeRelease(cqHead, head);
+    };
+    while (completed < total) {
+        // Top the ring up - the completion ring is twice as big, so depth() outstanding can never overflow it
+        unsigned int tail = *sqTail;
+        while (next < total && unsent + inFlight < entries) {
+            const Request& request = requests[next];
+            io_uring_sqe* sqe = at<io_uring_sqe>(sqeArea, (tail & sqMask) * sizeof(io_uring_sqe));
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = request.opcode;
+            sqe->fd = request.dirFd;
+            sqe->addr = reinterpret_cast<std::uint64_t>(request.name);
+            sqe->user_data = next;
+            if (request.opcode == IORING_OP_STATX) {
+                sqe->len = request.mask;
+                sqe->off = reinterpret_cast<std::uint64_t>(&statxBuffers[request.statxSlot]); // addr2
+                sqe->statx_flags = static_cast<std::uint32_t>(request.flags);
+            } else {
+                sqe->open_flags = static_cast<std::uint32_t>(request.flags);
+            }
+            ++tail;
+            ++next;
+            ++unsent;
+        }
+        storeRelease(sqTail, tail);
+
+        // Wait for the lot: we need every answer before returning anyway, and one wake-up beats one per completion
+        const int taken = ringEnter(ringFd, unsent, unsent + inFlight, IORING_ENTER_GETEVENTS);
+        ++enters;
+        if (taken < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue; // Nothing lost - the unsent ones are still in the ring for the next try
+            }
+            // 🐢 The ring gave up on us - drop it (this worker stays synchronous from here on)
+            whyNot = std::string("io_uring_enter failed: ") + std::strerror(errno);
+            // ...but the kernel may still be working on the ones it took. Wait for their answers
+            // first: made again the old way, an openat would open the folder twice and leak one.
+            reap();
+            while (inFlight > 0) {
+                if (ringEnter(ringFd, 0, inFlight, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                    break;
+                }
+                reap();
+            }
+            // Whatever it took and never answered is lost - failed, not repeated
+            for (std::size_t i = 0; i < next - unsent; ++i) {
+                if (requests[i].result == kNotRun) {
+                    requests[i].result = -ECANCELED;
+                }
+            }
+            teardown();
+            break;
+        }
+        unsent -= static_cast<unsigned int>(taken);
+        inFlight += static_cast<unsigned int>(taken);
+        reap();
+    }
+
+    if (telemetry) {
+        telemetry->add(TelemetryCounter::RingSubmits, enters);
+        telemetry->add(TelemetryCounter::RingRequests, completed);
+    }
+    if (completed < total) {
+        runSynchronously(); // Whatever never reached the broken ring (the rest are -ECANCELED by now)
+    }
+}
+
+void UringBatch::runSynchronously()
+{
+    for (Request& request : requests) {
+        if (request.result != kNotRun) {
+            continue;
+        }
+        if (request.opcode == IORING_OP_STATX) {
+            const int rc = ::statx(request.dirFd, request.name, request.flags, request.mask, &statxBuffers[request.statxSlot]);
+            request.result = rc == 0 ? 0 : -errno;
+        } else {
+            const int fd = ::openat(request.dirFd, request.name, request.flags);
+            request.result = fd >= 0 ? fd : -errno;
+        }
+    }
+}
+
+#else // No io_uring in this build: never ready, and callers never get past isReady()
+
+UringBatch::UringBatch(unsigned int queueDepth)
+    : whyNot("this build has no io_uring support (Linux only, IYS_ENABLE_IO_URING)")
+{
+    (void)queueDepth;
+}
+
+UringBatch::~UringBatch() = default;
+
+bool UringBatch::available(std::string* whyNot)
+{
+    UringBatch probe(1);
+    if (whyNot) {
+        *whyNot = probe.problem();
+    }
+    return false;
+}
+
+void UringBatch::run(ThreadTelemetry* telemetry)
+{
+    (void)telemetry;
+}
+
+#endif // IYS_HAVE_IO_URING
@@ -0,0 +1,120 @@
+#ifndef URINGBATCH_H
+#define URINGBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef IYS_HAVE_IO_URING
+#include <sys/stat.h> // struct statx
+#endif
+
+class ThreadTelemetry; // searchtelemetry.h
+
+// 💍 Batched Syscalls through io_uring 💍
+// The walk makes its blocking syscalls one at a time: a statx for every name that passed the
+// metadata predicates, another for every entry the filesystem didn't give a d_type, an openat
+// for every subfolder. On a warm cache each one is cheap. On a cold disk or a network mount
+// each one is a round trip, and the worker spends the whole folder waiting on them in a row.
+//
+// A UringBatch queues a folder's worth of those calls, hands them to the kernel together through
+// an io_uring submission ring, and waits until they are all done. The kernel works on them side
+// by side, and the worker makes one io_uring_enter() per queueDepth requests instead of one
+// syscall per request. It is plain raw syscalls plus three mmap'd rings. There is no liburing,
+// for the same reason the enumerator calls getdents64 itself.
+//
+// A ring belongs to ONE thread (the engine gives every worker its own). When the kernel says no
+// (older than 5.6, io_uring switched off, a seccomp filter), isReady() is false and the caller
+// keeps making the calls itself. If the ring breaks during run(), the requests the kernel never
+// took are made the old way right there, so the caller always gets an answer for every one. The
+// ones it did take get waited for; any it never answers come back as -ECANCELED, not repeated.
+
+// How the walk makes its per-entry syscalls
+enum class IoBackend {
+    Sync,   // One blocking call at a time - the classic
+    IoUring // Linux 5.6+: a folder's statx/openat calls batched through io_uring (see above); Sync when unavailable
+};
+
+class UringBatch
+{
+public:
+    // Asks for a ring with room for queueDepth requests in flight (the kernel rounds up to a power of two)
+    explicit UringBatch(unsigned int queueDepth);
+    ~UringBatch();
+
+    UringBatch(const UringBatch&) = delete;
+    UringBatch& operator=(const UringBatch&) = delete;
+
+    bool isReady() const { return ringFd >= 0; }
+    const std::string& problem() const { return whyNot; } // Why isReady() is false ("" when it isn't)
+    unsigned int depth() const { return entries; }        // Requests in flight at most
+
+    // Can this machine do it at all? Sets up a tiny ring and throws it away again.
+    static bool available(std::string* whyNot = nullptr);
+
+#ifdef IYS_HAVE_IO_URING
+    // Queueing just writes down the request - nothing reaches the kernel before run().
+    // name has to stay where it is until run() returns. Each call returns the request's index:
+    // 0, 1, 2... counting from the first request queued after the last run().
+    std::size_t addStatx(int dirFd, const char* name, int flags, unsigned int mask);
+    std::size_t addOpenat(int dirFd, const char* name, int flags);
+#endif
+    std::size_t pending() const { return finished ? 0 : requests.size(); } // Queued since the last run()
+
+    // Forgets whatever is queued and hasn't been run (somebody left in a hurry - an exception)
+    void discard() { requests.clear(); statxCount = 0; finished = false; }
+
+    // Sends everything queued, never more than depth() in flight at once, and waits for all of it.
+    // The submits and the requests are counted into telemetry when it's given.
+    void run(ThreadTelemetry* telemetry = nullptr);
+
+    // After run(): request i's return value (0, or the new descriptor) or -errno.
+    // Valid until the next add call.
+    int result(std::size_t index) const { return requests[index].result; }
+#ifdef IYS_HAVE_IO_URING
+    const struct statx& statxResult(std::size_t index) const { return statxBuffers[requests[index].statxSlot]; }
+#endif
+
+private:
+    struct Request {
+        std::uint8_t opcode;
+        int dirFd;
+        const char* name;
+        int flags;
+        unsigned int mask;      // statx only
+        std::size_t statxSlot;  // statx only: where the kernel writes the answer
+        int result;
+    };
+
+    void startBatch(); // Forgets the last batch before the first add of a new one
+    void runSynchronously(); // The fallback: makes every request nobody has answered yet
+    void teardown();         // Unmaps and closes whatever the ring got as far as having
+
+    int ringFd = -1;
+    unsigned int entries = 0;
+    std::string whyNot;
+    bool finished = true; // The current requests have been run (so the next add starts over)
+
+    // The three shared memory areas and the bits of them we touch
+    void* sqRing = nullptr;
+    std::size_t sqRingBytes = 0;
+    void* cqRing = nullptr; // Often the same mapping as sqRing
+    std::size_t cqRingBytes = 0;
+    void* sqeArea = nullptr;
+    std::size_t sqeBytes = 0;
+    unsigned int* sqTail = nullptr;
+    unsigned int sqMask = 0;
+    unsigned int* cqHead = nullptr;
+    unsigned int* cqTail = nullptr;
+    unsigned int cqMask = 0;
+    void* cqes = nullptr;
+
+    std::vector<Request> requests;
+    std::size_t statxCount = 0; // statx requests in the current batch
+#ifdef IYS_HAVE_IO_URING
+    std::vector<struct statx> statxBuffers; // Grows to the biggest batch, then stays
+#endif
+};
+
+#endif // URINGBATCH_H